@@ -0,0 +1,285 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <optional>
+#include <thread>
+
+#include "common/task_scheduler.h"
+#include "common/thread.h"
+
+namespace Common {
+namespace {
+constexpr std::size_t NUM_PRIORITIES = 3;
+
+// Times an idle worker looks for work again before going to sleep. Waking a worker up costs far
+// more than a few failed steals, and producers tend to submit tasks in bursts.
+constexpr int SPIN_ROUNDS = 64;
+
+thread_local const TaskScheduler* current_scheduler{};
+thread_local std::size_t current_worker{};
+} // Anonymous namespace
+
+struct alignas(64) TaskScheduler::Worker {
+    std::mutex mutex;
+    std::array<std::deque<Task>, NUM_PRIORITIES> queues;
+    // Tasks in the queues, lets thieves skip empty workers without taking their lock
+    std::atomic<std::size_t> num_tasks{};
+    std::atomic<u64> num_executed{};
+    std::atomic<u64> num_stolen{};
+};
+
+TaskScheduler::TaskScheduler(std::size_t num_workers, std::string name)
+    : thread_name{std::move(name)} {
+    workers.reserve(num_workers);
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    threads.reserve(num_workers);
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        threads.emplace_back([this, i](std::stop_token stop_token) { WorkerLoop(stop_token, i); });
+    }
+}
+
+TaskScheduler::~TaskScheduler() = default;
+
+TaskSchedulerStats TaskScheduler::GetStats() const {
+    TaskSchedulerStats stats{
+        .submitted = num_submitted.load(std::memory_order_relaxed),
+        .executed = 0,
+        .stolen = 0,
+        .helped = num_helped.load(std::memory_order_relaxed),
+        .sleeps = num_sleeps.load(std::memory_order_relaxed),
+    };
+    for (const auto& worker : workers) {
+        stats.executed += worker->num_executed.load(std::memory_order_relaxed);
+        stats.stolen += worker->num_stolen.load(std::memory_order_relaxed);
+    }
+    stats.executed += stats.helped;
+    return stats;
+}
+
+void TaskScheduler::Submit(TaskPriority priority, Task task) {
+    std::size_t index = current_worker;
+    if (current_scheduler != this) {
+        index = next_worker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+    }
+    Worker& worker = *workers[index];
+    {
+        std::scoped_lock lock{worker.mutex};
+        worker.queues[static_cast<std::size_t>(priority)].push_back(std::move(task));
+        worker.num_tasks.fetch_add(1, std::memory_order_relaxed);
+    }
+    num_submitted.fetch_add(1, std::memory_order_relaxed);
+
+    // Pairs with the sleeping workers checking num_queued, one of both sides sees the other
+    num_queued.fetch_add(1);
+    if (num_sleeping.load() != 0) {
+        { std::scoped_lock lock{sleep_mutex}; }
+        sleep_condition.notify_one();
+    }
+}
+
+bool TaskScheduler::RunQueuedTask(TaskPriority lowest_priority) {
+    const std::size_t num_workers = workers.size();
+    const auto take = [](Worker& worker, std::size_t priority) -> std::optional<Task> {
+        if (worker.num_tasks.load(std::memory_order_relaxed) == 0) {
+            return std::nullopt;
+        }
+        std::scoped_lock lock{worker.mutex};
+        auto& queue = worker.queues[priority];
+        if (queue.empty()) {
+            return std::nullopt;
+        }
+        std::optional<Task> task{std::move(queue.front())};
+        queue.pop_front();
+        worker.num_tasks.fetch_sub(1, std::memory_order_relaxed);
+        return task;
+    };
+
+    for (std::size_t priority = 0; priority <= static_cast<std::size_t>(lowest_priority);
+         ++priority) {
+        std::optional<Task> task = take(*workers[current_worker], priority);
+        const bool stolen = !task;
+        for (std::size_t i = 1; !task && i < num_workers; ++i) {
+            task = take(*workers[(current_worker + i) % num_workers], priority);
+        }
+        if (!task) {
+            continue;
+        }
+        num_queued.fetch_sub(1, std::memory_order_relaxed);
+        ExecuteTask(*task);
+
+        Worker& worker = *workers[current_worker];
+        worker.num_executed.fetch_add(1, std::memory_order_relaxed);
+        if (stolen) {
+            worker.num_stolen.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+    return false;
+}
+
+bool TaskScheduler::RunGroupTask(const TaskGroup& group) {
+    const std::size_t priority = static_cast<std::size_t>(group.priority);
+    const std::size_t num_workers = workers.size();
+    const std::size_t first = current_scheduler == this ? current_worker : 0;
+    for (std::size_t i = 0; i < num_workers; ++i) {
+        Worker& worker = *workers[(first + i) % num_workers];
+        if (worker.num_tasks.load(std::memory_order_relaxed) == 0) {
+            continue;
+        }
+        std::optional<Task> task;
+        {
+            std::scoped_lock lock{worker.mutex};
+            auto& queue = worker.queues[priority];
+            const auto it = std::ranges::find(queue, &group, &Task::owner);
+            if (it == queue.end()) {
+                continue;
+            }
+            task.emplace(std::move(*it));
+            queue.erase(it);
+            worker.num_tasks.fetch_sub(1, std::memory_order_relaxed);
+        }
+        num_queued.fetch_sub(1, std::memory_order_relaxed);
+        ExecuteTask(*task);
+        num_helped.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void TaskScheduler::ExecuteTask(Task& task) {
+    if (task.group != nullptr) {
+        task.group->Execute(task);
+    } else {
+        task.func();
+    }
+}
+
+void TaskScheduler::WorkerLoop(std::stop_token stop_token, std::size_t index) {
+    SetCurrentThreadName(thread_name.c_str());
+    current_scheduler = this;
+    current_worker = index;
+
+    int idle_rounds = 0;
+    while (!stop_token.stop_requested()) {
+        if (RunQueuedTask(TaskPriority::Low)) {
+            idle_rounds = 0;
+            continue;
+        }
+        if (++idle_rounds < SPIN_ROUNDS) {
+            std::this_thread::yield();
+            continue;
+        }
+        idle_rounds = 0;
+
+        std::unique_lock lock{sleep_mutex};
+        num_sleeping.fetch_add(1);
+        num_sleeps.fetch_add(1, std::memory_order_relaxed);
+        CondvarWait(sleep_condition, lock, stop_token, [this] { return num_queued.load() != 0; });
+        num_sleeping.fetch_sub(1);
+    }
+}
+
+TaskScheduler& GetTaskScheduler() {
+    static TaskScheduler scheduler{std::max(std::thread::hardware_concurrency(), 2U) - 1};
+    return scheduler;
+}
+
+TaskGroup::TaskGroup(TaskPriority priority_, std::size_t max_parallel_, TaskScheduler& scheduler_)
+    : scheduler{scheduler_}, priority{priority_}, max_parallel{max_parallel_} {}
+
+TaskGroup::~TaskGroup() {
+    Cancel();
+    Wait();
+}
+
+void TaskGroup::Run(UniqueFunction<void> func) {
+    num_pending.fetch_add(1, std::memory_order_relaxed);
+    TaskScheduler::Task task{
+        .func = std::move(func),
+        .group = this,
+        .owner = this,
+        .epoch = epoch.load(std::memory_order_relaxed),
+    };
+    if (max_parallel == 0) {
+        scheduler.Submit(priority, std::move(task));
+        return;
+    }
+    {
+        std::scoped_lock lock{mutex};
+        limited_tasks.push(std::move(task));
+        if (num_runners >= max_parallel) {
+            return;
+        }
+        ++num_runners;
+    }
+    // Runners count as pending, so waiting on the group also waits for them to let go of it
+    num_pending.fetch_add(1, std::memory_order_relaxed);
+    scheduler.Submit(priority, {
+                                   .func = [this] { RunLimited(); },
+                                   .group = nullptr,
+                                   .owner = this,
+                                   .epoch = 0,
+                               });
+}
+
+void TaskGroup::Wait(std::stop_token stop_token) {
+    std::stop_callback callback(stop_token, [this] { Cancel(); });
+    while (!IsIdle() && scheduler.RunGroupTask(*this)) {
+    }
+    std::unique_lock lock{mutex};
+    idle_condition.wait(lock, [this] { return IsIdle(); });
+}
+
+void TaskGroup::Cancel() {
+    epoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TaskGroup::Execute(TaskScheduler::Task& task) {
+    if (task.epoch == epoch.load(std::memory_order_relaxed)) {
+        task.func();
+    }
+    // Release what the task captured before the group can be considered idle
+    task.func = {};
+    Finish();
+}
+
+void TaskGroup::RunLimited() {
+    while (true) {
+        TaskScheduler::Task task{};
+        {
+            std::scoped_lock lock{mutex};
+            if (limited_tasks.empty()) {
+                --num_runners;
+                break;
+            }
+            task = std::move(limited_tasks.front());
+            limited_tasks.pop();
+        }
+        Execute(task);
+    }
+    Finish();
+}
+
+void TaskGroup::Finish() {
+    std::size_t pending = num_pending.load(std::memory_order_relaxed);
+    while (pending > 1) {
+        if (num_pending.compare_exchange_weak(pending, pending - 1, std::memory_order_acq_rel,
+                                              std::memory_order_relaxed)) {
+            return;
+        }
+    }
+    // The last task signals under the lock, so a waiter can't see the group idle and destroy it
+    // while this thread still uses it
+    std::scoped_lock lock{mutex};
+    if (num_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        idle_condition.notify_all();
+    }
+}
+
+} // namespace Common
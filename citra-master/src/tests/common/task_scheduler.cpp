@@ -0,0 +1,263 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/task_scheduler.h"
+#include "common/thread.h"
+#include "common/thread_worker.h"
+
+using namespace Common;
+
+namespace {
+/// Task keeping a worker busy until released.
+class Blocker {
+public:
+    void Block(TaskGroup& group) {
+        group.Run([this] { event.Wait(); });
+    }
+
+    void Release() {
+        event.Set();
+    }
+
+private:
+    Event event;
+};
+
+/// Small amount of work, the kind of task where scheduling overhead shows.
+u64 Work(u64 seed) {
+    for (int i = 0; i < 64; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    return seed;
+}
+} // Anonymous namespace
+
+TEST_CASE("TaskScheduler: Runs every task", "[common]") {
+    TaskScheduler scheduler{4};
+    std::atomic<std::size_t> count{};
+    std::vector<std::jthread> submitters;
+    for (int i = 0; i < 4; ++i) {
+        submitters.emplace_back([&] {
+            TaskGroup group{TaskPriority::Normal, 0, scheduler};
+            for (int task = 0; task < 10000; ++task) {
+                group.Run([&count] { ++count; });
+            }
+            group.Wait();
+        });
+    }
+    submitters.clear();
+    REQUIRE(count == 40000);
+    REQUIRE(scheduler.GetStats().executed == 40000);
+}
+
+TEST_CASE("TaskScheduler: Priorities", "[common]") {
+    TaskScheduler scheduler{1};
+    TaskGroup blocked{TaskPriority::High, 0, scheduler};
+    TaskGroup low{TaskPriority::Low, 0, scheduler};
+    TaskGroup high{TaskPriority::High, 0, scheduler};
+
+    Blocker blocker;
+    blocker.Block(blocked);
+    std::mutex mutex;
+    std::vector<TaskPriority> order;
+    for (int i = 0; i < 4; ++i) {
+        low.Run([&] {
+            std::scoped_lock lock{mutex};
+            order.push_back(TaskPriority::Low);
+        });
+        high.Run([&] {
+            std::scoped_lock lock{mutex};
+            order.push_back(TaskPriority::High);
+        });
+    }
+    // Waiting on a group helps with its tasks, so wait for the worker to drain the queues instead
+    Event done;
+    low.Run([&done] { done.Set(); });
+    blocker.Release();
+    done.Wait();
+    low.Wait();
+    high.Wait();
+    REQUIRE(order.size() == 8);
+    REQUIRE(std::is_sorted(order.begin(), order.end()));
+}
+
+TEST_CASE("TaskGroup: Limited parallelism", "[common]") {
+    TaskScheduler scheduler{4};
+    TaskGroup group{TaskPriority::Normal, 1, scheduler};
+    std::vector<int> order;
+    for (int i = 0; i < 10000; ++i) {
+        group.Run([&order, i] { order.push_back(i); });
+    }
+    group.Wait();
+    REQUIRE(order.size() == 10000);
+    REQUIRE(std::is_sorted(order.begin(), order.end()));
+
+    std::atomic<int> running{};
+    std::atomic<int> max_running{};
+    TaskGroup pair{TaskPriority::Normal, 2, scheduler};
+    for (int i = 0; i < 1000; ++i) {
+        pair.Run([&] {
+            const int now = ++running;
+            int max = max_running.load();
+            while (now > max && !max_running.compare_exchange_weak(max, now)) {
+            }
+            std::this_thread::yield();
+            --running;
+        });
+    }
+    pair.Wait();
+    REQUIRE(max_running <= 2);
+}
+
+TEST_CASE("TaskGroup: Cancel", "[common]") {
+    TaskScheduler scheduler{1};
+    TaskGroup blocked{TaskPriority::High, 0, scheduler};
+    TaskGroup group{TaskPriority::Low, 0, scheduler};
+    Blocker blocker;
+    blocker.Block(blocked);
+
+    std::atomic<int> count{};
+    for (int i = 0; i < 100; ++i) {
+        group.Run([&count] { ++count; });
+    }
+    group.Cancel();
+    group.Run([&count] { count += 1000; });
+    blocker.Release();
+    group.Wait();
+    REQUIRE(count == 1000);
+
+    // Stopping a wait cancels as well
+    blocker.Block(blocked);
+    for (int i = 0; i < 100; ++i) {
+        group.Run([&count] { ++count; });
+    }
+    std::stop_source stop_source;
+    stop_source.request_stop();
+    blocker.Release();
+    group.Wait(stop_source.get_token());
+    REQUIRE(count == 1000);
+}
+
+TEST_CASE("TaskGroup: Nested waits", "[common]") {
+    // Tasks waiting on other groups run the queued tasks of those groups instead of blocking
+    TaskScheduler scheduler{2};
+    TaskGroup outer{TaskPriority::Normal, 0, scheduler};
+    std::atomic<int> count{};
+    for (int i = 0; i < 16; ++i) {
+        outer.Run([&] {
+            TaskGroup inner{TaskPriority::Normal, 0, scheduler};
+            for (int j = 0; j < 16; ++j) {
+                inner.Run([&count] { ++count; });
+            }
+            inner.Wait();
+        });
+    }
+    outer.Wait();
+    REQUIRE(count == 256);
+}
+
+TEST_CASE("TaskGroup: Waits only help their own group", "[common]") {
+    // The task of group A waits on group B while a task waiting on A is queued before the task
+    // of B. Helping with any queued task would run the task waiting on A under A's own task.
+    TaskScheduler scheduler{1};
+    TaskGroup blocked{TaskPriority::Normal, 0, scheduler};
+    TaskGroup a{TaskPriority::Normal, 0, scheduler};
+    TaskGroup b{TaskPriority::Normal, 0, scheduler};
+    TaskGroup waiter{TaskPriority::Normal, 0, scheduler};
+
+    Blocker blocker;
+    blocker.Block(blocked);
+    Event done;
+    std::atomic<int> order{};
+    int b_order{};
+    int a_order{};
+    a.Run([&] {
+        b.Wait();
+        a_order = ++order;
+    });
+    waiter.Run([&] {
+        a.Wait();
+        done.Set();
+    });
+    b.Run([&] { b_order = ++order; });
+    blocker.Release();
+
+    REQUIRE(done.WaitFor(std::chrono::seconds(10)));
+    REQUIRE(b_order == 1);
+    REQUIRE(a_order == 2);
+}
+
+TEST_CASE("TaskScheduler: Contention benchmark", "[.][common]") {
+    // Several threads submitting small tasks and waiting on them, the way the texture, shader and
+    // rasterizer pools are used at the same time
+    const std::size_t num_threads = std::max(std::thread::hardware_concurrency(), 2U);
+    constexpr int num_submitters = 4;
+    constexpr int tasks_per_batch = 256;
+    constexpr int num_batches = 64;
+    constexpr double total_tasks = num_submitters * tasks_per_batch * num_batches;
+
+    const auto bench = [&](const char* name, auto&& make_pool, auto&& run_batch) {
+        double best = std::numeric_limits<double>::max();
+        for (int run = 0; run < 5; ++run) {
+            auto pools = make_pool();
+            const auto start = std::chrono::steady_clock::now();
+            std::vector<std::jthread> submitters;
+            for (int submitter = 0; submitter < num_submitters; ++submitter) {
+                submitters.emplace_back([&, submitter] {
+                    for (int batch = 0; batch < num_batches; ++batch) {
+                        run_batch(*pools, submitter);
+                    }
+                });
+            }
+            submitters.clear();
+            const std::chrono::duration<double, std::micro> elapsed =
+                std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        printf("TaskScheduler: %s %.0f ns per task\n", name, best * 1000.0 / total_tasks);
+    };
+
+    std::atomic<u64> sink{};
+    // A pool per submitter, each sized for the whole machine like the pools they replace
+    using Workers = std::vector<std::unique_ptr<ThreadWorker>>;
+    bench(
+        "ThreadWorker pools",
+        [&] {
+            auto workers = std::make_unique<Workers>();
+            for (int i = 0; i < num_submitters; ++i) {
+                workers->push_back(std::make_unique<ThreadWorker>(num_threads - 1, "Bench"));
+            }
+            return workers;
+        },
+        [&](Workers& workers, int submitter) {
+            ThreadWorker& worker = *workers[submitter];
+            for (int task = 0; task < tasks_per_batch; ++task) {
+                worker.QueueWork([&sink, task] { sink += Work(task); });
+            }
+            worker.WaitForRequests();
+        });
+    bench(
+        "shared TaskScheduler",
+        [&] { return std::make_unique<TaskScheduler>(num_threads - 1, "Bench"); },
+        [&](TaskScheduler& scheduler, int) {
+            TaskGroup group{TaskPriority::High, 0, scheduler};
+            for (int task = 0; task < tasks_per_batch; ++task) {
+                group.Run([&sink, task] { sink += Work(task); });
+            }
+            group.Wait();
+        });
+}
@@ -9,19 +9,23 @@
 #include <cmath>
 #include <memory>
 #include <span>
+#include <vector>
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <fmt/format.h>
 #include <nihstro/inline_assembly.h>
+#include "video_core/pica/regs_shader.h"
 #include "video_core/pica/shader_setup.h"
 #include "video_core/pica/shader_unit.h"
 #include "video_core/shader/shader_interpreter.h"
+#include "video_core/shader/shader_jit.h"
 #if CITRA_ARCH(x86_64)
 #include "video_core/shader/shader_jit_x64_compiler.h"
 #elif CITRA_ARCH(arm64)
 #include "video_core/shader/shader_jit_a64_compiler.h"
 #endif
 
+using JitEngine = Pica::Shader::JitEngine;
 using JitShader = Pica::Shader::JitShader;
 using ShaderInterpreter = Pica::Shader::InterpreterEngine;
 
@@ -702,4 +706,115 @@ TEST_CASE("Source Swizzle", "[video_core][shader][shader_jit]") {
             Common::Vec4f(iota_vec.y, iota_vec.y, iota_vec.y, iota_vec.y));
 }
 
+TEST_CASE("RunBatch", "[video_core][shader][shader_jit]") {
+    const auto sh_input1 = SourceRegister::MakeInput(0);
+    const auto sh_input2 = SourceRegister::MakeInput(1);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+    const auto sh_c0 = SourceRegister::MakeFloat(0);
+    const auto sh_output1 = DestRegister::MakeOutput(0);
+    const auto sh_output2 = DestRegister::MakeOutput(1);
+
+    auto shader_setup = CompileShaderSetup({
+        // clang-format off
+        {OpCode::Id::NOP}, // cmp sh_input1.x < sh_input2.x, sh_input1.y >= sh_input2.y
+        {OpCode::Id::NOP}, // ifc cc.x
+            {OpCode::Id::MUL, sh_output1, sh_c0, sh_input1},
+        // else
+            {OpCode::Id::ADD, sh_output1, sh_input1, sh_input2},
+        {OpCode::Id::MOV, sh_temp, sh_input2},
+        {OpCode::Id::LOOP, 0},
+            {OpCode::Id::ADD, sh_temp, sh_temp, sh_input1},
+            {OpCode::Id::NOP}, // breakc cc.y
+        {Type::EndLoop},
+        {OpCode::Id::MOV, sh_output2, sh_temp},
+        {OpCode::Id::END},
+        // clang-format on
+    });
+
+    // nihstro does not support the CMP, IFC and BREAKC instructions, so the instruction-binaries
+    // must be manually inserted here. The comparison uses the operands of the ADD.
+    const nihstro::Instruction ADD = {shader_setup->program_code[3]};
+    nihstro::Instruction CMP = {};
+    CMP.opcode = nihstro::OpCode(nihstro::OpCode::Id::CMP);
+    CMP.common.operand_desc_id = ADD.common.operand_desc_id.Value();
+    CMP.common.src1 = sh_input1;
+    CMP.common.src2 = sh_input2;
+    CMP.common.compare_op.x = nihstro::Instruction::Common::CompareOpType::LessThan;
+    CMP.common.compare_op.y = nihstro::Instruction::Common::CompareOpType::GreaterEqual;
+    shader_setup->program_code[0] = CMP.hex;
+
+    nihstro::Instruction IFC = {};
+    IFC.opcode = nihstro::OpCode(nihstro::OpCode::Id::IFC);
+    IFC.flow_control.op = nihstro::Instruction::FlowControlType::JustX;
+    IFC.flow_control.refx = 1;
+    IFC.flow_control.dest_offset = 3;
+    IFC.flow_control.num_instructions = 1;
+    shader_setup->program_code[1] = IFC.hex;
+
+    nihstro::Instruction BREAKC = {};
+    BREAKC.opcode = nihstro::OpCode(nihstro::OpCode::Id::BREAKC);
+    BREAKC.flow_control.op = nihstro::Instruction::FlowControlType::JustY;
+    BREAKC.flow_control.refy = 1;
+    shader_setup->program_code[7] = BREAKC.hex;
+
+    shader_setup->uniforms.f[0] = {Pica::f24::FromFloat32(2.0f), Pica::f24::FromFloat32(-1.0f),
+                                   Pica::f24::FromFloat32(0.5f), Pica::f24::FromFloat32(3.0f)};
+    shader_setup->uniforms.i[0] = {3, 0, 1, 0};
+
+    Pica::ShaderRegs config{};
+    config.max_input_attribute_index.Assign(1);
+    config.input_attribute_to_register_map_low = 0x10;
+    config.output_mask.Assign(0b11);
+
+    // Vertices take either side of the IFC and break out of the loop at different iterations
+    std::vector<Pica::AttributeBuffer> vertices(10);
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        const float value = static_cast<float>(i);
+        vertices[i][0] = {Pica::f24::FromFloat32(value),
+                          Pica::f24::FromFloat32(static_cast<float>(i % 3)),
+                          Pica::f24::FromFloat32(value * 0.5f), Pica::f24::One()};
+        vertices[i][1] = {Pica::f24::FromFloat32(4.5f), Pica::f24::One(),
+                          Pica::f24::FromFloat32(2.0f), Pica::f24::FromFloat32(-value)};
+    }
+
+    // Deduplicate the indices like PicaCore, shading each vertex once at its first index
+    constexpr std::array<u32, 18> indices = {0, 1, 2, 2, 1, 3, 4, 5, 6, 6, 5, 7, 8, 9, 0, 0, 9, 4};
+    std::vector<Pica::AttributeBuffer> unique_inputs;
+    std::array<std::size_t, indices.size()> index_slots;
+    std::vector<std::size_t> vertex_slots(vertices.size(), indices.size());
+    for (std::size_t index = 0; index < indices.size(); ++index) {
+        std::size_t& slot = vertex_slots[indices[index]];
+        if (slot == indices.size()) {
+            slot = unique_inputs.size();
+            unique_inputs.push_back(vertices[indices[index]]);
+        }
+        index_slots[index] = slot;
+    }
+    REQUIRE(unique_inputs.size() == vertices.size());
+
+    JitEngine engine;
+    engine.SetupBatch(*shader_setup, 0);
+
+    // The number of vertices isn't a multiple of the batch width, so the last ones are shaded
+    // one at a time
+    Pica::ShaderUnit batch_unit;
+    std::vector<Pica::AttributeBuffer> batch_outputs(unique_inputs.size());
+    engine.RunBatch(*shader_setup, config, batch_unit, unique_inputs, batch_outputs);
+
+    for (std::size_t index = 0; index < indices.size(); ++index) {
+        Pica::ShaderUnit shader_unit;
+        Pica::AttributeBuffer output{};
+        shader_unit.LoadInput(config, vertices[indices[index]]);
+        engine.Run(*shader_setup, shader_unit);
+        shader_unit.WriteOutput(config, output);
+
+        const Pica::AttributeBuffer& batch_output = batch_outputs[index_slots[index]];
+        for (std::size_t reg = 0; reg < 2; ++reg) {
+            for (std::size_t comp = 0; comp < 4; ++comp) {
+                REQUIRE(batch_output[reg][comp].ToFloat32() == output[reg][comp].ToFloat32());
+            }
+        }
+    }
+}
+
 #endif // CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
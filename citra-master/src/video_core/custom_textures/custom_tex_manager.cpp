@@ -89,10 +89,6 @@ void CustomTexManager::FindCustomTextures() {
     if (textures_loaded) {
         return;
     }
-    if (!workers) {
-        CreateWorkers();
-    }
-
     const u64 title_id = system.Kernel().GetCurrentProcess()->codeset->program_id;
     const auto textures = GetTextures(title_id);
     if (!ReadConfig(title_id)) {
@@ -216,7 +212,7 @@ void CustomTexManager::PreloadTextures(const std::atomic_bool& stop_run,
     const u64 max_mem =
         (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
 
-    workers->QueueWork([&]() {
+    workers.Run([&]() {
         for (auto& [hash, material] : material_map) {
             if (size_sum > max_mem) {
                 LOG_WARNING(Render, "Aborting texture preload due to insufficient memory");
@@ -233,7 +229,7 @@ void CustomTexManager::PreloadTextures(const std::atomic_bool& stop_run,
             preloaded++;
         }
     });
-    workers->WaitForRequests();
+    workers.Wait();
     async_custom_loading = false;
 }
 
@@ -279,10 +275,7 @@ void CustomTexManager::DumpTexture(const SurfaceParams& params, u32 level, std::
         Common::FlipRGBA8Texture(decoded, width, height);
         image_interface.EncodePNG(dump_path, width, height, decoded);
     };
-    if (!workers) {
-        CreateWorkers();
-    }
-    workers->QueueWork(std::move(dump));
+    dump_workers.Run(std::move(dump));
     dumped_textures.insert(data_hash);
 }
 
@@ -302,7 +295,7 @@ bool CustomTexManager::Decode(Material* material, std::function<bool()>&& upload
     }
     if (material->IsUnloaded()) {
         material->state = DecodeState::Pending;
-        workers->QueueWork([material, this] { material->LoadFromDisk(flip_png_files); });
+        workers.Run([material, this] { material->LoadFromDisk(flip_png_files); });
     }
     async_uploads.push_back({
         .material = material,
@@ -384,9 +377,4 @@ std::vector<FileUtil::FSTEntry> CustomTexManager::GetTextures(u64 title_id) {
     return textures;
 }
 
-void CustomTexManager::CreateWorkers() {
-    const std::size_t num_workers = std::max(std::thread::hardware_concurrency(), 2U) - 1;
-    workers = std::make_unique<Common::ThreadWorker>(num_workers, "Custom textures");
-}
-
 } // namespace VideoCore
@@ -2,6 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <span>
 #include "common/arch.h"
 #include "common/archives.h"
 #include "common/microprofile.h"
@@ -541,17 +544,14 @@ void PicaCore::LoadVertices(bool is_indexed) {
     const u8* index_address_8 = memory.GetPhysicalPointer(base_address + index_info.offset);
     const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
     const bool index_u16 = index_info.format != 0;
-
-    // Simple circular-replacement vertex cache
-    const std::size_t VERTEX_CACHE_SIZE = 64;
-    std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
-    std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
-    std::array<AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
-    u32 vertex_cache_pos = 0;
+    const auto get_vertex = [&](u32 index) -> u32 {
+        // Indexed rendering doesn't use the start offset
+        return is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
+                          : (index + pipeline.vertex_offset);
+    };
 
     // Compile the vertex shader for this batch.
     ShaderUnit shader_unit;
-    AttributeBuffer vs_output;
     shader_engine->SetupBatch(vs_setup, regs.internal.vs.main_offset);
 
     // Setup geometry pipeline in case we are using a geometry shader.
@@ -559,55 +559,101 @@ void PicaCore::LoadVertices(bool is_indexed) {
     geometry_pipeline.Setup(shader_engine.get());
     ASSERT(!geometry_pipeline.NeedIndexInput() || is_indexed);
 
-    for (u32 index = 0; index < pipeline.num_vertices; ++index) {
-        // Indexed rendering doesn't use the start offset
-        const u32 vertex = is_indexed
-                               ? (index_u16 ? index_address_16[index] : index_address_8[index])
-                               : (index + pipeline.vertex_offset);
-
-        bool vertex_cache_hit = false;
-        if (is_indexed) {
-            if (geometry_pipeline.NeedIndexInput()) {
-                geometry_pipeline.SubmitIndex(vertex);
-                continue;
-            }
-
-            for (u32 i = 0; i < VERTEX_CACHE_SIZE; ++i) {
-                if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
-                    vs_output = vertex_cache[i];
-                    vertex_cache_hit = true;
-                    break;
-                }
-            }
+    if (geometry_pipeline.NeedIndexInput()) {
+        for (u32 index = 0; index < pipeline.num_vertices; ++index) {
+            geometry_pipeline.SubmitIndex(get_vertex(index));
         }
+        return;
+    }
 
-        if (!vertex_cache_hit) {
-            // Initialize data for the current vertex
-            AttributeBuffer input;
-            loader.LoadVertex(base_address, index, vertex, input, input_default_attributes);
+    // Vertices are shaded in batches, indexed draws shade each referenced vertex only once.
+    // With a debugger attached every vertex is shaded on its own, right after its invocation is
+    // recorded and before it is submitted, like it was before batching.
+    static constexpr u32 VERTEX_BATCH_SIZE = 64;
+    const u32 batch_size = debug_context ? 1 : VERTEX_BATCH_SIZE;
+    vertex_inputs.resize(VERTEX_BATCH_SIZE);
+    const auto shade_vertices = [&](std::span<const u32> indices, std::span<const u32> vertices,
+                                    std::span<AttributeBuffer> outputs) {
+        for (std::size_t i = 0; i < vertices.size(); ++i) {
+            AttributeBuffer& input = vertex_inputs[i];
+            loader.LoadVertex(base_address, indices[i], vertices[i], input,
+                              input_default_attributes);
 
             // Record vertex processing to the debugger.
             if (debug_context) {
                 debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
                                        std::addressof(input));
             }
+        }
+        shader_engine->RunBatch(vs_setup, regs.internal.vs, shader_unit,
+                                std::span{vertex_inputs}.first(vertices.size()), outputs);
+    };
+
+    if (!is_indexed) {
+        vertex_outputs.resize(VERTEX_BATCH_SIZE);
+        std::array<u32, VERTEX_BATCH_SIZE> indices;
+        std::array<u32, VERTEX_BATCH_SIZE> vertices;
+        for (u32 first = 0; first < pipeline.num_vertices; first += batch_size) {
+            const u32 count = std::min(batch_size, pipeline.num_vertices - first);
+            for (u32 i = 0; i < count; ++i) {
+                indices[i] = first + i;
+                vertices[i] = get_vertex(first + i);
+            }
+            shade_vertices(std::span{indices}.first(count), std::span{vertices}.first(count),
+                           vertex_outputs);
+            for (u32 i = 0; i < count; ++i) {
+                geometry_pipeline.SubmitVertex(vertex_outputs[i]);
+            }
+        }
+        return;
+    }
+
+    // Deduplicate the index stream, keeping the first index of each unique vertex.
+    vertex_slots.resize(index_u16 ? 0x10000 : 0x100);
+    if (++vertex_slot_generation == 0) {
+        std::fill(vertex_slots.begin(), vertex_slots.end(), VertexSlot{});
+        vertex_slot_generation = 1;
+    }
+    index_slots.resize(pipeline.num_vertices);
+    unique_indices.clear();
+    unique_vertices.clear();
+    for (u32 index = 0; index < pipeline.num_vertices; ++index) {
+        const u32 vertex = get_vertex(index);
+        VertexSlot& vertex_slot = vertex_slots[vertex];
+        if (vertex_slot.generation != vertex_slot_generation) {
+            vertex_slot.generation = vertex_slot_generation;
+            vertex_slot.slot = static_cast<u32>(unique_vertices.size());
+            unique_indices.push_back(index);
+            unique_vertices.push_back(vertex);
+        }
+        index_slots[index] = vertex_slot.slot;
+    }
 
-            // Invoke the vertex shader for this vertex.
-            shader_unit.LoadInput(regs.internal.vs, input);
-            shader_engine->Run(vs_setup, shader_unit);
-            shader_unit.WriteOutput(regs.internal.vs, vs_output);
-
-            // Cache the vertex when doing indexed rendering.
-            if (is_indexed) {
-                vertex_cache[vertex_cache_pos] = vs_output;
-                vertex_cache_valid[vertex_cache_pos] = true;
-                vertex_cache_ids[vertex_cache_pos] = vertex;
-                vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
+    const u32 num_unique = static_cast<u32>(unique_vertices.size());
+    vertex_outputs.resize(num_unique);
+    if (debug_context) {
+        // Slots are handed out in index order, so a vertex is shaded at its first index.
+        for (u32 index = 0; index < pipeline.num_vertices; ++index) {
+            const u32 slot = index_slots[index];
+            if (unique_indices[slot] == index) {
+                shade_vertices(std::span{unique_indices}.subspan(slot, 1),
+                               std::span{unique_vertices}.subspan(slot, 1),
+                               std::span{vertex_outputs}.subspan(slot, 1));
             }
+            geometry_pipeline.SubmitVertex(vertex_outputs[slot]);
         }
+        return;
+    }
 
-        // Send to geometry pipeline
-        geometry_pipeline.SubmitVertex(vs_output);
+    // Shade every unique vertex, then submit them in index order.
+    for (u32 first = 0; first < num_unique; first += VERTEX_BATCH_SIZE) {
+        const u32 count = std::min(VERTEX_BATCH_SIZE, num_unique - first);
+        shade_vertices(std::span{unique_indices}.subspan(first, count),
+                       std::span{unique_vertices}.subspan(first, count),
+                       std::span{vertex_outputs}.subspan(first, count));
+    }
+    for (u32 index = 0; index < pipeline.num_vertices; ++index) {
+        geometry_pipeline.SubmitVertex(vertex_outputs[index_slots[index]]);
     }
 }
 
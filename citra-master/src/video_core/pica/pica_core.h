@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <vector>
 #include "core/hle/service/gsp/gsp_interrupt.h"
 #include "video_core/pica/geometry_pipeline.h"
 #include "video_core/pica/packed_attribute.h"
@@ -280,6 +281,21 @@ private:
     PrimitiveAssembler primitive_assembler;
     CommandList cmd_list;
     std::unique_ptr<ShaderEngine> shader_engine;
+
+    /// Slot of a vertex in vertex_outputs, valid when its generation matches the current draw.
+    struct VertexSlot {
+        u32 generation;
+        u32 slot;
+    };
+
+    // Scratch buffers of LoadVertices, kept between draws to avoid reallocating them.
+    std::vector<VertexSlot> vertex_slots;
+    u32 vertex_slot_generation{};
+    std::vector<u32> index_slots;
+    std::vector<u32> unique_indices;
+    std::vector<u32> unique_vertices;
+    std::vector<AttributeBuffer> vertex_inputs;
+    std::vector<AttributeBuffer> vertex_outputs;
 };
 
 #define GPU_REG_INDEX(field_name) (offsetof(Pica::PicaCore::Regs, field_name) / sizeof(u32))
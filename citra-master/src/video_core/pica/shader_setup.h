@@ -80,6 +80,7 @@ public:
     SwizzleData swizzle_data{};
     u32 entry_point{};
     const void* cached_shader{};
+    const void* cached_batch_shader{};
 
 private:
     bool program_code_hash_dirty{true};
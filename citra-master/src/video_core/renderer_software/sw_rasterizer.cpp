@@ -2,7 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <bit>
 #include <boost/container/static_vector.hpp>
+#include "common/arch.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/quaternion.h"
@@ -17,6 +20,12 @@
 #include "video_core/renderer_software/sw_texturing.h"
 #include "video_core/texture/texture_decode.h"
 
+#if CITRA_ARCH(x86_64)
+#include <emmintrin.h>
+#elif CITRA_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
 namespace SwRenderer {
 
 using Pica::f24;
@@ -66,10 +75,104 @@ struct Vertex : Pica::OutputVertex {
     }
 };
 
+/// Triangle binned for rasterization, with its setup computed once for every tile.
+struct Triangle {
+    Triangle(const Vertex& v0_, const Vertex& v1_, const Vertex& v2_,
+             const std::array<Common::Vec3<Fix12P4>, 3>& vtxpos_, std::array<int, 3> bias_,
+             u16 min_x_, u16 min_y_, u16 max_x_, u16 max_y_)
+        : v0{v0_}, v1{v1_}, v2{v2_}, vtxpos{vtxpos_}, bias{bias_},
+          w_inverse{Common::MakeVec(v0.pos.w, v1.pos.w, v2.pos.w)}, min_x{min_x_},
+          min_y{min_y_}, max_x{max_x_}, max_y{max_y_} {}
+
+    Vertex v0;
+    Vertex v1;
+    Vertex v2;
+    std::array<Common::Vec3<Fix12P4>, 3> vtxpos;
+    std::array<int, 3> bias;
+    Common::Vec3<f24> w_inverse;
+    u16 min_x;
+    u16 min_y;
+    u16 max_x;
+    u16 max_y;
+};
+
 namespace {
 
 MICROPROFILE_DEFINE(GPU_Rasterization, "GPU", "Rasterization", MP_RGB(50, 50, 240));
 
+/// Tiles are 32x32 pixels, in 12.4 fixed point rasterizer coordinates.
+constexpr u32 TILE_SHIFT = 4 + 5;
+constexpr u32 TILES_PER_ROW = 0x10000 >> TILE_SHIFT;
+
+/// Binned triangles are rasterized early past this count to bound the memory used by a draw.
+constexpr std::size_t MAX_BINNED_TRIANGLES = 0x2000;
+
+/// Number of horizontally adjacent pixels tested for coverage at once.
+constexpr u32 COVERAGE_LANES = 4;
+
+/**
+ * Edge function of a triangle, equivalent to `bias + SignedArea(a, b, p)`. It is evaluated with
+ * wrapping unsigned arithmetic so that stepping it gives the exact same values.
+ */
+struct EdgeFunction {
+    EdgeFunction(const Common::Vec2<Fix12P4>& a, const Common::Vec2<Fix12P4>& b, int bias_)
+        : ax{a.x}, ay{a.y}, dx{static_cast<u32>(b.x - a.x)}, dy{static_cast<u32>(b.y - a.y)},
+          bias{static_cast<u32>(bias_)}, step_x{0U - dy * 0x10}, step_y{dx * 0x10} {
+        for (u32 lane = 0; lane < COVERAGE_LANES; ++lane) {
+            lane_offsets[lane] = lane * step_x;
+        }
+    }
+
+    u32 Evaluate(u32 x, u32 y) const {
+        return bias + dx * (y - ay) - dy * (x - ax);
+    }
+
+    u32 ax;
+    u32 ay;
+    u32 dx;
+    u32 dy;
+    u32 bias;
+    u32 step_x; ///< Difference between horizontally adjacent pixels
+    u32 step_y; ///< Difference between vertically adjacent pixels
+    alignas(16) std::array<u32, COVERAGE_LANES> lane_offsets;
+};
+
+/**
+ * Tests COVERAGE_LANES horizontally adjacent pixels against the three edges of a triangle.
+ * @param w Edge function values of the first pixel.
+ * @returns Mask with a bit set for every covered pixel.
+ */
+u32 CoverageMask(const std::array<u32, 3>& w, const std::array<EdgeFunction, 3>& edges) {
+#if CITRA_ARCH(x86_64)
+    __m128i sign = _mm_setzero_si128();
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        const __m128i offsets =
+            _mm_load_si128(reinterpret_cast<const __m128i*>(edges[i].lane_offsets.data()));
+        sign = _mm_or_si128(sign, _mm_add_epi32(_mm_set1_epi32(static_cast<s32>(w[i])), offsets));
+    }
+    return ~static_cast<u32>(_mm_movemask_ps(_mm_castsi128_ps(sign))) & 0xF;
+#elif CITRA_ARCH(arm64)
+    uint32x4_t sign = vdupq_n_u32(0);
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        const uint32x4_t offsets = vld1q_u32(edges[i].lane_offsets.data());
+        sign = vorrq_u32(sign, vaddq_u32(vdupq_n_u32(w[i]), offsets));
+    }
+    static constexpr std::array<u32, COVERAGE_LANES> lane_bits{1, 2, 4, 8};
+    const uint32x4_t negative = vshrq_n_u32(sign, 31);
+    return ~vaddvq_u32(vmulq_u32(negative, vld1q_u32(lane_bits.data()))) & 0xF;
+#else
+    u32 mask = 0;
+    for (u32 lane = 0; lane < COVERAGE_LANES; ++lane) {
+        u32 sign = 0;
+        for (std::size_t i = 0; i < edges.size(); ++i) {
+            sign |= w[i] + edges[i].lane_offsets[lane];
+        }
+        mask |= ((sign >> 31) ^ 1) << lane;
+    }
+    return mask;
+#endif
+}
+
 struct ClippingEdge {
 public:
     constexpr ClippingEdge(Common::Vec4<f24> coeffs,
@@ -102,8 +205,10 @@ private:
 
 RasterizerSoftware::RasterizerSoftware(Memory::MemorySystem& memory_, Pica::PicaCore& pica_)
     : memory{memory_}, pica{pica_}, regs{pica.regs.internal},
-      num_sw_threads{std::max(std::thread::hardware_concurrency(), 2U)},
-      sw_workers{num_sw_threads, "SwRenderer workers"}, fb{memory, regs.framebuffer} {}
+      sw_workers{Common::TaskPriority::High}, fb{memory, regs.framebuffer},
+      tile_bins(TILES_PER_ROW * TILES_PER_ROW) {}
+
+RasterizerSoftware::~RasterizerSoftware() = default;
 
 void RasterizerSoftware::AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
                                      const Pica::OutputVertex& v2) {
@@ -229,8 +334,6 @@ void RasterizerSoftware::MakeScreenCoords(Vertex& vtx) {
 
 void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
                                          bool reversed) {
-    MICROPROFILE_SCOPE(GPU_Rasterization);
-
     // Vertex positions in rasterizer coordinates
     static auto screen_to_rasterizer_coords = [](const Common::Vec3<f24>& vec) {
         return Common::Vec3{Fix12P4::FromFloat24(vec.x), Fix12P4::FromFloat24(vec.y),
@@ -266,14 +369,14 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
     u16 max_x = std::max({vtxpos[0].x, vtxpos[1].x, vtxpos[2].x});
     u16 max_y = std::max({vtxpos[0].y, vtxpos[1].y, vtxpos[2].y});
 
-    // Convert the scissor box coordinates to 12.4 fixed point
-    const u16 scissor_x1 = static_cast<u16>(regs.rasterizer.scissor_test.x1 << 4);
-    const u16 scissor_y1 = static_cast<u16>(regs.rasterizer.scissor_test.y1 << 4);
-    // x2,y2 have +1 added to cover the entire sub-pixel area
-    const u16 scissor_x2 = static_cast<u16>((regs.rasterizer.scissor_test.x2 + 1) << 4);
-    const u16 scissor_y2 = static_cast<u16>((regs.rasterizer.scissor_test.y2 + 1) << 4);
-
     if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Include) {
+        // Convert the scissor box coordinates to 12.4 fixed point
+        const u16 scissor_x1 = static_cast<u16>(regs.rasterizer.scissor_test.x1 << 4);
+        const u16 scissor_y1 = static_cast<u16>(regs.rasterizer.scissor_test.y1 << 4);
+        // x2,y2 have +1 added to cover the entire sub-pixel area
+        const u16 scissor_x2 = static_cast<u16>((regs.rasterizer.scissor_test.x2 + 1) << 4);
+        const u16 scissor_y2 = static_cast<u16>((regs.rasterizer.scissor_test.y2 + 1) << 4);
+
         // Calculate the new bounds
         min_x = std::max(min_x, scissor_x1);
         min_y = std::max(min_y, scissor_y1);
@@ -285,6 +388,9 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
     min_y &= Fix12P4::IntMask();
     max_x = ((max_x + Fix12P4::FracMask()) & Fix12P4::IntMask());
     max_y = ((max_y + Fix12P4::FracMask()) & Fix12P4::IntMask());
+    if (min_x >= max_x || min_y >= max_y) {
+        return;
+    }
 
     const int bias0 =
         IsRightSideOrFlatBottomEdge(vtxpos[0].xy(), vtxpos[1].xy(), vtxpos[2].xy()) ? -1 : 0;
@@ -293,182 +399,253 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
     const int bias2 =
         IsRightSideOrFlatBottomEdge(vtxpos[2].xy(), vtxpos[0].xy(), vtxpos[1].xy()) ? -1 : 0;
 
-    const auto w_inverse = Common::MakeVec(v0.pos.w, v1.pos.w, v2.pos.w);
+    // Bin the triangle into every tile its bounding box overlaps, pixel centers are sampled
+    const u32 triangle_index = static_cast<u32>(triangles.size());
+    const Triangle& triangle = triangles.emplace_back(
+        v0, v1, v2, vtxpos, std::array{bias0, bias1, bias2}, min_x, min_y, max_x, max_y);
+    const u32 tile_x0 = triangle.min_x >> TILE_SHIFT;
+    const u32 tile_y0 = triangle.min_y >> TILE_SHIFT;
+    const u32 tile_x1 = (triangle.max_x - 1) >> TILE_SHIFT;
+    const u32 tile_y1 = (triangle.max_y - 1) >> TILE_SHIFT;
+    for (u32 tile_y = tile_y0; tile_y <= tile_y1; ++tile_y) {
+        for (u32 tile_x = tile_x0; tile_x <= tile_x1; ++tile_x) {
+            const u32 tile = tile_y * TILES_PER_ROW + tile_x;
+            if (tile_bins[tile].empty()) {
+                active_tiles.push_back(tile);
+            }
+            tile_bins[tile].push_back(triangle_index);
+        }
+    }
+    if (triangles.size() >= MAX_BINNED_TRIANGLES) {
+        DrawTriangles();
+    }
+}
+
+void RasterizerSoftware::DrawTriangles() {
+    if (triangles.empty()) {
+        return;
+    }
 
+    MICROPROFILE_SCOPE(GPU_Rasterization);
+
+    fb.Bind();
+
+    // Tiles don't share pixels, so they are rasterized in parallel. Each tile processes its
+    // triangles in submission order, which keeps depth testing and blending exact.
+    for (const u32 tile : active_tiles) {
+        sw_workers.Run([this, tile] { RasterizeTile(tile); });
+    }
+    sw_workers.Wait();
+
+    for (const u32 tile : active_tiles) {
+        tile_bins[tile].clear();
+    }
+    active_tiles.clear();
+    triangles.clear();
+}
+
+void RasterizerSoftware::RasterizeTile(u32 tile) {
+    const u16 tile_min_x = static_cast<u16>((tile % TILES_PER_ROW) << TILE_SHIFT);
+    const u16 tile_min_y = static_cast<u16>((tile / TILES_PER_ROW) << TILE_SHIFT);
+    const u32 tile_max_x = tile_min_x + (1U << TILE_SHIFT);
+    const u32 tile_max_y = tile_min_y + (1U << TILE_SHIFT);
     const auto textures = regs.texturing.GetTextures();
     const auto tev_stages = regs.texturing.GetTevStages();
 
-    fb.Bind();
+    for (const u32 triangle_index : tile_bins[tile]) {
+        const Triangle& triangle = triangles[triangle_index];
+        const u16 min_x = std::max(triangle.min_x, tile_min_x);
+        const u16 min_y = std::max(triangle.min_y, tile_min_y);
+        const u16 max_x = static_cast<u16>(std::min<u32>(triangle.max_x, tile_max_x));
+        const u16 max_y = static_cast<u16>(std::min<u32>(triangle.max_y, tile_max_y));
+
+        // Edge functions are linear, so they are stepped incrementally from the first pixel
+        // center of the tile instead of being evaluated per pixel.
+        const auto& vtxpos = triangle.vtxpos;
+        const std::array<EdgeFunction, 3> edges{
+            EdgeFunction{vtxpos[1].xy(), vtxpos[2].xy(), triangle.bias[0]},
+            EdgeFunction{vtxpos[2].xy(), vtxpos[0].xy(), triangle.bias[1]},
+            EdgeFunction{vtxpos[0].xy(), vtxpos[1].xy(), triangle.bias[2]},
+        };
+        const u16 start_x = min_x + 8;
+        std::array<u32, 3> row_start{};
+        for (std::size_t i = 0; i < edges.size(); ++i) {
+            row_start[i] = edges[i].Evaluate(start_x, min_y + 8);
+        }
 
-    // Enter rasterization loop, starting at the center of the topleft bounding box corner.
-    // TODO: Not sure if looping through x first might be faster
-    for (u16 y = min_y + 8; y < max_y; y += 0x10) {
-        const auto process_scanline = [&, y] {
-            for (u16 x = min_x + 8; x < max_x; x += 0x10) {
-                // Do not process the pixel if it's inside the scissor box and the scissor mode is
-                // set to Exclude.
-                if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Exclude) {
-                    if (x >= scissor_x1 && x < scissor_x2 && y >= scissor_y1 && y < scissor_y2) {
-                        continue;
-                    }
+        for (u16 y = min_y + 8; y < max_y; y += 0x10) {
+            std::array<u32, 3> w = row_start;
+            for (u16 x = start_x; x < max_x; x += 0x10 * COVERAGE_LANES) {
+                const u32 lanes = std::min<u32>(COVERAGE_LANES, (max_x - x + 0xF) >> 4);
+                u32 mask = CoverageMask(w, edges) & ((1U << lanes) - 1);
+                while (mask != 0) {
+                    const u32 lane = static_cast<u32>(std::countr_zero(mask));
+                    mask &= mask - 1;
+                    ProcessPixel(triangle, textures, tev_stages,
+                                 static_cast<u16>(x + lane * 0x10), y,
+                                 static_cast<s32>(w[0] + lane * edges[0].step_x),
+                                 static_cast<s32>(w[1] + lane * edges[1].step_x),
+                                 static_cast<s32>(w[2] + lane * edges[2].step_x));
                 }
+                for (std::size_t i = 0; i < edges.size(); ++i) {
+                    w[i] += COVERAGE_LANES * edges[i].step_x;
+                }
+            }
+            for (std::size_t i = 0; i < edges.size(); ++i) {
+                row_start[i] += edges[i].step_y;
+            }
+        }
+    }
+}
 
-                // Calculate the barycentric coordinates w0, w1 and w2
-                const s32 w0 = bias0 + SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), {x, y});
-                const s32 w1 = bias1 + SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), {x, y});
-                const s32 w2 = bias2 + SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), {x, y});
-                const s32 wsum = w0 + w1 + w2;
+void RasterizerSoftware::ProcessPixel(
+    const Triangle& triangle, std::span<const Pica::TexturingRegs::FullTextureConfig, 3> textures,
+    std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages, u16 x, u16 y, s32 w0,
+    s32 w1, s32 w2) {
+    const Vertex& v0 = triangle.v0;
+    const Vertex& v1 = triangle.v1;
+    const Vertex& v2 = triangle.v2;
+
+    // Do not process the pixel if it's inside the scissor box and the scissor mode is
+    // set to Exclude.
+    if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Exclude) {
+        const u16 scissor_x1 = static_cast<u16>(regs.rasterizer.scissor_test.x1 << 4);
+        const u16 scissor_y1 = static_cast<u16>(regs.rasterizer.scissor_test.y1 << 4);
+        const u16 scissor_x2 = static_cast<u16>((regs.rasterizer.scissor_test.x2 + 1) << 4);
+        const u16 scissor_y2 = static_cast<u16>((regs.rasterizer.scissor_test.y2 + 1) << 4);
+        if (x >= scissor_x1 && x < scissor_x2 && y >= scissor_y1 && y < scissor_y2) {
+            return;
+        }
+    }
 
-                // If current pixel is not covered by the current primitive
-                if (w0 < 0 || w1 < 0 || w2 < 0) {
-                    continue;
-                }
+    const s32 wsum = w0 + w1 + w2;
+
+    const auto baricentric_coordinates =
+        Common::MakeVec(f24::FromFloat32(static_cast<f32>(w0)),
+                        f24::FromFloat32(static_cast<f32>(w1)),
+                        f24::FromFloat32(static_cast<f32>(w2)));
+    const f24 interpolated_w_inverse =
+        f24::One() / Common::Dot(triangle.w_inverse, baricentric_coordinates);
+
+    // interpolated_z = z / w
+    const float interpolated_z_over_w =
+        (v0.screenpos[2].ToFloat32() * w0 + v1.screenpos[2].ToFloat32() * w1 +
+         v2.screenpos[2].ToFloat32() * w2) /
+        wsum;
+
+    // Not fully accurate. About 3 bits in precision are missing.
+    // Z-Buffer (z / w * scale + offset)
+    const float depth_scale = f24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
+    const float depth_offset = f24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
+    float depth = interpolated_z_over_w * depth_scale + depth_offset;
+
+    // Potentially switch to W-Buffer
+    if (regs.rasterizer.depthmap_enable == Pica::RasterizerRegs::DepthBuffering::WBuffering) {
+        // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
+        depth *= interpolated_w_inverse.ToFloat32() * wsum;
+    }
 
-                const auto baricentric_coordinates = Common::MakeVec(
-                    f24::FromFloat32(static_cast<f32>(w0)), f24::FromFloat32(static_cast<f32>(w1)),
-                    f24::FromFloat32(static_cast<f32>(w2)));
-                const f24 interpolated_w_inverse =
-                    f24::One() / Common::Dot(w_inverse, baricentric_coordinates);
-
-                // interpolated_z = z / w
-                const float interpolated_z_over_w =
-                    (v0.screenpos[2].ToFloat32() * w0 + v1.screenpos[2].ToFloat32() * w1 +
-                     v2.screenpos[2].ToFloat32() * w2) /
-                    wsum;
-
-                // Not fully accurate. About 3 bits in precision are missing.
-                // Z-Buffer (z / w * scale + offset)
-                const float depth_scale =
-                    f24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
-                const float depth_offset =
-                    f24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
-                float depth = interpolated_z_over_w * depth_scale + depth_offset;
-
-                // Potentially switch to W-Buffer
-                if (regs.rasterizer.depthmap_enable ==
-                    Pica::RasterizerRegs::DepthBuffering::WBuffering) {
-                    // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
-                    depth *= interpolated_w_inverse.ToFloat32() * wsum;
-                }
+    // Clamp the result
+    depth = std::clamp(depth, 0.0f, 1.0f);
 
-                // Clamp the result
-                depth = std::clamp(depth, 0.0f, 1.0f);
-
-                /**
-                 * Perspective correct attribute interpolation:
-                 * Attribute values cannot be calculated by simple linear interpolation since
-                 * they are not linear in screen space. For example, when interpolating a
-                 * texture coordinate across two vertices, something simple like
-                 *     u = (u0*w0 + u1*w1)/(w0+w1)
-                 * will not work. However, the attribute value divided by the
-                 * clipspace w-coordinate (u/w) and and the inverse w-coordinate (1/w) are linear
-                 * in screenspace. Hence, we can linearly interpolate these two independently and
-                 * calculate the interpolated attribute by dividing the results.
-                 * I.e.
-                 *     u_over_w   = ((u0/v0.pos.w)*w0 + (u1/v1.pos.w)*w1)/(w0+w1)
-                 *     one_over_w = (( 1/v0.pos.w)*w0 + ( 1/v1.pos.w)*w1)/(w0+w1)
-                 *     u = u_over_w / one_over_w
-                 *
-                 * The generalization to three vertices is straightforward in baricentric
-                 *coordinates.
-                 **/
-                const auto get_interpolated_attribute = [&](f24 attr0, f24 attr1, f24 attr2) {
-                    auto attr_over_w = Common::MakeVec(attr0, attr1, attr2);
-                    f24 interpolated_attr_over_w =
-                        Common::Dot(attr_over_w, baricentric_coordinates);
-                    return interpolated_attr_over_w * interpolated_w_inverse;
-                };
-
-                const Common::Vec4<u8> primary_color{
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.r(), v1.color.r(), v2.color.r())
-                                  .ToFloat32() *
-                              255)),
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.g(), v1.color.g(), v2.color.g())
-                                  .ToFloat32() *
-                              255)),
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.b(), v1.color.b(), v2.color.b())
-                                  .ToFloat32() *
-                              255)),
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.a(), v1.color.a(), v2.color.a())
-                                  .ToFloat32() *
-                              255)),
-                };
-
-                std::array<Common::Vec2<f24>, 3> uv;
-                uv[0].u() = get_interpolated_attribute(v0.tc0.u(), v1.tc0.u(), v2.tc0.u());
-                uv[0].v() = get_interpolated_attribute(v0.tc0.v(), v1.tc0.v(), v2.tc0.v());
-                uv[1].u() = get_interpolated_attribute(v0.tc1.u(), v1.tc1.u(), v2.tc1.u());
-                uv[1].v() = get_interpolated_attribute(v0.tc1.v(), v1.tc1.v(), v2.tc1.v());
-                uv[2].u() = get_interpolated_attribute(v0.tc2.u(), v1.tc2.u(), v2.tc2.u());
-                uv[2].v() = get_interpolated_attribute(v0.tc2.v(), v1.tc2.v(), v2.tc2.v());
-
-                // Sample bound texture units.
-                const f24 tc0_w = get_interpolated_attribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
-                const auto texture_color = TextureColor(uv, textures, tc0_w);
-
-                Common::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
-                Common::Vec4<u8> secondary_fragment_color = {0, 0, 0, 0};
-
-                if (!regs.lighting.disable) {
-                    const auto normquat =
-                        Common::Quaternion<f32>{
-                            {get_interpolated_attribute(v0.quat.x, v1.quat.x, v2.quat.x)
-                                 .ToFloat32(),
-                             get_interpolated_attribute(v0.quat.y, v1.quat.y, v2.quat.y)
-                                 .ToFloat32(),
-                             get_interpolated_attribute(v0.quat.z, v1.quat.z, v2.quat.z)
-                                 .ToFloat32()},
-                            get_interpolated_attribute(v0.quat.w, v1.quat.w, v2.quat.w).ToFloat32(),
-                        }
-                            .Normalized();
-
-                    const Common::Vec3f view{
-                        get_interpolated_attribute(v0.view.x, v1.view.x, v2.view.x).ToFloat32(),
-                        get_interpolated_attribute(v0.view.y, v1.view.y, v2.view.y).ToFloat32(),
-                        get_interpolated_attribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
-                    };
-                    std::tie(primary_fragment_color, secondary_fragment_color) =
-                        ComputeFragmentsColors(regs.lighting, pica.lighting, normquat, view,
-                                               texture_color);
-                }
+    /**
+     * Perspective correct attribute interpolation:
+     * Attribute values cannot be calculated by simple linear interpolation since
+     * they are not linear in screen space. For example, when interpolating a
+     * texture coordinate across two vertices, something simple like
+     *     u = (u0*w0 + u1*w1)/(w0+w1)
+     * will not work. However, the attribute value divided by the
+     * clipspace w-coordinate (u/w) and and the inverse w-coordinate (1/w) are linear
+     * in screenspace. Hence, we can linearly interpolate these two independently and
+     * calculate the interpolated attribute by dividing the results.
+     * I.e.
+     *     u_over_w   = ((u0/v0.pos.w)*w0 + (u1/v1.pos.w)*w1)/(w0+w1)
+     *     one_over_w = (( 1/v0.pos.w)*w0 + ( 1/v1.pos.w)*w1)/(w0+w1)
+     *     u = u_over_w / one_over_w
+     *
+     * The generalization to three vertices is straightforward in baricentric coordinates.
+     **/
+    const auto get_interpolated_attribute = [&](f24 attr0, f24 attr1, f24 attr2) {
+        auto attr_over_w = Common::MakeVec(attr0, attr1, attr2);
+        f24 interpolated_attr_over_w = Common::Dot(attr_over_w, baricentric_coordinates);
+        return interpolated_attr_over_w * interpolated_w_inverse;
+    };
 
-                // Write the TEV stages.
-                auto combiner_output =
-                    WriteTevConfig(texture_color, tev_stages, primary_color, primary_fragment_color,
-                                   secondary_fragment_color);
-
-                const auto& output_merger = regs.framebuffer.output_merger;
-                if (output_merger.fragment_operation_mode ==
-                    FramebufferRegs::FragmentOperationMode::Shadow) {
-                    const u32 depth_int = static_cast<u32>(depth * 0xFFFFFF);
-                    // Use green color as the shadow intensity
-                    const u8 stencil = combiner_output.y;
-                    fb.DrawShadowMapPixel(x >> 4, y >> 4, depth_int, stencil);
-                    // Skip the normal output merger pipeline if it is in shadow mode
-                    continue;
-                }
+    const Common::Vec4<u8> primary_color{
+        static_cast<u8>(round(
+            get_interpolated_attribute(v0.color.r(), v1.color.r(), v2.color.r()).ToFloat32() *
+            255)),
+        static_cast<u8>(round(
+            get_interpolated_attribute(v0.color.g(), v1.color.g(), v2.color.g()).ToFloat32() *
+            255)),
+        static_cast<u8>(round(
+            get_interpolated_attribute(v0.color.b(), v1.color.b(), v2.color.b()).ToFloat32() *
+            255)),
+        static_cast<u8>(round(
+            get_interpolated_attribute(v0.color.a(), v1.color.a(), v2.color.a()).ToFloat32() *
+            255)),
+    };
 
-                // Does alpha testing happen before or after stencil?
-                if (!DoAlphaTest(combiner_output.a())) {
-                    continue;
-                }
-                WriteFog(depth, combiner_output);
-                if (!DoDepthStencilTest(x, y, depth)) {
-                    continue;
-                }
-                const auto result = PixelColor(x, y, combiner_output);
-                if (regs.framebuffer.framebuffer.allow_color_write != 0) {
-                    fb.DrawPixel(x >> 4, y >> 4, result);
-                }
+    std::array<Common::Vec2<f24>, 3> uv;
+    uv[0].u() = get_interpolated_attribute(v0.tc0.u(), v1.tc0.u(), v2.tc0.u());
+    uv[0].v() = get_interpolated_attribute(v0.tc0.v(), v1.tc0.v(), v2.tc0.v());
+    uv[1].u() = get_interpolated_attribute(v0.tc1.u(), v1.tc1.u(), v2.tc1.u());
+    uv[1].v() = get_interpolated_attribute(v0.tc1.v(), v1.tc1.v(), v2.tc1.v());
+    uv[2].u() = get_interpolated_attribute(v0.tc2.u(), v1.tc2.u(), v2.tc2.u());
+    uv[2].v() = get_interpolated_attribute(v0.tc2.v(), v1.tc2.v(), v2.tc2.v());
+
+    // Sample bound texture units.
+    const f24 tc0_w = get_interpolated_attribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
+    const auto texture_color = TextureColor(uv, textures, tc0_w);
+
+    Common::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
+    Common::Vec4<u8> secondary_fragment_color = {0, 0, 0, 0};
+
+    if (!regs.lighting.disable) {
+        const auto normquat =
+            Common::Quaternion<f32>{
+                {get_interpolated_attribute(v0.quat.x, v1.quat.x, v2.quat.x).ToFloat32(),
+                 get_interpolated_attribute(v0.quat.y, v1.quat.y, v2.quat.y).ToFloat32(),
+                 get_interpolated_attribute(v0.quat.z, v1.quat.z, v2.quat.z).ToFloat32()},
+                get_interpolated_attribute(v0.quat.w, v1.quat.w, v2.quat.w).ToFloat32(),
             }
+                .Normalized();
+
+        const Common::Vec3f view{
+            get_interpolated_attribute(v0.view.x, v1.view.x, v2.view.x).ToFloat32(),
+            get_interpolated_attribute(v0.view.y, v1.view.y, v2.view.y).ToFloat32(),
+            get_interpolated_attribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
         };
-        sw_workers.QueueWork(std::move(process_scanline));
+        std::tie(primary_fragment_color, secondary_fragment_color) = ComputeFragmentsColors(
+            regs.lighting, pica.lighting, normquat, view, texture_color);
+    }
+
+    // Write the TEV stages.
+    auto combiner_output = WriteTevConfig(texture_color, tev_stages, primary_color,
+                                          primary_fragment_color, secondary_fragment_color);
+
+    const auto& output_merger = regs.framebuffer.output_merger;
+    if (output_merger.fragment_operation_mode == FramebufferRegs::FragmentOperationMode::Shadow) {
+        const u32 depth_int = static_cast<u32>(depth * 0xFFFFFF);
+        // Use green color as the shadow intensity
+        const u8 stencil = combiner_output.y;
+        fb.DrawShadowMapPixel(x >> 4, y >> 4, depth_int, stencil);
+        // Skip the normal output merger pipeline if it is in shadow mode
+        return;
+    }
+
+    // Does alpha testing happen before or after stencil?
+    if (!DoAlphaTest(combiner_output.a())) {
+        return;
+    }
+    WriteFog(depth, combiner_output);
+    if (!DoDepthStencilTest(x, y, depth)) {
+        return;
+    }
+    const auto result = PixelColor(x, y, combiner_output);
+    if (regs.framebuffer.framebuffer.allow_color_write != 0) {
+        fb.DrawPixel(x >> 4, y >> 4, result);
     }
-    sw_workers.WaitForRequests();
 }
 
 std::array<Common::Vec4<u8>, 4> RasterizerSoftware::TextureColor(
@@ -5,7 +5,8 @@
 #pragma once
 
 #include <span>
-#include "common/thread_worker.h"
+#include <vector>
+#include "common/task_scheduler.h"
 #include "video_core/pica/regs_texturing.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_software/sw_clipper.h"
@@ -19,14 +20,16 @@ class PicaCore;
 namespace SwRenderer {
 
 struct Vertex;
+struct Triangle;
 
 class RasterizerSoftware : public VideoCore::RasterizerInterface {
 public:
     explicit RasterizerSoftware(Memory::MemorySystem& memory, Pica::PicaCore& pica);
+    ~RasterizerSoftware() override;
 
     void AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
                      const Pica::OutputVertex& v2) override;
-    void DrawTriangles() override {}
+    void DrawTriangles() override;
     void NotifyPicaRegisterChanged(u32 id) override {}
     void FlushAll() override {}
     void FlushRegion(PAddr addr, u32 size) override {}
@@ -38,10 +41,19 @@ private:
     /// Computes the screen coordinates of the provided vertex.
     void MakeScreenCoords(Vertex& vtx);
 
-    /// Processes the triangle defined by the provided vertices.
+    /// Sets up the triangle defined by the provided vertices and bins it into screen tiles.
     void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
                          bool reversed = false);
 
+    /// Rasterizes the binned triangles overlapping a tile, in the order they were submitted.
+    void RasterizeTile(u32 tile);
+
+    /// Shades a pixel covered by the triangle, given its barycentric coordinates.
+    void ProcessPixel(const Triangle& triangle,
+                      std::span<const Pica::TexturingRegs::FullTextureConfig, 3> textures,
+                      std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages, u16 x,
+                      u16 y, s32 w0, s32 w1, s32 w2);
+
     /// Returns the texture color of the currently processed pixel.
     std::array<Common::Vec4<u8>, 4> TextureColor(
         std::span<const Common::Vec2<f24>, 3> uv,
@@ -70,9 +82,11 @@ private:
     Memory::MemorySystem& memory;
     Pica::PicaCore& pica;
     Pica::RegsInternal& regs;
-    std::size_t num_sw_threads;
-    Common::ThreadWorker sw_workers;
+    Common::TaskGroup sw_workers;
     Framebuffer fb;
+    std::vector<Triangle> triangles;
+    std::vector<std::vector<u32>> tile_bins;
+    std::vector<u32> active_tiles;
 };
 
 } // namespace SwRenderer
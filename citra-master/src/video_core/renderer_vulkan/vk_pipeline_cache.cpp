@@ -82,8 +82,6 @@ constexpr std::array<vk::DescriptorSetLayoutBinding, 7> SHADOW_BINDINGS = {{
 PipelineCache::PipelineCache(const Instance& instance_, Scheduler& scheduler_,
                              RenderpassCache& renderpass_cache_, DescriptorPool& pool_)
     : instance{instance_}, scheduler{scheduler_}, renderpass_cache{renderpass_cache_}, pool{pool_},
-      num_worker_threads{std::max(std::thread::hardware_concurrency(), 2U)},
-      workers{num_worker_threads, "Pipeline workers"},
       descriptor_set_providers{DescriptorSetProvider{instance, pool, BUFFER_BINDINGS},
                                DescriptorSetProvider{instance, pool, TEXTURE_BINDINGS},
                                DescriptorSetProvider{instance, pool, SHADOW_BINDINGS}},
@@ -417,7 +415,7 @@ bool PipelineCache::UseProgrammableVertexShader(const Pica::RegsInternal& regs,
         if (new_program) {
             shader.program = std::move(program);
             const vk::Device device = instance.GetDevice();
-            workers.QueueWork([device, &shader] {
+            workers.Run([device, &shader] {
                 shader.module = Compile(shader.program, vk::ShaderStageFlagBits::eVertex, device);
                 shader.MarkDone();
             });
@@ -454,7 +452,7 @@ bool PipelineCache::UseFixedGeometryShader(const Pica::RegsInternal& regs) {
     auto& shader = it->second;
 
     if (new_shader) {
-        workers.QueueWork([gs_config, device = instance.GetDevice(), &shader]() {
+        workers.Run([gs_config, device = instance.GetDevice(), &shader]() {
             const auto code = GLSL::GenerateFixedGeometryShader(gs_config, true);
             shader.module = Compile(code, vk::ShaderStageFlagBits::eGeometry, device);
             shader.MarkDone();
@@ -479,7 +477,7 @@ void PipelineCache::UseFragmentShader(const Pica::RegsInternal& regs,
     auto& shader = it->second;
 
     if (new_shader) {
-        workers.QueueWork([fs_config, this, &shader]() {
+        workers.Run([fs_config, this, &shader]() {
             const bool use_spirv = Settings::values.spirv_shader_gen.GetValue();
             if (use_spirv && !fs_config.UsesShadowPipeline()) {
                 const std::vector code = SPIRV::GenerateFragmentShader(fs_config, profile);
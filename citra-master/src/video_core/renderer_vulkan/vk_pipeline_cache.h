@@ -103,8 +103,7 @@ private:
     Pica::Shader::Profile profile{};
     vk::UniquePipelineCache pipeline_cache;
     vk::UniquePipelineLayout pipeline_layout;
-    std::size_t num_worker_threads;
-    Common::ThreadWorker workers;
+    Common::TaskGroup workers;
     PipelineInfo current_info{};
     GraphicsPipeline* current_pipeline{};
     tsl::robin_map<u64, std::unique_ptr<GraphicsPipeline>, Common::IdentityHash<u64>>
@@ -5,10 +5,13 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include "common/common_types.h"
+#include "video_core/pica/output_vertex.h"
 
 namespace Pica {
 
+struct ShaderRegs;
 struct ShaderSetup;
 struct ShaderUnit;
 
@@ -29,6 +32,21 @@ public:
      * @param state Shader unit state, must be setup with input data before each shader invocation.
      */
     virtual void Run(const ShaderSetup& setup, ShaderUnit& state) const = 0;
+
+    /**
+     * Runs the currently setup shader once for each vertex of a batch. Engines may run several
+     * vertices at once, each with its own registers like the shader units of the console, so
+     * registers read before the shader writes them are undefined within a batch.
+     *
+     * @param setup Shader engine state, must be setup with SetupBatch on each shader change.
+     * @param config Shader configuration used to load the inputs and write the outputs.
+     * @param state Shader unit used to run every vertex of the batch.
+     * @param inputs Input attributes of each vertex.
+     * @param outputs Output attributes of each vertex, must be as large as inputs.
+     */
+    virtual void RunBatch(const ShaderSetup& setup, const ShaderRegs& config, ShaderUnit& state,
+                          std::span<const AttributeBuffer> inputs,
+                          std::span<AttributeBuffer> outputs) const = 0;
 };
 
 std::unique_ptr<ShaderEngine> CreateEngine(bool use_jit);
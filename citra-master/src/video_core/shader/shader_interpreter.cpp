@@ -738,6 +738,21 @@ void InterpreterEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
     RunInterpreter(setup, state, dummy_debug_data, setup.entry_point);
 }
 
+void InterpreterEngine::RunBatch(const ShaderSetup& setup, const ShaderRegs& config,
+                                 ShaderUnit& state, std::span<const AttributeBuffer> inputs,
+                                 std::span<AttributeBuffer> outputs) const {
+    ASSERT(inputs.size() <= outputs.size());
+
+    MICROPROFILE_SCOPE(GPU_Shader);
+
+    DebugData<false> dummy_debug_data;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        state.LoadInput(config, inputs[i]);
+        RunInterpreter(setup, state, dummy_debug_data, setup.entry_point);
+        state.WriteOutput(config, outputs[i]);
+    }
+}
+
 DebugData<true> InterpreterEngine::ProduceDebugInfo(const ShaderSetup& setup,
                                                     const AttributeBuffer& input,
                                                     const ShaderRegs& config) const {
@@ -18,6 +18,9 @@ class InterpreterEngine final : public ShaderEngine {
 public:
     void SetupBatch(ShaderSetup& setup, u32 entry_point) override;
     void Run(const ShaderSetup& setup, ShaderUnit& state) const override;
+    void RunBatch(const ShaderSetup& setup, const ShaderRegs& config, ShaderUnit& state,
+                  std::span<const AttributeBuffer> inputs,
+                  std::span<AttributeBuffer> outputs) const override;
 
     /**
      * Produce debug information based on the given shader and input vertex
@@ -8,12 +8,14 @@
 #include "common/assert.h"
 #include "common/hash.h"
 #include "common/microprofile.h"
+#include "video_core/pica/shader_unit.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit.h"
 #if CITRA_ARCH(arm64)
 #include "video_core/shader/shader_jit_a64_compiler.h"
 #endif
 #if CITRA_ARCH(x86_64)
+#include "video_core/shader/shader_jit_x64_batch_compiler.h"
 #include "video_core/shader/shader_jit_x64_compiler.h"
 #endif
 
@@ -39,6 +41,21 @@ void JitEngine::SetupBatch(ShaderSetup& setup, u32 entry_point) {
         setup.cached_shader = shader.get();
         cache.emplace_hint(iter, cache_key, std::move(shader));
     }
+
+#if CITRA_ARCH(x86_64)
+    // Batch shaders only compile the code reachable from the entry point
+    const u64 batch_key = Common::HashCombine(cache_key, entry_point);
+    auto batch_iter = batch_cache.find(batch_key);
+    if (batch_iter != batch_cache.end()) {
+        setup.cached_batch_shader = batch_iter->second.get();
+    } else {
+        auto batch_shader = std::make_unique<JitBatchShader>();
+        batch_shader->Compile(&setup.program_code, &setup.swizzle_data, entry_point,
+                              *static_cast<const JitShader*>(setup.cached_shader));
+        setup.cached_batch_shader = batch_shader.get();
+        batch_cache.emplace_hint(batch_iter, batch_key, std::move(batch_shader));
+    }
+#endif
 }
 
 MICROPROFILE_DECLARE(GPU_Shader);
@@ -52,6 +69,50 @@ void JitEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
     shader->Run(setup, state, setup.entry_point);
 }
 
+void JitEngine::RunBatch(const ShaderSetup& setup, const ShaderRegs& config, ShaderUnit& state,
+                         std::span<const AttributeBuffer> inputs,
+                         std::span<AttributeBuffer> outputs) const {
+    ASSERT(setup.cached_shader != nullptr);
+    ASSERT(inputs.size() <= outputs.size());
+
+    MICROPROFILE_SCOPE(GPU_Shader);
+
+    std::size_t i = 0;
+#if CITRA_ARCH(x86_64)
+    if (setup.cached_batch_shader != nullptr && inputs.size() >= BatchUnit::NumLanes) {
+        // Shade the vertices in groups of one per lane, until the lanes of a group diverge in a
+        // way the batch shader can't follow
+        const auto* batch_shader = static_cast<const JitBatchShader*>(setup.cached_batch_shader);
+        BatchUnit lanes;
+        lanes.Load(state);
+        bool completed = true;
+        for (; i + BatchUnit::NumLanes <= inputs.size(); i += BatchUnit::NumLanes) {
+            for (u32 lane = 0; lane < BatchUnit::NumLanes; ++lane) {
+                lanes.LoadInput(config, lane, inputs[i + lane]);
+            }
+            if (!batch_shader->Run(setup, lanes)) {
+                completed = false;
+                break;
+            }
+            for (u32 lane = 0; lane < BatchUnit::NumLanes; ++lane) {
+                lanes.WriteOutput(config, lane, outputs[i + lane]);
+            }
+        }
+        if (completed) {
+            lanes.Store(BatchUnit::NumLanes - 1, state);
+        }
+    }
+#endif
+
+    // The remaining vertices are shaded one at a time
+    const JitShader* shader = static_cast<const JitShader*>(setup.cached_shader);
+    for (; i < inputs.size(); ++i) {
+        state.LoadInput(config, inputs[i]);
+        shader->Run(setup, state, setup.entry_point);
+        state.WriteOutput(config, outputs[i]);
+    }
+}
+
 } // namespace Pica::Shader
 
 #endif // CITRA_ARCH(x86_64) || CITRA_ARCH(arm64)
@@ -15,6 +15,7 @@
 namespace Pica::Shader {
 
 class JitShader;
+class JitBatchShader;
 
 class JitEngine final : public ShaderEngine {
 public:
@@ -23,9 +24,15 @@ public:
 
     void SetupBatch(ShaderSetup& setup, u32 entry_point) override;
     void Run(const ShaderSetup& setup, ShaderUnit& state) const override;
+    void RunBatch(const ShaderSetup& setup, const ShaderRegs& config, ShaderUnit& state,
+                  std::span<const AttributeBuffer> inputs,
+                  std::span<AttributeBuffer> outputs) const override;
 
 private:
     std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+#if CITRA_ARCH(x86_64)
+    std::unordered_map<u64, std::unique_ptr<JitBatchShader>> batch_cache;
+#endif
 };
 
 } // namespace Pica::Shader
@@ -0,0 +1,1271 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/arch.h"
+#if CITRA_ARCH(x86_64)
+
+#include <algorithm>
+#include <nihstro/shader_bytecode.h>
+#include <smmintrin.h>
+#include <xbyak/xbyak_util.h>
+#include <xmmintrin.h>
+#include "common/assert.h"
+#include "common/bit_set.h"
+#include "common/logging/log.h"
+#include "common/x64/xbyak_abi.h"
+#include "common/x64/xbyak_util.h"
+#include "video_core/pica/regs_shader.h"
+#include "video_core/pica/shader_unit.h"
+#include "video_core/shader/shader_jit_x64_batch_compiler.h"
+#include "video_core/shader/shader_jit_x64_compiler.h"
+
+using namespace Common::X64;
+using namespace Xbyak::util;
+using Xbyak::Label;
+using Xbyak::Reg32;
+using Xbyak::Reg64;
+using Xbyak::Xmm;
+
+using nihstro::DestRegister;
+using nihstro::RegisterType;
+
+static const Xbyak::util::Cpu host_caps;
+
+namespace Pica::Shader {
+
+void BatchUnit::Load(const ShaderUnit& state) {
+    const auto broadcast = [](std::array<Register, 16>& lanes,
+                              const std::array<Common::Vec4<f24>, 16>& registers) {
+        for (std::size_t reg = 0; reg < registers.size(); ++reg) {
+            for (std::size_t comp = 0; comp < 4; ++comp) {
+                lanes[reg][comp].fill(registers[reg][comp]);
+            }
+        }
+    };
+    broadcast(input, state.input);
+    broadcast(temporary, state.temporary);
+    broadcast(output, state.output);
+
+    for (std::size_t i = 0; i < conditional_code.size(); ++i) {
+        conditional_code[i].fill(state.conditional_code[i] ? ~0U : 0U);
+    }
+    for (std::size_t i = 0; i < address_registers.size(); ++i) {
+        address_registers[i].fill(static_cast<u32>(state.address_registers[i]));
+    }
+}
+
+void BatchUnit::Store(u32 lane, ShaderUnit& state) const {
+    const auto extract = [lane](std::array<Common::Vec4<f24>, 16>& registers,
+                                const std::array<Register, 16>& lanes) {
+        for (std::size_t reg = 0; reg < registers.size(); ++reg) {
+            for (std::size_t comp = 0; comp < 4; ++comp) {
+                registers[reg][comp] = lanes[reg][comp][lane];
+            }
+        }
+    };
+    extract(state.input, input);
+    extract(state.temporary, temporary);
+    extract(state.output, output);
+
+    for (std::size_t i = 0; i < conditional_code.size(); ++i) {
+        state.conditional_code[i] = conditional_code[i][lane] != 0;
+    }
+    for (std::size_t i = 0; i < address_registers.size(); ++i) {
+        state.address_registers[i] = static_cast<s32>(address_registers[i][lane]);
+    }
+}
+
+void BatchUnit::LoadInput(const ShaderRegs& config, u32 lane, const AttributeBuffer& buffer) {
+    const u32 max_attribute = config.max_input_attribute_index;
+    for (u32 attr = 0; attr <= max_attribute; ++attr) {
+        const u32 reg = config.GetRegisterForAttribute(attr);
+        for (std::size_t comp = 0; comp < 4; ++comp) {
+            input[reg][comp][lane] = buffer[attr][comp];
+        }
+    }
+}
+
+void BatchUnit::WriteOutput(const ShaderRegs& config, u32 lane, AttributeBuffer& buffer) const {
+    u32 output_index{};
+    for (u32 reg : Common::BitSet<u32>(config.output_mask)) {
+        for (std::size_t comp = 0; comp < 4; ++comp) {
+            buffer[output_index][comp] = output[reg][comp][lane];
+        }
+        ++output_index;
+    }
+}
+
+typedef void (JitBatchShader::*JitBatchFunction)(Instruction instr);
+
+const JitBatchFunction batch_instr_table[64] = {
+    &JitBatchShader::Compile_ADD,    // add
+    &JitBatchShader::Compile_DP3,    // dp3
+    &JitBatchShader::Compile_DP4,    // dp4
+    &JitBatchShader::Compile_DPH,    // dph
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_EX2,    // ex2
+    &JitBatchShader::Compile_LG2,    // lg2
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_MUL,    // mul
+    &JitBatchShader::Compile_SGE,    // sge
+    &JitBatchShader::Compile_SLT,    // slt
+    &JitBatchShader::Compile_FLR,    // flr
+    &JitBatchShader::Compile_MAX,    // max
+    &JitBatchShader::Compile_MIN,    // min
+    &JitBatchShader::Compile_RCP,    // rcp
+    &JitBatchShader::Compile_RSQ,    // rsq
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_MOVA,   // mova
+    &JitBatchShader::Compile_MOV,    // mov
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_DPH,    // dphi
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_SGE,    // sgei
+    &JitBatchShader::Compile_SLT,    // slti
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    nullptr,                         // unknown
+    &JitBatchShader::Compile_NOP,    // nop
+    &JitBatchShader::Compile_END,    // end
+    &JitBatchShader::Compile_BREAKC, // breakc
+    &JitBatchShader::Compile_CALL,   // call
+    &JitBatchShader::Compile_CALLC,  // callc
+    &JitBatchShader::Compile_CALLU,  // callu
+    &JitBatchShader::Compile_IF,     // ifu
+    &JitBatchShader::Compile_IF,     // ifc
+    &JitBatchShader::Compile_LOOP,   // loop
+    &JitBatchShader::Compile_EMIT,   // emit
+    &JitBatchShader::Compile_SETE,   // sete
+    &JitBatchShader::Compile_JMP,    // jmpc
+    &JitBatchShader::Compile_JMP,    // jmpu
+    &JitBatchShader::Compile_CMP,    // cmp
+    &JitBatchShader::Compile_CMP,    // cmp
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // madi
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+    &JitBatchShader::Compile_MAD,    // mad
+};
+
+// The registers below follow the ones of JitShader where both use them, since the log2 and exp2
+// subroutines of JitShader are called for each lane. RAX-RDX, XMM0-XMM4 and the RESULT registers
+// can be used as scratch registers within a compiler function.
+
+/// Pointer to the uniform memory
+constexpr Reg64 UNIFORMS = r9;
+/// Top of the lane mask stack in the BatchUnit
+constexpr Reg64 MASK_STACK = r12;
+/// Current VS loop iteration number, the same for every lane
+constexpr Reg32 LOOPCOUNT = esi;
+/// Number to increment the loop register aL of every lane by on each loop iteration
+constexpr Reg32 LOOPINC = edi;
+/// Pointer to the BatchUnit instance
+constexpr Reg64 STATE = r15;
+/// SIMD scratch register, clobbered by the log2 and exp2 subroutines
+constexpr Xmm SCRATCH = xmm0;
+/// Loaded with a swizzled source component, otherwise can be used as a scratch register
+constexpr Xmm SRC1 = xmm1;
+constexpr Xmm SRC2 = xmm2;
+constexpr Xmm SRC3 = xmm3;
+/// Additional scratch register, clobbered by the log2 and exp2 subroutines
+constexpr Xmm SCRATCH2 = xmm4;
+/// Result of an instruction, one register for each destination component
+constexpr std::array<Xmm, 4> RESULT = {xmm5, xmm6, xmm7, xmm8};
+/// Mask of the lanes that haven't run into an END instruction yet
+constexpr Xmm RUNNING = xmm10;
+/// Result of the previous CMP instruction for the X-component comparison of each lane
+constexpr Xmm COND0 = xmm11;
+/// Result of the previous CMP instruction for the Y-component comparison of each lane
+constexpr Xmm COND1 = xmm12;
+/// Mask of the lanes that run the current instruction
+constexpr Xmm ACTIVE = xmm13;
+/// Constant vector of [1.0f, 1.0f, 1.0f, 1.0f], used to efficiently set a vector to one
+constexpr Xmm ONE = xmm14;
+/// Constant vector of [-0.f, -0.f, -0.f, -0.f], used to efficiently negate a vector with XOR
+constexpr Xmm NEGBIT = xmm15;
+
+/// Stack slots of a LOOP frame
+enum LoopSlot : u32 {
+    LoopCounters = 0, ///< LOOPCOUNT and LOOPINC of the enclosing loop
+    LoopSavedAL = 1,  ///< aL of every lane in the enclosing loop
+    LoopAlive = 2,    ///< Lanes that haven't broken out of the loop
+    LoopEntry = 3,    ///< Lanes that entered the loop
+    LoopFrameSize = 4,
+};
+
+SwizzlePattern JitBatchShader::GetSwizzlePattern(Instruction instr) const {
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        return {(*swizzle_data)[instr.mad.operand_desc_id]};
+    }
+    return {(*swizzle_data)[instr.common.operand_desc_id]};
+}
+
+void JitBatchShader::Compile_SwizzleSrc(Instruction instr, u32 src_num, SourceRegister src_reg,
+                                        u32 component, Xmm dest) {
+    const bool is_inverted =
+        (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+
+    u32 address_register_index;
+    u32 offset_src;
+
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        offset_src = is_inverted ? 3 : 2;
+        address_register_index = instr.mad.address_register_index;
+    } else {
+        offset_src = is_inverted ? 2 : 1;
+        address_register_index = instr.common.address_register_index;
+    }
+
+    // Swizzling picks the component to load, the selector of the X-component is in the high bits
+    const SwizzlePattern swiz = GetSwizzlePattern(instr);
+    const u32 selector = (swiz.GetRawSelector(src_num) >> (6 - 2 * component)) & 3;
+    const std::size_t selector_offset = selector * sizeof(BatchUnit::Component);
+
+    switch (src_reg.GetRegisterType()) {
+    case RegisterType::FloatUniform:
+        if (src_num == offset_src && address_register_index != 0) {
+            if (!relative_uniform_loaded) {
+                Compile_RelativeUniform(src_reg, address_register_index);
+                relative_uniform_loaded = true;
+            }
+            movaps(dest, xword[STATE + offsetof(BatchUnit, relative_uniform) + selector_offset]);
+        } else {
+            // Uniforms are the same for every lane
+            const std::size_t offset =
+                Uniforms::GetFloatUniformOffset(src_reg.GetIndex()) + selector * sizeof(f24);
+            if (host_caps.has(Cpu::tAVX)) {
+                vbroadcastss(dest, dword[UNIFORMS + offset]);
+            } else {
+                movss(dest, dword[UNIFORMS + offset]);
+                shufps(dest, dest, _MM_SHUFFLE(0, 0, 0, 0));
+            }
+        }
+        break;
+    case RegisterType::Input:
+        movaps(dest, xword[STATE + BatchUnit::InputOffset(src_reg.GetIndex()) + selector_offset]);
+        break;
+    case RegisterType::Temporary:
+        movaps(dest,
+               xword[STATE + BatchUnit::TemporaryOffset(src_reg.GetIndex()) + selector_offset]);
+        break;
+    default:
+        UNREACHABLE_MSG("Encountered unknown source register type: {}", src_reg.GetRegisterType());
+        break;
+    }
+
+    // If the source register should be negated, flip the negative bit using XOR
+    const bool negate[] = {swiz.negate_src1, swiz.negate_src2, swiz.negate_src3};
+    if (negate[src_num - 1]) {
+        xorps(dest, NEGBIT);
+    }
+}
+
+void JitBatchShader::Compile_RelativeUniform(SourceRegister src_reg, u32 address_register_index) {
+    const std::size_t address_offset = BatchUnit::AddressRegisterOffset(address_register_index - 1);
+
+    for (u32 lane = 0; lane < BatchUnit::NumLanes; ++lane) {
+        const std::size_t lane_offset = offsetof(BatchUnit, relative_uniform) + lane * sizeof(f24);
+
+        // Same index computation as JitShader::Compile_SwizzleSrc with the offset of this lane
+        movsxd(rcx, dword[STATE + address_offset + lane * sizeof(u32)]);
+        lea(eax, ptr[rcx + 128]);
+        mov(ebx, src_reg.GetIndex());
+        add(ecx, ebx);
+        cmp(eax, 256);
+        cmovb(ebx, ecx);
+        and_(ebx, 0x7f);
+
+        // index > 95 ? vec4(1.0) : uniforms.f[index];
+        Label load_one, load_end;
+        cmp(ebx, 95);
+        jg(load_one);
+        shl(rbx, 4);
+        for (u32 comp = 0; comp < 4; ++comp) {
+            mov(edx, dword[UNIFORMS + rbx + comp * sizeof(f24)]);
+            mov(dword[STATE + lane_offset + comp * sizeof(BatchUnit::Component)], edx);
+        }
+        jmp(load_end);
+        L(load_one);
+        for (u32 comp = 0; comp < 4; ++comp) {
+            mov(dword[STATE + lane_offset + comp * sizeof(BatchUnit::Component)],
+                0x3f800000); // 1.0f
+        }
+        L(load_end);
+    }
+}
+
+void JitBatchShader::Compile_DestEnable(Instruction instr, const std::array<Xmm, 4>& src) {
+    DestRegister dest;
+    if (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MAD ||
+        instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI) {
+        dest = instr.mad.dest.Value();
+    } else {
+        dest = instr.common.dest.Value();
+    }
+
+    std::size_t dest_offset_disp;
+    switch (dest.GetRegisterType()) {
+    case RegisterType::Output:
+        dest_offset_disp = BatchUnit::OutputOffset(dest.GetIndex());
+        break;
+    case RegisterType::Temporary:
+        dest_offset_disp = BatchUnit::TemporaryOffset(dest.GetIndex());
+        break;
+    default:
+        UNREACHABLE_MSG("Encountered unknown destination register type: {}",
+                        dest.GetRegisterType());
+        break;
+    }
+
+    // Disabled components are simply not stored, as each one has its own vector
+    const SwizzlePattern swiz = GetSwizzlePattern(instr);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (swiz.DestComponentEnabled(comp)) {
+            Compile_MaskedStore(
+                xword[STATE + dest_offset_disp + comp * sizeof(BatchUnit::Component)], src[comp]);
+        }
+    }
+}
+
+void JitBatchShader::Compile_MaskedMove(Xmm dest, Xmm src) {
+    if (!masked_flow) {
+        movaps(dest, src);
+    } else if (host_caps.has(Cpu::tAVX)) {
+        vblendvps(dest, dest, src, ACTIVE);
+    } else {
+        // dest ^= (dest ^ src) & ACTIVE
+        movaps(SCRATCH, dest);
+        xorps(SCRATCH, src);
+        andps(SCRATCH, ACTIVE);
+        xorps(dest, SCRATCH);
+    }
+}
+
+void JitBatchShader::Compile_MaskedStore(const Xbyak::Address& dest, Xmm src) {
+    if (!masked_flow) {
+        movaps(dest, src);
+        return;
+    }
+    movaps(SCRATCH2, dest);
+    Compile_MaskedMove(SCRATCH2, src);
+    movaps(dest, SCRATCH2);
+}
+
+void JitBatchShader::Compile_SanitizedMul(Xmm src1, Xmm src2, Xmm scratch) {
+    // 0 * inf and inf * 0 in the PICA should return 0 instead of NaN, see
+    // JitShader::Compile_SanitizedMul.
+
+    if (host_caps.has(Cpu::tAVX512F | Cpu::tAVX512VL | Cpu::tAVX512DQ)) {
+        vmulps(scratch, src1, src2);
+
+        // Mask of any NaN values found in the result
+        const Xbyak::Opmask zero_mask = k1;
+        vcmpunordps(zero_mask, scratch, scratch);
+
+        // Mask of any non-NaN inputs producing NaN results
+        vcmpordps(zero_mask | zero_mask, src1, src2);
+
+        knotb(zero_mask, zero_mask);
+        vmovaps(src1 | zero_mask | T_z, scratch);
+
+        return;
+    }
+
+    // Set scratch to mask of (src1 != NaN and src2 != NaN)
+    if (host_caps.has(Cpu::tAVX)) {
+        vcmpordps(scratch, src1, src2);
+    } else {
+        movaps(scratch, src1);
+        cmpordps(scratch, src2);
+    }
+
+    mulps(src1, src2);
+
+    // Set src2 to mask of (result == NaN)
+    if (host_caps.has(Cpu::tAVX)) {
+        vcmpunordps(src2, src2, src1);
+    } else {
+        movaps(src2, src1);
+        cmpunordps(src2, src2);
+    }
+
+    // Clear components where scratch != src2 (i.e. if result is NaN where neither source was NaN)
+    xorps(scratch, src2);
+    andps(src1, scratch);
+}
+
+void JitBatchShader::Compile_ScalarSubroutine(Instruction instr, const u8* subroutine) {
+    // The subroutines only compute the first component of SRC1, so call them once for each lane
+    const std::size_t operand_offset = offsetof(BatchUnit, scalar_operand);
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, 0, SRC1);
+    movaps(xword[STATE + operand_offset], SRC1);
+
+    for (u32 lane = 0; lane < BatchUnit::NumLanes; ++lane) {
+        movss(SRC1, dword[STATE + operand_offset + lane * sizeof(f24)]);
+        mov(rax, reinterpret_cast<std::size_t>(subroutine));
+        call(rax);
+        movss(dword[STATE + operand_offset + lane * sizeof(f24)], SRC1);
+    }
+
+    movaps(RESULT[0], xword[STATE + operand_offset]);
+    Compile_DestEnable(instr, {RESULT[0], RESULT[0], RESULT[0], RESULT[0]});
+}
+
+void JitBatchShader::Compile_EvaluateCondition(Instruction instr) {
+    // Loads the lanes where a condition code equals the reference value
+    const auto compare = [this](Xmm dest, Xmm cond, u32 ref) {
+        if (ref) {
+            movaps(dest, cond);
+        } else {
+            pcmpeqd(dest, dest);
+            xorps(dest, cond);
+        }
+    };
+
+    switch (instr.flow_control.op) {
+    case Instruction::FlowControlType::Or:
+        compare(SCRATCH, COND0, instr.flow_control.refx.Value());
+        compare(SCRATCH2, COND1, instr.flow_control.refy.Value());
+        orps(SCRATCH, SCRATCH2);
+        break;
+
+    case Instruction::FlowControlType::And:
+        compare(SCRATCH, COND0, instr.flow_control.refx.Value());
+        compare(SCRATCH2, COND1, instr.flow_control.refy.Value());
+        andps(SCRATCH, SCRATCH2);
+        break;
+
+    case Instruction::FlowControlType::JustX:
+        compare(SCRATCH, COND0, instr.flow_control.refx.Value());
+        break;
+
+    case Instruction::FlowControlType::JustY:
+        compare(SCRATCH, COND1, instr.flow_control.refy.Value());
+        break;
+    }
+}
+
+void JitBatchShader::Compile_UniformCondition(Instruction instr) {
+    std::size_t offset = Uniforms::GetBoolUniformOffset(instr.flow_control.bool_uniform_id);
+    cmp(byte[UNIFORMS + offset], 0);
+}
+
+void JitBatchShader::Compile_SkipIfInactive(Label& label) {
+    movmskps(eax, ACTIVE);
+    test(eax, eax);
+    jz(label, T_NEAR);
+}
+
+void JitBatchShader::Compile_RestoreActive(u32 slot) {
+    movaps(ACTIVE, xword[MASK_STACK + slot * sizeof(BatchUnit::LaneMask)]);
+    andps(ACTIVE, RUNNING);
+    if (!loop_frames.empty()) {
+        // Lanes that broke out of the loop stay off until its end
+        andps(ACTIVE, xword[MASK_STACK + LoopSlotOffset(LoopAlive)]);
+    }
+}
+
+void JitBatchShader::Compile_PushStack(u32 num_slots) {
+    sub(MASK_STACK, num_slots * sizeof(BatchUnit::LaneMask));
+
+    // Flow control nested deeper than the stack stops the batch
+    lea(rax, ptr[STATE + offsetof(BatchUnit, stack)]);
+    cmp(MASK_STACK, rax);
+    jb(abort_label, T_NEAR);
+
+    stack_depth += num_slots;
+}
+
+void JitBatchShader::Compile_PopStack(u32 num_slots) {
+    add(MASK_STACK, num_slots * sizeof(BatchUnit::LaneMask));
+    stack_depth -= num_slots;
+}
+
+std::size_t JitBatchShader::LoopSlotOffset(u32 slot) const {
+    return (stack_depth - loop_frames.back() + slot) * sizeof(BatchUnit::LaneMask);
+}
+
+Label& JitBatchShader::Compile_Thunk(u32 target, u32 return_offset) {
+    return thunks.emplace_back(Thunk{{}, target, return_offset, current_region}).label;
+}
+
+void JitBatchShader::Compile_ADD(Instruction instr) {
+    const SwizzlePattern swiz = GetSwizzlePattern(instr);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (swiz.DestComponentEnabled(comp)) {
+            Compile_SwizzleSrc(instr, 1, instr.common.src1, comp, RESULT[comp]);
+            Compile_SwizzleSrc(instr, 2, instr.common.src2, comp, SRC2);
+            addps(RESULT[comp], SRC2);
+        }
+    }
+    Compile_DestEnable(instr, RESULT);
+}
+
+void JitBatchShader::Compile_DP3(Instruction instr) {
+    for (u32 comp = 0; comp < 3; ++comp) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, comp, RESULT[comp]);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, comp, SRC2);
+        Compile_SanitizedMul(RESULT[comp], SRC2, SCRATCH);
+    }
+
+    // Same order of additions as JitShader
+    addps(RESULT[0], RESULT[1]);
+    addps(RESULT[0], RESULT[2]);
+
+    Compile_DestEnable(instr, {RESULT[0], RESULT[0], RESULT[0], RESULT[0]});
+}
+
+void JitBatchShader::Compile_DP4(Instruction instr) {
+    for (u32 comp = 0; comp < 4; ++comp) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, comp, RESULT[comp]);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, comp, SRC2);
+        Compile_SanitizedMul(RESULT[comp], SRC2, SCRATCH);
+    }
+
+    // Same order of additions as the horizontal adds of JitShader
+    addps(RESULT[0], RESULT[1]);
+    addps(RESULT[2], RESULT[3]);
+    addps(RESULT[0], RESULT[2]);
+
+    Compile_DestEnable(instr, {RESULT[0], RESULT[0], RESULT[0], RESULT[0]});
+}
+
+void JitBatchShader::Compile_DPH(Instruction instr) {
+    const bool is_inverted = instr.opcode.Value().EffectiveOpCode() == OpCode::Id::DPHI;
+    const SourceRegister src1 =
+        is_inverted ? instr.common.src1i.Value() : instr.common.src1.Value();
+    const SourceRegister src2 =
+        is_inverted ? instr.common.src2i.Value() : instr.common.src2.Value();
+
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (comp == 3) {
+            // Set 4th component to 1.0
+            movaps(RESULT[comp], ONE);
+        } else {
+            Compile_SwizzleSrc(instr, 1, src1, comp, RESULT[comp]);
+        }
+        Compile_SwizzleSrc(instr, 2, src2, comp, SRC2);
+        Compile_SanitizedMul(RESULT[comp], SRC2, SCRATCH);
+    }
+
+    addps(RESULT[0], RESULT[1]);
+    addps(RESULT[2], RESULT[3]);
+    addps(RESULT[0], RESULT[2]);
+
+    Compile_DestEnable(instr, {RESULT[0], RESULT[0], RESULT[0], RESULT[0]});
+}
+
+void JitBatchShader::Compile_EX2(Instruction instr) {
+    Compile_ScalarSubroutine(instr, exp2_subroutine);
+}
+
+void JitBatchShader::Compile_LG2(Instruction instr) {
+    Compile_ScalarSubroutine(instr, log2_subroutine);
+}
+
+void JitBatchShader::Compile_MUL(Instruction instr) {
+    const SwizzlePattern swiz = GetSwizzlePattern(instr);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (swiz.DestComponentEnabled(comp)) {
+            Compile_SwizzleSrc(instr, 1, instr.common.src1, comp, RESULT[comp]);
+            Compile_SwizzleSrc(instr, 2, instr.common.src2, comp, SRC2);
+            Compile_SanitizedMul(RESULT[comp], SRC2, SCRATCH);
+        }
+    }
+    Compile_DestEnable(instr, RESULT);
+}
+
+void JitBatchShader::Compile_SGE(Instruction instr) {
+    const bool is_inverted = instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SGEI;
+    const SourceRegister src1 =
+        is_inverted ? instr.common.src1i.Value() : instr.common.src1.Value();
+    const SourceRegister src2 =
+        is_inverted ? instr.common.src2i.Value() : instr.common.src2.Value();
+
+    const SwizzlePattern swiz = GetSwizzlePattern(instr);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (swiz.DestComponentEnabled(comp)) {
+            Compile_SwizzleSrc(instr, 1, src1, comp, SRC1);
+            Compile_SwizzleSrc(instr, 2, src2, comp, RESULT[comp]);
+            cmpleps(RESULT[comp], SRC1);
+            andps(RESULT[comp], ONE);
+        }
+    }
+    Compile_DestEnable(instr, RESULT);
+}
+
+void JitBatchShader::Compile_SLT(Instruction instr) {
+    const bool is_inverted = instr.opcode.Value().EffectiveOpCode() == OpCode::Id::SLTI;
+    const SourceRegister src1 =
+        is_inverted ? instr.common.src1i.Value() : instr.common.src1.Value();
+    const SourceRegister src2 =
+        is_inverted ? instr.common.src2i.Value() : instr.common.src2.Value();
+
+    const SwizzlePattern swiz = GetSwizzlePattern(instr);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (swiz.DestComponentEnabled(comp)) {
+            Compile_SwizzleSrc(instr, 1, src1, comp, RESULT[comp]);
+            Compile_SwizzleSrc(instr, 2, src2, comp, SRC2);
+            cmpltps(RESULT[comp], SRC2);
+            andps(RESULT[comp], ONE);
+        }
+    }
+    Compile_DestEnable(instr, RESULT);
+}
+
+void JitBatchShader::Compile_FLR(Instruction instr) {
+    const SwizzlePattern swiz = GetSwizzlePattern(instr);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (!swiz.DestComponentEnabled(comp)) {
+            continue;
+        }
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, comp, RESULT[comp]);
+        if (host_caps.has(Cpu::tSSE41)) {
+            roundps(RESULT[comp], RESULT[comp], _MM_FROUND_FLOOR);
+        } else {
+            cvttps2dq(RESULT[comp], RESULT[comp]);
+            cvtdq2ps(RESULT[comp], RESULT[comp]);
+        }
+    }
+    Compile_DestEnable(instr, RESULT);
+}
+
+void JitBatchShader::Compile_MAX(Instruction instr) {
+    const SwizzlePattern swiz = GetSwizzlePattern(instr);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (swiz.DestComponentEnabled(comp)) {
+            Compile_SwizzleSrc(instr, 1, instr.common.src1, comp, RESULT[comp]);
+            Compile_SwizzleSrc(instr, 2, instr.common.src2, comp, SRC2);
+            // SSE semantics match PICA200 ones: In case of NaN, SRC2 is returned.
+            maxps(RESULT[comp], SRC2);
+        }
+    }
+    Compile_DestEnable(instr, RESULT);
+}
+
+void JitBatchShader::Compile_MIN(Instruction instr) {
+    const SwizzlePattern swiz = GetSwizzlePattern(instr);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (swiz.DestComponentEnabled(comp)) {
+            Compile_SwizzleSrc(instr, 1, instr.common.src1, comp, RESULT[comp]);
+            Compile_SwizzleSrc(instr, 2, instr.common.src2, comp, SRC2);
+            // SSE semantics match PICA200 ones: In case of NaN, SRC2 is returned.
+            minps(RESULT[comp], SRC2);
+        }
+    }
+    Compile_DestEnable(instr, RESULT);
+}
+
+void JitBatchShader::Compile_MOVA(Instruction instr) {
+    const SwizzlePattern swiz = GetSwizzlePattern(instr);
+    for (u32 comp = 0; comp < 2; ++comp) {
+        if (swiz.DestComponentEnabled(comp)) {
+            Compile_SwizzleSrc(instr, 1, instr.common.src1, comp, RESULT[comp]);
+            // Convert floats to integers using truncation
+            cvttps2dq(RESULT[comp], RESULT[comp]);
+        }
+    }
+    for (u32 comp = 0; comp < 2; ++comp) {
+        if (swiz.DestComponentEnabled(comp)) {
+            Compile_MaskedStore(xword[STATE + BatchUnit::AddressRegisterOffset(comp)],
+                                RESULT[comp]);
+        }
+    }
+}
+
+void JitBatchShader::Compile_MOV(Instruction instr) {
+    const SwizzlePattern swiz = GetSwizzlePattern(instr);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (swiz.DestComponentEnabled(comp)) {
+            Compile_SwizzleSrc(instr, 1, instr.common.src1, comp, RESULT[comp]);
+        }
+    }
+    Compile_DestEnable(instr, RESULT);
+}
+
+void JitBatchShader::Compile_RCP(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, 0, RESULT[0]);
+
+    // The packed forms give the same approximation as the scalar ones of JitShader
+    if (host_caps.has(Cpu::tAVX512F | Cpu::tAVX512VL)) {
+        vrcp14ps(RESULT[0], RESULT[0]);
+    } else {
+        rcpps(RESULT[0], RESULT[0]);
+    }
+
+    Compile_DestEnable(instr, {RESULT[0], RESULT[0], RESULT[0], RESULT[0]});
+}
+
+void JitBatchShader::Compile_RSQ(Instruction instr) {
+    Compile_SwizzleSrc(instr, 1, instr.common.src1, 0, RESULT[0]);
+
+    if (host_caps.has(Cpu::tAVX512F | Cpu::tAVX512VL)) {
+        vrsqrt14ps(RESULT[0], RESULT[0]);
+    } else {
+        rsqrtps(RESULT[0], RESULT[0]);
+    }
+
+    Compile_DestEnable(instr, {RESULT[0], RESULT[0], RESULT[0], RESULT[0]});
+}
+
+void JitBatchShader::Compile_NOP(Instruction instr) {}
+
+void JitBatchShader::Compile_END(Instruction instr) {
+    if (!masked_flow) {
+        jmp(end_label, T_NEAR);
+        return;
+    }
+
+    // The active lanes are done, the shader returns once every lane is
+    movaps(SCRATCH, ACTIVE);
+    andnps(SCRATCH, RUNNING);
+    movaps(RUNNING, SCRATCH);
+    xorps(ACTIVE, ACTIVE);
+
+    movmskps(eax, RUNNING);
+    test(eax, eax);
+    jz(end_label, T_NEAR);
+}
+
+void JitBatchShader::Compile_BREAKC(Instruction instr) {
+    if (loop_frames.empty()) {
+        // BREAKC must be inside a LOOP
+        jmp(abort_label, T_NEAR);
+        return;
+    }
+
+    // Lanes that break are off until the end of the loop
+    Compile_EvaluateCondition(instr);
+    andps(SCRATCH, ACTIVE);
+    const std::size_t alive_offset = LoopSlotOffset(LoopAlive);
+    movaps(SCRATCH2, SCRATCH);
+    andnps(SCRATCH2, xword[MASK_STACK + alive_offset]);
+    movaps(xword[MASK_STACK + alive_offset], SCRATCH2);
+    andnps(SCRATCH, ACTIVE);
+    movaps(ACTIVE, SCRATCH);
+
+    // Leave the loop once none of its lanes is running
+    Label l_continue;
+    andps(SCRATCH2, RUNNING);
+    movmskps(eax, SCRATCH2);
+    test(eax, eax);
+    jnz(l_continue);
+    if (stack_depth != loop_frames.back()) {
+        add(MASK_STACK, (stack_depth - loop_frames.back()) * sizeof(BatchUnit::LaneMask));
+    }
+    jmp(loop_break_labels.back(), T_NEAR);
+    L(l_continue);
+}
+
+void JitBatchShader::Compile_CALL(Instruction instr) {
+    const u32 return_offset = instr.flow_control.dest_offset + instr.flow_control.num_instructions;
+
+    // Push offset of the return
+    push(qword, return_offset);
+
+    // Call the subroutine
+    call(Compile_Thunk(instr.flow_control.dest_offset, return_offset));
+
+    // Skip over the return offset that's on the stack
+    add(rsp, 8);
+}
+
+void JitBatchShader::Compile_CALLC(Instruction instr) {
+    // Only the lanes that meet the condition run the subroutine
+    Compile_EvaluateCondition(instr);
+    Compile_PushStack(1);
+    movaps(xword[MASK_STACK], ACTIVE);
+    andps(ACTIVE, SCRATCH);
+
+    Label b;
+    Compile_SkipIfInactive(b);
+    Compile_CALL(instr);
+    L(b);
+
+    Compile_RestoreActive(0);
+    Compile_PopStack(1);
+}
+
+void JitBatchShader::Compile_CALLU(Instruction instr) {
+    Compile_UniformCondition(instr);
+    Label b;
+    jz(b);
+    Compile_CALL(instr);
+    L(b);
+}
+
+void JitBatchShader::Compile_CMP(Instruction instr) {
+    using Op = Instruction::Common::CompareOpType::Op;
+    const Op ops[] = {instr.common.compare_op.x, instr.common.compare_op.y};
+
+    // SSE doesn't have greater-than (GT) or greater-equal (GE) comparison operators, see
+    // JitShader::Compile_CMP.
+    static const u8 cmp[] = {CMP_EQ, CMP_NEQ, CMP_LT, CMP_LE, CMP_LT, CMP_LE};
+
+    for (u32 comp = 0; comp < 2; ++comp) {
+        Compile_SwizzleSrc(instr, 1, instr.common.src1, comp, RESULT[comp]);
+        Compile_SwizzleSrc(instr, 2, instr.common.src2, comp, SRC2);
+        if (ops[comp] == Op::GreaterThan || ops[comp] == Op::GreaterEqual) {
+            cmpps(SRC2, RESULT[comp], cmp[ops[comp]]);
+            movaps(RESULT[comp], SRC2);
+        } else {
+            cmpps(RESULT[comp], SRC2, cmp[ops[comp]]);
+        }
+    }
+
+    Compile_MaskedMove(COND0, RESULT[0]);
+    Compile_MaskedMove(COND1, RESULT[1]);
+}
+
+void JitBatchShader::Compile_MAD(Instruction instr) {
+    const bool is_inverted = instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI;
+    const SourceRegister src2 =
+        is_inverted ? instr.mad.src2i.Value() : instr.mad.src2.Value();
+    const SourceRegister src3 =
+        is_inverted ? instr.mad.src3i.Value() : instr.mad.src3.Value();
+
+    const SwizzlePattern swiz = GetSwizzlePattern(instr);
+    for (u32 comp = 0; comp < 4; ++comp) {
+        if (swiz.DestComponentEnabled(comp)) {
+            Compile_SwizzleSrc(instr, 1, instr.mad.src1, comp, RESULT[comp]);
+            Compile_SwizzleSrc(instr, 2, src2, comp, SRC2);
+            Compile_SwizzleSrc(instr, 3, src3, comp, SRC3);
+            Compile_SanitizedMul(RESULT[comp], SRC2, SCRATCH);
+            addps(RESULT[comp], SRC3);
+        }
+    }
+    Compile_DestEnable(instr, RESULT);
+}
+
+void JitBatchShader::Compile_IF(Instruction instr) {
+    const u32 end = instr.flow_control.dest_offset + instr.flow_control.num_instructions;
+    if (instr.flow_control.dest_offset < program_counter || end > program_end) {
+        // Backwards if-statements are not supported, and ones past the reachable code never run
+        jmp(abort_label, T_NEAR);
+        return;
+    }
+    Label l_else, l_endif;
+
+    if (instr.opcode.Value() == OpCode::Id::IFU) {
+        // The condition is the same for every lane
+        Compile_UniformCondition(instr);
+        jz(l_else, T_NEAR);
+        Compile_Block(instr.flow_control.dest_offset);
+
+        // If there isn't an "ELSE" condition, we are done here
+        if (instr.flow_control.num_instructions == 0) {
+            L(l_else);
+            return;
+        }
+
+        jmp(l_endif, T_NEAR);
+        L(l_else);
+        Compile_Block(end);
+        L(l_endif);
+        return;
+    }
+
+    // Lanes run the code for the condition evaluating as true, then the code for it evaluating as
+    // false, with the other lanes masked off. The lanes of the "ELSE" code are saved on the stack
+    // below the lanes active at the IF.
+    Compile_EvaluateCondition(instr);
+    Compile_PushStack(2);
+    movaps(xword[MASK_STACK + sizeof(BatchUnit::LaneMask)], ACTIVE);
+    movaps(SCRATCH2, SCRATCH);
+    andnps(SCRATCH2, ACTIVE);
+    movaps(xword[MASK_STACK], SCRATCH2);
+    andps(ACTIVE, SCRATCH);
+
+    const u16 outer_region = current_region;
+    current_region = ++num_regions;
+    Compile_SkipIfInactive(l_else);
+    Compile_Block(instr.flow_control.dest_offset);
+    L(l_else);
+
+    if (instr.flow_control.num_instructions != 0) {
+        current_region = ++num_regions;
+        Compile_RestoreActive(0);
+        Compile_SkipIfInactive(l_endif);
+        Compile_Block(end);
+        L(l_endif);
+    }
+    current_region = outer_region;
+
+    Compile_RestoreActive(1);
+    Compile_PopStack(2);
+}
+
+void JitBatchShader::Compile_LOOP(Instruction instr) {
+    if (instr.flow_control.dest_offset < program_counter ||
+        instr.flow_control.dest_offset >= program_end) {
+        // Backwards loops are not supported, and ones past the reachable code never run
+        jmp(abort_label, T_NEAR);
+        return;
+    }
+
+    // Every lane runs the loop the same number of times, the ones that break out of it are masked
+    // off until its end. The counters and aL of an enclosing loop are saved in the frame.
+    const std::size_t address_offset = BatchUnit::AddressRegisterOffset(2);
+    Compile_PushStack(LoopFrameSize);
+    mov(dword[MASK_STACK + LoopCounters * sizeof(BatchUnit::LaneMask)], LOOPCOUNT);
+    mov(dword[MASK_STACK + LoopCounters * sizeof(BatchUnit::LaneMask) + 4], LOOPINC);
+    movaps(SCRATCH, xword[STATE + address_offset]);
+    movaps(xword[MASK_STACK + LoopSavedAL * sizeof(BatchUnit::LaneMask)], SCRATCH);
+    movaps(xword[MASK_STACK + LoopAlive * sizeof(BatchUnit::LaneMask)], ACTIVE);
+    movaps(xword[MASK_STACK + LoopEntry * sizeof(BatchUnit::LaneMask)], ACTIVE);
+
+    // This decodes the fields from the integer uniform at index instr.flow_control.int_uniform_id,
+    // like JitShader::Compile_LOOP.
+    std::size_t offset = Uniforms::GetIntUniformOffset(instr.flow_control.int_uniform_id);
+    mov(LOOPCOUNT, dword[UNIFORMS + offset]);
+    mov(eax, LOOPCOUNT);
+    shr(eax, 8);
+    and_(eax, 0xFF); // Y-component is the start
+    movd(SRC1, eax);
+    pshufd(SRC1, SRC1, _MM_SHUFFLE(0, 0, 0, 0));
+    Compile_MaskedStore(xword[STATE + address_offset], SRC1);
+    mov(LOOPINC, LOOPCOUNT);
+    shr(LOOPINC, 16);
+    and_(LOOPINC, 0xFF);                // Z-component is the incrementer
+    movzx(LOOPCOUNT, LOOPCOUNT.cvt8()); // X-component is iteration count
+    add(LOOPCOUNT, 1);                  // Iteration count is X-component + 1
+
+    loop_frames.push_back(stack_depth);
+    loop_break_labels.emplace_back(Xbyak::Label());
+    const u16 outer_region = current_region;
+    current_region = ++num_regions;
+
+    Label l_loop_start;
+    L(l_loop_start);
+    Compile_Block(instr.flow_control.dest_offset + 1);
+
+    // Increment aL of the lanes still in the loop by the Z-component
+    movd(SRC1, LOOPINC);
+    pshufd(SRC1, SRC1, _MM_SHUFFLE(0, 0, 0, 0));
+    paddd(SRC1, xword[STATE + address_offset]);
+    Compile_MaskedStore(xword[STATE + address_offset], SRC1);
+    sub(LOOPCOUNT, 1);
+    jnz(l_loop_start, T_NEAR);
+
+    L(loop_break_labels.back());
+    loop_break_labels.pop_back();
+    loop_frames.pop_back();
+    current_region = outer_region;
+
+    // Lanes that broke out of the loop are active again
+    movaps(ACTIVE, xword[MASK_STACK + LoopEntry * sizeof(BatchUnit::LaneMask)]);
+    andps(ACTIVE, RUNNING);
+
+    if (!loop_frames.empty()) {
+        movaps(SCRATCH, xword[MASK_STACK + LoopSavedAL * sizeof(BatchUnit::LaneMask)]);
+        movaps(xword[STATE + address_offset], SCRATCH);
+    }
+    mov(LOOPCOUNT, dword[MASK_STACK + LoopCounters * sizeof(BatchUnit::LaneMask)]);
+    mov(LOOPINC, dword[MASK_STACK + LoopCounters * sizeof(BatchUnit::LaneMask) + 4]);
+    Compile_PopStack(LoopFrameSize);
+}
+
+void JitBatchShader::Compile_JMP(Instruction instr) {
+    Label& target = Compile_Thunk(instr.flow_control.dest_offset, NoReturn);
+    Label b;
+
+    if (instr.opcode.Value() == OpCode::Id::JMPU) {
+        if (masked_flow) {
+            // Lanes that are all off carry on past the jump
+            Compile_SkipIfInactive(b);
+        }
+        Compile_UniformCondition(instr);
+        if (instr.flow_control.num_instructions & 1) {
+            jz(target, T_NEAR);
+        } else {
+            jnz(target, T_NEAR);
+        }
+    } else if (instr.opcode.Value() == OpCode::Id::JMPC) {
+        // The active lanes can only follow the jump together, otherwise the batch stops
+        Compile_EvaluateCondition(instr);
+        andps(SCRATCH, ACTIVE);
+        movmskps(eax, SCRATCH);
+        movmskps(ecx, ACTIVE);
+        test(eax, eax);
+        jz(b);
+        cmp(eax, ecx);
+        jne(abort_label, T_NEAR);
+        jmp(target, T_NEAR);
+    } else {
+        UNREACHABLE();
+    }
+    L(b);
+}
+
+void JitBatchShader::Compile_EMIT(Instruction instr) {
+    // Geometry shaders are not run in batches
+    jmp(abort_label, T_NEAR);
+}
+
+void JitBatchShader::Compile_SETE(Instruction instr) {
+    jmp(abort_label, T_NEAR);
+}
+
+void JitBatchShader::Compile_Block(u32 end) {
+    while (program_counter < end) {
+        Compile_NextInstr();
+    }
+}
+
+void JitBatchShader::Compile_Return() {
+    // Peek return offset on the stack and check if we're at that offset
+    mov(rax, qword[rsp + 8]);
+    cmp(eax, (program_counter));
+
+    // If so, jump back to before CALL
+    Label b;
+    jnz(b);
+    ret();
+    L(b);
+}
+
+void JitBatchShader::Compile_NextInstr() {
+    if (std::binary_search(return_offsets.begin(), return_offsets.end(), program_counter)) {
+        Compile_Return();
+    }
+
+    L(instruction_labels[program_counter]);
+    instruction_regions[program_counter] = current_region;
+    relative_uniform_loaded = false;
+
+    Instruction instr = {(*program_code)[program_counter++]};
+
+    OpCode::Id opcode = instr.opcode.Value();
+    auto instr_func = batch_instr_table[static_cast<u32>(opcode)];
+
+    if (instr_func) {
+        // JIT the instruction!
+        ((*this).*instr_func)(instr);
+    } else {
+        // Unhandled instruction
+        LOG_CRITICAL(HW_GPU, "Unhandled instruction: 0x{:02x} (0x{:08x})",
+                     static_cast<u32>(instr.opcode.Value().EffectiveOpCode()), instr.hex);
+    }
+}
+
+void JitBatchShader::FindProgramRange(u32 entry_point) {
+    std::vector<bool> reached(MAX_PROGRAM_CODE_LENGTH);
+    std::vector<u32> pending;
+    program_begin = entry_point;
+    program_end = entry_point + 1;
+
+    const auto visit = [&](u32 offset) {
+        if (offset < MAX_PROGRAM_CODE_LENGTH && !reached[offset]) {
+            reached[offset] = true;
+            pending.push_back(offset);
+        }
+    };
+
+    visit(entry_point);
+    while (!pending.empty()) {
+        const u32 offset = pending.back();
+        pending.pop_back();
+        program_begin = std::min(program_begin, offset);
+        program_end = std::max(program_end, offset + 1);
+
+        const Instruction instr = {(*program_code)[offset]};
+        const u32 dest = instr.flow_control.dest_offset;
+        const u32 num = instr.flow_control.num_instructions;
+        switch (instr.opcode.Value()) {
+        case OpCode::Id::END:
+            break;
+        case OpCode::Id::CALL:
+        case OpCode::Id::CALLC:
+        case OpCode::Id::CALLU:
+            visit(dest);
+            visit(offset + 1);
+            // The return check is compiled at the instruction after the subroutine
+            program_end =
+                std::max(program_end, std::min<u32>(dest + num + 1, MAX_PROGRAM_CODE_LENGTH));
+            break;
+        case OpCode::Id::IFU:
+        case OpCode::Id::IFC:
+            visit(offset + 1);
+            visit(dest);
+            visit(dest + num);
+            break;
+        case OpCode::Id::LOOP:
+            visit(offset + 1);
+            visit(dest + 1);
+            break;
+        case OpCode::Id::JMPC:
+        case OpCode::Id::JMPU:
+            visit(dest);
+            visit(offset + 1);
+            break;
+        default:
+            visit(offset + 1);
+            break;
+        }
+    }
+}
+
+void JitBatchShader::FindReturnOffsets() {
+    return_offsets.clear();
+
+    for (std::size_t offset = program_begin; offset < program_end; ++offset) {
+        Instruction instr = {(*program_code)[offset]};
+
+        switch (instr.opcode.Value()) {
+        case OpCode::Id::CALL:
+        case OpCode::Id::CALLC:
+        case OpCode::Id::CALLU:
+            return_offsets.push_back(instr.flow_control.dest_offset +
+                                     instr.flow_control.num_instructions);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Sort for efficient binary search later
+    std::sort(return_offsets.begin(), return_offsets.end());
+}
+
+void JitBatchShader::Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code_,
+                             const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data_,
+                             u32 entry_point, const JitShader& shader) {
+    program_code = program_code_;
+    swizzle_data = swizzle_data_;
+    log2_subroutine = shader.GetLog2Subroutine();
+    exp2_subroutine = shader.GetExp2Subroutine();
+
+    // Reset flow control state
+    program_counter = 0;
+    stack_depth = 0;
+    current_region = 0;
+    num_regions = 0;
+    instruction_labels.fill(Xbyak::Label());
+    instruction_regions.fill(NotCompiled);
+    thunks.clear();
+
+    FindProgramRange(entry_point);
+    FindReturnOffsets();
+
+    // Without flow control that depends on the lane, every lane is always active
+    masked_flow = std::any_of(program_code->begin() + program_begin,
+                              program_code->begin() + program_end, [](u32 word) {
+                                  const Instruction instr = {word};
+                                  switch (instr.opcode.Value()) {
+                                  case OpCode::Id::IFC:
+                                  case OpCode::Id::CALLC:
+                                  case OpCode::Id::BREAKC:
+                                      return true;
+                                  default:
+                                      return false;
+                                  }
+                              });
+
+    // The stack pointer is 8 modulo 16 at the entry of a procedure
+    // We reserve 16 bytes and assign a dummy value to the first 8 bytes, to catch any potential
+    // return checks (see Compile_Return) that happen in shader main routine.
+    ABI_PushRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    mov(qword[rsp + 8], 0xFFFFFFFFFFFFFFFFULL);
+
+    mov(UNIFORMS, ABI_PARAM1);
+    mov(STATE, ABI_PARAM2);
+    mov(qword[STATE + offsetof(BatchUnit, host_stack_pointer)], rsp);
+    lea(MASK_STACK, ptr[STATE + offsetof(BatchUnit, stack) + sizeof(BatchUnit::stack)]);
+
+    // Load conditional code
+    movaps(COND0, xword[STATE + BatchUnit::ConditionalCodeOffset(0)]);
+    movaps(COND1, xword[STATE + BatchUnit::ConditionalCodeOffset(1)]);
+
+    // Every lane starts out active
+    pcmpeqd(ACTIVE, ACTIVE);
+    movaps(RUNNING, ACTIVE);
+
+    // Used to set a register to one
+    static const __m128 one = {1.f, 1.f, 1.f, 1.f};
+    mov(rax, reinterpret_cast<std::size_t>(&one));
+    movaps(ONE, xword[rax]);
+
+    // Used to negate registers
+    static const __m128 neg = {-0.f, -0.f, -0.f, -0.f};
+    mov(rax, reinterpret_cast<std::size_t>(&neg));
+    movaps(NEGBIT, xword[rax]);
+
+    // Jump to the entry point, which has to be outside of any masked block
+    jmp(Compile_Thunk(entry_point, NoReturn), T_NEAR);
+
+    // Compile the reachable part of the program, running past it stops the batch
+    program_counter = program_begin;
+    Compile_Block(program_end);
+    jmp(abort_label, T_NEAR);
+
+    // Jumps and calls into other masked blocks, or to code that wasn't compiled, stop the batch
+    for (Thunk& thunk : thunks) {
+        const u16 target_region = instruction_regions[thunk.target];
+        bool valid;
+        if (thunk.return_offset == NoReturn) {
+            valid = target_region == thunk.region;
+        } else {
+            valid = target_region == 0 && thunk.return_offset < MAX_PROGRAM_CODE_LENGTH &&
+                    instruction_regions[thunk.return_offset] == 0;
+        }
+        L(thunk.label);
+        jmp(valid ? instruction_labels[thunk.target] : abort_label, T_NEAR);
+    }
+
+    Label exit;
+    L(abort_label);
+    xor_(eax, eax);
+    jmp(exit);
+
+    L(end_label);
+    // Save conditional code
+    movaps(xword[STATE + BatchUnit::ConditionalCodeOffset(0)], COND0);
+    movaps(xword[STATE + BatchUnit::ConditionalCodeOffset(1)], COND1);
+    mov(eax, 1);
+
+    // Subroutines may still be on the stack
+    L(exit);
+    mov(rsp, qword[STATE + offsetof(BatchUnit, host_stack_pointer)]);
+    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8, 16);
+    ret();
+
+    // Free memory that's no longer needed
+    program_code = nullptr;
+    swizzle_data = nullptr;
+    return_offsets.clear();
+    return_offsets.shrink_to_fit();
+    thunks.clear();
+    thunks.shrink_to_fit();
+
+    // The code buffer grows with the size of the program, its address is only final now
+    ready();
+    program = getCode<CompiledShader*>();
+
+    LOG_DEBUG(HW_GPU, "Compiled batch shader size={}", getSize());
+}
+
+JitBatchShader::JitBatchShader() : Xbyak::CodeGenerator(MAX_SHADER_SIZE, Xbyak::AutoGrow) {}
+
+} // namespace Pica::Shader
+
+#endif // CITRA_ARCH(x86_64)
@@ -0,0 +1,271 @@
+// Copyright 2024 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "common/arch.h"
+#if CITRA_ARCH(x86_64)
+
+#include <array>
+#include <cstddef>
+#include <vector>
+#include <nihstro/shader_bytecode.h>
+#include <xbyak/xbyak.h>
+#include "common/common_types.h"
+#include "video_core/pica/output_vertex.h"
+#include "video_core/pica/shader_setup.h"
+
+using nihstro::Instruction;
+using nihstro::OpCode;
+using nihstro::SourceRegister;
+using nihstro::SwizzlePattern;
+
+namespace Pica {
+struct ShaderRegs;
+struct ShaderUnit;
+} // namespace Pica
+
+namespace Pica::Shader {
+
+class JitShader;
+
+/**
+ * Registers of the vertices shaded together by a JitBatchShader, one vertex per lane. The
+ * registers are stored component by component, so that one SSE vector holds the same component of
+ * a register for every lane.
+ */
+struct BatchUnit {
+    static constexpr u32 NumLanes = 4;
+
+    /// One component of a register for every lane
+    using Component = std::array<f24, NumLanes>;
+    using Register = std::array<Component, 4>;
+    /// One bit mask or integer for every lane
+    using LaneMask = std::array<u32, NumLanes>;
+
+    /// Copies the registers of a shader unit to every lane.
+    void Load(const ShaderUnit& state);
+
+    /// Copies the registers of a lane back to a shader unit.
+    void Store(u32 lane, ShaderUnit& state) const;
+
+    void LoadInput(const ShaderRegs& config, u32 lane, const AttributeBuffer& input);
+
+    void WriteOutput(const ShaderRegs& config, u32 lane, AttributeBuffer& output) const;
+
+    static constexpr std::size_t InputOffset(s32 register_index) {
+        return offsetof(BatchUnit, input) + register_index * sizeof(Register);
+    }
+
+    static constexpr std::size_t OutputOffset(s32 register_index) {
+        return offsetof(BatchUnit, output) + register_index * sizeof(Register);
+    }
+
+    static constexpr std::size_t TemporaryOffset(s32 register_index) {
+        return offsetof(BatchUnit, temporary) + register_index * sizeof(Register);
+    }
+
+    static constexpr std::size_t ConditionalCodeOffset(u32 index) {
+        return offsetof(BatchUnit, conditional_code) + index * sizeof(LaneMask);
+    }
+
+    static constexpr std::size_t AddressRegisterOffset(u32 index) {
+        return offsetof(BatchUnit, address_registers) + index * sizeof(LaneMask);
+    }
+
+    alignas(16) std::array<Register, 16> input;
+    alignas(16) std::array<Register, 16> temporary;
+    alignas(16) std::array<Register, 16> output;
+    /// Results of the last CMP instruction, all bits of a lane are set when the result is true
+    alignas(16) std::array<LaneMask, 2> conditional_code;
+    alignas(16) std::array<LaneMask, 3> address_registers;
+
+    /// Float uniform read with relative addressing, gathered for every lane
+    alignas(16) Register relative_uniform;
+    /// Operand of the EX2 and LG2 instructions, which are computed one lane at a time
+    alignas(16) Component scalar_operand;
+    /// Lane masks and loop state saved by flow control instructions, grows downwards
+    alignas(16) std::array<LaneMask, 64> stack;
+    /// Host stack pointer on entry, used to return from nested subroutines
+    u64 host_stack_pointer;
+};
+
+/**
+ * This class implements the batch shader JIT compiler. It recompiles a Pica shader program into
+ * x86_64 code that shades one vertex in each SSE lane. Flow control with a condition that differs
+ * between lanes runs both paths in turn, with the lanes of the other path masked off. Jumps and
+ * calls that can't be followed this way stop the batch, so that its vertices are shaded one at a
+ * time.
+ */
+class JitBatchShader : public Xbyak::CodeGenerator {
+public:
+    JitBatchShader();
+
+    /**
+     * Runs the shader on every lane of the batch unit.
+     * @returns false if the lanes diverged in a way the batch shader can't follow, the registers
+     *          of the batch unit are undefined then.
+     */
+    bool Run(const ShaderSetup& setup, BatchUnit& state) const {
+        return program(&setup.uniforms, &state);
+    }
+
+    /**
+     * Compiles the part of the shader program that is reachable from the entry point.
+     * @param shader Per-vertex shader of the same program, its log2 and exp2 subroutines are used
+     *               for every lane.
+     */
+    void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
+                 const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data, u32 entry_point,
+                 const JitShader& shader);
+
+    void Compile_ADD(Instruction instr);
+    void Compile_DP3(Instruction instr);
+    void Compile_DP4(Instruction instr);
+    void Compile_DPH(Instruction instr);
+    void Compile_EX2(Instruction instr);
+    void Compile_LG2(Instruction instr);
+    void Compile_MUL(Instruction instr);
+    void Compile_SGE(Instruction instr);
+    void Compile_SLT(Instruction instr);
+    void Compile_FLR(Instruction instr);
+    void Compile_MAX(Instruction instr);
+    void Compile_MIN(Instruction instr);
+    void Compile_RCP(Instruction instr);
+    void Compile_RSQ(Instruction instr);
+    void Compile_MOVA(Instruction instr);
+    void Compile_MOV(Instruction instr);
+    void Compile_NOP(Instruction instr);
+    void Compile_END(Instruction instr);
+    void Compile_BREAKC(Instruction instr);
+    void Compile_CALL(Instruction instr);
+    void Compile_CALLC(Instruction instr);
+    void Compile_CALLU(Instruction instr);
+    void Compile_IF(Instruction instr);
+    void Compile_LOOP(Instruction instr);
+    void Compile_JMP(Instruction instr);
+    void Compile_CMP(Instruction instr);
+    void Compile_MAD(Instruction instr);
+    void Compile_EMIT(Instruction instr);
+    void Compile_SETE(Instruction instr);
+
+private:
+    void Compile_Block(u32 end);
+    void Compile_NextInstr();
+
+    /// Loads one component of a swizzled source register of every lane into `dest`.
+    void Compile_SwizzleSrc(Instruction instr, u32 src_num, SourceRegister src_reg, u32 component,
+                            Xbyak::Xmm dest);
+
+    /// Gathers the float uniform read with relative addressing by every lane.
+    void Compile_RelativeUniform(SourceRegister src_reg, u32 address_register_index);
+
+    /// Stores the enabled components of the destination register from `src`, one register for
+    /// each component, in the active lanes.
+    void Compile_DestEnable(Instruction instr, const std::array<Xbyak::Xmm, 4>& src);
+
+    /// Copies `src` to `dest` in the active lanes. Clobbers `SCRATCH`.
+    void Compile_MaskedMove(Xbyak::Xmm dest, Xbyak::Xmm src);
+
+    /// Stores `src` to memory in the active lanes. Clobbers `SCRATCH` and `SCRATCH2`.
+    void Compile_MaskedStore(const Xbyak::Address& dest, Xbyak::Xmm src);
+
+    /// See JitShader::Compile_SanitizedMul.
+    void Compile_SanitizedMul(Xbyak::Xmm src1, Xbyak::Xmm src2, Xbyak::Xmm scratch);
+
+    /// Computes `component` of every lane with the log2 or exp2 subroutine.
+    void Compile_ScalarSubroutine(Instruction instr, const u8* subroutine);
+
+    /// Evaluates the condition of a flow control instruction into a lane mask in `SCRATCH`.
+    void Compile_EvaluateCondition(Instruction instr);
+    void Compile_UniformCondition(Instruction instr);
+
+    /// Jumps to `label` if no lane is active.
+    void Compile_SkipIfInactive(Xbyak::Label& label);
+
+    /// Restores the lane mask saved in a stack slot, keeping off the lanes that finished or left
+    /// the current loop since.
+    void Compile_RestoreActive(u32 slot);
+
+    void Compile_PushStack(u32 num_slots);
+    void Compile_PopStack(u32 num_slots);
+
+    /// Offset from the top of the stack to a slot of the innermost LOOP frame.
+    std::size_t LoopSlotOffset(u32 slot) const;
+
+    /// Returns the label of a jump to `target`, see Thunk.
+    Xbyak::Label& Compile_Thunk(u32 target, u32 return_offset);
+
+    /**
+     * Emits the code to conditionally return from a subroutine envoked by the `CALL` instruction.
+     */
+    void Compile_Return();
+
+    SwizzlePattern GetSwizzlePattern(Instruction instr) const;
+
+    /// Finds the range of instructions that is reachable from the entry point.
+    void FindProgramRange(u32 entry_point);
+
+    /// Analyzes the entire shader program for `CALL` instructions before emitting any code,
+    /// identifying the locations where a return needs to be inserted.
+    void FindReturnOffsets();
+
+    const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code = nullptr;
+    const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data = nullptr;
+
+    /// Mapping of Pica VS instructions to pointers in the emitted code
+    std::array<Xbyak::Label, MAX_PROGRAM_CODE_LENGTH> instruction_labels;
+
+    /**
+     * Flow control instructions other than IF and LOOP can only be followed by the lanes if their
+     * target is in the same masked block, since the lane masks are kept on a stack. Their jumps go
+     * through a thunk that is resolved once all regions are known.
+     */
+    struct Thunk {
+        Xbyak::Label label;
+        u32 target;
+        u32 return_offset; ///< Offset the subroutine returns at, or NoReturn for jumps
+        u16 region;        ///< Region of the jump
+    };
+    static constexpr u32 NoReturn = ~0U;
+    static constexpr u16 NotCompiled = 0xFFFF;
+    std::vector<Thunk> thunks;
+
+    /// Masked block of each instruction, 0 outside of any masked IF or LOOP
+    std::array<u16, MAX_PROGRAM_CODE_LENGTH> instruction_regions;
+    u16 current_region = 0;
+    u16 num_regions = 0;
+
+    /// Labels pointing to the end of each nested LOOP block. Used by the BREAKC instruction to
+    /// break out of a loop.
+    std::vector<Xbyak::Label> loop_break_labels;
+    /// Stack depth at each nested LOOP frame
+    std::vector<u32> loop_frames;
+
+    /// Offsets in code where a return needs to be inserted
+    std::vector<u32> return_offsets;
+
+    u32 program_counter = 0; ///< Offset of the next instruction to decode
+    u32 program_begin = 0;   ///< First reachable instruction
+    u32 program_end = 0;     ///< Offset after the last reachable instruction
+    u32 stack_depth = 0;     ///< Number of stack slots in use at the compiled instruction
+
+    /// Whether any instruction can leave some lanes inactive, otherwise writes skip the masking
+    bool masked_flow = false;
+    /// Whether the uniform read with relative addressing was gathered for this instruction
+    bool relative_uniform_loaded = false;
+
+    Xbyak::Label end_label;
+    Xbyak::Label abort_label;
+
+    using CompiledShader = bool(const void* setup, void* state);
+    CompiledShader* program = nullptr;
+
+    const u8* log2_subroutine = nullptr;
+    const u8* exp2_subroutine = nullptr;
+};
+
+} // namespace Pica::Shader
+
+#endif // CITRA_ARCH(x86_64)
@@ -45,6 +45,14 @@ public:
     void Compile(const std::array<u32, MAX_PROGRAM_CODE_LENGTH>* program_code,
                  const std::array<u32, MAX_SWIZZLE_DATA_LENGTH>* swizzle_data);
 
+    /// Subroutines computing log2 and exp2 of the first component of SRC1, see CompilePrelude.
+    const u8* GetLog2Subroutine() const {
+        return log2_subroutine.getAddress();
+    }
+    const u8* GetExp2Subroutine() const {
+        return exp2_subroutine.getAddress();
+    }
+
     void Compile_ADD(Instruction instr);
     void Compile_DP3(Instruction instr);
     void Compile_DP4(Instruction instr);
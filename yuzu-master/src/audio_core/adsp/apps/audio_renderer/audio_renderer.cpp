@@ -19,7 +19,11 @@ MICROPROFILE_DEFINE(Audio_Renderer, "Audio", "DSP_AudioRenderer", MP_RGB(60, 19,
 namespace AudioCore::ADSP::AudioRenderer {
 
 AudioRenderer::AudioRenderer(Core::System& system_, Sink::Sink& sink_)
-    : system{system_}, sink{sink_} {}
+    : system{system_}, sink{sink_} {
+    for (auto& command_list_processor : command_list_processors) {
+        command_list_processor.parallel_voices = true;
+    }
+}
 
 AudioRenderer::~AudioRenderer() {
     Stop();
@@ -1,18 +1,86 @@
 // SPDX-FileCopyrightText: Copyright 2023 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <array>
 #include <string>
 
 #include "audio_core/adsp/apps/audio_renderer/command_list_processor.h"
 #include "audio_core/renderer/command/command_list_header.h"
 #include "audio_core/renderer/command/commands.h"
 #include "common/settings.h"
+#include "common/task_scheduler.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/kernel/k_process.h"
 #include "core/memory.h"
 
 namespace AudioCore::ADSP::AudioRenderer {
+namespace {
+using Renderer::CommandId;
+using Renderer::ICommand;
+
+/// Minimum number of voice chains in a list for processing them in parallel to be worthwhile.
+constexpr size_t MinParallelVoiceChains = 8;
+/// Number of tasks queued per task scheduler worker, to balance uneven voices.
+constexpr u64 TasksPerWorker = 4;
+
+/**
+ * Get the mix buffer written by a voice command which may be processed ahead of the list.
+ * These commands only read and write their own voice state and the buffer they output to.
+ *
+ * @param command - The command to check.
+ * @return The written mix buffer index, or -1 if the command must be processed in list order.
+ */
+s32 GetVoiceOutputBuffer(const ICommand& command) {
+    switch (command.type) {
+    case CommandId::DataSourcePcmInt16Version1:
+        return static_cast<const Renderer::PcmInt16DataSourceVersion1Command&>(command)
+            .output_index;
+    case CommandId::DataSourcePcmInt16Version2:
+        return static_cast<const Renderer::PcmInt16DataSourceVersion2Command&>(command)
+            .output_index;
+    case CommandId::DataSourcePcmFloatVersion1:
+        return static_cast<const Renderer::PcmFloatDataSourceVersion1Command&>(command)
+            .output_index;
+    case CommandId::DataSourcePcmFloatVersion2:
+        return static_cast<const Renderer::PcmFloatDataSourceVersion2Command&>(command)
+            .output_index;
+    case CommandId::DataSourceAdpcmVersion1:
+        return static_cast<const Renderer::AdpcmDataSourceVersion1Command&>(command).output_index;
+    case CommandId::DataSourceAdpcmVersion2:
+        return static_cast<const Renderer::AdpcmDataSourceVersion2Command&>(command).output_index;
+    case CommandId::BiquadFilter: {
+        const auto& biquad{static_cast<const Renderer::BiquadFilterCommand&>(command)};
+        return biquad.input == biquad.output ? biquad.output : -1;
+    }
+    case CommandId::MultiTapBiquadFilter: {
+        const auto& biquad{static_cast<const Renderer::MultiTapBiquadFilterCommand&>(command)};
+        return biquad.input == biquad.output ? biquad.output : -1;
+    }
+    case CommandId::VolumeRamp: {
+        const auto& volume{static_cast<const Renderer::VolumeRampCommand&>(command)};
+        return volume.input_index == volume.output_index ? volume.output_index : -1;
+    }
+    default:
+        return -1;
+    }
+}
+
+bool IsDataSourceCommand(const ICommand& command) {
+    switch (command.type) {
+    case CommandId::DataSourcePcmInt16Version1:
+    case CommandId::DataSourcePcmInt16Version2:
+    case CommandId::DataSourcePcmFloatVersion1:
+    case CommandId::DataSourcePcmFloatVersion2:
+    case CommandId::DataSourceAdpcmVersion1:
+    case CommandId::DataSourceAdpcmVersion2:
+        return true;
+    default:
+        return false;
+    }
+}
+} // Anonymous namespace
 
 void CommandListProcessor::Initialize(Core::System& system_, Kernel::KProcess& process,
                                       CpuAddr buffer, u64 size, Sink::SinkStream* stream_) {
@@ -28,6 +96,8 @@ void CommandListProcessor::Initialize(Core::System& system_, Kernel::KProcess& p
     mix_buffers = header->samples_buffer;
     buffer_count = header->buffer_count;
     processed_command_count = 0;
+    precomputed_commands.clear();
+    next_precomputed_command = 0;
 }
 
 void CommandListProcessor::SetProcessTimeMax(const u64 time) {
@@ -55,6 +125,10 @@ u64 CommandListProcessor::Process(u32 session_id) {
 
     std::string dump{fmt::format("\nSession {}\n", session_id)};
 
+    if (processed_command_count == 0 && parallel_voices) {
+        ProcessVoiceChains();
+    }
+
     for (u32 index = 0; index < command_count; index++) {
         auto& command{*reinterpret_cast<Renderer::ICommand*>(commands)};
 
@@ -82,7 +156,17 @@ u64 CommandListProcessor::Process(u32 session_id) {
             break;
         }
 
-        if (command.enabled) {
+        if (next_precomputed_command < precomputed_commands.size() &&
+            precomputed_commands[next_precomputed_command].index == index) {
+            // Already processed by a voice task, publish its output buffer if this is the
+            // last command writing it before the voice mixes read it.
+            const auto& precomputed{precomputed_commands[next_precomputed_command++]};
+            if (precomputed.publish) {
+                std::ranges::copy(
+                    std::span(voice_staging).subspan(precomputed.staging_offset, sample_count),
+                    mix_buffers.subspan(precomputed.output * sample_count).begin());
+            }
+        } else if (command.enabled) {
             command.Process(*this);
         } else {
             dump += fmt::format("\tDisabled!\n");
@@ -101,4 +185,155 @@ u64 CommandListProcessor::Process(u32 session_id) {
     return end_time - start_time_;
 }
 
+void CommandListProcessor::ProcessVoiceChains() {
+    precomputed_commands.clear();
+    voice_chains.clear();
+
+    const u32 begin{std::min(header->voice_command_begin, command_count)};
+    const u32 end{std::min(header->voice_command_end, command_count)};
+    const auto command_base{CpuAddr(commands)};
+    u8* command_ptr{commands};
+
+    // Voices are split into chains at node boundaries, or when a data source starts over a
+    // buffer the chain already wrote. The generator emits the data source, filters and volume of
+    // a channel before its mixes, so each buffer is final at its last writer in the chain.
+    u32 chain_node_id{};
+    bool chain_valid{};
+    const auto close_chain{[&] {
+        auto& chain{voice_chains.back()};
+        chain.command_end = static_cast<u32>(precomputed_commands.size());
+        if (!chain_valid || chain.command_begin == chain.command_end) {
+            precomputed_commands.resize(chain.command_begin);
+            voice_chains.pop_back();
+        }
+    }};
+    const auto chain_writes{[&](s32 output) {
+        const auto chain_commands{
+            std::span(precomputed_commands).subspan(voice_chains.back().command_begin)};
+        return std::ranges::any_of(chain_commands, [output](const PrecomputedCommand& other) {
+            return other.output == output;
+        });
+    }};
+
+    // Walk the list up to the end of the voices, checking it the same way Process does.
+    for (u32 index = 0; index < end; index++) {
+        auto& command{*reinterpret_cast<ICommand*>(command_ptr)};
+        if (command.magic != Renderer::CommandMagic ||
+            CpuAddr(command_ptr) - command_base + command.size > commands_buffer_size ||
+            !command.Verify(*this)) {
+            break;
+        }
+        command_ptr += command.size;
+
+        const s32 output{index >= begin && command.enabled ? GetVoiceOutputBuffer(command) : -1};
+        if (output < 0) {
+            continue;
+        }
+        const bool data_source{IsDataSourceCommand(command)};
+        if (voice_chains.empty() || command.node_id != chain_node_id ||
+            (data_source && chain_writes(output))) {
+            if (!voice_chains.empty()) {
+                close_chain();
+            }
+            voice_chains.push_back({
+                .command_begin = static_cast<u32>(precomputed_commands.size()),
+                .command_end = 0,
+            });
+            chain_node_id = command.node_id;
+            chain_valid = true;
+        }
+        // Scratch buffers don't hold what the serial path would find in the mix buffers, so a
+        // buffer must be written by a data source, which always writes all of it, before
+        // anything else reads it.
+        if (static_cast<u32>(output) >= buffer_count || (!data_source && !chain_writes(output))) {
+            chain_valid = false;
+        }
+        precomputed_commands.push_back({
+            .command = &command,
+            .index = index,
+            .output = static_cast<s16>(output),
+            .publish = true,
+            .staging_offset = 0,
+        });
+    }
+    if (!voice_chains.empty()) {
+        close_chain();
+    }
+    if (voice_chains.size() < MinParallelVoiceChains) {
+        precomputed_commands.clear();
+        voice_chains.clear();
+        return;
+    }
+
+    u64 total_estimated_time{};
+    u32 staging_size{};
+    for (const auto& chain : voice_chains) {
+        const auto chain_begin{precomputed_commands.begin() + chain.command_begin};
+        const auto chain_end{precomputed_commands.begin() + chain.command_end};
+        for (auto it = chain_begin; it != chain_end; ++it) {
+            total_estimated_time += it->command->estimated_process_time;
+            it->publish = std::none_of(std::next(it), chain_end, [&it](const auto& next) {
+                return next.output == it->output;
+            });
+            if (it->publish) {
+                it->staging_offset = staging_size;
+                staging_size += sample_count;
+            }
+        }
+    }
+    voice_staging.resize(staging_size);
+
+    // Queue the chains in contiguous batches of similar estimated cost. The audio thread is
+    // blocked until they are done.
+    Common::TaskGroup voice_tasks{Common::TaskPriority::High};
+    const u64 num_tasks{
+        std::max<u64>(Common::GetTaskScheduler().NumWorkers() * TasksPerWorker, 1)};
+    const u64 task_time{std::max<u64>(total_estimated_time / num_tasks, 1)};
+    size_t chain_begin{};
+    u64 batch_time{};
+    for (size_t chain = 0; chain < voice_chains.size(); chain++) {
+        const auto& voice_chain{voice_chains[chain]};
+        for (u32 i = voice_chain.command_begin; i < voice_chain.command_end; i++) {
+            batch_time += precomputed_commands[i].command->estimated_process_time;
+        }
+        if (batch_time < task_time && chain + 1 < voice_chains.size()) {
+            continue;
+        }
+        voice_tasks.Run([this, chain_begin, chain_end = chain + 1] {
+            for (size_t i = chain_begin; i < chain_end; i++) {
+                ProcessVoiceChain(voice_chains[i]);
+            }
+        });
+        chain_begin = chain + 1;
+        batch_time = 0;
+    }
+    voice_tasks.Wait();
+}
+
+void CommandListProcessor::ProcessVoiceChain(const VoiceChain& chain) {
+    // Scratch mix buffers of the thread running the chain, scheduler workers are long lived
+    thread_local std::vector<s32> scratch;
+    scratch.resize(static_cast<size_t>(buffer_count) * sample_count);
+
+    CommandListProcessor processor;
+    processor.system = system;
+    processor.memory = memory;
+    processor.sample_count = sample_count;
+    processor.target_sample_rate = target_sample_rate;
+    processor.mix_buffers = scratch;
+    processor.buffer_count = buffer_count;
+
+    const auto chain_commands{std::span(precomputed_commands)
+                                  .subspan(chain.command_begin,
+                                           chain.command_end - chain.command_begin)};
+    for (const auto& precomputed : chain_commands) {
+        precomputed.command->Process(processor);
+        if (precomputed.publish) {
+            std::ranges::copy(
+                processor.mix_buffers.subspan(precomputed.output * sample_count, sample_count),
+                voice_staging.begin() + precomputed.staging_offset);
+        }
+    }
+}
+
 } // namespace AudioCore::ADSP::AudioRenderer
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <span>
+#include <vector>
 
 #include "audio_core/common/common.h"
 #include "audio_core/renderer/command/command_list_header.h"
@@ -27,7 +28,8 @@ class SinkStream;
 
 namespace Renderer {
 struct CommandListHeader;
-}
+struct ICommand;
+} // namespace Renderer
 
 namespace ADSP::AudioRenderer {
 
@@ -111,6 +113,53 @@ public:
     u64 end_time{};
     /// Last command list string generated, used for dumping audio commands to console
     std::string last_dump{};
+    /// If the voices may be processed in parallel on the task scheduler
+    bool parallel_voices{};
+
+private:
+    /// A voice command processed ahead of the list by a worker.
+    struct PrecomputedCommand {
+        /// The command
+        Renderer::ICommand* command;
+        /// Index of the command in the list
+        u32 index;
+        /// Mix buffer written by the command
+        s16 output;
+        /// If this is the last command of its chain writing the output buffer
+        bool publish;
+        /// Offset of the staged output samples in voice_staging
+        u32 staging_offset;
+    };
+
+    /// A chain of voice commands which only depends on its own voice state.
+    struct VoiceChain {
+        /// Range of the chain commands in precomputed_commands
+        u32 command_begin;
+        u32 command_end;
+    };
+
+    /**
+     * Split the voice commands of the list into chains, and process the decoding, filtering and
+     * volume commands of each chain on the task scheduler. The results are staged, and copied
+     * into the mix buffers by Process when it reaches the commands, in list order.
+     */
+    void ProcessVoiceChains();
+
+    /**
+     * Process the commands of a voice chain into scratch mix buffers and stage the results.
+     *
+     * @param chain - The chain to process.
+     */
+    void ProcessVoiceChain(const VoiceChain& chain);
+
+    /// Voice commands processed ahead of the list, sorted by index
+    std::vector<PrecomputedCommand> precomputed_commands{};
+    /// Position of the next precomputed command to be reached by Process
+    size_t next_precomputed_command{};
+    /// Voice chains of the list
+    std::vector<VoiceChain> voice_chains{};
+    /// Staged output samples of the voice chains
+    std::vector<s32> voice_staging{};
 };
 
 } // namespace ADSP::AudioRenderer
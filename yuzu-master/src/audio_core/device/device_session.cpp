@@ -106,10 +106,12 @@ void DeviceSession::AppendBuffers(std::span<const AudioBuffer> buffers) {
     }
 }
 
-void DeviceSession::ReleaseBuffer(const AudioBuffer& buffer) const {
+void DeviceSession::ReleaseBuffer(const AudioBuffer& buffer) {
     if (type == Sink::StreamType::In) {
-        auto samples{stream->ReleaseBuffer(buffer.size / sizeof(s16))};
-        handle->GetMemory().WriteBlockUnsafe(buffer.samples, samples.data(), buffer.size);
+        tmp_samples.resize_destructive(buffer.size / sizeof(s16));
+        Core::Memory::CpuGuestMemoryScoped<s16, Core::Memory::GuestMemoryFlags::UnsafeWrite>
+            samples(handle->GetMemory(), buffer.samples, buffer.size / sizeof(s16), &tmp_samples);
+        stream->ReleaseBuffer(samples);
     }
 }
 
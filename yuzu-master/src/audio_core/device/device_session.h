@@ -74,7 +74,7 @@ public:
      *
      * @param buffer - The buffer to write to.
      */
-    void ReleaseBuffer(const AudioBuffer& buffer) const;
+    void ReleaseBuffer(const AudioBuffer& buffer);
 
     /**
      * Check if the buffer for the given tag has been consumed by the backend.
@@ -17,6 +17,10 @@ struct CommandListHeader {
     s16 buffer_count;
     u32 sample_count;
     u32 sample_rate;
+    /// Index of the first command generated for a voice
+    u32 voice_command_begin;
+    /// Index one past the last command generated for a voice
+    u32 voice_command_end;
 };
 
 } // namespace AudioCore::Renderer
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2022 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <array>
 #include <vector>
 
@@ -240,6 +241,10 @@ void DecodeFromWaveBuffers(Core::Memory::Memory& memory, const DecodeFromWaveBuf
         index = (index + 1) % MaxWaveBuffers;
         consumed++;
     };
+    // Samples which aren't decoded, when the voice is starved or can't be resampled, are silent
+    // rather than whatever the output buffer held before, usually the output of another voice.
+    std::ranges::fill(args.output, 0);
+
     auto& voice_state{*args.voice_state};
     auto remaining_sample_count{args.sample_count};
     auto fraction{voice_state.fraction};
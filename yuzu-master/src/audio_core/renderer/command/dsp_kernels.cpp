@@ -0,0 +1,472 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <limits>
+
+#ifdef ARCHITECTURE_x86_64
+#include <immintrin.h>
+#elif defined(ARCHITECTURE_arm64)
+#include <arm_neon.h>
+#endif
+
+#include "audio_core/renderer/command/dsp_kernels.h"
+#include "common/assert.h"
+#include "common/common_funcs.h"
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace AudioCore::Renderer::DspKernels {
+namespace {
+using ResampleFixed = Common::FixedPoint<56, 8>;
+
+template <size_t Q>
+s32 MixScalar(std::span<s32> output, std::span<const s32> input, s64 volume_, s64 ramp_) {
+    using Fixed = Common::FixedPoint<64 - Q, Q>;
+    Fixed volume{Fixed::from_base(volume_)};
+    const Fixed ramp{Fixed::from_base(ramp_)};
+    Fixed sample{0};
+    for (size_t i = 0; i < output.size(); i++) {
+        sample = input[i] * volume;
+        output[i] = (output[i] + sample).to_int();
+        volume += ramp;
+    }
+    return sample.to_int();
+}
+
+template <size_t Q>
+void GainScalar(std::span<s32> output, std::span<const s32> input, s64 volume_, s64 ramp_) {
+    using Fixed = Common::FixedPoint<64 - Q, Q>;
+    Fixed volume{Fixed::from_base(volume_)};
+    const Fixed ramp{Fixed::from_base(ramp_)};
+    for (size_t i = 0; i < output.size(); i++) {
+        output[i] = (input[i] * volume).to_int();
+        volume += ramp;
+    }
+}
+
+s32 MixScalar(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp,
+              u32 precision) {
+    switch (precision) {
+    case 15:
+        return MixScalar<15>(output, input, volume, ramp);
+    case 23:
+        return MixScalar<23>(output, input, volume, ramp);
+    default:
+        UNREACHABLE_MSG("Invalid precision {}", precision);
+    }
+}
+
+void GainScalar(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp,
+                u32 precision) {
+    switch (precision) {
+    case 15:
+        return GainScalar<15>(output, input, volume, ramp);
+    case 23:
+        return GainScalar<23>(output, input, volume, ramp);
+    default:
+        UNREACHABLE_MSG("Invalid precision {}", precision);
+    }
+}
+
+template <size_t Taps>
+void ResampleScalar(std::span<s32> output, std::span<const s16> input, std::span<const f32> lut,
+                    const Fraction& sample_rate_ratio, Fraction& fraction) {
+    u32 read_index{0};
+    for (size_t i = 0; i < output.size(); i++) {
+        const auto lut_index{(fraction.get_frac() >> 8) * Taps};
+        ResampleFixed sum{0};
+        for (size_t tap = 0; tap < Taps; tap++) {
+            sum += ResampleFixed{input[read_index + tap] * lut[lut_index + tap]};
+        }
+        output[i] = sum.to_int_floor();
+        fraction += sample_rate_ratio;
+        read_index += static_cast<u32>(fraction.to_int_floor());
+        fraction.clear_int();
+    }
+}
+
+/// Scalar fallback of the vectorized kernels, for volumes too large for 32-bit lanes.
+template <bool Accumulate>
+s32 ApplyScalar(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp,
+                u32 precision) {
+    if constexpr (Accumulate) {
+        return MixScalar(output, input, volume, ramp, precision);
+    } else {
+        GainScalar(output, input, volume, ramp, precision);
+        return 0;
+    }
+}
+
+/**
+ * Scale a sample by a fixed point volume and round it like Common::FixedPoint::to_int.
+ * Only valid for volumes fitting in 32 bits, the product can't overflow then.
+ */
+s32 ScaleSample(s32 sample, s64 volume, u32 precision) {
+    const s64 product{sample * volume};
+    const s64 mask{(s64{1} << precision) - 1};
+    return static_cast<s32>((product + ((product & mask) >> 1)) >> precision);
+}
+
+/// Returns true when every volume of a ramp over count samples fits in 32 bits.
+bool FitsInt32(s64 volume, s64 ramp, size_t count) {
+    static constexpr s64 min{std::numeric_limits<s32>::min()};
+    static constexpr s64 max{std::numeric_limits<s32>::max()};
+    if (volume < min || volume > max || ramp < min || ramp > max) {
+        return false;
+    }
+    const s64 last{volume + ramp * static_cast<s64>(count == 0 ? 0 : count - 1)};
+    return last >= min && last <= max;
+}
+
+/// Read the lut offset of the next output sample and advance the fraction past it.
+template <size_t Taps>
+u32 StepFraction(const Fraction& sample_rate_ratio, Fraction& fraction, u32& read_index) {
+    const auto lut_index{static_cast<u32>((fraction.get_frac() >> 8) * Taps)};
+    fraction += sample_rate_ratio;
+    read_index += static_cast<u32>(fraction.to_int_floor());
+    fraction.clear_int();
+    return lut_index;
+}
+
+#ifdef ARCHITECTURE_x86_64
+TARGET_ISA("sse4.1")
+__m128i RoundShiftSse41(__m128i product, __m128i mask, __m128i shift) {
+    const __m128i round{_mm_srli_epi64(_mm_and_si128(product, mask), 1)};
+    return _mm_srl_epi64(_mm_add_epi64(product, round), shift);
+}
+
+/// Vector version of ScaleSample for 4 samples.
+TARGET_ISA("sse4.1")
+__m128i ScaleSse41(__m128i samples, __m128i volumes, __m128i mask, __m128i shift) {
+    const __m128i even{_mm_mul_epi32(samples, volumes)};
+    const __m128i odd{_mm_mul_epi32(_mm_srli_epi64(samples, 32), _mm_srli_epi64(volumes, 32))};
+    // The low 32 bits of each shifted product hold the result, as in the scalar truncation
+    return _mm_blend_epi16(RoundShiftSse41(even, mask, shift),
+                           _mm_slli_epi64(RoundShiftSse41(odd, mask, shift), 32), 0xCC);
+}
+
+template <bool Accumulate>
+TARGET_ISA("sse4.1")
+s32 ApplySse41(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp,
+               u32 precision) {
+    const size_t count{output.size()};
+    if (!FitsInt32(volume, ramp, count)) {
+        return ApplyScalar<Accumulate>(output, input, volume, ramp, precision);
+    }
+    const __m128i mask{_mm_set1_epi64x((s64{1} << precision) - 1)};
+    const __m128i shift{_mm_cvtsi32_si128(static_cast<int>(precision))};
+    __m128i volumes{_mm_setr_epi32(static_cast<s32>(volume), static_cast<s32>(volume + ramp),
+                                   static_cast<s32>(volume + ramp * 2),
+                                   static_cast<s32>(volume + ramp * 3))};
+    const __m128i step{_mm_set1_epi32(static_cast<s32>(ramp * 4))};
+
+    size_t i{0};
+    for (; i + 4 <= count; i += 4) {
+        const __m128i samples{_mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[i]))};
+        __m128i result{ScaleSse41(samples, volumes, mask, shift)};
+        if constexpr (Accumulate) {
+            result = _mm_add_epi32(
+                result, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&output[i])));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&output[i]), result);
+        volumes = _mm_add_epi32(volumes, step);
+    }
+    for (; i < count; i++) {
+        const s32 sample{ScaleSample(input[i], volume + ramp * static_cast<s64>(i), precision)};
+        output[i] = Accumulate ? static_cast<s32>(static_cast<u32>(output[i]) + sample) : sample;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    return ScaleSample(input[count - 1], volume + ramp * static_cast<s64>(count - 1), precision);
+}
+
+s32 MixSse41(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp,
+             u32 precision) {
+    return ApplySse41<true>(output, input, volume, ramp, precision);
+}
+
+void GainSse41(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp,
+               u32 precision) {
+    ApplySse41<false>(output, input, volume, ramp, precision);
+}
+
+/// Multiply 4 input samples by 4 coefficients, truncating the products to 24.8 fixed point.
+TARGET_ISA("sse4.1")
+__m128i ResampleTapsSse41(const s16* input, const f32* lut) {
+    const __m128i samples{
+        _mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(input)))};
+    const __m128 products{_mm_mul_ps(_mm_cvtepi32_ps(samples), _mm_loadu_ps(lut))};
+    return _mm_cvttps_epi32(_mm_mul_ps(products, _mm_set1_ps(256.0f)));
+}
+
+template <size_t Taps>
+TARGET_ISA("sse4.1")
+void ResampleSse41(std::span<s32> output, std::span<const s16> input, std::span<const f32> lut,
+                   const Fraction& sample_rate_ratio, Fraction& fraction) {
+    const size_t count{output.size()};
+    u32 read_index{0};
+    size_t i{0};
+    for (; i + 4 <= count; i += 4) {
+        __m128i taps[4];
+        for (size_t j = 0; j < 4; j++) {
+            const s16* const samples{&input[read_index]};
+            const f32* const coefficients{&lut[StepFraction<Taps>(sample_rate_ratio, fraction,
+                                                                  read_index)]};
+            taps[j] = ResampleTapsSse41(samples, coefficients);
+            if constexpr (Taps == 8) {
+                taps[j] = _mm_add_epi32(taps[j],
+                                        ResampleTapsSse41(samples + 4, coefficients + 4));
+            }
+        }
+        // Integer sums are exact, so the order of the horizontal adds doesn't matter
+        const __m128i sums{_mm_hadd_epi32(_mm_hadd_epi32(taps[0], taps[1]),
+                                          _mm_hadd_epi32(taps[2], taps[3]))};
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&output[i]), _mm_srai_epi32(sums, 8));
+    }
+    ResampleScalar<Taps>(output.subspan(i), input.subspan(read_index), lut, sample_rate_ratio,
+                         fraction);
+}
+
+TARGET_ISA("avx2")
+__m256i RoundShiftAvx2(__m256i product, __m256i mask, __m128i shift) {
+    const __m256i round{_mm256_srli_epi64(_mm256_and_si256(product, mask), 1)};
+    return _mm256_srl_epi64(_mm256_add_epi64(product, round), shift);
+}
+
+/// Vector version of ScaleSample for 8 samples.
+TARGET_ISA("avx2")
+__m256i ScaleAvx2(__m256i samples, __m256i volumes, __m256i mask, __m128i shift) {
+    const __m256i even{_mm256_mul_epi32(samples, volumes)};
+    const __m256i odd{
+        _mm256_mul_epi32(_mm256_srli_epi64(samples, 32), _mm256_srli_epi64(volumes, 32))};
+    return _mm256_blend_epi32(RoundShiftAvx2(even, mask, shift),
+                              _mm256_slli_epi64(RoundShiftAvx2(odd, mask, shift), 32), 0xAA);
+}
+
+template <bool Accumulate>
+TARGET_ISA("avx2")
+s32 ApplyAvx2(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp,
+              u32 precision) {
+    const size_t count{output.size()};
+    if (!FitsInt32(volume, ramp, count)) {
+        return ApplyScalar<Accumulate>(output, input, volume, ramp, precision);
+    }
+    const __m256i mask{_mm256_set1_epi64x((s64{1} << precision) - 1)};
+    const __m128i shift{_mm_cvtsi32_si128(static_cast<int>(precision))};
+    __m256i volumes{_mm256_setr_epi32(
+        static_cast<s32>(volume), static_cast<s32>(volume + ramp),
+        static_cast<s32>(volume + ramp * 2), static_cast<s32>(volume + ramp * 3),
+        static_cast<s32>(volume + ramp * 4), static_cast<s32>(volume + ramp * 5),
+        static_cast<s32>(volume + ramp * 6), static_cast<s32>(volume + ramp * 7))};
+    const __m256i step{_mm256_set1_epi32(static_cast<s32>(ramp * 8))};
+
+    size_t i{0};
+    for (; i + 8 <= count; i += 8) {
+        const __m256i samples{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input[i]))};
+        __m256i result{ScaleAvx2(samples, volumes, mask, shift)};
+        if constexpr (Accumulate) {
+            result = _mm256_add_epi32(
+                result, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&output[i])));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&output[i]), result);
+        volumes = _mm256_add_epi32(volumes, step);
+    }
+    for (; i < count; i++) {
+        const s32 sample{ScaleSample(input[i], volume + ramp * static_cast<s64>(i), precision)};
+        output[i] = Accumulate ? static_cast<s32>(static_cast<u32>(output[i]) + sample) : sample;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    return ScaleSample(input[count - 1], volume + ramp * static_cast<s64>(count - 1), precision);
+}
+
+s32 MixAvx2(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp,
+            u32 precision) {
+    return ApplyAvx2<true>(output, input, volume, ramp, precision);
+}
+
+void GainAvx2(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp,
+              u32 precision) {
+    ApplyAvx2<false>(output, input, volume, ramp, precision);
+}
+
+TARGET_ISA("avx2")
+void Resample8Avx2(std::span<s32> output, std::span<const s16> input, std::span<const f32> lut,
+                   const Fraction& sample_rate_ratio, Fraction& fraction) {
+    const size_t count{output.size()};
+    const __m256 scale{_mm256_set1_ps(256.0f)};
+    u32 read_index{0};
+    size_t i{0};
+    for (; i + 8 <= count; i += 8) {
+        __m256i taps[8];
+        for (size_t j = 0; j < 8; j++) {
+            const __m256i samples{_mm256_cvtepi16_epi32(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input[read_index])))};
+            const f32* const coefficients{
+                &lut[StepFraction<8>(sample_rate_ratio, fraction, read_index)]};
+            const __m256 products{
+                _mm256_mul_ps(_mm256_cvtepi32_ps(samples), _mm256_loadu_ps(coefficients))};
+            taps[j] = _mm256_cvttps_epi32(_mm256_mul_ps(products, scale));
+        }
+        // Each 128-bit half of the tree holds the partial sums of 4 taps of every output
+        const __m256i sums_0123{_mm256_hadd_epi32(_mm256_hadd_epi32(taps[0], taps[1]),
+                                                  _mm256_hadd_epi32(taps[2], taps[3]))};
+        const __m256i sums_4567{_mm256_hadd_epi32(_mm256_hadd_epi32(taps[4], taps[5]),
+                                                  _mm256_hadd_epi32(taps[6], taps[7]))};
+        const __m256i sums{_mm256_add_epi32(_mm256_permute2x128_si256(sums_0123, sums_4567, 0x20),
+                                            _mm256_permute2x128_si256(sums_0123, sums_4567, 0x31))};
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&output[i]), _mm256_srai_epi32(sums, 8));
+    }
+    ResampleScalar<8>(output.subspan(i), input.subspan(read_index), lut, sample_rate_ratio,
+                      fraction);
+}
+#endif
+
+#ifdef ARCHITECTURE_arm64
+/// Vector version of ScaleSample for 4 samples.
+int32x4_t ScaleNeon(int32x4_t samples, int32x4_t volumes, int64x2_t mask, int64x2_t shift) {
+    const auto round_shift{[mask, shift](int64x2_t product) {
+        const int64x2_t round{vshrq_n_s64(vandq_s64(product, mask), 1)};
+        return vmovn_s64(vshlq_s64(vaddq_s64(product, round), shift));
+    }};
+    const int64x2_t low{vmull_s32(vget_low_s32(samples), vget_low_s32(volumes))};
+    const int64x2_t high{vmull_s32(vget_high_s32(samples), vget_high_s32(volumes))};
+    return vcombine_s32(round_shift(low), round_shift(high));
+}
+
+template <bool Accumulate>
+s32 ApplyNeon(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp,
+              u32 precision) {
+    const size_t count{output.size()};
+    if (!FitsInt32(volume, ramp, count)) {
+        return ApplyScalar<Accumulate>(output, input, volume, ramp, precision);
+    }
+    const int64x2_t mask{vdupq_n_s64((s64{1} << precision) - 1)};
+    const int64x2_t shift{vdupq_n_s64(-static_cast<s64>(precision))};
+    const std::array<s32, 4> initial_volumes{
+        static_cast<s32>(volume), static_cast<s32>(volume + ramp),
+        static_cast<s32>(volume + ramp * 2), static_cast<s32>(volume + ramp * 3)};
+    int32x4_t volumes{vld1q_s32(initial_volumes.data())};
+    const int32x4_t step{vdupq_n_s32(static_cast<s32>(ramp * 4))};
+
+    size_t i{0};
+    for (; i + 4 <= count; i += 4) {
+        int32x4_t result{ScaleNeon(vld1q_s32(&input[i]), volumes, mask, shift)};
+        if constexpr (Accumulate) {
+            result = vaddq_s32(result, vld1q_s32(&output[i]));
+        }
+        vst1q_s32(&output[i], result);
+        volumes = vaddq_s32(volumes, step);
+    }
+    for (; i < count; i++) {
+        const s32 sample{ScaleSample(input[i], volume + ramp * static_cast<s64>(i), precision)};
+        output[i] = Accumulate ? static_cast<s32>(static_cast<u32>(output[i]) + sample) : sample;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    return ScaleSample(input[count - 1], volume + ramp * static_cast<s64>(count - 1), precision);
+}
+
+s32 MixNeon(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp,
+            u32 precision) {
+    return ApplyNeon<true>(output, input, volume, ramp, precision);
+}
+
+void GainNeon(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp,
+              u32 precision) {
+    ApplyNeon<false>(output, input, volume, ramp, precision);
+}
+
+/// Multiply 4 input samples by 4 coefficients, truncating the products to 24.8 fixed point.
+int32x4_t ResampleTapsNeon(const s16* input, const f32* lut) {
+    const float32x4_t samples{vcvtq_f32_s32(vmovl_s16(vld1_s16(input)))};
+    return vcvtq_s32_f32(vmulq_n_f32(vmulq_f32(samples, vld1q_f32(lut)), 256.0f));
+}
+
+template <size_t Taps>
+void ResampleNeon(std::span<s32> output, std::span<const s16> input, std::span<const f32> lut,
+                  const Fraction& sample_rate_ratio, Fraction& fraction) {
+    u32 read_index{0};
+    for (size_t i = 0; i < output.size(); i++) {
+        const s16* const samples{&input[read_index]};
+        const f32* const coefficients{
+            &lut[StepFraction<Taps>(sample_rate_ratio, fraction, read_index)]};
+        int32x4_t taps{ResampleTapsNeon(samples, coefficients)};
+        if constexpr (Taps == 8) {
+            taps = vaddq_s32(taps, ResampleTapsNeon(samples + 4, coefficients + 4));
+        }
+        output[i] = vaddvq_s32(taps) >> 8;
+    }
+}
+#endif
+
+constexpr Table ScalarTable{
+    .mix = MixScalar,
+    .gain = GainScalar,
+    .resample4 = ResampleScalar<4>,
+    .resample8 = ResampleScalar<8>,
+};
+
+#ifdef ARCHITECTURE_x86_64
+constexpr Table Sse41Table{
+    .mix = MixSse41,
+    .gain = GainSse41,
+    .resample4 = ResampleSse41<4>,
+    .resample8 = ResampleSse41<8>,
+};
+
+constexpr Table Avx2Table{
+    .mix = MixAvx2,
+    .gain = GainAvx2,
+    .resample4 = ResampleSse41<4>,
+    .resample8 = Resample8Avx2,
+};
+#endif
+
+#ifdef ARCHITECTURE_arm64
+constexpr Table NeonTable{
+    .mix = MixNeon,
+    .gain = GainNeon,
+    .resample4 = ResampleNeon<4>,
+    .resample8 = ResampleNeon<8>,
+};
+#endif
+} // Anonymous namespace
+
+const Table* GetTable(Isa isa) {
+    switch (isa) {
+    case Isa::Scalar:
+        return &ScalarTable;
+#ifdef ARCHITECTURE_x86_64
+    case Isa::Sse41:
+        return Common::GetCPUCaps().sse4_1 ? &Sse41Table : nullptr;
+    case Isa::Avx2:
+        return Common::GetCPUCaps().avx2 ? &Avx2Table : nullptr;
+#endif
+#ifdef ARCHITECTURE_arm64
+    case Isa::Neon:
+        return &NeonTable;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+const Table& GetTable() {
+    static const Table& table{[]() -> const Table& {
+        for (const Isa isa : {Isa::Avx2, Isa::Sse41, Isa::Neon}) {
+            if (const Table* const candidate = GetTable(isa)) {
+                return *candidate;
+            }
+        }
+        return ScalarTable;
+    }()};
+    return table;
+}
+
+} // namespace AudioCore::Renderer::DspKernels
@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <span>
+
+#include "common/common_types.h"
+#include "common/fixed_point.h"
+
+// Per-sample kernels of the mix, volume and resample commands. Every implementation produces the
+// same samples as the scalar Common::FixedPoint arithmetic of the commands, bit for bit, the
+// vectorized ones only differ in how many samples are processed at once.
+namespace AudioCore::Renderer::DspKernels {
+
+/// Instruction sets the kernels are implemented with.
+enum class Isa {
+    Scalar,
+    Sse41,
+    Avx2,
+    Neon,
+};
+
+/// Fixed point fraction used by the resampler.
+using Fraction = Common::FixedPoint<49, 15>;
+
+struct Table {
+    /**
+     * Add the input, scaled by a volume ramping linearly every sample, to the output.
+     * Volume and ramp are the raw values of Common::FixedPoint<64 - precision, precision>.
+     *
+     * @return The final scaled input sample, used for depopping.
+     */
+    s32 (*mix)(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp,
+               u32 precision);
+
+    /**
+     * Write the input, scaled by a volume ramping linearly every sample, to the output.
+     * Volume and ramp are the raw values of Common::FixedPoint<64 - precision, precision>.
+     */
+    void (*gain)(std::span<s32> output, std::span<const s32> input, s64 volume, s64 ramp,
+                 u32 precision);
+
+    /**
+     * Resample the input into the output with a 4 tap filter, advancing the fraction.
+     * The lut holds 4 coefficients for each of the 128 fraction steps.
+     */
+    void (*resample4)(std::span<s32> output, std::span<const s16> input,
+                      std::span<const f32> lut, const Fraction& sample_rate_ratio,
+                      Fraction& fraction);
+
+    /**
+     * Resample the input into the output with an 8 tap filter, advancing the fraction.
+     * The lut holds 8 coefficients for each of the 128 fraction steps.
+     */
+    void (*resample8)(std::span<s32> output, std::span<const s16> input,
+                      std::span<const f32> lut, const Fraction& sample_rate_ratio,
+                      Fraction& fraction);
+};
+
+/// Returns the kernels of an instruction set, or nullptr when the host doesn't support it.
+[[nodiscard]] const Table* GetTable(Isa isa);
+
+/// Returns the fastest kernels supported by the host.
+[[nodiscard]] const Table& GetTable();
+
+} // namespace AudioCore::Renderer::DspKernels
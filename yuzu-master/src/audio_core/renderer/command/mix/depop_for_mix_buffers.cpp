@@ -21,14 +21,15 @@ static s32 ApplyDepopMix(std::span<s32> output, const s32 depop_sample,
     auto sample{std::abs(depop_sample)};
     auto decay{decay_.to_raw()};
 
+    // Once the sample decays to 0 it stays there and adds nothing more, so stop early.
     if (depop_sample <= 0) {
-        for (u32 i = 0; i < sample_count; i++) {
+        for (u32 i = 0; i < sample_count && sample != 0; i++) {
             sample = static_cast<s32>((static_cast<s64>(sample) * decay) >> 15);
             output[i] -= sample;
         }
         return -sample;
     } else {
-        for (u32 i = 0; i < sample_count; i++) {
+        for (u32 i = 0; i < sample_count && sample != 0; i++) {
             sample = static_cast<s32>((static_cast<s64>(sample) * decay) >> 15);
             output[i] += sample;
         }
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2022 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "audio_core/renderer/command/dsp_kernels.h"
 #include "audio_core/renderer/command/resample/resample.h"
 
 namespace AudioCore::Renderer {
@@ -292,19 +293,8 @@ static void ResampleNormalQuality(std::span<s32> output, std::span<const s16> in
         }
     };
 
-    auto lut{get_lut()};
-    u32 read_index{0};
-    for (u32 i = 0; i < samples_to_write; i++) {
-        const auto lut_index{(fraction.get_frac() >> 8) * 4};
-        const Common::FixedPoint<56, 8> sample0{input[read_index + 0] * lut[lut_index + 0]};
-        const Common::FixedPoint<56, 8> sample1{input[read_index + 1] * lut[lut_index + 1]};
-        const Common::FixedPoint<56, 8> sample2{input[read_index + 2] * lut[lut_index + 2]};
-        const Common::FixedPoint<56, 8> sample3{input[read_index + 3] * lut[lut_index + 3]};
-        output[i] = (sample0 + sample1 + sample2 + sample3).to_int_floor();
-        fraction += sample_rate_ratio;
-        read_index += static_cast<u32>(fraction.to_int_floor());
-        fraction.clear_int();
-    }
+    DspKernels::GetTable().resample4(output.first(samples_to_write), input, get_lut(),
+                                     sample_rate_ratio, fraction);
 }
 
 static void ResampleHighQuality(std::span<s32> output, std::span<const s16> input,
@@ -842,24 +832,8 @@ static void ResampleHighQuality(std::span<s32> output, std::span<const s16> inpu
         }
     };
 
-    auto lut{get_lut()};
-    u32 read_index{0};
-    for (u32 i = 0; i < samples_to_write; i++) {
-        const auto lut_index{(fraction.get_frac() >> 8) * 8};
-        const Common::FixedPoint<56, 8> sample0{input[read_index + 0] * lut[lut_index + 0]};
-        const Common::FixedPoint<56, 8> sample1{input[read_index + 1] * lut[lut_index + 1]};
-        const Common::FixedPoint<56, 8> sample2{input[read_index + 2] * lut[lut_index + 2]};
-        const Common::FixedPoint<56, 8> sample3{input[read_index + 3] * lut[lut_index + 3]};
-        const Common::FixedPoint<56, 8> sample4{input[read_index + 4] * lut[lut_index + 4]};
-        const Common::FixedPoint<56, 8> sample5{input[read_index + 5] * lut[lut_index + 5]};
-        const Common::FixedPoint<56, 8> sample6{input[read_index + 6] * lut[lut_index + 6]};
-        const Common::FixedPoint<56, 8> sample7{input[read_index + 7] * lut[lut_index + 7]};
-        output[i] = (sample0 + sample1 + sample2 + sample3 + sample4 + sample5 + sample6 + sample7)
-                        .to_int_floor();
-        fraction += sample_rate_ratio;
-        read_index += static_cast<u32>(fraction.to_int_floor());
-        fraction.clear_int();
-    }
+    DspKernels::GetTable().resample8(output.first(samples_to_write), input, get_lut(),
+                                     sample_rate_ratio, fraction);
 }
 
 void Resample(std::span<s32> output, std::span<const s16> input,
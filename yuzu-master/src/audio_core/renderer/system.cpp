@@ -688,7 +688,11 @@ u64 System::GenerateCommand(std::span<u8> in_command_buffer,
                                        sink_context,   splitter_context,     perf_manager};
 
     voice_context.SortInfo();
+    // Voices only write to mix buffers, they have no incoming edges in the mix graph, so the
+    // commands of each voice are independent of every other voice until the mix stage.
+    command_list_header->voice_command_begin = command_buffer.count;
     command_generator.GenerateVoiceCommands();
+    command_list_header->voice_command_end = command_buffer.count;
 
     const auto start_estimated_time{drop_voice_param *
                                     static_cast<f32>(command_buffer.estimated_process_time)};
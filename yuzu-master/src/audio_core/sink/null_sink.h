@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -21,8 +22,8 @@ public:
         : SinkStream{system_, type_} {}
     ~NullSinkStreamImpl() override {}
     void AppendBuffer(SinkBuffer&, std::span<s16>) override {}
-    std::vector<s16> ReleaseBuffer(u64) override {
-        return {};
+    void ReleaseBuffer(std::span<s16> samples) override {
+        std::ranges::fill(samples, s16{0});
     }
 };
 
@@ -0,0 +1,138 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#elif defined(ARCHITECTURE_arm64)
+#include <arm_neon.h>
+#endif
+
+#include "audio_core/common/common.h"
+#include "audio_core/sink/sample_conversion.h"
+
+namespace AudioCore::Sink {
+namespace {
+constexpr s32 SampleMin{std::numeric_limits<s16>::min()};
+constexpr s32 SampleMax{std::numeric_limits<s16>::max()};
+
+s16 ScaleSample(s16 sample, f32 volume) {
+    return static_cast<s16>(
+        std::clamp(static_cast<s32>(static_cast<f32>(sample) * volume), SampleMin, SampleMax));
+}
+} // Anonymous namespace
+
+void ScaleSamples(std::span<s16> samples, f32 volume) {
+    size_t i{0};
+#ifdef ARCHITECTURE_x86_64
+    const __m128 volumes{_mm_set1_ps(volume)};
+    for (; i + 8 <= samples.size(); i += 8) {
+        const __m128i in{_mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[i]))};
+        const __m128i low{_mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16)};
+        const __m128i high{_mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16)};
+        const __m128i low_scaled{_mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(low), volumes))};
+        const __m128i high_scaled{_mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(high), volumes))};
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&samples[i]),
+                         _mm_packs_epi32(low_scaled, high_scaled));
+    }
+#elif defined(ARCHITECTURE_arm64)
+    for (; i + 8 <= samples.size(); i += 8) {
+        const int16x8_t in{vld1q_s16(&samples[i])};
+        const float32x4_t low{vcvtq_f32_s32(vmovl_s16(vget_low_s16(in)))};
+        const float32x4_t high{vcvtq_f32_s32(vmovl_s16(vget_high_s16(in)))};
+        const int32x4_t low_scaled{vcvtq_s32_f32(vmulq_n_f32(low, volume))};
+        const int32x4_t high_scaled{vcvtq_s32_f32(vmulq_n_f32(high, volume))};
+        vst1q_s16(&samples[i], vcombine_s16(vqmovn_s32(low_scaled), vqmovn_s32(high_scaled)));
+    }
+#endif
+    for (; i < samples.size(); i++) {
+        samples[i] = ScaleSample(samples[i], volume);
+    }
+}
+
+size_t DownmixToStereo(std::span<s16> samples, f32 volume) {
+    // Front = 1.0
+    // Center = 0.596
+    // LFE = 0.354
+    // Back = 0.707
+    static constexpr std::array<f32, 4> down_mix_coeff{1.0, 0.596f, 0.354f, 0.707f};
+
+    // Output frames are never ahead of the input frames, so writing in place is safe
+    const size_t num_frames{samples.size() / 6};
+    size_t frame{0};
+#ifdef ARCHITECTURE_x86_64
+    // Two frames at a time, the lanes hold left and right of both frames
+    for (; frame + 2 <= num_frames; frame += 2) {
+        const s16* const in{&samples[frame * 6]};
+        const __m128i frames{_mm_loadu_si128(reinterpret_cast<const __m128i*>(in))};
+        const __m128i back{_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + 8))};
+        // v0 = fl0 fr0 c0 lfe0, v1 = bl0 br0 fl1 fr1, v2 = c1 lfe1 bl1 br1
+        const __m128 v0{_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(frames, frames), 16))};
+        const __m128 v1{_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(frames, frames), 16))};
+        const __m128 v2{_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(back, back), 16))};
+        const __m128 front_lr{_mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 2, 1, 0))};
+        const __m128 center{_mm_shuffle_ps(v0, v2, _MM_SHUFFLE(0, 0, 2, 2))};
+        const __m128 lfe{_mm_shuffle_ps(v0, v2, _MM_SHUFFLE(1, 1, 3, 3))};
+        const __m128 back_lr{_mm_shuffle_ps(v1, v2, _MM_SHUFFLE(3, 2, 1, 0))};
+        // Same operation order as the scalar path, so the rounding matches
+        __m128 mix{_mm_mul_ps(front_lr, _mm_set1_ps(down_mix_coeff[0]))};
+        mix = _mm_add_ps(mix, _mm_mul_ps(center, _mm_set1_ps(down_mix_coeff[1])));
+        mix = _mm_add_ps(mix, _mm_mul_ps(lfe, _mm_set1_ps(down_mix_coeff[2])));
+        mix = _mm_add_ps(mix, _mm_mul_ps(back_lr, _mm_set1_ps(down_mix_coeff[3])));
+        const __m128i out{_mm_cvttps_epi32(_mm_mul_ps(mix, _mm_set1_ps(volume)))};
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&samples[frame * 2]),
+                         _mm_packs_epi32(out, out));
+    }
+#elif defined(ARCHITECTURE_arm64)
+    for (; frame + 2 <= num_frames; frame += 2) {
+        const s16* const in{&samples[frame * 6]};
+        const int16x8_t frames{vld1q_s16(in)};
+        const float32x4_t v0{vcvtq_f32_s32(vmovl_s16(vget_low_s16(frames)))};
+        const float32x4_t v1{vcvtq_f32_s32(vmovl_s16(vget_high_s16(frames)))};
+        const float32x4_t v2{vcvtq_f32_s32(vmovl_s16(vld1_s16(in + 8)))};
+        const float32x4_t front_lr{vcombine_f32(vget_low_f32(v0), vget_high_f32(v1))};
+        const float32x4_t center{vcombine_f32(vdup_lane_f32(vget_high_f32(v0), 0),
+                                              vdup_lane_f32(vget_low_f32(v2), 0))};
+        const float32x4_t lfe{vcombine_f32(vdup_lane_f32(vget_high_f32(v0), 1),
+                                           vdup_lane_f32(vget_low_f32(v2), 1))};
+        const float32x4_t back_lr{vcombine_f32(vget_low_f32(v1), vget_high_f32(v2))};
+        // Separate multiplies and adds, a fused multiply-add would round differently
+        float32x4_t mix{vmulq_n_f32(front_lr, down_mix_coeff[0])};
+        mix = vaddq_f32(mix, vmulq_n_f32(center, down_mix_coeff[1]));
+        mix = vaddq_f32(mix, vmulq_n_f32(lfe, down_mix_coeff[2]));
+        mix = vaddq_f32(mix, vmulq_n_f32(back_lr, down_mix_coeff[3]));
+        const int32x4_t out{vcvtq_s32_f32(vmulq_n_f32(mix, volume))};
+        vst1_s16(&samples[frame * 2], vqmovn_s32(out));
+    }
+#endif
+    for (; frame < num_frames; frame++) {
+        const s16* const in{&samples[frame * 6]};
+        const auto fl = static_cast<f32>(in[static_cast<u32>(Channels::FrontLeft)]);
+        const auto fr = static_cast<f32>(in[static_cast<u32>(Channels::FrontRight)]);
+        const auto c = static_cast<f32>(in[static_cast<u32>(Channels::Center)]);
+        const auto lfe = static_cast<f32>(in[static_cast<u32>(Channels::LFE)]);
+        const auto bl = static_cast<f32>(in[static_cast<u32>(Channels::BackLeft)]);
+        const auto br = static_cast<f32>(in[static_cast<u32>(Channels::BackRight)]);
+
+        const auto left_sample{
+            static_cast<s32>((fl * down_mix_coeff[0] + c * down_mix_coeff[1] +
+                              lfe * down_mix_coeff[2] + bl * down_mix_coeff[3]) *
+                             volume)};
+
+        const auto right_sample{
+            static_cast<s32>((fr * down_mix_coeff[0] + c * down_mix_coeff[1] +
+                              lfe * down_mix_coeff[2] + br * down_mix_coeff[3]) *
+                             volume)};
+
+        samples[frame * 2 + static_cast<u32>(Channels::FrontLeft)] =
+            static_cast<s16>(std::clamp(left_sample, SampleMin, SampleMax));
+        samples[frame * 2 + static_cast<u32>(Channels::FrontRight)] =
+            static_cast<s16>(std::clamp(right_sample, SampleMin, SampleMax));
+    }
+    return num_frames * 2;
+}
+
+} // namespace AudioCore::Sink
@@ -0,0 +1,32 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <span>
+
+#include "common/common_types.h"
+
+namespace AudioCore::Sink {
+
+/**
+ * Scale samples in place by a volume. Samples are truncated and saturated to s16, the vectorized
+ * paths give the same results as the scalar one.
+ *
+ * @param samples - Samples to scale.
+ * @param volume  - Volume to apply.
+ */
+void ScaleSamples(std::span<s16> samples, f32 volume);
+
+/**
+ * Downmix 6 channel frames to 2 channels in place, applying a volume. Samples are truncated and
+ * saturated to s16, the vectorized paths give the same results as the scalar one.
+ *
+ * @param samples - 6 channel frames, overwritten with the 2 channel frames.
+ * @param volume  - Volume to apply.
+ *
+ * @return Number of 2 channel samples written to the start of samples.
+ */
+size_t DownmixToStereo(std::span<s16> samples, f32 volume);
+
+} // namespace AudioCore::Sink
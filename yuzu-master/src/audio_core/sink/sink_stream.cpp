@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2018 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <memory>
@@ -9,9 +10,11 @@
 
 #include "audio_core/audio_core.h"
 #include "audio_core/common/common.h"
+#include "audio_core/sink/sample_conversion.h"
 #include "audio_core/sink/sink_stream.h"
 #include "common/common_types.h"
 #include "common/fixed_point.h"
+#include "common/logging/log.h"
 #include "common/scope_exit.h"
 #include "common/settings.h"
 #include "core/core.h"
@@ -19,6 +22,14 @@
 
 namespace AudioCore::Sink {
 
+SinkStream::~SinkStream() {
+    const auto stats{GetStats()};
+    if (stats.underruns != 0 || stats.dropped_samples != 0) {
+        LOG_INFO(Audio_Sink, "Stream {} ran out of samples {} times and dropped {} samples", name,
+                 stats.underruns, stats.dropped_samples);
+    }
+}
+
 void SinkStream::AppendBuffer(SinkBuffer& buffer, std::span<s16> samples) {
     SCOPE_EXIT {
         queue.enqueue(buffer);
@@ -29,55 +40,22 @@ void SinkStream::AppendBuffer(SinkBuffer& buffer, std::span<s16> samples) {
         return;
     }
 
-    constexpr s32 min{std::numeric_limits<s16>::min()};
-    constexpr s32 max{std::numeric_limits<s16>::max()};
-
     auto yuzu_volume{Settings::Volume()};
     if (yuzu_volume > 1.0f) {
         yuzu_volume = 0.6f + 20 * std::log10(yuzu_volume);
     }
     auto volume{system_volume * device_volume * yuzu_volume};
 
-    if (system_channels == 6 && device_channels == 2) {
-        // We're given 6 channels, but our device only outputs 2, so downmix.
-        // Front = 1.0
-        // Center = 0.596
-        // LFE = 0.354
-        // Back = 0.707
-        static constexpr std::array<f32, 4> down_mix_coeff{1.0, 0.596f, 0.354f, 0.707f};
-
-        for (u32 read_index = 0, write_index = 0; read_index < samples.size();
-             read_index += system_channels, write_index += device_channels) {
-            const auto fl =
-                static_cast<f32>(samples[read_index + static_cast<u32>(Channels::FrontLeft)]);
-            const auto fr =
-                static_cast<f32>(samples[read_index + static_cast<u32>(Channels::FrontRight)]);
-            const auto c =
-                static_cast<f32>(samples[read_index + static_cast<u32>(Channels::Center)]);
-            const auto lfe =
-                static_cast<f32>(samples[read_index + static_cast<u32>(Channels::LFE)]);
-            const auto bl =
-                static_cast<f32>(samples[read_index + static_cast<u32>(Channels::BackLeft)]);
-            const auto br =
-                static_cast<f32>(samples[read_index + static_cast<u32>(Channels::BackRight)]);
-
-            const auto left_sample{
-                static_cast<s32>((fl * down_mix_coeff[0] + c * down_mix_coeff[1] +
-                                  lfe * down_mix_coeff[2] + bl * down_mix_coeff[3]) *
-                                 volume)};
-
-            const auto right_sample{
-                static_cast<s32>((fr * down_mix_coeff[0] + c * down_mix_coeff[1] +
-                                  lfe * down_mix_coeff[2] + br * down_mix_coeff[3]) *
-                                 volume)};
-
-            samples[write_index + static_cast<u32>(Channels::FrontLeft)] =
-                static_cast<s16>(std::clamp(left_sample, min, max));
-            samples[write_index + static_cast<u32>(Channels::FrontRight)] =
-                static_cast<s16>(std::clamp(right_sample, min, max));
+    const auto push{[this](std::span<const s16> converted) {
+        const size_t pushed{samples_buffer.Push(converted)};
+        if (pushed < converted.size()) {
+            dropped_sample_count.fetch_add(converted.size() - pushed, std::memory_order_relaxed);
         }
+    }};
 
-        samples_buffer.Push(samples.subspan(0, samples.size() / system_channels * device_channels));
+    if (system_channels == 6 && device_channels == 2) {
+        // We're given 6 channels, but our device only outputs 2, so downmix.
+        push(samples.first(DownmixToStereo(samples, volume)));
         return;
     }
 
@@ -85,46 +63,31 @@ void SinkStream::AppendBuffer(SinkBuffer& buffer, std::span<s16> samples) {
         // We need moar samples! Not all games will provide 6 channel audio.
         // TODO: Implement some upmixing here. Currently just passthrough, with other
         // channels left as silence.
-        std::vector<s16> new_samples(samples.size() / system_channels * device_channels);
-
-        for (u32 read_index = 0, write_index = 0; read_index < samples.size();
-             read_index += system_channels, write_index += device_channels) {
-            const auto left_sample{static_cast<s16>(std::clamp(
-                static_cast<s32>(
-                    static_cast<f32>(samples[read_index + static_cast<u32>(Channels::FrontLeft)]) *
-                    volume),
-                min, max))};
-
-            new_samples[write_index + static_cast<u32>(Channels::FrontLeft)] = left_sample;
-
-            const auto right_sample{static_cast<s16>(std::clamp(
-                static_cast<s32>(
-                    static_cast<f32>(samples[read_index + static_cast<u32>(Channels::FrontRight)]) *
-                    volume),
-                min, max))};
-
-            new_samples[write_index + static_cast<u32>(Channels::FrontRight)] = right_sample;
+        const size_t num_frames{samples.size() / system_channels};
+        ScaleSamples(samples.first(num_frames * system_channels), volume);
+
+        upmix_buffer.resize_destructive(num_frames * device_channels);
+        for (size_t frame = 0; frame < num_frames; frame++) {
+            s16* const out{&upmix_buffer[frame * device_channels]};
+            out[static_cast<u32>(Channels::FrontLeft)] =
+                samples[frame * system_channels + static_cast<u32>(Channels::FrontLeft)];
+            out[static_cast<u32>(Channels::FrontRight)] =
+                samples[frame * system_channels + static_cast<u32>(Channels::FrontRight)];
+            std::fill(out + static_cast<u32>(Channels::Center), out + device_channels, s16{0});
         }
-
-        samples_buffer.Push(new_samples);
+        push(upmix_buffer);
         return;
     }
 
     if (volume != 1.0f) {
-        for (u32 i = 0; i < samples.size(); ++i) {
-            samples[i] = static_cast<s16>(
-                std::clamp(static_cast<s32>(static_cast<f32>(samples[i]) * volume), min, max));
-        }
+        ScaleSamples(samples, volume);
     }
 
-    samples_buffer.Push(samples);
+    push(samples);
 }
 
-std::vector<s16> SinkStream::ReleaseBuffer(u64 num_samples) {
-    constexpr s32 min = std::numeric_limits<s16>::min();
-    constexpr s32 max = std::numeric_limits<s16>::max();
-
-    auto samples{samples_buffer.Pop(num_samples)};
+void SinkStream::ReleaseBuffer(std::span<s16> samples) {
+    const size_t popped{samples_buffer.Pop(samples.data(), samples.size())};
 
     // TODO: Up-mix to 6 channels if the game expects it.
     // For audio input this is unlikely to ever be the case though.
@@ -132,15 +95,9 @@ std::vector<s16> SinkStream::ReleaseBuffer(u64 num_samples) {
     // Incoming mic volume seems to always be very quiet, so multiply by an additional 8 here.
     // TODO: Play with this and find something that works better.
     auto volume{system_volume * device_volume * 8};
-    for (u32 i = 0; i < samples.size(); i++) {
-        samples[i] = static_cast<s16>(
-            std::clamp(static_cast<s32>(static_cast<f32>(samples[i]) * volume), min, max));
-    }
+    ScaleSamples(samples.first(popped), volume);
 
-    if (samples.size() < num_samples) {
-        samples.resize(num_samples, 0);
-    }
-    return samples;
+    std::fill(samples.begin() + popped, samples.end(), s16{0});
 }
 
 void SinkStream::ClearQueue() {
@@ -231,6 +188,7 @@ void SinkStream::ProcessAudioOutAndRender(std::span<s16> output_buffer, std::siz
             if (!queue.try_dequeue(playing_buffer)) {
                 // If no buffer was available we've underrun, fill the remaining buffer with
                 // the last written frame and continue.
+                underrun_count.fetch_add(1, std::memory_order_relaxed);
                 for (size_t i = frames_written; i < num_frames; i++) {
                     std::memcpy(&output_buffer[i * frame_size], &last_frame[0], frame_size_bytes);
                 }
@@ -286,6 +244,17 @@ u64 SinkStream::GetExpectedPlayedSampleCount() {
     return std::min<u64>(exp_played_sample_count, max_played_sample_count) + TargetSampleCount * 3;
 }
 
+SinkStreamStats SinkStream::GetStats() const {
+    const u64 queued_frames{samples_buffer.Size() / std::max<u32>(device_channels, 1)};
+    return {
+        .underruns = underrun_count.load(std::memory_order_relaxed),
+        .dropped_samples = dropped_sample_count.load(std::memory_order_relaxed),
+        .queued_buffers = queued_buffers.load(std::memory_order_relaxed),
+        .queued_frames = queued_frames,
+        .latency = std::chrono::microseconds{queued_frames * 1'000'000 / TargetSampleRate},
+    };
+}
+
 void SinkStream::WaitFreeSpace(std::stop_token stop_token) {
     std::unique_lock lk{release_mutex};
     release_cv.wait_for(lk, std::chrono::milliseconds(5),
@@ -16,6 +16,7 @@
 #include "common/polyfill_thread.h"
 #include "common/reader_writer_queue.h"
 #include "common/ring_buffer.h"
+#include "common/scratch_buffer.h"
 #include "common/thread.h"
 
 namespace Core {
@@ -37,6 +38,20 @@ struct SinkBuffer {
     bool consumed;
 };
 
+/// Playback statistics of a stream, safe to query from any thread while it is running.
+struct SinkStreamStats {
+    /// Number of backend callbacks which ran out of samples to play
+    u64 underruns;
+    /// Number of samples dropped because the sample ring buffer was full
+    u64 dropped_samples;
+    /// Number of audio buffers waiting to be played
+    u32 queued_buffers;
+    /// Number of frames waiting in the sample ring buffer
+    u64 queued_frames;
+    /// Time it takes to play the queued frames
+    std::chrono::microseconds latency;
+};
+
 /**
  * Contains a real backend stream for outputting samples to hardware,
  * created only via a Sink (See Sink::AcquireSinkStream).
@@ -56,7 +71,7 @@ struct SinkBuffer {
 class SinkStream {
 public:
     explicit SinkStream(Core::System& system_, StreamType type_) : system{system_}, type{type_} {}
-    virtual ~SinkStream() {}
+    virtual ~SinkStream();
 
     /**
      * Finalize the sink stream.
@@ -174,11 +189,11 @@ public:
 
     /**
      * Release a buffer. Audio In only, will fill a buffer with recorded samples.
+     * Samples not recorded yet are filled with silence.
      *
-     * @param num_samples - Maximum number of samples to receive.
-     * @return Vector of recorded samples. May have fewer than num_samples.
+     * @param samples - Buffer to receive the recorded samples.
      */
-    virtual std::vector<s16> ReleaseBuffer(u64 num_samples);
+    virtual void ReleaseBuffer(std::span<s16> samples);
 
     /**
      * Empty out the buffer queue.
@@ -208,6 +223,13 @@ public:
      */
     u64 GetExpectedPlayedSampleCount();
 
+    /**
+     * Get the playback statistics of this stream.
+     *
+     * @return The current statistics.
+     */
+    SinkStreamStats GetStats() const;
+
     /**
      * Waits for free space in the sample ring buffer
      */
@@ -244,6 +266,12 @@ private:
     std::array<s16, MaxChannels> last_frame{};
     /// Number of buffers waiting to be played
     std::atomic<u32> queued_buffers{};
+    /// Number of callbacks which ran out of samples
+    std::atomic<u64> underrun_count{};
+    /// Number of samples which didn't fit in the ring buffer
+    std::atomic<u64> dropped_sample_count{};
+    /// Upmixed samples of the buffer being appended, kept to avoid allocating on the audio path
+    Common::ScratchBuffer<s16> upmix_buffer{TargetSampleCount * MaxChannels * 4};
     /// The ring size for audio out buffers (usually 4, rarely 2 or 8)
     u32 max_queue_size{};
     /// Locks access to sample count tracking info
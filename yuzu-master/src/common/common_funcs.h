@@ -41,10 +41,16 @@
 
 #define LTO_NOINLINE __attribute__((noinline))
 
+/// Allows a single function to use instruction set extensions that are not enabled globally.
+/// Callers must check for host support at runtime before calling it.
+#define TARGET_ISA(isa) __attribute__((target(isa)))
+
 #else // _MSC_VER
 
 #define LTO_NOINLINE
 
+#define TARGET_ISA(isa)
+
 // Locale Cross-Compatibility
 #define locale_t _locale_t
 
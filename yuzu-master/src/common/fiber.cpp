@@ -1,7 +1,10 @@
 // SPDX-FileCopyrightText: Copyright 2020 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <atomic>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 #include "common/assert.h"
 #include "common/fiber.h"
@@ -13,21 +16,97 @@ namespace Common {
 
 constexpr std::size_t default_stack_size = 512 * 1024;
 
+// Inaccessible pages below every stack, so an overflow faults instead of silently corrupting
+// whatever is mapped below it. Covers a whole page on hosts with up to 64 KiB pages.
+constexpr std::size_t stack_guard_size = 64 * 1024;
+
+// Freed stacks kept around for new fibers, bounds the memory an idle pool holds on to
+constexpr std::size_t max_pooled_stacks = 32;
+
+namespace {
+
+/// Recycles fiber stacks. Guest threads are created and destroyed all the time, and a fresh
+/// stack costs a map and an unmap plus faulting its pages in again.
+class StackPool {
+public:
+    /// Returns the lowest usable address of a stack of default_stack_size bytes
+    u8* Allocate() {
+        {
+            std::scoped_lock lock{mutex};
+            if (!free_stacks.empty()) {
+                u8* const stack = free_stacks.back();
+                free_stacks.pop_back();
+                return stack;
+            }
+        }
+        auto* const base =
+            static_cast<u8*>(AllocateMemoryPages(stack_guard_size + default_stack_size));
+        GuardMemoryPages(base, stack_guard_size);
+        return base + stack_guard_size;
+    }
+
+    void Free(u8* stack) {
+        if (!stack) {
+            return;
+        }
+        {
+            std::scoped_lock lock{mutex};
+            if (free_stacks.size() < max_pooled_stacks) {
+                free_stacks.push_back(stack);
+                return;
+            }
+        }
+        Unmap(stack);
+    }
+
+private:
+    static void Unmap(u8* stack) {
+        FreeMemoryPages(stack - stack_guard_size, stack_guard_size + default_stack_size);
+    }
+
+    std::mutex mutex;
+    std::vector<u8*> free_stacks;
+};
+
+StackPool& GetStackPool() {
+    // Leaked on purpose, fibers owned by other statics or by threads still running at exit return
+    // their stacks after static destructors have run
+    static auto* const pool = new StackPool;
+    return *pool;
+}
+
+} // Anonymous namespace
+
 struct Fiber::FiberImpl {
-    FiberImpl() : stack{default_stack_size}, rewind_stack{default_stack_size} {}
+    ~FiberImpl() {
+        GetStackPool().Free(stack);
+        GetStackPool().Free(rewind_stack);
+    }
 
-    VirtualBuffer<u8> stack;
-    VirtualBuffer<u8> rewind_stack;
+    /// Claims the fiber, waiting for the thread running it to switch away first
+    void Lock() {
+        while (is_running.test_and_set(std::memory_order_acquire)) {
+            is_running.wait(true, std::memory_order_relaxed);
+        }
+    }
 
-    std::mutex guard;
+    void Unlock() {
+        is_running.clear(std::memory_order_release);
+        is_running.notify_one();
+    }
+
+    // Lowest addresses of the stacks, thread fibers run on the stack of their thread instead.
+    // The rewind stack is only allocated once the fiber rewinds, which most fibers never do.
+    u8* stack{};
+    u8* rewind_stack{};
+
+    std::atomic_flag is_running;
     std::function<void()> entry_point;
     std::function<void()> rewind_point;
     std::shared_ptr<Fiber> previous_fiber;
     bool is_thread_fiber{};
     bool released{};
 
-    u8* stack_limit{};
-    u8* rewind_stack_limit{};
     boost::context::detail::fcontext_t context{};
     boost::context::detail::fcontext_t rewind_context{};
 };
@@ -39,7 +118,7 @@ void Fiber::SetRewindPoint(std::function<void()>&& rewind_func) {
 void Fiber::Start(boost::context::detail::transfer_t& transfer) {
     ASSERT(impl->previous_fiber != nullptr);
     impl->previous_fiber->impl->context = transfer.fctx;
-    impl->previous_fiber->impl->guard.unlock();
+    impl->previous_fiber->impl->Unlock();
     impl->previous_fiber.reset();
     impl->entry_point();
     UNREACHABLE();
@@ -49,9 +128,7 @@ void Fiber::OnRewind([[maybe_unused]] boost::context::detail::transfer_t& transf
     ASSERT(impl->context != nullptr);
     impl->context = impl->rewind_context;
     impl->rewind_context = nullptr;
-    u8* tmp = impl->stack_limit;
-    impl->stack_limit = impl->rewind_stack_limit;
-    impl->rewind_stack_limit = tmp;
+    std::swap(impl->stack, impl->rewind_stack);
     impl->rewind_point();
     UNREACHABLE();
 }
@@ -68,11 +145,10 @@ void Fiber::RewindStartFunc(boost::context::detail::transfer_t transfer) {
 
 Fiber::Fiber(std::function<void()>&& entry_point_func) : impl{std::make_unique<FiberImpl>()} {
     impl->entry_point = std::move(entry_point_func);
-    impl->stack_limit = impl->stack.data();
-    impl->rewind_stack_limit = impl->rewind_stack.data();
-    u8* stack_base = impl->stack_limit + default_stack_size;
+    impl->stack = GetStackPool().Allocate();
+    u8* stack_base = impl->stack + default_stack_size;
     impl->context =
-        boost::context::detail::make_fcontext(stack_base, impl->stack.size(), FiberStartFunc);
+        boost::context::detail::make_fcontext(stack_base, default_stack_size, FiberStartFunc);
 }
 
 Fiber::Fiber() : impl{std::make_unique<FiberImpl>()} {}
@@ -82,11 +158,8 @@ Fiber::~Fiber() {
         return;
     }
     // Make sure the Fiber is not being used
-    const bool locked = impl->guard.try_lock();
-    ASSERT_MSG(locked, "Destroying a fiber that's still running");
-    if (locked) {
-        impl->guard.unlock();
-    }
+    ASSERT_MSG(!impl->is_running.test(std::memory_order_acquire),
+               "Destroying a fiber that's still running");
 }
 
 void Fiber::Exit() {
@@ -94,21 +167,24 @@ void Fiber::Exit() {
     if (!impl->is_thread_fiber) {
         return;
     }
-    impl->guard.unlock();
+    impl->Unlock();
     impl->released = true;
 }
 
 void Fiber::Rewind() {
     ASSERT(impl->rewind_point);
     ASSERT(impl->rewind_context == nullptr);
-    u8* stack_base = impl->rewind_stack_limit + default_stack_size;
+    if (!impl->rewind_stack) {
+        impl->rewind_stack = GetStackPool().Allocate();
+    }
+    u8* stack_base = impl->rewind_stack + default_stack_size;
     impl->rewind_context =
-        boost::context::detail::make_fcontext(stack_base, impl->stack.size(), RewindStartFunc);
+        boost::context::detail::make_fcontext(stack_base, default_stack_size, RewindStartFunc);
     boost::context::detail::jump_fcontext(impl->rewind_context, this);
 }
 
 void Fiber::YieldTo(std::weak_ptr<Fiber> weak_from, Fiber& to) {
-    to.impl->guard.lock();
+    to.impl->Lock();
     to.impl->previous_fiber = weak_from.lock();
 
     auto transfer = boost::context::detail::jump_fcontext(to.impl->context, &to);
@@ -120,14 +196,14 @@ void Fiber::YieldTo(std::weak_ptr<Fiber> weak_from, Fiber& to) {
             return;
         }
         from->impl->previous_fiber->impl->context = transfer.fctx;
-        from->impl->previous_fiber->impl->guard.unlock();
+        from->impl->previous_fiber->impl->Unlock();
         from->impl->previous_fiber.reset();
     }
 }
 
 std::shared_ptr<Fiber> Fiber::ThreadToFiber() {
     std::shared_ptr<Fiber> fiber = std::shared_ptr<Fiber>{new Fiber()};
-    fiber->impl->guard.lock();
+    fiber->impl->Lock();
     fiber->impl->is_thread_fiber = true;
     return fiber;
 }
@@ -1,6 +1,12 @@
 // SPDX-FileCopyrightText: Copyright 2021 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#if defined(__linux__) && !defined(ANDROID)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "common/fs/file.h"
 #include "common/fs/fs.h"
 #ifdef ANDROID
@@ -130,6 +136,47 @@ bool RenameFile(const fs::path& old_path, const fs::path& new_path) {
     return true;
 }
 
+u64 CopyFileRange(const fs::path& src_path, u64 src_offset, const fs::path& dest_path,
+                  u64 dest_offset, u64 length) {
+#if defined(__linux__) && !defined(ANDROID)
+    const int src_fd = open(src_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (src_fd == -1) {
+        return 0;
+    }
+    const int dest_fd = open(dest_path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (dest_fd == -1) {
+        close(src_fd);
+        return 0;
+    }
+
+    auto src_pos = static_cast<loff_t>(src_offset);
+    auto dest_pos = static_cast<loff_t>(dest_offset);
+    u64 copied = 0;
+    while (copied < length) {
+        const ssize_t result =
+            copy_file_range(src_fd, &src_pos, dest_fd, &dest_pos, length - copied, 0);
+        if (result <= 0) {
+            // Copies between filesystems or from special files are refused, callers fall back to
+            // reading and writing the data
+            if (result == -1) {
+                const auto ec = std::error_code{errno, std::generic_category()};
+                LOG_DEBUG(Common_Filesystem,
+                          "Failed to copy from src_path={} to dest_path={}, ec_message={}",
+                          PathToUTF8String(src_path), PathToUTF8String(dest_path), ec.message());
+            }
+            break;
+        }
+        copied += static_cast<u64>(result);
+    }
+
+    close(dest_fd);
+    close(src_fd);
+    return copied;
+#else
+    return 0;
+#endif
+}
+
 std::shared_ptr<IOFile> FileOpen(const fs::path& path, FileAccessMode mode, FileType type,
                                  FileShareFlag flag) {
     if (!ValidatePath(path)) {
@@ -102,6 +102,28 @@ template <typename Path1, typename Path2>
 }
 #endif
 
+/**
+ * Copies length bytes at src_offset of the file at src_path to dest_offset of the file at
+ * dest_path within the host, without passing the data through memory. Filesystems supporting it
+ * share the data between both files instead of duplicating it.
+ *
+ * Failures occur when:
+ * - Either file can't be opened
+ * - The host has no way of copying between files, which is currently the case outside of Linux
+ * - The filesystems of the files don't support copying between them
+ *
+ * @param src_path Source filesystem path
+ * @param src_offset Offset of the data in the source file
+ * @param dest_path Destination filesystem path, the file must exist
+ * @param dest_offset Offset of the data in the destination file
+ * @param length Number of bytes to copy
+ *
+ * @returns The number of bytes copied, which may be less than length. Returns 0 on failure.
+ */
+[[nodiscard]] u64 CopyFileRange(const std::filesystem::path& src_path, u64 src_offset,
+                                const std::filesystem::path& dest_path, u64 dest_offset,
+                                u64 length);
+
 /**
  * Opens a file at path with the specified file access mode.
  * This function behaves differently depending on the FileAccessMode.
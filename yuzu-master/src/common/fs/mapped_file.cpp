@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include "common/fs/mapped_file.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Common::FS {
+
+MappedFile::MappedFile() = default;
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    Open(path);
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    std::swap(data, other.data);
+    std::swap(size, other.size);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    std::swap(data, other.data);
+    std::swap(size, other.size);
+    return *this;
+}
+
+void MappedFile::Open(const std::filesystem::path& path) {
+    Close();
+
+#ifdef _WIN32
+    // Let other handles keep writing to the file, a mapped cache file is still appended to
+    const HANDLE file =
+        CreateFileW(path.wstring().c_str(), GENERIC_READ,
+                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                    FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOG_ERROR(Common_Filesystem, "Failed to open path={} for mapping",
+                  PathToUTF8String(path));
+        return;
+    }
+    LARGE_INTEGER file_size{};
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        CloseHandle(file);
+        return;
+    }
+    const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        LOG_ERROR(Common_Filesystem, "Failed to create a mapping of path={}",
+                  PathToUTF8String(path));
+        return;
+    }
+    // The view keeps the mapping object alive
+    void* const view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr) {
+        LOG_ERROR(Common_Filesystem, "Failed to map path={}", PathToUTF8String(path));
+        return;
+    }
+    data = static_cast<const u8*>(view);
+    size = static_cast<size_t>(file_size.QuadPart);
+#else
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        LOG_ERROR(Common_Filesystem, "Failed to open path={} for mapping",
+                  PathToUTF8String(path));
+        return;
+    }
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        close(fd);
+        return;
+    }
+    const size_t file_size = static_cast<size_t>(file_stat.st_size);
+    // The mapping keeps its own reference to the file, the descriptor is not needed afterwards
+    void* const view = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        LOG_ERROR(Common_Filesystem, "Failed to map path={}, error: {}", PathToUTF8String(path),
+                  strerror(errno));
+        return;
+    }
+    data = static_cast<const u8*>(view);
+    size = file_size;
+#endif
+}
+
+void MappedFile::Close() {
+    if (!IsOpen()) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap(const_cast<u8*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+size_t MappedFile::Read(u8* out, size_t length, size_t offset) const {
+    if (offset >= size) {
+        return 0;
+    }
+    const size_t read_size = std::min(length, size - offset);
+    std::memcpy(out, data + offset, read_size);
+    return read_size;
+}
+
+} // namespace Common::FS
@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+#include "common/common_types.h"
+
+namespace Common::FS {
+
+/**
+ * A read-only view of a whole file mapped into the address space of the process.
+ * Reads are served directly from the page cache without going through a system call.
+ *
+ * The file may be written and appended to through other handles while it is mapped, appended data
+ * is not part of the mapping. The file must not be truncated while it is mapped.
+ */
+class MappedFile final {
+public:
+    MappedFile();
+
+    /**
+     * Maps the file at path for reading.
+     * Check IsOpen() to know if the mapping succeeded; empty files are never mapped.
+     *
+     * @param path Filesystem path
+     */
+    explicit MappedFile(const std::filesystem::path& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * Maps the file at path for reading, unmapping any previously mapped file.
+     *
+     * @param path Filesystem path
+     */
+    void Open(const std::filesystem::path& path);
+
+    /// Unmaps the file if it is mapped.
+    void Close();
+
+    /**
+     * Checks whether the file is mapped.
+     *
+     * @returns True if the file is mapped, false otherwise.
+     */
+    [[nodiscard]] bool IsOpen() const {
+        return data != nullptr;
+    }
+
+    /**
+     * Gets the size of the mapped file.
+     *
+     * @returns The size of the mapped file, 0 if it is not mapped.
+     */
+    [[nodiscard]] size_t GetSize() const {
+        return size;
+    }
+
+    /**
+     * Gets a view of the whole mapped file.
+     *
+     * @returns A span over the contents of the file, empty if it is not mapped.
+     */
+    [[nodiscard]] std::span<const u8> GetSpan() const {
+        return {data, size};
+    }
+
+    /**
+     * Copies up to length bytes starting at offset into out.
+     *
+     * @param out Destination buffer
+     * @param length Number of bytes to copy
+     * @param offset Offset into the file
+     *
+     * @returns Number of bytes copied, truncated at the end of the file.
+     */
+    size_t Read(u8* out, size_t length, size_t offset) const;
+
+private:
+    const u8* data{};
+    size_t size{};
+};
+
+} // namespace Common::FS
@@ -0,0 +1,155 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/polyfill_thread.h"
+#include "common/unique_function.h"
+
+namespace Common {
+
+enum class TaskPriority : u32 {
+    High,   ///< Work a thread is blocked on, like texture transcoding
+    Normal, ///< Work needed soon, like building shaders
+    Low,    ///< Work nobody waits for, like preloading assets
+};
+
+struct TaskSchedulerStats {
+    u64 submitted;
+    u64 executed;
+    u64 stolen; ///< Tasks taken from the queue of another worker
+    u64 helped; ///< Tasks run by threads waiting on a group
+    u64 sleeps; ///< Times a worker ran out of work and went to sleep
+};
+
+class TaskGroup;
+
+/**
+ * Pool of worker threads running the tasks of any number of TaskGroups.
+ * Every worker owns a queue per priority. Tasks submitted from outside the pool are spread over
+ * the workers, tasks submitted from a worker go to its own queue. Workers steal from the queues of
+ * other workers when theirs run dry, so neither submitters nor workers contend on a single lock.
+ */
+class TaskScheduler {
+public:
+    explicit TaskScheduler(size_t num_workers, std::string name = "TaskWorker");
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    TaskScheduler(TaskScheduler&&) = delete;
+    TaskScheduler& operator=(TaskScheduler&&) = delete;
+
+    [[nodiscard]] size_t NumWorkers() const noexcept {
+        return workers.size();
+    }
+
+    [[nodiscard]] TaskSchedulerStats GetStats() const;
+
+private:
+    friend class TaskGroup;
+
+    struct Task {
+        UniqueFunction<void> func;
+        TaskGroup* group; ///< Group the task is accounted to, null for the runners of a group
+        const TaskGroup* owner; ///< Group that submitted the task
+        u32 epoch;
+    };
+
+    struct Worker;
+
+    void Submit(TaskPriority priority, Task task);
+
+    /// Runs a queued task of at least the given priority, returns false when there is none.
+    bool RunQueuedTask(TaskPriority lowest_priority);
+
+    /// Runs a queued task submitted by the given group, returns false when there is none.
+    /// Threads waiting on a group only help with its own tasks, running anything else could
+    /// deadlock on a task waiting for the caller, or stall the caller behind a long task.
+    bool RunGroupTask(const TaskGroup& group);
+
+    static void ExecuteTask(Task& task);
+
+    void WorkerLoop(std::stop_token stop_token, size_t index);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<size_t> num_queued{};
+    std::atomic<size_t> next_worker{};
+
+    std::mutex sleep_mutex;
+    std::condition_variable_any sleep_condition;
+    std::atomic<size_t> num_sleeping{};
+
+    std::atomic<u64> num_submitted{};
+    std::atomic<u64> num_helped{};
+    std::atomic<u64> num_sleeps{};
+
+    std::string thread_name;
+    std::vector<std::jthread> threads;
+};
+
+/// Returns the scheduler shared by the emulator, with a worker for every core but one.
+[[nodiscard]] TaskScheduler& GetTaskScheduler();
+
+/**
+ * Set of tasks run on a TaskScheduler that can be waited on or cancelled together.
+ * Groups may limit how many of their tasks run at once, a limit of one runs them in order.
+ * Destroying a group cancels its queued tasks and waits for the running ones.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskPriority priority = TaskPriority::Normal, size_t max_parallel = 0,
+                       TaskScheduler& scheduler = GetTaskScheduler());
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    TaskGroup(TaskGroup&&) = delete;
+    TaskGroup& operator=(TaskGroup&&) = delete;
+
+    void Run(UniqueFunction<void> func);
+
+    /// Waits for the submitted tasks to finish, running queued tasks of the group meanwhile.
+    /// Requesting a stop cancels the tasks that haven't started.
+    void Wait(std::stop_token stop_token = {});
+
+    /// Drops the submitted tasks that haven't started yet.
+    void Cancel();
+
+    [[nodiscard]] bool IsIdle() const noexcept {
+        return num_pending.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    friend class TaskScheduler;
+
+    void Execute(TaskScheduler::Task& task);
+    void RunLimited();
+    void Finish();
+
+    TaskScheduler& scheduler;
+    TaskPriority priority;
+    size_t max_parallel;
+
+    std::atomic<size_t> num_pending{};
+    std::atomic<u32> epoch{};
+    std::mutex mutex;
+    std::condition_variable idle_condition;
+
+    // Tasks waiting for a free slot, only used when the parallelism of the group is limited
+    std::queue<TaskScheduler::Task> limited_tasks;
+    size_t num_runners{};
+};
+
+} // namespace Common
@@ -4,6 +4,8 @@
 #ifdef _WIN32
 #include <windows.h>
 #else
+#include <cerrno>
+#include <cstring>
 #include <sys/mman.h>
 #endif
 
@@ -33,9 +35,22 @@ void FreeMemoryPages(void* base, [[maybe_unused]] std::size_t size) noexcept {
         return;
     }
 #ifdef _WIN32
-    ASSERT(VirtualFree(base, 0, MEM_RELEASE));
+    const BOOL ret = VirtualFree(base, 0, MEM_RELEASE);
+    ASSERT(ret);
 #else
-    ASSERT(munmap(base, size) == 0);
+    const int ret = munmap(base, size);
+    ASSERT_MSG(ret == 0, "munmap failed: {}", strerror(errno));
+#endif
+}
+
+void GuardMemoryPages(void* base, std::size_t size) noexcept {
+#ifdef _WIN32
+    // Decommitting leaves the range reserved but inaccessible, and stops it counting as committed
+    const BOOL ret = VirtualFree(base, size, MEM_DECOMMIT);
+    ASSERT(ret);
+#else
+    const int ret = mprotect(base, size, PROT_NONE);
+    ASSERT_MSG(ret == 0, "mprotect failed: {}", strerror(errno));
 #endif
 }
 
@@ -10,6 +10,10 @@ namespace Common {
 void* AllocateMemoryPages(std::size_t size) noexcept;
 void FreeMemoryPages(void* base, std::size_t size) noexcept;
 
+/// Makes pages of an allocation inaccessible, so any access to them faults.
+/// Both base and size have to be multiples of the host page size.
+void GuardMemoryPages(void* base, std::size_t size) noexcept;
+
 template <typename T>
 class VirtualBuffer final {
 public:
@@ -5,6 +5,8 @@
 #include <mutex>
 #include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #ifdef _WIN32
 #include "common/windows/timer_resolution.h"
@@ -21,6 +23,8 @@
 namespace Core::Timing {
 
 constexpr s64 MAX_SLICE_LENGTH = 10000;
+/// Queues smaller than this are not worth compacting, their stale events are dropped on pop.
+constexpr size_t MIN_COMPACTION_SIZE = 64;
 
 std::shared_ptr<EventType> CreateEvent(std::string name, TimedCallback&& callback) {
     return std::make_shared<EventType>(std::move(callback), std::move(name));
@@ -31,23 +35,100 @@ struct CoreTiming::Event {
     u64 fifo_order;
     std::weak_ptr<EventType> type;
     s64 reschedule_time;
-    heap_t::handle_type handle{};
+    size_t sequence_number;
+
+    /// Pairing heap links, sibling also links the events in the scheduled events list.
+    Event* child{};
+    Event* sibling{};
 
     // Sort by time, unless the times are the same, in which case sort by
     // the order added to the queue
-    friend bool operator>(const Event& left, const Event& right) {
-        return std::tie(left.time, left.fifo_order) > std::tie(right.time, right.fifo_order);
-    }
-
     friend bool operator<(const Event& left, const Event& right) {
         return std::tie(left.time, left.fifo_order) < std::tie(right.time, right.fifo_order);
     }
+
+    /// Melds two pairing heaps, their roots must not have siblings.
+    static Event* Meld(Event* left, Event* right) {
+        if (!left) {
+            return right;
+        }
+        if (!right) {
+            return left;
+        }
+        if (*right < *left) {
+            std::swap(left, right);
+        }
+        right->sibling = left->child;
+        left->child = right;
+        return left;
+    }
+
+    /// Two pass merge of the children of a popped root.
+    static Event* MergePairs(Event* first) {
+        // Meld siblings in pairs from left to right, keeping the results in reverse order
+        Event* pairs{};
+        while (first) {
+            Event* const left{first};
+            Event* const right{first->sibling};
+            if (!right) {
+                left->sibling = pairs;
+                pairs = left;
+                break;
+            }
+            first = right->sibling;
+            left->sibling = nullptr;
+            right->sibling = nullptr;
+            Event* const melded{Meld(left, right)};
+            melded->sibling = pairs;
+            pairs = melded;
+        }
+        // Meld the pairs from right to left
+        Event* root{};
+        while (pairs) {
+            Event* const next{pairs->sibling};
+            pairs->sibling = nullptr;
+            root = Meld(root, pairs);
+            pairs = next;
+        }
+        return root;
+    }
+
+    /// Calls func on every event of the heap, func may delete the event it is given.
+    template <typename Func>
+    static void ForEach(Event* root, Func&& func) {
+        std::vector<Event*> pending;
+        if (root) {
+            pending.push_back(root);
+        }
+        while (!pending.empty()) {
+            Event* const node{pending.back()};
+            pending.pop_back();
+            if (node->child) {
+                pending.push_back(node->child);
+            }
+            if (node->sibling) {
+                pending.push_back(node->sibling);
+            }
+            func(node);
+        }
+    }
+
+    static void DeleteHeap(Event* root) {
+        ForEach(root, [](Event* node) { delete node; });
+    }
+
+    /// Whether the event type was unscheduled or destroyed after this event was scheduled.
+    bool IsStale() const {
+        const auto event_type{type.lock()};
+        return !event_type || sequence_number != event_type->sequence_number;
+    }
 };
 
 CoreTiming::CoreTiming() : clock{Common::CreateOptimalClock()} {}
 
 CoreTiming::~CoreTiming() {
     Reset();
+    DeleteEvents();
 }
 
 void CoreTiming::ThreadEntry(CoreTiming& instance) {
@@ -73,7 +154,7 @@ void CoreTiming::Initialize(std::function<void()>&& on_thread_init_) {
 
 void CoreTiming::ClearPendingEvents() {
     std::scoped_lock lock{advance_lock, basic_lock};
-    event_queue.clear();
+    DeleteEvents();
     event.Set();
 }
 
@@ -112,18 +193,18 @@ bool CoreTiming::IsRunning() const {
 
 bool CoreTiming::HasPendingEvents() const {
     std::scoped_lock lock{basic_lock};
-    return !(wait_set && event_queue.empty());
+    return !(wait_set && !event_queue && !scheduled_events.load(std::memory_order_acquire));
+}
+
+size_t CoreTiming::GetQueuedEventCount() const {
+    std::scoped_lock lock{basic_lock};
+    return num_queued_events;
 }
 
 void CoreTiming::ScheduleEvent(std::chrono::nanoseconds ns_into_future,
                                const std::shared_ptr<EventType>& event_type, bool absolute_time) {
-    {
-        std::scoped_lock scope{basic_lock};
-        const auto next_time{absolute_time ? ns_into_future : GetGlobalTimeNs() + ns_into_future};
-
-        auto h{event_queue.emplace(Event{next_time.count(), event_fifo_id++, event_type, 0})};
-        (*h).handle = h;
-    }
+    const auto next_time{absolute_time ? ns_into_future : GetGlobalTimeNs() + ns_into_future};
+    PushScheduledEvent(next_time.count(), event_type, 0);
 
     event.Set();
 }
@@ -132,37 +213,18 @@ void CoreTiming::ScheduleLoopingEvent(std::chrono::nanoseconds start_time,
                                       std::chrono::nanoseconds resched_time,
                                       const std::shared_ptr<EventType>& event_type,
                                       bool absolute_time) {
-    {
-        std::scoped_lock scope{basic_lock};
-        const auto next_time{absolute_time ? start_time : GetGlobalTimeNs() + start_time};
-
-        auto h{event_queue.emplace(
-            Event{next_time.count(), event_fifo_id++, event_type, resched_time.count()})};
-        (*h).handle = h;
-    }
+    const auto next_time{absolute_time ? start_time : GetGlobalTimeNs() + start_time};
+    PushScheduledEvent(next_time.count(), event_type, resched_time.count());
 
     event.Set();
 }
 
 void CoreTiming::UnscheduleEvent(const std::shared_ptr<EventType>& event_type,
                                  UnscheduleEventType type) {
-    {
-        std::scoped_lock lk{basic_lock};
-
-        std::vector<heap_t::handle_type> to_remove;
-        for (auto itr = event_queue.begin(); itr != event_queue.end(); itr++) {
-            const Event& e = *itr;
-            if (e.type.lock().get() == event_type.get()) {
-                to_remove.push_back(itr->handle);
-            }
-        }
-
-        for (auto& h : to_remove) {
-            event_queue.erase(h);
-        }
-
-        event_type->sequence_number++;
-    }
+    // Pending events of this type are now stale. The timer drops them when they reach the front
+    // of the queue or when it compacts the queue, so there is no need to wake it up here.
+    event_type->sequence_number.fetch_add(1, std::memory_order_acq_rel);
+    num_unscheduled.fetch_add(1, std::memory_order_relaxed);
 
     // Force any in-progress events to finish
     if (type == UnscheduleEventType::Wait) {
@@ -170,6 +232,78 @@ void CoreTiming::UnscheduleEvent(const std::shared_ptr<EventType>& event_type,
     }
 }
 
+void CoreTiming::PushScheduledEvent(s64 time, const std::shared_ptr<EventType>& event_type,
+                                    s64 reschedule_time) {
+    Event* const new_event{new Event{
+        .time = time,
+        .fifo_order = event_fifo_id.fetch_add(1, std::memory_order_relaxed),
+        .type = event_type,
+        .reschedule_time = reschedule_time,
+        .sequence_number = event_type->sequence_number.load(std::memory_order_acquire),
+    }};
+    Event* head{scheduled_events.load(std::memory_order_relaxed)};
+    do {
+        new_event->sibling = head;
+    } while (!scheduled_events.compare_exchange_weak(head, new_event, std::memory_order_release,
+                                                     std::memory_order_relaxed));
+}
+
+void CoreTiming::MergeScheduledEvents() {
+    Event* scheduled{scheduled_events.exchange(nullptr, std::memory_order_acquire)};
+    while (scheduled) {
+        Event* const next{scheduled->sibling};
+        InsertEvent(scheduled);
+        scheduled = next;
+    }
+}
+
+void CoreTiming::InsertEvent(Event* new_event) {
+    new_event->child = nullptr;
+    new_event->sibling = nullptr;
+    event_queue = Event::Meld(event_queue, new_event);
+    ++num_queued_events;
+}
+
+void CoreTiming::PopEvent() {
+    event_queue = Event::MergePairs(event_queue->child);
+    --num_queued_events;
+}
+
+void CoreTiming::CompactEvents() {
+    // An unschedule usually makes a single event stale, waiting until they could make up half of
+    // the queue keeps the cost of the rebuild constant per unschedule.
+    if (num_queued_events < MIN_COMPACTION_SIZE ||
+        num_unscheduled.load(std::memory_order_relaxed) * 2 < num_queued_events) {
+        return;
+    }
+    num_unscheduled.store(0, std::memory_order_relaxed);
+
+    std::vector<Event*> live_events;
+    live_events.reserve(num_queued_events);
+    Event::ForEach(event_queue, [&live_events](Event* node) {
+        if (node->IsStale()) {
+            delete node;
+        } else {
+            live_events.push_back(node);
+        }
+    });
+    event_queue = nullptr;
+    num_queued_events = 0;
+    for (Event* const live_event : live_events) {
+        InsertEvent(live_event);
+    }
+}
+
+void CoreTiming::DeleteEvents() {
+    Event::DeleteHeap(event_queue);
+    event_queue = nullptr;
+    num_queued_events = 0;
+    Event* scheduled{scheduled_events.exchange(nullptr, std::memory_order_acquire)};
+    while (scheduled) {
+        delete std::exchange(scheduled, scheduled->sibling);
+    }
+}
+
 void CoreTiming::AddTicks(u64 ticks_to_add) {
     cpu_ticks += ticks_to_add;
     downcount -= static_cast<s64>(cpu_ticks);
@@ -200,57 +334,57 @@ u64 CoreTiming::GetGPUTicks() const {
 std::optional<s64> CoreTiming::Advance() {
     std::scoped_lock lock{advance_lock, basic_lock};
     global_timer = GetGlobalTimeNs().count();
+    MergeScheduledEvents();
+    CompactEvents();
+
+    while (Event* const evt = event_queue) {
+        const auto event_type{evt->type.lock()};
+        if (!event_type || evt->sequence_number != event_type->sequence_number) {
+            // Unscheduled after it was scheduled
+            PopEvent();
+            delete evt;
+            continue;
+        }
+        if (evt->time > global_timer) {
+            break;
+        }
+        PopEvent();
 
-    while (!event_queue.empty() && event_queue.top().time <= global_timer) {
-        const Event& evt = event_queue.top();
-
-        if (const auto event_type{evt.type.lock()}) {
-            const auto evt_time = evt.time;
-            const auto evt_sequence_num = event_type->sequence_number;
-
-            if (evt.reschedule_time == 0) {
-                event_queue.pop();
-
-                basic_lock.unlock();
-
-                event_type->callback(
-                    evt_time, std::chrono::nanoseconds{GetGlobalTimeNs().count() - evt_time});
-
-                basic_lock.lock();
-            } else {
-                basic_lock.unlock();
-
-                const auto new_schedule_time{event_type->callback(
-                    evt_time, std::chrono::nanoseconds{GetGlobalTimeNs().count() - evt_time})};
-
-                basic_lock.lock();
+        const auto evt_time = evt->time;
+        basic_lock.unlock();
 
-                if (evt_sequence_num != event_type->sequence_number) {
-                    // Heap handle is invalidated after external modification.
-                    continue;
-                }
+        const auto new_schedule_time{event_type->callback(
+            evt_time, std::chrono::nanoseconds{GetGlobalTimeNs().count() - evt_time})};
 
-                const auto next_schedule_time{new_schedule_time.has_value()
-                                                  ? new_schedule_time.value().count()
-                                                  : evt.reschedule_time};
+        basic_lock.lock();
 
-                // If this event was scheduled into a pause, its time now is going to be way
-                // behind. Re-set this event to continue from the end of the pause.
-                auto next_time{evt.time + next_schedule_time};
-                if (evt.time < pause_end_time) {
-                    next_time = pause_end_time + next_schedule_time;
-                }
+        if (evt->reschedule_time == 0 || evt->sequence_number != event_type->sequence_number) {
+            delete evt;
+        } else {
+            const auto next_schedule_time{new_schedule_time.has_value()
+                                              ? new_schedule_time.value().count()
+                                              : evt->reschedule_time};
 
-                event_queue.update(evt.handle, Event{next_time, event_fifo_id++, evt.type,
-                                                     next_schedule_time, evt.handle});
+            // If this event was scheduled into a pause, its time now is going to be way
+            // behind. Re-set this event to continue from the end of the pause.
+            auto next_time{evt->time + next_schedule_time};
+            if (evt->time < pause_end_time) {
+                next_time = pause_end_time + next_schedule_time;
             }
+
+            evt->time = next_time;
+            evt->fifo_order = event_fifo_id.fetch_add(1, std::memory_order_relaxed);
+            evt->reschedule_time = next_schedule_time;
+            InsertEvent(evt);
         }
 
+        // Pick up the events scheduled by the callback
+        MergeScheduledEvents();
         global_timer = GetGlobalTimeNs().count();
     }
 
-    if (!event_queue.empty()) {
-        return event_queue.top().time;
+    if (event_queue) {
+        return event_queue->time;
     } else {
         return std::nullopt;
     }
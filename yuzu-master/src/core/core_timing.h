@@ -12,8 +12,6 @@
 #include <string>
 #include <thread>
 
-#include <boost/heap/fibonacci_heap.hpp>
-
 #include "common/common_types.h"
 #include "common/thread.h"
 #include "common/wall_clock.h"
@@ -34,8 +32,8 @@ struct EventType {
     /// A pointer to the name of the event.
     const std::string name;
     /// A monotonic sequence number, incremented when this event is
-    /// changed externally.
-    size_t sequence_number;
+    /// changed externally. Scheduled events with an older sequence number are discarded.
+    std::atomic<size_t> sequence_number;
 };
 
 enum class UnscheduleEventType {
@@ -47,6 +45,12 @@ enum class UnscheduleEventType {
  * This is a system to schedule events into the emulated machine's future. Time is measured
  * in main CPU clock cycles.
  *
+ * Scheduling and unscheduling never wait for the timer. New events are pushed to a lock-free
+ * list that the timer merges into its queue, and unscheduling only bumps the sequence number of
+ * the event type, so its pending events are dropped when they reach the front of the queue. Once
+ * enough events were unscheduled, the timer also compacts its queue to drop the stale events
+ * that are still far in the future.
+ *
  * To schedule an event, you first have to register its type. This is where you pass in the
  * callback. You then schedule events using the type ID you get back.
  *
@@ -95,6 +99,9 @@ public:
     /// Checks if there are any pending time events.
     bool HasPendingEvents() const;
 
+    /// Returns the number of events in the timer queue, including unscheduled ones not yet dropped.
+    size_t GetQueuedEventCount() const;
+
     /// Schedules an event in core timing
     void ScheduleEvent(std::chrono::nanoseconds ns_into_future,
                        const std::shared_ptr<EventType>& event_type, bool absolute_time = false);
@@ -146,6 +153,19 @@ private:
 
     void Reset();
 
+    /// Creates an event and pushes it to the scheduled events list, safe from any thread.
+    void PushScheduledEvent(s64 time, const std::shared_ptr<EventType>& event_type,
+                            s64 reschedule_time);
+
+    /// Moves the events scheduled since the last call into the event queue.
+    void MergeScheduledEvents();
+
+    void InsertEvent(Event* new_event);
+    void PopEvent();
+    /// Rebuilds the event queue without its stale events once enough events were unscheduled.
+    void CompactEvents();
+    void DeleteEvents();
+
     std::unique_ptr<Common::WallClock> clock;
 
     s64 global_timer = 0;
@@ -154,11 +174,15 @@ private:
     s64 timer_resolution_ns;
 #endif
 
-    using heap_t =
-        boost::heap::fibonacci_heap<CoreTiming::Event, boost::heap::compare<std::greater<>>>;
-
-    heap_t event_queue;
-    u64 event_fifo_id = 0;
+    /// Root of a pairing heap with the earliest event on top, owned by the timer.
+    Event* event_queue{};
+    /// Lock-free list of events scheduled since the timer last merged them.
+    std::atomic<Event*> scheduled_events{};
+    /// Number of events in the event queue, including stale ones.
+    size_t num_queued_events{};
+    /// Number of unschedules since the event queue was last compacted.
+    std::atomic<size_t> num_unscheduled{};
+    std::atomic<u64> event_fifo_id{};
 
     Common::Event event{};
     Common::Event pause_event{};
@@ -0,0 +1,391 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef ARCHITECTURE_x86_64
+#include <immintrin.h>
+#elif defined(ARCHITECTURE_arm64)
+#include <arm_neon.h>
+#endif
+
+#include "common/assert.h"
+#include "common/common_funcs.h"
+#include "common/swap.h"
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+#include "core/crypto/aes_hw.h"
+
+#if defined(ARCHITECTURE_arm64) && (defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO))
+#define HAS_ARM_CRYPTO_EXTENSION
+#endif
+
+namespace Core::Crypto::AesHw {
+namespace {
+using Block = std::array<u8, BlockSize>;
+
+/// Blocks kept in flight by the kernels, enough to cover the latency of the round instructions.
+constexpr std::size_t ParallelBlocks = 8;
+
+using BlocksFunction = void (*)(const KeySchedule& key, const u8* src, u8* dest,
+                                std::size_t num_blocks);
+
+constexpr u8 GaloisMultiply(u8 a, u8 b) {
+    u8 result = 0;
+    while (b != 0) {
+        if ((b & 1) != 0) {
+            result ^= a;
+        }
+        a = static_cast<u8>((a << 1) ^ ((a & 0x80) != 0 ? 0x1B : 0));
+        b >>= 1;
+    }
+    return result;
+}
+
+constexpr std::array<u8, 256> MakeSubstitutionBox() {
+    // Powers of the generator 3 give the multiplicative inverses, as 3^i * 3^(255-i) = 1
+    std::array<u8, 255> powers{};
+    std::array<u8, 256> logarithms{};
+    u8 power = 1;
+    for (u32 i = 0; i < 255; ++i) {
+        powers[i] = power;
+        logarithms[power] = static_cast<u8>(i);
+        power = GaloisMultiply(power, 3);
+    }
+    std::array<u8, 256> sbox{};
+    for (u32 value = 0; value < 256; ++value) {
+        // Zero has no inverse and maps to itself
+        const u8 inverse = value == 0 ? 0 : powers[(255 - logarithms[value]) % 255];
+        // Affine transformation
+        u8 result = 0x63;
+        for (u32 bit = 0; bit < 5; ++bit) {
+            result ^= static_cast<u8>((inverse << bit) | (inverse >> (8 - bit)));
+        }
+        sbox[value] = result;
+    }
+    return sbox;
+}
+
+constexpr std::array<u8, 256> SBOX = MakeSubstitutionBox();
+static_assert(SBOX[0x00] == 0x63 && SBOX[0x53] == 0xED && SBOX[0xFF] == 0x16);
+
+Block InverseMixColumns(const Block& block) {
+    Block result;
+    for (std::size_t column = 0; column < 4; ++column) {
+        const u8* const in = &block[column * 4];
+        u8* const out = &result[column * 4];
+        for (std::size_t row = 0; row < 4; ++row) {
+            out[row] = GaloisMultiply(in[row], 0x0E) ^ GaloisMultiply(in[(row + 1) % 4], 0x0B) ^
+                       GaloisMultiply(in[(row + 2) % 4], 0x0D) ^
+                       GaloisMultiply(in[(row + 3) % 4], 0x09);
+        }
+    }
+    return result;
+}
+
+/// Multiplies an XTS tweak by the primitive element of GF(2^128), little endian convention.
+void NextTweak(u64& low, u64& high) {
+    const u64 carry = (high >> 63) * 0x87;
+    high = (high << 1) | (low >> 63);
+    low = (low << 1) ^ carry;
+}
+
+void XorBlocks(u8* dest, const u8* a, const u8* b, std::size_t size) {
+    for (std::size_t i = 0; i < size; i += sizeof(u64)) {
+        u64 lhs;
+        u64 rhs;
+        std::memcpy(&lhs, a + i, sizeof(lhs));
+        std::memcpy(&rhs, b + i, sizeof(rhs));
+        lhs ^= rhs;
+        std::memcpy(dest + i, &lhs, sizeof(lhs));
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+TARGET_ISA("aes")
+void EncryptBlocksAesNi(const KeySchedule& key, const u8* src, u8* dest, std::size_t num_blocks) {
+    __m128i round_keys[Rounds + 1];
+    for (std::size_t round = 0; round <= Rounds; ++round) {
+        round_keys[round] =
+            _mm_load_si128(reinterpret_cast<const __m128i*>(key.round_keys[round].data()));
+    }
+    const auto* const in = reinterpret_cast<const __m128i*>(src);
+    auto* const out = reinterpret_cast<__m128i*>(dest);
+    std::size_t block = 0;
+    for (; block + ParallelBlocks <= num_blocks; block += ParallelBlocks) {
+        __m128i state[ParallelBlocks];
+        for (std::size_t i = 0; i < ParallelBlocks; ++i) {
+            state[i] = _mm_xor_si128(_mm_loadu_si128(in + block + i), round_keys[0]);
+        }
+        for (std::size_t round = 1; round < Rounds; ++round) {
+            for (std::size_t i = 0; i < ParallelBlocks; ++i) {
+                state[i] = _mm_aesenc_si128(state[i], round_keys[round]);
+            }
+        }
+        for (std::size_t i = 0; i < ParallelBlocks; ++i) {
+            _mm_storeu_si128(out + block + i, _mm_aesenclast_si128(state[i], round_keys[Rounds]));
+        }
+    }
+    for (; block < num_blocks; ++block) {
+        __m128i state = _mm_xor_si128(_mm_loadu_si128(in + block), round_keys[0]);
+        for (std::size_t round = 1; round < Rounds; ++round) {
+            state = _mm_aesenc_si128(state, round_keys[round]);
+        }
+        _mm_storeu_si128(out + block, _mm_aesenclast_si128(state, round_keys[Rounds]));
+    }
+}
+
+TARGET_ISA("aes")
+void DecryptBlocksAesNi(const KeySchedule& key, const u8* src, u8* dest, std::size_t num_blocks) {
+    __m128i round_keys[Rounds + 1];
+    for (std::size_t round = 0; round <= Rounds; ++round) {
+        round_keys[round] =
+            _mm_load_si128(reinterpret_cast<const __m128i*>(key.round_keys[round].data()));
+    }
+    const auto* const in = reinterpret_cast<const __m128i*>(src);
+    auto* const out = reinterpret_cast<__m128i*>(dest);
+    std::size_t block = 0;
+    for (; block + ParallelBlocks <= num_blocks; block += ParallelBlocks) {
+        __m128i state[ParallelBlocks];
+        for (std::size_t i = 0; i < ParallelBlocks; ++i) {
+            state[i] = _mm_xor_si128(_mm_loadu_si128(in + block + i), round_keys[0]);
+        }
+        for (std::size_t round = 1; round < Rounds; ++round) {
+            for (std::size_t i = 0; i < ParallelBlocks; ++i) {
+                state[i] = _mm_aesdec_si128(state[i], round_keys[round]);
+            }
+        }
+        for (std::size_t i = 0; i < ParallelBlocks; ++i) {
+            _mm_storeu_si128(out + block + i, _mm_aesdeclast_si128(state[i], round_keys[Rounds]));
+        }
+    }
+    for (; block < num_blocks; ++block) {
+        __m128i state = _mm_xor_si128(_mm_loadu_si128(in + block), round_keys[0]);
+        for (std::size_t round = 1; round < Rounds; ++round) {
+            state = _mm_aesdec_si128(state, round_keys[round]);
+        }
+        _mm_storeu_si128(out + block, _mm_aesdeclast_si128(state, round_keys[Rounds]));
+    }
+}
+#endif
+
+#ifdef HAS_ARM_CRYPTO_EXTENSION
+void EncryptBlocksArmCrypto(const KeySchedule& key, const u8* src, u8* dest,
+                            std::size_t num_blocks) {
+    uint8x16_t round_keys[Rounds + 1];
+    for (std::size_t round = 0; round <= Rounds; ++round) {
+        round_keys[round] = vld1q_u8(key.round_keys[round].data());
+    }
+    std::size_t block = 0;
+    for (; block + ParallelBlocks <= num_blocks; block += ParallelBlocks) {
+        uint8x16_t state[ParallelBlocks];
+        for (std::size_t i = 0; i < ParallelBlocks; ++i) {
+            state[i] = vld1q_u8(src + (block + i) * BlockSize);
+        }
+        for (std::size_t round = 0; round < Rounds - 1; ++round) {
+            for (std::size_t i = 0; i < ParallelBlocks; ++i) {
+                state[i] = vaesmcq_u8(vaeseq_u8(state[i], round_keys[round]));
+            }
+        }
+        for (std::size_t i = 0; i < ParallelBlocks; ++i) {
+            state[i] = veorq_u8(vaeseq_u8(state[i], round_keys[Rounds - 1]), round_keys[Rounds]);
+            vst1q_u8(dest + (block + i) * BlockSize, state[i]);
+        }
+    }
+    for (; block < num_blocks; ++block) {
+        uint8x16_t state = vld1q_u8(src + block * BlockSize);
+        for (std::size_t round = 0; round < Rounds - 1; ++round) {
+            state = vaesmcq_u8(vaeseq_u8(state, round_keys[round]));
+        }
+        state = veorq_u8(vaeseq_u8(state, round_keys[Rounds - 1]), round_keys[Rounds]);
+        vst1q_u8(dest + block * BlockSize, state);
+    }
+}
+
+void DecryptBlocksArmCrypto(const KeySchedule& key, const u8* src, u8* dest,
+                            std::size_t num_blocks) {
+    uint8x16_t round_keys[Rounds + 1];
+    for (std::size_t round = 0; round <= Rounds; ++round) {
+        round_keys[round] = vld1q_u8(key.round_keys[round].data());
+    }
+    std::size_t block = 0;
+    for (; block + ParallelBlocks <= num_blocks; block += ParallelBlocks) {
+        uint8x16_t state[ParallelBlocks];
+        for (std::size_t i = 0; i < ParallelBlocks; ++i) {
+            state[i] = vld1q_u8(src + (block + i) * BlockSize);
+        }
+        for (std::size_t round = 0; round < Rounds - 1; ++round) {
+            for (std::size_t i = 0; i < ParallelBlocks; ++i) {
+                state[i] = vaesimcq_u8(vaesdq_u8(state[i], round_keys[round]));
+            }
+        }
+        for (std::size_t i = 0; i < ParallelBlocks; ++i) {
+            state[i] = veorq_u8(vaesdq_u8(state[i], round_keys[Rounds - 1]), round_keys[Rounds]);
+            vst1q_u8(dest + (block + i) * BlockSize, state[i]);
+        }
+    }
+    for (; block < num_blocks; ++block) {
+        uint8x16_t state = vld1q_u8(src + block * BlockSize);
+        for (std::size_t round = 0; round < Rounds - 1; ++round) {
+            state = vaesimcq_u8(vaesdq_u8(state, round_keys[round]));
+        }
+        state = veorq_u8(vaesdq_u8(state, round_keys[Rounds - 1]), round_keys[Rounds]);
+        vst1q_u8(dest + block * BlockSize, state);
+    }
+}
+#endif
+
+struct Kernels {
+    BlocksFunction encrypt;
+    BlocksFunction decrypt;
+};
+
+Kernels GetKernels() {
+    static const Kernels kernels = []() -> Kernels {
+#if defined(ARCHITECTURE_x86_64)
+        if (Common::GetCPUCaps().aes) {
+            return {EncryptBlocksAesNi, DecryptBlocksAesNi};
+        }
+#elif defined(HAS_ARM_CRYPTO_EXTENSION)
+        return {EncryptBlocksArmCrypto, DecryptBlocksArmCrypto};
+#endif
+        return {nullptr, nullptr};
+    }();
+    return kernels;
+}
+} // Anonymous namespace
+
+bool IsSupported() {
+    return GetKernels().encrypt != nullptr;
+}
+
+void ExpandKey(const u8* key, KeySchedule& encrypt, KeySchedule& decrypt) {
+    static constexpr std::array<u8, Rounds> round_constants{0x01, 0x02, 0x04, 0x08, 0x10,
+                                                            0x20, 0x40, 0x80, 0x1B, 0x36};
+    auto& round_keys = encrypt.round_keys;
+    std::memcpy(round_keys[0].data(), key, KeySize);
+    for (std::size_t round = 1; round <= Rounds; ++round) {
+        const Block& previous = round_keys[round - 1];
+        Block& current = round_keys[round];
+        // RotWord and SubWord of the last word of the previous round key
+        current[0] = previous[0] ^ SBOX[previous[13]] ^ round_constants[round - 1];
+        current[1] = previous[1] ^ SBOX[previous[14]];
+        current[2] = previous[2] ^ SBOX[previous[15]];
+        current[3] = previous[3] ^ SBOX[previous[12]];
+        for (std::size_t i = 4; i < BlockSize; ++i) {
+            current[i] = previous[i] ^ current[i - 4];
+        }
+    }
+
+    // Equivalent inverse cipher: reversed round keys with InvMixColumns applied to the inner ones
+    decrypt.round_keys[0] = round_keys[Rounds];
+    for (std::size_t round = 1; round < Rounds; ++round) {
+        decrypt.round_keys[round] = InverseMixColumns(round_keys[Rounds - round]);
+    }
+    decrypt.round_keys[Rounds] = round_keys[0];
+}
+
+void CtrTranscode(const KeySchedule& key, std::array<u8, BlockSize>& counter, const u8* src,
+                  u8* dest, std::size_t size) {
+    const BlocksFunction encrypt = GetKernels().encrypt;
+    ASSERT(encrypt != nullptr);
+
+    u64 high;
+    u64 low;
+    std::memcpy(&high, counter.data(), sizeof(high));
+    std::memcpy(&low, counter.data() + sizeof(high), sizeof(low));
+    high = Common::swap64(high);
+    low = Common::swap64(low);
+
+    alignas(16) std::array<u8, ParallelBlocks * BlockSize> keystream;
+    for (std::size_t offset = 0; offset < size; offset += keystream.size()) {
+        const std::size_t length = std::min(keystream.size(), size - offset);
+        const std::size_t num_blocks = (length + BlockSize - 1) / BlockSize;
+        for (std::size_t block = 0; block < num_blocks; ++block) {
+            const u64 high_be = Common::swap64(high);
+            const u64 low_be = Common::swap64(low);
+            std::memcpy(&keystream[block * BlockSize], &high_be, sizeof(high_be));
+            std::memcpy(&keystream[block * BlockSize + sizeof(high_be)], &low_be, sizeof(low_be));
+            high += ++low == 0 ? 1 : 0;
+        }
+        encrypt(key, keystream.data(), keystream.data(), num_blocks);
+
+        const std::size_t aligned_length = length & ~(BlockSize - 1);
+        XorBlocks(dest + offset, src + offset, keystream.data(), aligned_length);
+        for (std::size_t i = aligned_length; i < length; ++i) {
+            dest[offset + i] = src[offset + i] ^ keystream[i];
+        }
+    }
+
+    high = Common::swap64(high);
+    low = Common::swap64(low);
+    std::memcpy(counter.data(), &high, sizeof(high));
+    std::memcpy(counter.data() + sizeof(high), &low, sizeof(low));
+}
+
+void XtsTranscode(const KeySchedule& data_key, const KeySchedule& tweak_key,
+                  const std::array<u8, BlockSize>& tweak, const u8* src, u8* dest,
+                  std::size_t size, bool encrypt) {
+    const Kernels kernels = GetKernels();
+    ASSERT(kernels.encrypt != nullptr);
+    ASSERT(size >= BlockSize);
+    const BlocksFunction transcode = encrypt ? kernels.encrypt : kernels.decrypt;
+
+    alignas(16) Block encrypted_tweak;
+    kernels.encrypt(tweak_key, tweak.data(), encrypted_tweak.data(), 1);
+    u64 low;
+    u64 high;
+    std::memcpy(&low, encrypted_tweak.data(), sizeof(low));
+    std::memcpy(&high, encrypted_tweak.data() + sizeof(low), sizeof(high));
+
+    // With ciphertext stealing the last full block is handled together with the partial one
+    const std::size_t leftover = size % BlockSize;
+    const std::size_t num_blocks = size / BlockSize - (leftover != 0 ? 1 : 0);
+
+    alignas(16) std::array<u8, ParallelBlocks * BlockSize> tweaks;
+    alignas(16) std::array<u8, ParallelBlocks * BlockSize> buffer;
+    for (std::size_t block = 0; block < num_blocks; block += ParallelBlocks) {
+        const std::size_t count = std::min(ParallelBlocks, num_blocks - block);
+        const std::size_t length = count * BlockSize;
+        for (std::size_t i = 0; i < count; ++i) {
+            std::memcpy(&tweaks[i * BlockSize], &low, sizeof(low));
+            std::memcpy(&tweaks[i * BlockSize + sizeof(low)], &high, sizeof(high));
+            NextTweak(low, high);
+        }
+        XorBlocks(buffer.data(), src + block * BlockSize, tweaks.data(), length);
+        transcode(data_key, buffer.data(), buffer.data(), count);
+        XorBlocks(dest + block * BlockSize, buffer.data(), tweaks.data(), length);
+    }
+    if (leftover == 0) {
+        return;
+    }
+
+    // Ciphertext stealing, decryption consumes the two remaining tweaks in reverse order
+    const std::size_t offset = num_blocks * BlockSize;
+    alignas(16) std::array<Block, 2> final_tweaks;
+    std::memcpy(final_tweaks[0].data(), &low, sizeof(low));
+    std::memcpy(final_tweaks[0].data() + sizeof(low), &high, sizeof(high));
+    NextTweak(low, high);
+    std::memcpy(final_tweaks[1].data(), &low, sizeof(low));
+    std::memcpy(final_tweaks[1].data() + sizeof(low), &high, sizeof(high));
+    const Block& first_tweak = final_tweaks[encrypt ? 0 : 1];
+    const Block& second_tweak = final_tweaks[encrypt ? 1 : 0];
+
+    alignas(16) Block block;
+    XorBlocks(block.data(), src + offset, first_tweak.data(), BlockSize);
+    transcode(data_key, block.data(), block.data(), 1);
+    XorBlocks(block.data(), block.data(), first_tweak.data(), BlockSize);
+
+    // Steal the tail of the transcoded block to pad the partial one
+    alignas(16) Block stolen = block;
+    std::memcpy(stolen.data(), src + offset + BlockSize, leftover);
+    std::memcpy(dest + offset + BlockSize, block.data(), leftover);
+
+    XorBlocks(stolen.data(), stolen.data(), second_tweak.data(), BlockSize);
+    transcode(data_key, stolen.data(), stolen.data(), 1);
+    XorBlocks(dest + offset, stolen.data(), second_tweak.data(), BlockSize);
+}
+
+} // namespace Core::Crypto::AesHw
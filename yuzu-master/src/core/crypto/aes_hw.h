@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+
+// AES-128 CTR and XTS implemented with the host's AES instructions (AES-NI or the ARMv8 crypto
+// extension). Several blocks are kept in flight at once to hide the latency of the round
+// instructions. Used by AESCipher when the host supports it, mbedtls is used otherwise.
+namespace Core::Crypto::AesHw {
+
+constexpr std::size_t BlockSize = 0x10;
+constexpr std::size_t KeySize = 0x10;
+constexpr std::size_t Rounds = 10;
+
+struct KeySchedule {
+    alignas(16) std::array<std::array<u8, BlockSize>, Rounds + 1> round_keys;
+};
+
+/// Returns true when the host has the instructions required by this backend.
+[[nodiscard]] bool IsSupported();
+
+/// Expands a 128-bit key into its encryption and (equivalent inverse cipher) decryption schedules.
+void ExpandKey(const u8* key, KeySchedule& encrypt, KeySchedule& decrypt);
+
+/**
+ * Encrypts or decrypts size bytes in CTR mode. The big endian 128-bit counter is advanced by
+ * one for every started block, like mbedtls does for a reset context.
+ */
+void CtrTranscode(const KeySchedule& key, std::array<u8, BlockSize>& counter, const u8* src,
+                  u8* dest, std::size_t size);
+
+/**
+ * Encrypts or decrypts one XTS data unit of size bytes, using ciphertext stealing for partial
+ * final blocks. The size must be at least one block.
+ */
+void XtsTranscode(const KeySchedule& data_key, const KeySchedule& tweak_key,
+                  const std::array<u8, BlockSize>& tweak, const u8* src, u8* dest,
+                  std::size_t size, bool encrypt);
+
+} // namespace Core::Crypto::AesHw
@@ -2,9 +2,11 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <array>
+#include <cstring>
 #include <mbedtls/cipher.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "core/crypto/aes_hw.h"
 #include "core/crypto/aes_util.h"
 #include "core/crypto/key_manager.h"
 
@@ -36,6 +38,15 @@ static_assert(static_cast<std::size_t>(Mode::XTS) ==
 struct CipherContext {
     mbedtls_cipher_context_t encryption_context;
     mbedtls_cipher_context_t decryption_context;
+
+    // CTR and XTS use the host's AES instructions when available. Like the mbedtls contexts,
+    // encryption and decryption keep separate IVs.
+    bool use_hardware;
+    Mode mode;
+    AesHw::KeySchedule encryption_key;
+    AesHw::KeySchedule decryption_key;
+    AesHw::KeySchedule tweak_key;
+    std::array<std::array<u8, AesHw::BlockSize>, 2> ivs;
 };
 
 template <typename Key, std::size_t KeySize>
@@ -57,6 +68,18 @@ Crypto::AESCipher<Key, KeySize>::AESCipher(Key key, Mode mode)
     ASSERT(
         !mbedtls_cipher_setkey(&ctx->decryption_context, key.data(), KeySize * 8, MBEDTLS_DECRYPT));
     //"Failed to set key on mbedtls ciphers.");
+
+    ctx->mode = mode;
+    ctx->use_hardware = AesHw::IsSupported() &&
+                        ((mode == Mode::CTR && KeySize == AesHw::KeySize) ||
+                         (mode == Mode::XTS && KeySize == AesHw::KeySize * 2));
+    if (ctx->use_hardware) {
+        AesHw::ExpandKey(key.data(), ctx->encryption_key, ctx->decryption_key);
+        if (mode == Mode::XTS) {
+            AesHw::KeySchedule unused_key;
+            AesHw::ExpandKey(key.data() + AesHw::KeySize, ctx->tweak_key, unused_key);
+        }
+    }
 }
 
 template <typename Key, std::size_t KeySize>
@@ -67,6 +90,20 @@ AESCipher<Key, KeySize>::~AESCipher() {
 
 template <typename Key, std::size_t KeySize>
 void AESCipher<Key, KeySize>::Transcode(const u8* src, std::size_t size, u8* dest, Op op) const {
+    if (ctx->use_hardware) {
+        auto& iv = ctx->ivs[static_cast<std::size_t>(op)];
+        if (ctx->mode == Mode::CTR) {
+            AesHw::CtrTranscode(ctx->encryption_key, iv, src, dest, size);
+            return;
+        }
+        if (size >= AesHw::BlockSize) {
+            const bool encrypt = op == Op::Encrypt;
+            AesHw::XtsTranscode(encrypt ? ctx->encryption_key : ctx->decryption_key,
+                                ctx->tweak_key, iv, src, dest, size, encrypt);
+            return;
+        }
+    }
+
     auto* const context = op == Op::Encrypt ? &ctx->encryption_context : &ctx->decryption_context;
 
     mbedtls_cipher_reset(context);
@@ -122,6 +159,13 @@ void AESCipher<Key, KeySize>::SetIV(std::span<const u8> data) {
     ASSERT_MSG((mbedtls_cipher_set_iv(&ctx->encryption_context, data.data(), data.size()) ||
                 mbedtls_cipher_set_iv(&ctx->decryption_context, data.data(), data.size())) == 0,
                "Failed to set IV on mbedtls ciphers.");
+
+    if (ctx->use_hardware) {
+        ASSERT(data.size() == AesHw::BlockSize);
+        for (auto& iv : ctx->ivs) {
+            std::memcpy(iv.data(), data.data(), iv.size());
+        }
+    }
 }
 
 template class AESCipher<Key128>;
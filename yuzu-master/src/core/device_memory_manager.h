@@ -53,6 +53,11 @@ public:
 
     void Unmap(DAddr address, size_t size);
 
+    /// Returns a counter bumped after every change of the device to host memory mappings.
+    u64 MappingGeneration() const {
+        return mapping_generation.load(std::memory_order_acquire);
+    }
+
     void TrackContinuityImpl(DAddr address, VAddr virtual_address, size_t size, Asid asid);
     void TrackContinuity(DAddr address, VAddr virtual_address, size_t size, Asid asid) {
         std::scoped_lock lk(mapping_guard);
@@ -212,6 +217,7 @@ private:
     std::unique_ptr<CachedPages> cached_pages;
     Common::RangeMutex counter_guard;
     std::mutex mapping_guard;
+    std::atomic<u64> mapping_generation{};
 };
 
 } // namespace Core
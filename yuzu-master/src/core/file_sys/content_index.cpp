@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstring>
+#include <utility>
+#include "common/cityhash.h"
+#include "common/common_funcs.h"
+#include "common/swap.h"
+#include "core/file_sys/content_index.h"
+#include "core/file_sys/vfs/vfs.h"
+
+namespace FileSys {
+
+// Bump whenever the index format or what goes into an Entry changes
+constexpr u32 INDEX_VERSION = 1;
+
+struct IndexFileHeader {
+    u32_le magic;
+    u32_le version;
+    u32_le num_entries;
+    INSERT_PADDING_WORDS(1);
+    // CityHash64 of everything after the header
+    u64_le checksum;
+    INSERT_PADDING_WORDS(2);
+};
+static_assert(sizeof(IndexFileHeader) == 0x20, "IndexFileHeader has incorrect size.");
+
+struct IndexFileEntry {
+    NcaID id;
+    u64_le size;
+    u64_le modified;
+    u64_le title_id;
+    u32_le cnmt_size;
+    INSERT_PADDING_WORDS(1);
+};
+static_assert(sizeof(IndexFileEntry) == 0x30, "IndexFileEntry has incorrect size.");
+
+static u64 Checksum(const std::vector<u8>& data) {
+    return Common::CityHash64(reinterpret_cast<const char*>(data.data()) + sizeof(IndexFileHeader),
+                              data.size() - sizeof(IndexFileHeader));
+}
+
+ContentIndex::ContentIndex(VirtualDir dir_) : dir{std::move(dir_)} {}
+
+ContentIndex::~ContentIndex() = default;
+
+void ContentIndex::Load() {
+    entries.clear();
+
+    const auto file = dir->GetFile(FileName);
+    if (file == nullptr) {
+        return;
+    }
+    const auto data = file->ReadAllBytes();
+    IndexFileHeader header{};
+    if (data.size() < sizeof(header)) {
+        return;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != Common::MakeMagic('Y', 'C', 'I', 'X') || header.version != INDEX_VERSION ||
+        header.checksum != Checksum(data)) {
+        return;
+    }
+
+    std::map<NcaID, Entry> loaded;
+    size_t offset = sizeof(header);
+    for (u32 i = 0; i < header.num_entries; ++i) {
+        IndexFileEntry file_entry{};
+        if (data.size() - offset < sizeof(file_entry)) {
+            return;
+        }
+        std::memcpy(&file_entry, data.data() + offset, sizeof(file_entry));
+        offset += sizeof(file_entry);
+        if (data.size() - offset < file_entry.cnmt_size) {
+            return;
+        }
+        const auto cnmt_begin = data.begin() + static_cast<std::ptrdiff_t>(offset);
+        loaded.insert_or_assign(file_entry.id,
+                                Entry{
+                                    .size = file_entry.size,
+                                    .modified = file_entry.modified,
+                                    .title_id = file_entry.title_id,
+                                    .cnmt = {cnmt_begin, cnmt_begin + file_entry.cnmt_size},
+                                });
+        offset += file_entry.cnmt_size;
+    }
+    if (offset != data.size()) {
+        return;
+    }
+    entries = std::move(loaded);
+}
+
+bool ContentIndex::Save() const {
+    std::vector<u8> data(sizeof(IndexFileHeader));
+    for (const auto& [id, entry] : entries) {
+        const IndexFileEntry file_entry{
+            .id = id,
+            .size = entry.size,
+            .modified = entry.modified,
+            .title_id = entry.title_id,
+            .cnmt_size = static_cast<u32>(entry.cnmt.size()),
+        };
+        const auto* const entry_bytes = reinterpret_cast<const u8*>(&file_entry);
+        data.insert(data.end(), entry_bytes, entry_bytes + sizeof(file_entry));
+        data.insert(data.end(), entry.cnmt.begin(), entry.cnmt.end());
+    }
+    const IndexFileHeader header{
+        .magic = Common::MakeMagic('Y', 'C', 'I', 'X'),
+        .version = INDEX_VERSION,
+        .num_entries = static_cast<u32>(entries.size()),
+        .checksum = Checksum(data),
+    };
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    auto file = dir->GetFile(FileName);
+    if (file == nullptr) {
+        file = dir->CreateFile(FileName);
+    }
+    return file != nullptr && file->Resize(data.size()) && file->WriteBytes(data) == data.size();
+}
+
+const ContentIndex::Entry* ContentIndex::Find(const NcaID& id, u64 size, u64 modified) const {
+    const auto it = entries.find(id);
+    if (modified == 0 || it == entries.end() || it->second.size != size ||
+        it->second.modified != modified) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+void ContentIndex::Assign(std::map<NcaID, Entry> entries_) {
+    entries = std::move(entries_);
+}
+
+} // namespace FileSys
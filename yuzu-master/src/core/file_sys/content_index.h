@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <map>
+#include <string_view>
+#include <vector>
+#include "common/common_types.h"
+#include "core/file_sys/vfs/vfs_types.h"
+
+namespace FileSys {
+
+using NcaID = std::array<u8, 0x10>;
+
+// Index of what parsing each NCA of a registered cache revealed. It is kept in a file at the root
+// of the cache so NCAs that didn't change since they were parsed don't have to be parsed again.
+class ContentIndex {
+public:
+    static constexpr std::string_view FileName = "yuzu_content_index.bin";
+
+    struct Entry {
+        // Size and modification time of the NCA file, or of the parts of a split NCA, when it was
+        // parsed. The entry is stale once they don't match anymore.
+        u64 size{};
+        u64 modified{};
+        // Title ID and raw CNMT of meta NCAs, cnmt is empty for every other type of NCA
+        u64 title_id{};
+        std::vector<u8> cnmt;
+    };
+
+    explicit ContentIndex(VirtualDir dir_);
+    ~ContentIndex();
+
+    // Loads the index file of the cache. A missing, outdated or corrupted file leaves the index
+    // empty, so every NCA is parsed again.
+    void Load();
+
+    // Writes the index file of the cache, returns false if it couldn't be written.
+    bool Save() const;
+
+    // Returns the entry of the NCA if it was parsed with the given size and modification time.
+    // A modification time of zero means the filesystem doesn't provide one and never matches.
+    const Entry* Find(const NcaID& id, u64 size, u64 modified) const;
+
+    // Replaces all entries, so NCAs that were removed from the cache are dropped from the index.
+    void Assign(std::map<NcaID, Entry> entries_);
+
+    std::size_t Size() const {
+        return entries.size();
+    }
+
+private:
+    VirtualDir dir;
+    std::map<NcaID, Entry> entries;
+};
+
+} // namespace FileSys
@@ -48,8 +48,15 @@ size_t AesCtrStorage::Read(u8* buffer, size_t size, size_t offset) const {
     ASSERT(Common::IsAligned(offset, BlockSize));
     ASSERT(Common::IsAligned(size, BlockSize));
 
-    // Read the data.
-    m_base_storage->Read(buffer, size, offset);
+    // Decrypt straight out of the base storage when it is mapped, instead of copying first.
+    const std::span<const u8> view = m_base_storage->GetView(size, offset);
+    const u8* source = buffer;
+    if (view.size() == size) {
+        source = view.data();
+    } else {
+        // Read the data.
+        m_base_storage->Read(buffer, size, offset);
+    }
 
     // Setup the counter.
     std::array<u8, IvSize> ctr;
@@ -58,7 +65,7 @@ size_t AesCtrStorage::Read(u8* buffer, size_t size, size_t offset) const {
 
     // Decrypt.
     m_cipher->SetIV(ctr);
-    m_cipher->Transcode(buffer, size, buffer, Core::Crypto::Op::Decrypt);
+    m_cipher->Transcode(source, size, buffer, Core::Crypto::Op::Decrypt);
 
     return size;
 }
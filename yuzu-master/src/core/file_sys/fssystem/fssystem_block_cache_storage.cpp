@@ -0,0 +1,148 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/logging/log.h"
+#include "core/file_sys/fssystem/fssystem_block_cache_storage.h"
+
+namespace FileSys {
+
+BlockCacheBudget::BlockCacheBudget(size_t size) : m_size(size) {}
+
+BlockCacheBudget& BlockCacheBudget::Decrypted() {
+    static BlockCacheBudget budget{BlockCacheStorage::DecryptedBudgetSize};
+    return budget;
+}
+
+bool BlockCacheBudget::TryCharge(size_t size) {
+    size_t used = m_used.load(std::memory_order_relaxed);
+    do {
+        if (used + size > m_size) {
+            return false;
+        }
+    } while (!m_used.compare_exchange_weak(used, used + size, std::memory_order_relaxed));
+    return true;
+}
+
+void BlockCacheBudget::Release(size_t size) {
+    m_used.fetch_sub(size, std::memory_order_relaxed);
+}
+
+BlockCacheStorage::BlockCacheStorage(VirtualFile base, BlockCacheBudget& budget)
+    : m_base_storage(std::move(base)), m_base_size(m_base_storage->GetSize()), m_budget(budget) {}
+
+BlockCacheStorage::~BlockCacheStorage() {
+    // Give the blocks back to the budget for the caches still open.
+    for (const Shard& shard : m_shards) {
+        m_budget.Release(shard.lru.size() * BlockSize);
+    }
+
+    const Statistics stats = this->GetStatistics();
+    if (stats.hits + stats.misses != 0) {
+        LOG_DEBUG(Service_FS, "Block cache hits={} misses={} bypassed={} hit rate={:.1f}%",
+                  stats.hits, stats.misses, stats.bypassed_reads,
+                  100.0 * static_cast<double>(stats.hits) /
+                      static_cast<double>(stats.hits + stats.misses));
+    }
+}
+
+size_t BlockCacheStorage::Read(u8* buffer, size_t size, size_t offset) const {
+    // Allow zero-size reads.
+    if (size == 0 || offset >= m_base_size) {
+        return 0;
+    }
+
+    // Ensure buffer is valid.
+    ASSERT(buffer != nullptr);
+
+    size = std::min(size, m_base_size - offset);
+    if (size >= BypassSize) {
+        ++m_bypassed_reads;
+        return m_base_storage->Read(buffer, size, offset);
+    }
+
+    size_t read = 0;
+    while (read < size) {
+        const size_t cur_offset = offset + read;
+        const size_t block_index = cur_offset / BlockSize;
+        const size_t block_offset = cur_offset % BlockSize;
+        const size_t copy_size = std::min(BlockSize - block_offset, size - read);
+        const size_t copied = this->ReadBlock(buffer + read, block_index, block_offset, copy_size);
+        read += copied;
+        if (copied != copy_size) {
+            break;
+        }
+    }
+    return read;
+}
+
+size_t BlockCacheStorage::ReadBlock(u8* buffer, size_t block_index, size_t block_offset,
+                                    size_t size) const {
+    Shard& shard = m_shards[block_index % ShardCount];
+
+    // Serve the read from the cache if possible.
+    {
+        std::scoped_lock lk{shard.mutex};
+        if (const auto it = shard.entries.find(block_index); it != shard.entries.end()) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            const Entry& entry = *it->second;
+            const size_t copy_size =
+                block_offset < entry.size ? std::min(size, entry.size - block_offset) : 0;
+            std::memcpy(buffer, entry.data.get() + block_offset, copy_size);
+            ++m_hits;
+            return copy_size;
+        }
+    }
+    ++m_misses;
+
+    // Read the whole block outside of the lock, the base storage is the slow part.
+    const size_t block_start = block_index * BlockSize;
+    const size_t block_size = std::min(BlockSize, m_base_size - block_start);
+    auto data = std::make_unique_for_overwrite<u8[]>(BlockSize);
+    const size_t block_read = m_base_storage->Read(data.get(), block_size, block_start);
+    const size_t copy_size =
+        block_offset < block_read ? std::min(size, block_read - block_offset) : 0;
+    std::memcpy(buffer, data.get() + block_offset, copy_size);
+    if (block_read != block_size) {
+        // Don't cache short reads, they are errors from the base storage.
+        return copy_size;
+    }
+
+    std::scoped_lock lk{shard.mutex};
+    if (shard.entries.contains(block_index)) {
+        // Another reader inserted the block while we were reading it.
+        return copy_size;
+    }
+    if (!m_budget.TryCharge(BlockSize)) {
+        if (shard.lru.empty()) {
+            // Other caches hold the whole budget, this block can't be kept.
+            return copy_size;
+        }
+        // Recycle the least recently used block of the shard, its charge goes to the new one.
+        shard.entries.erase(shard.lru.back().block_index);
+        shard.lru.pop_back();
+    }
+    shard.lru.push_front(Entry{
+        .block_index = block_index,
+        .size = block_read,
+        .data = std::move(data),
+    });
+    shard.entries.emplace(block_index, shard.lru.begin());
+    return copy_size;
+}
+
+size_t BlockCacheStorage::GetSize() const {
+    return m_base_size;
+}
+
+BlockCacheStorage::Statistics BlockCacheStorage::GetStatistics() const {
+    return {
+        .hits = m_hits.load(std::memory_order_relaxed),
+        .misses = m_misses.load(std::memory_order_relaxed),
+        .bypassed_reads = m_bypassed_reads.load(std::memory_order_relaxed),
+    };
+}
+
+} // namespace FileSys
@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "core/file_sys/fssystem/fs_i_storage.h"
+
+namespace FileSys {
+
+// Memory budget that block caches charge their blocks against. A single budget is shared by
+// every cache it is given to, however many storages are open at once.
+class BlockCacheBudget {
+    YUZU_NON_COPYABLE(BlockCacheBudget);
+    YUZU_NON_MOVEABLE(BlockCacheBudget);
+
+public:
+    explicit BlockCacheBudget(size_t size);
+
+    // Budget of every cache placed over a decryption layer, NCA section bodies and NAX archives
+    // alike, for the whole process.
+    static BlockCacheBudget& Decrypted();
+
+    // Charges size bytes against the budget, returns false without charging if it is exhausted.
+    bool TryCharge(size_t size);
+    void Release(size_t size);
+
+    size_t GetSize() const {
+        return m_size;
+    }
+
+    size_t GetUsed() const {
+        return m_used.load(std::memory_order_relaxed);
+    }
+
+private:
+    const size_t m_size;
+    std::atomic<size_t> m_used{};
+};
+
+// Read-only cache of fixed size blocks in front of an expensive storage, such as a decryption
+// layer. Blocks are kept in sharded LRU lists so concurrent readers rarely contend on a lock.
+// When the budget is exhausted, a cache recycles the oldest block of the shard it inserts into.
+class BlockCacheStorage : public IReadOnlyStorage {
+    YUZU_NON_COPYABLE(BlockCacheStorage);
+    YUZU_NON_MOVEABLE(BlockCacheStorage);
+
+public:
+    static constexpr size_t BlockSize = 0x4000;
+    static constexpr size_t ShardCount = 8;
+
+    // Size of the budget shared by the caches over decryption layers.
+    static constexpr size_t DecryptedBudgetSize = 0x1000000;
+
+    // Reads this large are sequential streaming reads, they go straight to the base storage
+    // instead of evicting the whole cache.
+    static constexpr size_t BypassSize = 0x40000;
+
+    struct Statistics {
+        u64 hits;
+        u64 misses;
+        u64 bypassed_reads;
+    };
+
+public:
+    BlockCacheStorage(VirtualFile base, BlockCacheBudget& budget);
+    ~BlockCacheStorage() override;
+
+    virtual size_t Read(u8* buffer, size_t size, size_t offset) const override;
+    virtual size_t GetSize() const override;
+
+    Statistics GetStatistics() const;
+
+private:
+    struct Entry {
+        size_t block_index;
+        size_t size;
+        std::unique_ptr<u8[]> data;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<Entry> lru;
+        std::unordered_map<size_t, std::list<Entry>::iterator> entries;
+    };
+
+    size_t ReadBlock(u8* buffer, size_t block_index, size_t block_offset, size_t size) const;
+
+private:
+    VirtualFile m_base_storage;
+    size_t m_base_size;
+    BlockCacheBudget& m_budget;
+    mutable std::array<Shard, ShardCount> m_shards;
+    mutable std::atomic<u64> m_hits{};
+    mutable std::atomic<u64> m_misses{};
+    mutable std::atomic<u64> m_bypassed_reads{};
+};
+
+} // namespace FileSys
@@ -5,6 +5,7 @@
 #include "core/file_sys/fssystem/fssystem_aes_ctr_storage.h"
 #include "core/file_sys/fssystem/fssystem_aes_xts_storage.h"
 #include "core/file_sys/fssystem/fssystem_alignment_matching_storage.h"
+#include "core/file_sys/fssystem/fssystem_block_cache_storage.h"
 #include "core/file_sys/fssystem/fssystem_compressed_storage.h"
 #include "core/file_sys/fssystem/fssystem_hierarchical_integrity_verification_storage.h"
 #include "core/file_sys/fssystem/fssystem_hierarchical_sha256_storage.h"
@@ -47,6 +48,13 @@ public:
         return m_storage->Read(buffer, size, offset);
     }
 
+    virtual std::span<const u8> GetView(size_t size, size_t offset) const override {
+        // Validate pre-conditions.
+        ASSERT(m_storage != nullptr);
+
+        return m_storage->GetView(size, offset);
+    }
+
     virtual size_t GetSize() const override {
         // Validate pre-conditions.
         ASSERT(m_storage != nullptr);
@@ -448,6 +456,16 @@ Result NcaFileSystemDriver::CreateAesCtrStorage(
         std::move(aes_ctr_storage));
     R_UNLESS(aligned_storage != nullptr, ResultAllocationMemoryFailedAllocateShared);
 
+    // Cache decrypted blocks of section bodies, which are read repeatedly in small pieces.
+    if (alignment_storage_requirement == AlignmentStorageRequirement::CacheBlockSize) {
+        auto cache_storage = std::make_shared<BlockCacheStorage>(std::move(aligned_storage),
+                                                                 BlockCacheBudget::Decrypted());
+        R_UNLESS(cache_storage != nullptr, ResultAllocationMemoryFailedAllocateShared);
+
+        *out = std::move(cache_storage);
+        R_SUCCEED();
+    }
+
     // Set the out storage.
     *out = std::move(aligned_storage);
     R_SUCCEED();
@@ -476,8 +494,13 @@ Result NcaFileSystemDriver::CreateAesXtsStorage(VirtualFile* out, VirtualFile ba
         std::move(xts_storage));
     R_UNLESS(aligned_storage != nullptr, ResultAllocationMemoryFailedAllocateShared);
 
+    // Cache decrypted blocks, xts sections are only used for section bodies.
+    auto cache_storage = std::make_shared<BlockCacheStorage>(std::move(aligned_storage),
+                                                             BlockCacheBudget::Decrypted());
+    R_UNLESS(cache_storage != nullptr, ResultAllocationMemoryFailedAllocateShared);
+
     // Set the out storage.
-    *out = std::move(xts_storage);
+    *out = std::move(cache_storage);
     R_SUCCEED();
 }
 
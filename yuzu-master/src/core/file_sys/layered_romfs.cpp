@@ -0,0 +1,317 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstring>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include "common/cityhash.h"
+#include "common/common_funcs.h"
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/file_sys/fsmitm_romfsbuild.h"
+#include "core/file_sys/layered_romfs.h"
+#include "core/file_sys/romfs.h"
+#include "core/file_sys/vfs/vfs_concat.h"
+#include "core/file_sys/vfs/vfs_layered.h"
+#include "core/file_sys/vfs/vfs_offset.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+
+namespace FileSys {
+namespace {
+// Bump whenever the cache format or the way RomFSBuildContext lays out a RomFS changes
+constexpr u32 CACHE_VERSION = 1;
+constexpr u32 BASE_LAYER = 0xFFFFFFFF;
+
+struct TableLocation {
+    u64_le offset;
+    u64_le size;
+};
+static_assert(sizeof(TableLocation) == 0x10, "TableLocation has incorrect size.");
+
+struct RomFSHeader {
+    u64_le header_size;
+    TableLocation directory_hash;
+    TableLocation directory_meta;
+    TableLocation file_hash;
+    TableLocation file_meta;
+    u64_le data_offset;
+};
+static_assert(sizeof(RomFSHeader) == 0x50, "RomFSHeader has incorrect size.");
+
+struct CacheHeader {
+    u32_le magic;
+    u32_le version;
+    u64_le base_fingerprint;
+    u64_le mods_fingerprint;
+    u64_le metadata_offset;
+    u64_le metadata_size;
+    u32_le num_files;
+    u32_le name_size;
+};
+static_assert(sizeof(CacheHeader) == 0x30, "CacheHeader has incorrect size.");
+
+// Followed by the name, the RomFS header, the metadata tables and the file entries
+struct CacheFileEntry {
+    u64_le offset;
+    u64_le size;
+    // Offset of the file in the base RomFS, for files of the base layer
+    u64_le source_offset;
+    u32_le layer;
+    // Size of the path of the file within its mod layer, the path follows the entry
+    u32_le path_size;
+};
+static_assert(sizeof(CacheFileEntry) == 0x20, "CacheFileEntry has incorrect size.");
+
+// Files of a mod layer by their path within it
+using LayerFiles = std::map<std::string, VirtualFile, std::less<>>;
+
+u64 HashBytes(const void* data, size_t size, u64 hash) {
+    return Common::CityHash64WithSeed(static_cast<const char*>(data), size, hash);
+}
+
+// Collects the files under dir, hashing the names and sizes of its files and subdirectories.
+// Returns false when a file can't be referred to by the cached layout.
+bool CollectFiles(const VirtualDir& dir, const std::string& path, LayerFiles& files, u64& hash) {
+    bool cacheable = true;
+    for (auto& file : dir->GetFiles()) {
+        std::string file_path = path + '/' + file->GetName();
+        const u64 size = file->GetSize();
+        hash = HashBytes(file_path.data(), file_path.size(), hash);
+        hash = HashBytes(&size, sizeof(size), hash);
+        cacheable &= !file_path.ends_with(".ips");
+        files.emplace(std::move(file_path), std::move(file));
+    }
+    for (const auto& subdir : dir->GetSubdirectories()) {
+        // The trailing separator tells directories apart from files of the same name
+        const std::string subdir_path = path + '/' + subdir->GetName();
+        hash = HashBytes(subdir_path.data(), subdir_path.size(), hash);
+        hash = HashBytes("/", 1, hash);
+        cacheable &= CollectFiles(subdir, subdir_path, files, hash);
+    }
+    return cacheable;
+}
+
+// Hashes the header and metadata tables of a RomFS, which hold the name, offset and size of every
+// file in it. The contents of the files don't matter, the layout reads them from the RomFS.
+std::optional<u64> GetBaseFingerprint(const VirtualFile& romfs) {
+    RomFSHeader header{};
+    if (romfs->ReadObject(&header) != sizeof(header)) {
+        return std::nullopt;
+    }
+    const u64 romfs_size = romfs->GetSize();
+    u64 hash = HashBytes(&header, sizeof(header), romfs_size);
+    for (const TableLocation& table : {header.directory_meta, header.file_meta}) {
+        const std::vector<u8> data = romfs->ReadBytes(table.size, table.offset);
+        if (data.size() != table.size) {
+            return std::nullopt;
+        }
+        hash = HashBytes(data.data(), data.size(), hash);
+    }
+    return hash;
+}
+
+void SaveLayout(const std::filesystem::path& cache_file, u64 base_fingerprint,
+                u64 mods_fingerprint, const std::string& name,
+                const std::vector<std::pair<u64, VirtualFile>>& pieces,
+                const std::vector<LayerFiles>& layer_files) {
+    std::unordered_map<const VfsFile*, std::pair<u32, std::string_view>> mod_sources;
+    for (size_t layer = 0; layer < layer_files.size(); ++layer) {
+        for (const auto& [path, file] : layer_files[layer]) {
+            mod_sources.try_emplace(file.get(), static_cast<u32>(layer), path);
+        }
+    }
+
+    std::string entries;
+    u32 num_files = 0;
+    std::vector<u8> romfs_header;
+    std::vector<u8> metadata;
+    u64 metadata_offset = 0;
+    for (const auto& [offset, file] : pieces) {
+        CacheFileEntry entry{
+            .offset = offset,
+            .size = file->GetSize(),
+            .source_offset = 0,
+            .layer = BASE_LAYER,
+            .path_size = 0,
+        };
+        std::string_view path;
+        if (const auto it = mod_sources.find(file.get()); it != mod_sources.end()) {
+            entry.layer = it->second.first;
+            path = it->second.second;
+            entry.path_size = static_cast<u32>(path.size());
+        } else if (const auto* const base_file = dynamic_cast<const OffsetVfsFile*>(file.get())) {
+            entry.source_offset = base_file->GetOffset();
+        } else if (offset == 0 && romfs_header.empty()) {
+            romfs_header = file->ReadAllBytes();
+            continue;
+        } else if (metadata.empty()) {
+            metadata = file->ReadAllBytes();
+            metadata_offset = offset;
+            continue;
+        } else {
+            LOG_DEBUG(Loader, "LayeredFS layout refers to generated files, not caching it");
+            return;
+        }
+        entries.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        entries.append(path);
+        ++num_files;
+    }
+    if (romfs_header.size() != sizeof(RomFSHeader) || metadata.empty()) {
+        return;
+    }
+
+    const CacheHeader header{
+        .magic = Common::MakeMagic('Y', 'L', 'F', 'S'),
+        .version = CACHE_VERSION,
+        .base_fingerprint = base_fingerprint,
+        .mods_fingerprint = mods_fingerprint,
+        .metadata_offset = metadata_offset,
+        .metadata_size = metadata.size(),
+        .num_files = num_files,
+        .name_size = static_cast<u32>(name.size()),
+    };
+    std::string data(reinterpret_cast<const char*>(&header), sizeof(header));
+    data.append(name);
+    data.append(romfs_header.begin(), romfs_header.end());
+    data.append(metadata.begin(), metadata.end());
+    data.append(entries);
+
+    if (!Common::FS::CreateParentDirs(cache_file) ||
+        Common::FS::WriteStringToFile(cache_file, Common::FS::FileType::BinaryFile, data) !=
+            data.size()) {
+        LOG_WARNING(Loader, "Failed to write the LayeredFS cache to {}",
+                    Common::FS::PathToUTF8String(cache_file));
+    }
+}
+
+VirtualFile LoadLayout(const std::filesystem::path& cache_file, u64 base_fingerprint,
+                       u64 mods_fingerprint, const VirtualFile& base_romfs,
+                       const std::vector<LayerFiles>& layer_files) {
+    if (!Common::FS::Exists(cache_file)) {
+        return nullptr;
+    }
+    const std::string data =
+        Common::FS::ReadStringFromFile(cache_file, Common::FS::FileType::BinaryFile);
+    size_t position = 0;
+    const auto read = [&data, &position](size_t size) -> const char* {
+        if (data.size() - position < size) {
+            return nullptr;
+        }
+        const char* const pointer = data.data() + position;
+        position += size;
+        return pointer;
+    };
+
+    CacheHeader header{};
+    const char* const header_data = read(sizeof(header));
+    if (header_data == nullptr) {
+        return nullptr;
+    }
+    std::memcpy(&header, header_data, sizeof(header));
+    if (header.magic != Common::MakeMagic('Y', 'L', 'F', 'S') || header.version != CACHE_VERSION ||
+        header.base_fingerprint != base_fingerprint ||
+        header.mods_fingerprint != mods_fingerprint) {
+        return nullptr;
+    }
+    const char* const name = read(header.name_size);
+    const char* const romfs_header = read(sizeof(RomFSHeader));
+    const char* const metadata = read(header.metadata_size);
+    if (name == nullptr || romfs_header == nullptr || metadata == nullptr) {
+        return nullptr;
+    }
+
+    std::vector<std::pair<u64, VirtualFile>> pieces;
+    pieces.reserve(header.num_files + 2);
+    pieces.emplace_back(0, std::make_shared<VectorVfsFile>(std::vector<u8>(
+                               romfs_header, romfs_header + sizeof(RomFSHeader))));
+    for (u32 i = 0; i < header.num_files; ++i) {
+        CacheFileEntry entry{};
+        const char* const entry_data = read(sizeof(entry));
+        if (entry_data == nullptr) {
+            return nullptr;
+        }
+        std::memcpy(&entry, entry_data, sizeof(entry));
+        if (entry.layer == BASE_LAYER) {
+            if (entry.source_offset + entry.size > base_romfs->GetSize()) {
+                return nullptr;
+            }
+            pieces.emplace_back(entry.offset, std::make_shared<OffsetVfsFile>(
+                                                  base_romfs, entry.size, entry.source_offset));
+            continue;
+        }
+        const char* const path = read(entry.path_size);
+        if (path == nullptr || entry.layer >= layer_files.size()) {
+            return nullptr;
+        }
+        const auto& files = layer_files[entry.layer];
+        const auto it = files.find(std::string_view(path, entry.path_size));
+        if (it == files.end() || it->second->GetSize() != entry.size) {
+            return nullptr;
+        }
+        pieces.emplace_back(entry.offset, it->second);
+    }
+    pieces.emplace_back(header.metadata_offset,
+                        std::make_shared<VectorVfsFile>(
+                            std::vector<u8>(metadata, metadata + header.metadata_size)));
+
+    return ConcatenatedVfsFile::MakeConcatenatedFile(0, std::string(name, header.name_size),
+                                                     std::move(pieces));
+}
+} // Anonymous namespace
+
+VirtualFile CreateLayeredRomFS(VirtualFile base_romfs, std::vector<VirtualDir> layers,
+                               std::vector<VirtualDir> layers_ext,
+                               const std::filesystem::path& cache_file) {
+    // Everything shaping the layout goes into the fingerprint, including the order of the layers
+    std::vector<LayerFiles> layer_files(layers.size());
+    u64 mods_fingerprint = layers.size();
+    bool cacheable = base_romfs != nullptr;
+    for (size_t layer = 0; layer < layers.size(); ++layer) {
+        cacheable &= CollectFiles(layers[layer], "", layer_files[layer], mods_fingerprint);
+    }
+    mods_fingerprint = HashBytes("ext", 3, mods_fingerprint);
+    for (const auto& layer_ext : layers_ext) {
+        LayerFiles ext_files;
+        cacheable &= CollectFiles(layer_ext, "", ext_files, mods_fingerprint);
+    }
+
+    const auto base_fingerprint =
+        cacheable ? GetBaseFingerprint(base_romfs) : std::optional<u64>{};
+    if (base_fingerprint) {
+        if (auto cached = LoadLayout(cache_file, *base_fingerprint, mods_fingerprint, base_romfs,
+                                     layer_files)) {
+            LOG_DEBUG(Loader, "Reusing the LayeredFS layout in {}",
+                      Common::FS::PathToUTF8String(cache_file));
+            return cached;
+        }
+    }
+
+    auto extracted = ExtractRomFS(base_romfs);
+    if (extracted == nullptr) {
+        return nullptr;
+    }
+    layers.push_back(std::move(extracted));
+
+    const auto layered = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers));
+    if (layered == nullptr) {
+        return nullptr;
+    }
+    auto layered_ext = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers_ext));
+
+    std::string name = layered->GetName();
+    RomFSBuildContext ctx{layered, std::move(layered_ext)};
+    auto pieces = ctx.Build();
+    if (base_fingerprint) {
+        SaveLayout(cache_file, *base_fingerprint, mods_fingerprint, name, pieces, layer_files);
+    }
+    return ConcatenatedVfsFile::MakeConcatenatedFile(0, std::move(name), std::move(pieces));
+}
+
+} // namespace FileSys
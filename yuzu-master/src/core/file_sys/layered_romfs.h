@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <vector>
+#include "core/file_sys/vfs/vfs.h"
+
+namespace FileSys {
+
+// Builds the RomFS of base_romfs with LayeredFS mods applied, the same way CreateRomFS does over a
+// LayeredVfsDirectory of layers and the extracted base_romfs, with layers_ext holding the
+// romfs_ext directories. Layers are ordered from the highest priority to the lowest.
+//
+// The layout of the result is stored in cache_file and reused for as long as the tables of the
+// base RomFS and the names and sizes of the mod files stay the same, which skips extracting the
+// base RomFS and building the tables again. Mod files edited without changing size are still
+// picked up, the layout only refers to them. Mods with IPS patches in romfs_ext aren't cached.
+// Returns nullptr on failure.
+VirtualFile CreateLayeredRomFS(VirtualFile base_romfs, std::vector<VirtualDir> layers,
+                               std::vector<VirtualDir> layers_ext,
+                               const std::filesystem::path& cache_file);
+
+} // namespace FileSys
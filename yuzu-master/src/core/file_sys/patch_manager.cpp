@@ -6,6 +6,7 @@
 #include <cstddef>
 #include <cstring>
 
+#include "common/fs/path_util.h"
 #include "common/hex_util.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
@@ -18,6 +19,7 @@
 #include "core/file_sys/content_archive.h"
 #include "core/file_sys/control_metadata.h"
 #include "core/file_sys/ips_layer.h"
+#include "core/file_sys/layered_romfs.h"
 #include "core/file_sys/patch_manager.h"
 #include "core/file_sys/registered_cache.h"
 #include "core/file_sys/romfs.h"
@@ -395,21 +397,9 @@ static void ApplyLayeredFS(VirtualFile& romfs, u64 title_id, ContentRecordType t
         return;
     }
 
-    auto extracted = ExtractRomFS(romfs);
-    if (extracted == nullptr) {
-        return;
-    }
-
-    layers.emplace_back(std::move(extracted));
-
-    auto layered = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers));
-    if (layered == nullptr) {
-        return;
-    }
-
-    auto layered_ext = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers_ext));
-
-    auto packed = CreateRomFS(std::move(layered), std::move(layered_ext));
+    const auto cache_file = Common::FS::GetYuzuPath(Common::FS::YuzuPath::CacheDir) / "layeredfs" /
+                            fmt::format("{:016X}_{:02X}.bin", title_id, static_cast<u8>(type));
+    auto packed = CreateLayeredRomFS(romfs, std::move(layers), std::move(layers_ext), cache_file);
     if (packed == nullptr) {
         return;
     }
@@ -2,22 +2,29 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
 #include <random>
-#include <regex>
 #include <mbedtls/sha256.h>
 #include "common/assert.h"
+#include "common/cityhash.h"
 #include "common/fs/path_util.h"
 #include "common/hex_util.h"
 #include "common/logging/log.h"
 #include "common/scope_exit.h"
+#include "common/string_util.h"
+#include "common/task_scheduler.h"
 #include "core/crypto/key_manager.h"
 #include "core/file_sys/card_image.h"
 #include "core/file_sys/common_funcs.h"
 #include "core/file_sys/content_archive.h"
+#include "core/file_sys/content_index.h"
 #include "core/file_sys/nca_metadata.h"
 #include "core/file_sys/registered_cache.h"
 #include "core/file_sys/submission_package.h"
 #include "core/file_sys/vfs/vfs_concat.h"
+#include "core/file_sys/vfs/vfs_vector.h"
 #include "core/loader/loader.h"
 
 namespace FileSys {
@@ -41,19 +48,23 @@ bool operator!=(const ContentProviderEntry& lhs, const ContentProviderEntry& rhs
     return !operator==(lhs, rhs);
 }
 
+// The cache directories are scanned on every refresh, so names are checked by hand rather than
+// with a std::regex, which is slow enough to matter with many NCAs.
+static bool IsHexString(std::string_view name) {
+    return std::all_of(name.begin(), name.end(),
+                       [](char c) { return std::isxdigit(static_cast<unsigned char>(c)) != 0; });
+}
+
 static bool FollowsTwoDigitDirFormat(std::string_view name) {
-    static const std::regex two_digit_regex("000000[0-9A-F]{2}", std::regex_constants::ECMAScript |
-                                                                     std::regex_constants::icase);
-    return std::regex_match(name.begin(), name.end(), two_digit_regex);
+    return name.size() == 8 && name.starts_with("000000") && IsHexString(name.substr(6));
 }
 
 static bool FollowsNcaIdFormat(std::string_view name) {
-    static const std::regex nca_id_regex("[0-9A-F]{32}\\.nca", std::regex_constants::ECMAScript |
-                                                                   std::regex_constants::icase);
-    static const std::regex nca_id_cnmt_regex(
-        "[0-9A-F]{32}\\.cnmt.nca", std::regex_constants::ECMAScript | std::regex_constants::icase);
-    return (name.size() == 36 && std::regex_match(name.begin(), name.end(), nca_id_regex)) ||
-           (name.size() == 41 && std::regex_match(name.begin(), name.end(), nca_id_cnmt_regex));
+    if ((name.size() != 36 && name.size() != 41) || !IsHexString(name.substr(0, 32))) {
+        return false;
+    }
+    const auto suffix = Common::ToLower(std::string(name.substr(32)));
+    return suffix == ".nca" || suffix == ".cnmt.nca";
 }
 
 static std::string GetRelativePathFromNcaID(const std::array<u8, 16>& nca_id, bool second_hex_upper,
@@ -376,11 +387,43 @@ std::optional<NcaID> RegisteredCache::GetNcaIDFromMetadata(u64 title_id,
     return CheckMapForContentRecord(meta, title_id, type);
 }
 
-std::vector<NcaID> RegisteredCache::AccumulateFiles() const {
-    std::vector<NcaID> ids;
+std::vector<RegisteredCache::FoundNca> RegisteredCache::AccumulateFiles() const {
+    std::vector<FoundNca> ncas;
+    const auto add_file = [&ncas](const VirtualDir& parent, const VirtualFile& nca_file) {
+        const auto& name = nca_file->GetName();
+        ncas.push_back({
+            .id = Common::HexStringToArray<0x10, true>(name.substr(0, 0x20)),
+            .size = nca_file->GetSize(),
+            .modified = parent->GetFileTimeStamp(name).modified,
+        });
+    };
+    // Parts of a split NCA can be replaced without touching its directory, so the size and
+    // modification times of the parts themselves are used.
+    const auto add_dir = [&ncas](const VirtualDir& nca_dir) {
+        const auto& name = nca_dir->GetName();
+        u64 size = 0;
+        std::vector<u64> part_times;
+        for (const auto& part : nca_dir->GetFiles()) {
+            size += part->GetSize();
+            part_times.push_back(nca_dir->GetFileTimeStamp(part->GetName()).modified);
+        }
+        u64 modified = 0;
+        if (!part_times.empty() && std::ranges::find(part_times, u64{0}) == part_times.end()) {
+            // Keep the hash nonzero, zero means there is no time to validate against
+            modified = Common::CityHash64(reinterpret_cast<const char*>(part_times.data()),
+                                          part_times.size() * sizeof(u64)) |
+                       1;
+        }
+        ncas.push_back({
+            .id = Common::HexStringToArray<0x10, true>(name.substr(0, 0x20)),
+            .size = size,
+            .modified = modified,
+        });
+    };
+
     for (const auto& d2_dir : dir->GetSubdirectories()) {
         if (FollowsNcaIdFormat(d2_dir->GetName())) {
-            ids.push_back(Common::HexStringToArray<0x10, true>(d2_dir->GetName().substr(0, 0x20)));
+            add_dir(d2_dir);
             continue;
         }
 
@@ -392,7 +435,7 @@ std::vector<NcaID> RegisteredCache::AccumulateFiles() const {
                 continue;
             }
 
-            ids.push_back(Common::HexStringToArray<0x10, true>(nca_dir->GetName().substr(0, 0x20)));
+            add_dir(nca_dir);
         }
 
         for (const auto& nca_file : d2_dir->GetFiles()) {
@@ -400,41 +443,98 @@ std::vector<NcaID> RegisteredCache::AccumulateFiles() const {
                 continue;
             }
 
-            ids.push_back(
-                Common::HexStringToArray<0x10, true>(nca_file->GetName().substr(0, 0x20)));
+            add_file(d2_dir, nca_file);
         }
     }
 
     for (const auto& d2_file : dir->GetFiles()) {
         if (FollowsNcaIdFormat(d2_file->GetName()))
-            ids.push_back(Common::HexStringToArray<0x10, true>(d2_file->GetName().substr(0, 0x20)));
+            add_file(dir, d2_file);
     }
-    return ids;
+    return ncas;
 }
 
-void RegisteredCache::ProcessFiles(const std::vector<NcaID>& ids) {
-    for (const auto& id : ids) {
-        const auto file = GetFileAtID(id);
+std::optional<ContentIndex::Entry> RegisteredCache::ParseFile(const FoundNca& found) const {
+    const auto file = GetFileAtID(found.id);
+    if (file == nullptr) {
+        return std::nullopt;
+    }
+    // NCAs that fail to parse, e.g. for missing keys, aren't indexed so they're retried next time
+    const NCA nca(parser(file, found.id));
+    if (nca.GetStatus() != Loader::ResultStatus::Success) {
+        return std::nullopt;
+    }
 
-        if (file == nullptr)
-            continue;
-        const auto nca = std::make_shared<NCA>(parser(file, id));
-        if (nca->GetStatus() != Loader::ResultStatus::Success ||
-            nca->GetType() != NCAContentType::Meta || nca->GetSubdirectories().empty()) {
-            continue;
+    ContentIndex::Entry entry{
+        .size = found.size,
+        .modified = found.modified,
+        .title_id = nca.GetTitleId(),
+        .cnmt = {},
+    };
+    if (nca.GetType() != NCAContentType::Meta || nca.GetSubdirectories().empty()) {
+        return entry;
+    }
+    for (const auto& section0_file : nca.GetSubdirectories()[0]->GetFiles()) {
+        if (section0_file->GetExtension() == "cnmt") {
+            entry.cnmt = section0_file->ReadAllBytes();
+            break;
         }
+    }
+    return entry;
+}
 
-        const auto section0 = nca->GetSubdirectories()[0];
+void RegisteredCache::ProcessFiles(const std::vector<FoundNca>& ncas) {
+    if (!index) {
+        index = std::make_unique<ContentIndex>(dir);
+        index->Load();
+    }
 
-        for (const auto& section0_file : section0->GetFiles()) {
-            if (section0_file->GetExtension() != "cnmt")
-                continue;
+    // Look up the NCAs in the index, parsing only those that are new or changed
+    std::vector<std::optional<ContentIndex::Entry>> entries(ncas.size());
+    std::vector<size_t> misses;
+    for (size_t i = 0; i < ncas.size(); ++i) {
+        if (const auto* const entry = index->Find(ncas[i].id, ncas[i].size, ncas[i].modified)) {
+            entries[i] = *entry;
+        } else {
+            misses.push_back(i);
+        }
+    }
+    if (!misses.empty()) {
+        // The NAX parser derives the SD seed on first use, derive it before going wide so the
+        // workers only read the keys
+        Core::Crypto::KeyManager::Instance().DeriveSDSeedLazy();
+
+        Common::TaskGroup workers;
+        for (const size_t nca_index : misses) {
+            workers.Run([this, &ncas, &entries, nca_index] {
+                entries[nca_index] = ParseFile(ncas[nca_index]);
+            });
+        }
+        workers.Wait();
+    }
 
-            meta.insert_or_assign(nca->GetTitleId(), CNMT(section0_file));
-            meta_id.insert_or_assign(nca->GetTitleId(), id);
-            break;
+    std::map<NcaID, ContentIndex::Entry> new_index;
+    for (size_t i = 0; i < ncas.size(); ++i) {
+        if (!entries[i]) {
+            continue;
+        }
+        const auto& entry = *entries[i];
+        if (!entry.cnmt.empty()) {
+            meta.insert_or_assign(entry.title_id,
+                                  CNMT(std::make_shared<VectorVfsFile>(entry.cnmt)));
+            meta_id.insert_or_assign(entry.title_id, ncas[i].id);
+        }
+        if (ncas[i].modified != 0) {
+            new_index.insert_or_assign(ncas[i].id, std::move(*entries[i]));
         }
     }
+
+    const bool index_changed = !misses.empty() || new_index.size() != index->Size();
+    index->Assign(std::move(new_index));
+    // The index is only an optimization, a read-only cache just goes without it
+    if (index_changed && !index->Save()) {
+        LOG_WARNING(Loader, "Failed to write the content index of {}", dir->GetFullPath());
+    }
 }
 
 void RegisteredCache::AccumulateYuzuMeta() {
@@ -458,8 +558,8 @@ void RegisteredCache::Refresh() {
         return;
     }
 
-    const auto ids = AccumulateFiles();
-    ProcessFiles(ids);
+    const auto ncas = AccumulateFiles();
+    ProcessFiles(ncas);
     AccumulateYuzuMeta();
 }
 
@@ -798,8 +898,15 @@ InstallResult RegisteredCache::RawInstallNCA(const NCA& nca, const VfsCopyFuncti
     if (out == nullptr) {
         return InstallResult::ErrorCopyFailed;
     }
-    return copy(in, out, VFS_RC_LARGE_COPY_BLOCK) ? InstallResult::Success
-                                                  : InstallResult::ErrorCopyFailed;
+    const auto start = std::chrono::steady_clock::now();
+    if (!copy(in, out, VFS_RC_LARGE_COPY_BLOCK)) {
+        return InstallResult::ErrorCopyFailed;
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const double mib = static_cast<double>(in->GetSize()) / 0x100000;
+    LOG_INFO(Loader, "Installed NCA {} ({:.1f} MiB) in {:.2f} s, {:.1f} MiB/s", path, mib,
+             elapsed.count(), mib / std::max(elapsed.count(), 1e-6));
+    return InstallResult::Success;
 }
 
 bool RegisteredCache::RawInstallYuzuMeta(const CNMT& cnmt) {
@@ -6,11 +6,13 @@
 #include <array>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 #include <boost/container/flat_map.hpp>
 #include "common/common_types.h"
 #include "core/crypto/key_manager.h"
+#include "core/file_sys/content_index.h"
 #include "core/file_sys/vfs/vfs.h"
 
 namespace FileSys {
@@ -182,8 +184,18 @@ private:
     void IterateAllMetadata(std::vector<T>& out,
                             std::function<T(const CNMT&, const ContentRecord&)> proc,
                             std::function<bool(const CNMT&, const ContentRecord&)> filter) const;
-    std::vector<NcaID> AccumulateFiles() const;
-    void ProcessFiles(const std::vector<NcaID>& ids);
+    // An NCA found in the cache, with the size and modification time of its file, or the total
+    // size and a hash of the modification times of the parts of a split NCA. The time is zero
+    // when the filesystem doesn't provide one.
+    struct FoundNca {
+        NcaID id;
+        u64 size;
+        u64 modified;
+    };
+
+    std::vector<FoundNca> AccumulateFiles() const;
+    void ProcessFiles(const std::vector<FoundNca>& ncas);
+    std::optional<ContentIndex::Entry> ParseFile(const FoundNca& nca) const;
     void AccumulateYuzuMeta();
     std::optional<NcaID> GetNcaIDFromMetadata(u64 title_id, ContentRecordType type) const;
     VirtualFile GetFileAtID(NcaID id) const;
@@ -201,6 +213,8 @@ private:
     std::map<u64, CNMT> meta;
     // maps tid -> meta for CNMT in yuzu_meta
     std::map<u64, CNMT> yuzu_meta;
+    // what parsing each NCA revealed, loaded on the first refresh
+    std::unique_ptr<ContentIndex> index;
 };
 
 enum class ContentProviderUnionSlot {
@@ -4,7 +4,11 @@
 #include <algorithm>
 #include <numeric>
 #include <string>
+#include "common/bounded_threadsafe_queue.h"
+#include "common/fs/fs.h"
 #include "common/fs/path_util.h"
+#include "common/polyfill_thread.h"
+#include "common/scratch_buffer.h"
 #include "core/file_sys/vfs/vfs.h"
 
 namespace FileSys {
@@ -162,6 +166,14 @@ std::string VfsFile::GetExtension() const {
 
 VfsDirectory::~VfsDirectory() = default;
 
+std::span<const u8> VfsFile::GetView(std::size_t length, std::size_t offset) const {
+    return {};
+}
+
+std::optional<VfsHostLocation> VfsFile::GetHostLocation() const {
+    return std::nullopt;
+}
+
 std::optional<u8> VfsFile::ReadByte(std::size_t offset) const {
     u8 out{};
     const std::size_t size = Read(&out, sizeof(u8), offset);
@@ -501,25 +513,134 @@ bool DeepEquals(const VirtualFile& file1, const VirtualFile& file2, std::size_t
     return true;
 }
 
-bool VfsRawCopy(const VirtualFile& src, const VirtualFile& dest, std::size_t block_size) {
-    if (src == nullptr || dest == nullptr || !src->IsReadable() || !dest->IsWritable())
-        return false;
-    if (!dest->Resize(src->GetSize()))
+namespace {
+// Number of blocks that can be in flight between the reader thread and the writer
+constexpr std::size_t NUM_COPY_BUFFERS = 3;
+
+// Asks the callback whether to keep going, dropping the copied data when it cancels.
+bool CopyCanceled(VfsFile& dest, std::size_t size, std::size_t copied,
+                  const VfsCopyProgressCallback& callback) {
+    if (!callback || !callback(size, copied)) {
         return false;
+    }
+    dest.Resize(0);
+    return true;
+}
 
-    std::vector<u8> temp(std::min(block_size, src->GetSize()));
-    for (std::size_t i = 0; i < src->GetSize(); i += block_size) {
-        const auto read = std::min(block_size, src->GetSize() - i);
+// Lets the host copy between the host files backing src and dest, returning how far it got.
+// The data is written to the host file behind dest's back, which is fine as long as nothing else
+// writes dest during the copy. VfsRawCopy callers create or own dest, so nothing does.
+std::size_t HostCopy(const VfsFile& src, VfsFile& dest, std::size_t block_size,
+                     const VfsCopyProgressCallback& callback, bool& canceled) {
+    const auto src_location = src.GetHostLocation();
+    const auto dest_location = dest.GetHostLocation();
+    if (!src_location || !dest_location) {
+        return 0;
+    }
+    const auto src_path = Common::FS::ToU8String(src_location->path);
+    const auto dest_path = Common::FS::ToU8String(dest_location->path);
+    const std::size_t size = src.GetSize();
+    std::size_t offset = 0;
+    while (offset < size) {
+        if (CopyCanceled(dest, size, offset, callback)) {
+            canceled = true;
+            return offset;
+        }
+        const std::size_t length = std::min(block_size, size - offset);
+        const u64 copied =
+            Common::FS::CopyFileRange(src_path, src_location->offset + offset, dest_path,
+                                      dest_location->offset + offset, length);
+        offset += static_cast<std::size_t>(copied);
+        if (copied != length) {
+            break;
+        }
+    }
+    return offset;
+}
 
-        if (src->Read(temp.data(), read, i) != read) {
+// Copies src from offset on through memory. The next blocks are read on a separate thread while
+// the current one is written, so reading, and decrypting in layered files, overlaps with writing.
+bool BufferedCopy(const VfsFile& src, VfsFile& dest, std::size_t offset, std::size_t block_size,
+                  const VfsCopyProgressCallback& callback) {
+    const std::size_t size = src.GetSize();
+    if (size - offset <= block_size) {
+        if (CopyCanceled(dest, size, offset, callback)) {
             return false;
         }
+        const std::size_t length = size - offset;
+        Common::ScratchBuffer<u8> buffer(length);
+        return src.Read(buffer.data(), length, offset) == length &&
+               dest.Write(buffer.data(), length, offset) == length;
+    }
 
-        if (dest->Write(temp.data(), read, i) != read) {
+    struct Block {
+        u8* data;
+        std::size_t offset;
+        std::size_t size;
+    };
+    Common::ScratchBuffer<u8> buffers(NUM_COPY_BUFFERS * block_size);
+    Common::SPSCQueue<u8*, 4> free_buffers;
+    Common::SPSCQueue<Block, 4> read_blocks;
+    for (std::size_t i = 0; i < NUM_COPY_BUFFERS; ++i) {
+        free_buffers.EmplaceWait(buffers.data() + i * block_size);
+    }
+
+    std::jthread reader([&](std::stop_token stop_token) {
+        for (std::size_t read_offset = offset; read_offset < size; read_offset += block_size) {
+            u8* const data = free_buffers.PopWait(stop_token);
+            if (stop_token.stop_requested()) {
+                return;
+            }
+            const std::size_t length = std::min(block_size, size - read_offset);
+            const std::size_t read = src.Read(data, length, read_offset);
+            // There are never more blocks than the queue can hold, this doesn't wait
+            read_blocks.EmplaceWait(Block{data, read_offset, read});
+            if (read != length) {
+                return;
+            }
+        }
+    });
+
+    for (std::size_t write_offset = offset; write_offset < size; write_offset += block_size) {
+        if (CopyCanceled(dest, size, write_offset, callback)) {
             return false;
         }
+        const Block block = read_blocks.PopWait();
+        const std::size_t length = std::min(block_size, size - write_offset);
+        if (block.size != length || dest.Write(block.data, length, block.offset) != length) {
+            return false;
+        }
+        free_buffers.EmplaceWait(block.data);
     }
+    return true;
+}
+} // Anonymous namespace
+
+bool VfsRawCopy(const VirtualFile& src, const VirtualFile& dest, std::size_t block_size) {
+    return VfsRawCopyWithProgress(src, dest, block_size, {});
+}
+
+bool VfsRawCopyWithProgress(const VirtualFile& src, const VirtualFile& dest, std::size_t block_size,
+                            const VfsCopyProgressCallback& callback) {
+    if (src == nullptr || dest == nullptr || !src->IsReadable() || !dest->IsWritable())
+        return false;
+    if (!dest->Resize(src->GetSize()))
+        return false;
+    if (src->GetSize() == 0)
+        return true;
+
+    // Whatever the host couldn't copy is copied through memory
+    bool canceled = false;
+    const std::size_t size = src->GetSize();
+    const std::size_t copied = HostCopy(*src, *dest, block_size, callback, canceled);
+    if (canceled)
+        return false;
+    if (copied != size && !BufferedCopy(*src, *dest, copied, block_size, callback))
+        return false;
 
+    // Report the last block too, the copy is done so canceling has no effect anymore
+    if (callback)
+        callback(size, size);
     return true;
 }
 
@@ -7,6 +7,7 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -25,6 +26,18 @@ enum class VfsEntryType {
     Directory,
 };
 
+// Where the data of a VfsFile is stored on the host, for copies the host can do by itself
+struct VfsHostLocation {
+    // Path of the host file holding the data
+    std::string path;
+    // Offset of the data within the host file
+    std::size_t offset;
+};
+
+// Callback reporting the progress of a copy, with the total size and the bytes copied so far.
+// Returning true cancels the copy.
+using VfsCopyProgressCallback = std::function<bool(std::size_t, std::size_t)>;
+
 // A class representing an abstract filesystem. A default implementation given the root VirtualDir
 // is provided for convenience, but if the Vfs implementation has any additional state or
 // functionality, they will need to override.
@@ -110,6 +123,16 @@ public:
     // into file. Returns number of bytes successfully written.
     virtual std::size_t Write(const u8* data, std::size_t length, std::size_t offset = 0) = 0;
 
+    // Returns a view of length bytes of the file starting at offset without copying them, when the
+    // backing storage is addressable memory. Returns an empty span otherwise, in which case the
+    // caller has to fall back to Read. The view is valid for as long as the file object lives.
+    virtual std::span<const u8> GetView(std::size_t length, std::size_t offset = 0) const;
+
+    // Returns the host file the data of this file is stored in as is, contiguously from the
+    // returned offset. Returns std::nullopt when the data is transformed or spread over several
+    // places, in which case it can only be accessed through Read and Write.
+    virtual std::optional<VfsHostLocation> GetHostLocation() const;
+
     // Reads exactly one byte at the offset provided, returning std::nullopt on error.
     virtual std::optional<u8> ReadByte(std::size_t offset = 0) const;
     // Reads size bytes starting at offset in file into a vector.
@@ -312,12 +335,22 @@ bool DeepEquals(const VirtualFile& file1, const VirtualFile& file2,
 // A method that copies the raw data between two different implementations of VirtualFile. If you
 // are using the same implementation, it is probably better to use the Copy method in the parent
 // directory of src/dest.
-bool VfsRawCopy(const VirtualFile& src, const VirtualFile& dest, std::size_t block_size = 0x1000);
+// When both files are stored in host files, the host is asked to copy the data, which lets
+// filesystems supporting it share the data between both files. Otherwise files larger than
+// block_size are copied through a few buffers of block_size, reading the next blocks from src on a
+// separate thread while the current one is written to dest. Nothing else may write to dest during
+// the copy, as the host writes to the file backing it directly.
+bool VfsRawCopy(const VirtualFile& src, const VirtualFile& dest, std::size_t block_size = 0x400000);
+
+// VfsRawCopy reporting its progress to callback before each block, and with the full size once the
+// copy is done. When the copy is canceled, dest is resized to zero.
+bool VfsRawCopyWithProgress(const VirtualFile& src, const VirtualFile& dest, std::size_t block_size,
+                            const VfsCopyProgressCallback& callback);
 
 // A method that performs a similar function to VfsRawCopy above, but instead copies entire
 // directories. It suffers the same performance penalties as above and an implementation-specific
 // Copy should always be preferred.
-bool VfsRawCopyD(const VirtualDir& src, const VirtualDir& dest, std::size_t block_size = 0x1000);
+bool VfsRawCopyD(const VirtualDir& src, const VirtualDir& dest, std::size_t block_size = 0x400000);
 
 // Checks if the directory at path relative to rel exists. If it does, returns that. If it does not
 // it attempts to create it and returns the new dir or nullptr on failure.
@@ -26,6 +26,8 @@ public:
     bool IsWritable() const override;
     bool IsReadable() const override;
     std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::span<const u8> GetView(std::size_t length, std::size_t offset) const override;
+    std::optional<VfsHostLocation> GetHostLocation() const override;
     std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
     std::optional<u8> ReadByte(std::size_t offset) const override;
     std::vector<u8> ReadBytes(std::size_t size, std::size_t offset) const override;
@@ -2,14 +2,18 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <array>
 #include <cstddef>
 #include <iterator>
 #include <utility>
 #include "common/assert.h"
 #include "common/fs/file.h"
 #include "common/fs/fs.h"
+#include "common/fs/mapped_file.h"
 #include "common/fs/path_util.h"
+#include "common/literals.h"
 #include "common/logging/log.h"
+#include "common/string_util.h"
 #include "core/file_sys/vfs/vfs.h"
 #include "core/file_sys/vfs/vfs_real.h"
 
@@ -28,10 +32,27 @@ namespace FileSys {
 
 namespace FS = Common::FS;
 
+using namespace Common::Literals;
+
 namespace {
 
 constexpr size_t MaxOpenFiles = 512;
 
+// Smallest game image served from a mapping, smaller files aren't worth the risk below
+constexpr u64 MinMappedFileSize = 16_MiB;
+
+// Only game images are mapped. Reading a mapping faults instead of returning a short count when
+// another process truncates the file, so files users edit while the emulator runs (mods, keys,
+// saves, NAND metadata) always go through IOFile. Game images are opened once and stay put.
+bool IsMappableGameImage(const std::string& path) {
+    static constexpr std::array extensions{"xci", "nsp", "nca"};
+    const std::string extension = Common::ToLower(std::string{FS::GetExtensionFromFilename(path)});
+    if (std::ranges::find(extensions, extension) == extensions.end()) {
+        return false;
+    }
+    return FS::GetSize(path) >= MinMappedFileSize;
+}
+
 constexpr FS::FileAccessMode ModeFlagsToFileAccessMode(OpenMode mode) {
     switch (mode) {
     case OpenMode::Read:
@@ -290,6 +311,9 @@ std::size_t RealVfsFile::GetSize() const {
     if (size) {
         return *size;
     }
+    if (const auto* const mapping = GetMappedFile()) {
+        return mapping->GetSize();
+    }
     auto lk = base.RefreshReference(path, perms, *reference);
     return reference->file ? reference->file->GetSize() : 0;
 }
@@ -313,6 +337,9 @@ bool RealVfsFile::IsReadable() const {
 }
 
 std::size_t RealVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    if (const auto* const mapping = GetMappedFile()) {
+        return mapping->Read(data, length, offset);
+    }
     auto lk = base.RefreshReference(path, perms, *reference);
     if (!reference->file || !reference->file->Seek(static_cast<s64>(offset))) {
         return 0;
@@ -320,6 +347,40 @@ std::size_t RealVfsFile::Read(u8* data, std::size_t length, std::size_t offset)
     return reference->file->ReadSpan(std::span{data, length});
 }
 
+std::span<const u8> RealVfsFile::GetView(std::size_t length, std::size_t offset) const {
+    const auto* const mapping = GetMappedFile();
+    if (!mapping || offset >= mapping->GetSize()) {
+        return {};
+    }
+    return mapping->GetSpan().subspan(offset, std::min(length, mapping->GetSize() - offset));
+}
+
+const FS::MappedFile* RealVfsFile::GetMappedFile() const {
+    if (perms != OpenMode::Read) {
+        return nullptr;
+    }
+    std::call_once(map_flag, [this] {
+#ifdef ANDROID
+        // Content URIs can only be opened through the Java file descriptor API
+        if (FS::Android::IsContentUri(path)) {
+            return;
+        }
+#endif
+        if (!IsMappableGameImage(path)) {
+            return;
+        }
+        auto mapping = std::make_unique<FS::MappedFile>(FS::ToU8String(path));
+        if (mapping->IsOpen()) {
+            mapped_file = std::move(mapping);
+        }
+    });
+    return mapped_file.get();
+}
+
+std::optional<VfsHostLocation> RealVfsFile::GetHostLocation() const {
+    return VfsHostLocation{path, 0};
+}
+
 std::size_t RealVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
     size.reset();
     auto lk = base.RefreshReference(path, perms, *reference);
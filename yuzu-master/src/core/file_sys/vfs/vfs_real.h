@@ -13,6 +13,7 @@
 
 namespace Common::FS {
 class IOFile;
+class MappedFile;
 }
 
 namespace FileSys {
@@ -85,6 +86,8 @@ public:
     bool IsWritable() const override;
     bool IsReadable() const override;
     std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::span<const u8> GetView(std::size_t length, std::size_t offset) const override;
+    std::optional<VfsHostLocation> GetHostLocation() const override;
     std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
     bool Rename(std::string_view name) override;
 
@@ -93,6 +96,10 @@ private:
                 const std::string& path, OpenMode perms = OpenMode::Read,
                 std::optional<u64> size = {});
 
+    // Returns the read-only mapping of the file, or nullptr when it isn't a game image that can be
+    // mapped. Views are only handed out for mapped files.
+    const Common::FS::MappedFile* GetMappedFile() const;
+
     RealVfsFilesystem& base;
     std::unique_ptr<FileReference> reference;
     std::string path;
@@ -100,6 +107,11 @@ private:
     std::vector<std::string> path_components;
     std::optional<u64> size;
     OpenMode perms;
+
+    // Read-only game images are served from a mapping created on first access, which doesn't hold
+    // any of the descriptors tracked by the reference lists.
+    mutable std::once_flag map_flag;
+    mutable std::unique_ptr<Common::FS::MappedFile> mapped_file;
 };
 
 // An implementation of VfsDirectory that represents a directory on the user's computer.
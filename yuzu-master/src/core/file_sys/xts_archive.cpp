@@ -17,6 +17,7 @@
 #include "core/crypto/key_manager.h"
 #include "core/crypto/xts_encryption_layer.h"
 #include "core/file_sys/content_archive.h"
+#include "core/file_sys/fssystem/fssystem_block_cache_storage.h"
 #include "core/file_sys/vfs/vfs_offset.h"
 #include "core/file_sys/xts_archive.h"
 #include "core/loader/loader.h"
@@ -128,7 +129,10 @@ Loader::ResultStatus NAX::Parse(std::string_view path) {
     std::memcpy(final_key.data(), &header->key_area, final_key.size());
     const auto enc_file =
         std::make_shared<OffsetVfsFile>(file, header->file_size, NAX_HEADER_PADDING_SIZE);
-    dec_file = std::make_shared<Core::Crypto::XTSEncryptionLayer>(enc_file, final_key);
+    // The xts layer decrypts whole 0x4000 byte sectors for every read, cache them.
+    dec_file = std::make_shared<BlockCacheStorage>(
+        std::make_shared<Core::Crypto::XTSEncryptionLayer>(enc_file, final_key),
+        BlockCacheBudget::Decrypted());
 
     return Loader::ResultStatus::Success;
 }
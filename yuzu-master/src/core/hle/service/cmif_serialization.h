@@ -239,7 +239,24 @@ constexpr RequestLayout GetReplyOutLayout(bool is_domain) {
     return is_domain ? GetDomainReplyOutLayout<MethodArguments>() : GetNonDomainReplyOutLayout<MethodArguments>();
 }
 
-using OutTemporaryBuffers = std::array<Common::ScratchBuffer<u8>, 3>;
+struct OutTemporaryBuffers {
+    // Memory handed to the service for each output buffer, the guest memory itself when it can
+    // be written in place.
+    std::array<std::span<u8>, 3> spans{};
+    // Backing memory of the output buffers which can not be written in place.
+    std::array<Common::ScratchBuffer<u8>, 3> scratch{};
+};
+
+template <typename ArgType>
+std::span<u8> GetOutBufferGuestSpan(HLERequestContext& ctx, size_t buffer_index) {
+    if constexpr (ArgType::Attr & BufferAttr_HipcAutoSelect) {
+        return ctx.WriteBufferSpan(buffer_index);
+    } else if constexpr (ArgType::Attr & BufferAttr_HipcMapAlias) {
+        return ctx.WriteBufferSpanB(buffer_index);
+    } else /* if (ArgType::Attr & BufferAttr_HipcPointer) */ {
+        return ctx.WriteBufferSpanC(buffer_index);
+    }
+}
 
 template <typename MethodArguments, typename CallArguments, size_t PrevAlign = 1, size_t DataOffset = 0, size_t HandleIndex = 0, size_t InBufferIndex = 0, size_t OutBufferIndex = 0, bool RawDataFinished = false, size_t ArgIndex = 0>
 void ReadInArgument(bool is_domain, CallArguments& args, const u8* raw_data, HLERequestContext& ctx, OutTemporaryBuffers& temp) {
@@ -338,12 +355,17 @@ void ReadInArgument(bool is_domain, CallArguments& args, const u8* raw_data, HLE
         } else if constexpr (ArgumentTraits<ArgType>::Type == ArgumentType::OutBuffer) {
             using ElementType = typename ArgType::Type;
 
-            // Set up scratch buffer.
-            auto& buffer = temp[OutBufferIndex];
+            // Let the service write to guest memory directly, or set up a scratch buffer when it can't.
+            auto& buffer = temp.spans[OutBufferIndex];
+            buffer = {};
             if (ctx.CanWriteBuffer(OutBufferIndex)) {
-                buffer.resize_destructive(ctx.GetWriteBufferSize(OutBufferIndex));
-            } else {
-                buffer.resize_destructive(0);
+                const size_t buffer_size = ctx.GetWriteBufferSize(OutBufferIndex);
+                buffer = GetOutBufferGuestSpan<ArgType>(ctx, OutBufferIndex);
+                if (buffer.size() != buffer_size || reinterpret_cast<uintptr_t>(buffer.data()) % alignof(ElementType) != 0) {
+                    auto& scratch = temp.scratch[OutBufferIndex];
+                    scratch.resize_destructive(buffer_size);
+                    buffer = scratch;
+                }
             }
 
             ElementType* ptr = (ElementType*) buffer.data();
@@ -412,7 +434,7 @@ void WriteOutArgument(bool is_domain, CallArguments& args, u8* raw_data, HLERequ
 
             return WriteOutArgument<MethodArguments, CallArguments, PrevAlign, DataOffset, OutBufferIndex + 1, RawDataFinished, ArgIndex + 1>(is_domain, args, raw_data, ctx, temp);
         } else if constexpr (ArgumentTraits<ArgType>::Type == ArgumentType::OutBuffer) {
-            auto& buffer = temp[OutBufferIndex];
+            const std::span<u8> buffer = temp.spans[OutBufferIndex];
             const size_t size = buffer.size();
 
             if (size > 0 && ctx.CanWriteBuffer(OutBufferIndex)) {
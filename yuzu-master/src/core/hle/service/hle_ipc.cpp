@@ -152,9 +152,6 @@ void HLERequestContext::ParseCommandBuffer(u32_le* src_cmdbuf, bool incoming) {
         }
         if (incoming) {
             // Populate the object lists with the data in the IPC request.
-            incoming_copy_handles.reserve(handle_descriptor_header->num_handles_to_copy);
-            incoming_move_handles.reserve(handle_descriptor_header->num_handles_to_move);
-
             for (u32 handle = 0; handle < handle_descriptor_header->num_handles_to_copy; ++handle) {
                 incoming_copy_handles.push_back(rp.Pop<Handle>());
             }
@@ -169,11 +166,6 @@ void HLERequestContext::ParseCommandBuffer(u32_le* src_cmdbuf, bool incoming) {
         }
     }
 
-    buffer_x_descriptors.reserve(command_header->num_buf_x_descriptors);
-    buffer_a_descriptors.reserve(command_header->num_buf_a_descriptors);
-    buffer_b_descriptors.reserve(command_header->num_buf_b_descriptors);
-    buffer_w_descriptors.reserve(command_header->num_buf_w_descriptors);
-
     for (u32 i = 0; i < command_header->num_buf_x_descriptors; ++i) {
         buffer_x_descriptors.push_back(rp.PopRaw<IPC::BufferDescriptorX>());
     }
@@ -429,7 +421,7 @@ std::size_t HLERequestContext::WriteBufferB(const void* buffer, std::size_t size
         size = buffer_size; // TODO(bunnei): This needs to be HW tested
     }
 
-    memory.WriteBlock(BufferDescriptorB()[buffer_index].Address(), buffer, size);
+    CommitWriteBuffer(BufferDescriptorB()[buffer_index].Address(), buffer, size);
     return size;
 }
 
@@ -446,10 +438,67 @@ std::size_t HLERequestContext::WriteBufferC(const void* buffer, std::size_t size
         size = buffer_size; // TODO(bunnei): This needs to be HW tested
     }
 
-    memory.WriteBlock(BufferDescriptorC()[buffer_index].Address(), buffer, size);
+    CommitWriteBuffer(BufferDescriptorC()[buffer_index].Address(), buffer, size);
     return size;
 }
 
+void HLERequestContext::CommitWriteBuffer(u64 address, const void* buffer,
+                                          std::size_t size) const {
+    if (memory.GetSpan(address, size) == buffer) {
+        // The service wrote the response in place, only the caches need to see the write
+        memory.StoreDataCache(address, size);
+    } else {
+        memory.WriteBlock(address, buffer, size);
+    }
+}
+
+std::span<u8> HLERequestContext::WriteBufferSpan(std::size_t buffer_index) const {
+    const bool is_buffer_b{BufferDescriptorB().size() > buffer_index &&
+                           BufferDescriptorB()[buffer_index].Size()};
+    return is_buffer_b ? WriteBufferSpanB(buffer_index) : WriteBufferSpanC(buffer_index);
+}
+
+std::span<u8> HLERequestContext::WriteBufferSpanB(std::size_t buffer_index) const {
+    if (buffer_index >= BufferDescriptorB().size()) {
+        return {};
+    }
+    const auto& descriptor{BufferDescriptorB()[buffer_index]};
+    return GetWritableSpan(&descriptor, descriptor.Address(), descriptor.Size());
+}
+
+std::span<u8> HLERequestContext::WriteBufferSpanC(std::size_t buffer_index) const {
+    if (buffer_index >= BufferDescriptorC().size()) {
+        return {};
+    }
+    const auto& descriptor{BufferDescriptorC()[buffer_index]};
+    return GetWritableSpan(&descriptor, descriptor.Address(), descriptor.Size());
+}
+
+std::span<u8> HLERequestContext::GetWritableSpan(const void* descriptor, u64 address,
+                                                 u64 size) const {
+    if (size == 0) {
+        return {};
+    }
+    // Writing in place is only equivalent to writing a copy at the end of the request when no
+    // other buffer can observe the partial results.
+    const auto overlaps = [&](const auto& descriptors) {
+        return std::ranges::any_of(descriptors, [&](const auto& other) {
+            return static_cast<const void*>(&other) != descriptor && other.Size() != 0 &&
+                   other.Address() < address + size && address < other.Address() + other.Size();
+        });
+    };
+    if (overlaps(buffer_x_descriptors) || overlaps(buffer_a_descriptors) ||
+        overlaps(buffer_b_descriptors) || overlaps(buffer_w_descriptors) ||
+        overlaps(buffer_c_descriptors)) {
+        return {};
+    }
+    u8* const pointer{memory.GetSpan(address, size)};
+    if (!pointer) {
+        return {};
+    }
+    return {pointer, size};
+}
+
 std::size_t HLERequestContext::GetReadBufferSize(std::size_t buffer_index) const {
     const bool is_buffer_a{BufferDescriptorA().size() > buffer_index &&
                            BufferDescriptorA()[buffer_index].Size()};
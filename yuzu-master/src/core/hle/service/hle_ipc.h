@@ -12,6 +12,9 @@
 #include <type_traits>
 #include <vector>
 
+#include <boost/container/small_vector.hpp>
+#include <boost/container/static_vector.hpp>
+
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/concepts.h"
@@ -201,6 +204,13 @@ public:
     /// Populates this context with data from the requesting process/thread.
     Result PopulateFromIncomingCommandBuffer(u32_le* src_cmdbuf);
 
+    /**
+     * Parses the headers, buffer descriptors and handles of a command buffer. Unlike
+     * PopulateFromIncomingCommandBuffer, this does not need the requesting thread unless the
+     * request sends its process ID.
+     */
+    void ParseCommandBuffer(u32_le* src_cmdbuf, bool incoming);
+
     /// Writes data from this context back to the requesting process/thread.
     Result WriteToOutgoingCommandBuffer();
 
@@ -233,20 +243,20 @@ public:
         return data_payload_offset;
     }
 
-    [[nodiscard]] const std::vector<IPC::BufferDescriptorX>& BufferDescriptorX() const {
-        return buffer_x_descriptors;
+    [[nodiscard]] std::span<const IPC::BufferDescriptorX> BufferDescriptorX() const {
+        return {buffer_x_descriptors.data(), buffer_x_descriptors.size()};
     }
 
-    [[nodiscard]] const std::vector<IPC::BufferDescriptorABW>& BufferDescriptorA() const {
-        return buffer_a_descriptors;
+    [[nodiscard]] std::span<const IPC::BufferDescriptorABW> BufferDescriptorA() const {
+        return {buffer_a_descriptors.data(), buffer_a_descriptors.size()};
     }
 
-    [[nodiscard]] const std::vector<IPC::BufferDescriptorABW>& BufferDescriptorB() const {
-        return buffer_b_descriptors;
+    [[nodiscard]] std::span<const IPC::BufferDescriptorABW> BufferDescriptorB() const {
+        return {buffer_b_descriptors.data(), buffer_b_descriptors.size()};
     }
 
-    [[nodiscard]] const std::vector<IPC::BufferDescriptorC>& BufferDescriptorC() const {
-        return buffer_c_descriptors;
+    [[nodiscard]] std::span<const IPC::BufferDescriptorC> BufferDescriptorC() const {
+        return {buffer_c_descriptors.data(), buffer_c_descriptors.size()};
     }
 
     [[nodiscard]] const IPC::DomainMessageHeader& GetDomainMessageHeader() const {
@@ -281,6 +291,22 @@ public:
     std::size_t WriteBufferC(const void* buffer, std::size_t size,
                              std::size_t buffer_index = 0) const;
 
+    /**
+     * Helper function to get the guest memory of an output buffer, using the appropriate buffer
+     * descriptor, so a service can produce its response in place. The data still has to be
+     * committed with WriteBuffer, which skips the copy when it is given the returned span.
+     *
+     * @returns The guest memory of the buffer, or an empty span when the buffer is not contiguous
+     *          in host memory or overlaps another buffer of the request.
+     */
+    [[nodiscard]] std::span<u8> WriteBufferSpan(std::size_t buffer_index = 0) const;
+
+    /// Helper function to get the guest memory of buffer B, see WriteBufferSpan
+    [[nodiscard]] std::span<u8> WriteBufferSpanB(std::size_t buffer_index = 0) const;
+
+    /// Helper function to get the guest memory of buffer C, see WriteBufferSpan
+    [[nodiscard]] std::span<u8> WriteBufferSpanC(std::size_t buffer_index = 0) const;
+
     /* Helper function to write a buffer using the appropriate buffer descriptor
      *
      * @tparam T an arbitrary container that satisfies the
@@ -392,29 +418,40 @@ public:
 private:
     friend class IPC::ResponseBuilder;
 
-    void ParseCommandBuffer(u32_le* src_cmdbuf, bool incoming);
+    [[nodiscard]] std::span<u8> GetWritableSpan(const void* descriptor, u64 address,
+                                                u64 size) const;
+
+    /// Commits size bytes of buffer to an output buffer, unless they were written in place.
+    void CommitWriteBuffer(u64 address, const void* buffer, std::size_t size) const;
+
+    // Descriptor and handle counts are 4-bit fields of the command header, with at most 13 C
+    // buffers, so a request always fits in fixed storage and parsing it never allocates.
+    static constexpr std::size_t MaxDescriptors = 16;
+
+    template <typename T>
+    using DescriptorList = boost::container::static_vector<T, MaxDescriptors>;
 
     std::array<u32, IPC::COMMAND_BUFFER_LENGTH> cmd_buf;
     Kernel::KServerSession* server_session{};
     Kernel::KHandleTable* client_handle_table{};
     Kernel::KThread* thread{};
 
-    std::vector<Handle> incoming_move_handles;
-    std::vector<Handle> incoming_copy_handles;
+    DescriptorList<Handle> incoming_move_handles;
+    DescriptorList<Handle> incoming_copy_handles;
 
-    std::vector<Kernel::KAutoObject*> outgoing_move_objects;
-    std::vector<Kernel::KAutoObject*> outgoing_copy_objects;
-    std::vector<SessionRequestHandlerPtr> outgoing_domain_objects;
+    boost::container::small_vector<Kernel::KAutoObject*, 4> outgoing_move_objects;
+    boost::container::small_vector<Kernel::KAutoObject*, 4> outgoing_copy_objects;
+    boost::container::small_vector<SessionRequestHandlerPtr, 4> outgoing_domain_objects;
 
     std::optional<IPC::CommandHeader> command_header;
     std::optional<IPC::HandleDescriptorHeader> handle_descriptor_header;
     std::optional<IPC::DataPayloadHeader> data_payload_header;
     std::optional<IPC::DomainMessageHeader> domain_message_header;
-    std::vector<IPC::BufferDescriptorX> buffer_x_descriptors;
-    std::vector<IPC::BufferDescriptorABW> buffer_a_descriptors;
-    std::vector<IPC::BufferDescriptorABW> buffer_b_descriptors;
-    std::vector<IPC::BufferDescriptorABW> buffer_w_descriptors;
-    std::vector<IPC::BufferDescriptorC> buffer_c_descriptors;
+    DescriptorList<IPC::BufferDescriptorX> buffer_x_descriptors;
+    DescriptorList<IPC::BufferDescriptorABW> buffer_a_descriptors;
+    DescriptorList<IPC::BufferDescriptorABW> buffer_b_descriptors;
+    DescriptorList<IPC::BufferDescriptorABW> buffer_w_descriptors;
+    DescriptorList<IPC::BufferDescriptorC> buffer_c_descriptors;
 
     u32_le command{};
     u64 pid{};
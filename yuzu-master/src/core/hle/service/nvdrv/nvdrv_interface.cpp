@@ -15,6 +15,22 @@
 #include "core/hle/service/nvdrv/nvdrv_interface.h"
 
 namespace Service::Nvidia {
+namespace {
+/// Returns the memory an ioctl writes an output buffer to, which is the guest memory itself
+/// unless the buffer has to be written as a copy. Ioctls without outputs always get a copy, which
+/// is discarded, as the device wrappers fill the output buffer whatever the ioctl does.
+std::span<u8> GetOutputBuffer(HLERequestContext& ctx, Common::ScratchBuffer<u8>& scratch,
+                              const Ioctl& command, std::size_t buffer_index) {
+    const std::size_t size = ctx.GetWriteBufferSize(buffer_index);
+    if (command.is_out != 0) {
+        if (const auto span = ctx.WriteBufferSpan(buffer_index); span.size() == size) {
+            return span;
+        }
+    }
+    scratch.resize_destructive(size);
+    return scratch;
+}
+} // Anonymous namespace
 
 void NVDRV::Open(HLERequestContext& ctx) {
     LOG_DEBUG(Service_NVDRV, "called");
@@ -65,12 +81,12 @@ void NVDRV::Ioctl1(HLERequestContext& ctx) {
     }
 
     // Check device
-    output_buffer.resize_destructive(ctx.GetWriteBufferSize(0));
+    const auto output = GetOutputBuffer(ctx, output_buffer, command, 0);
     const auto input_buffer = ctx.ReadBuffer(0);
 
-    const auto nv_result = nvdrv->Ioctl1(fd, command, input_buffer, output_buffer);
+    const auto nv_result = nvdrv->Ioctl1(fd, command, input_buffer, output);
     if (command.is_out != 0) {
-        ctx.WriteBuffer(output_buffer);
+        ctx.WriteBuffer(output);
     }
 
     IPC::ResponseBuilder rb{ctx, 3};
@@ -92,12 +108,11 @@ void NVDRV::Ioctl2(HLERequestContext& ctx) {
 
     const auto input_buffer = ctx.ReadBuffer(0);
     const auto input_inlined_buffer = ctx.ReadBuffer(1);
-    output_buffer.resize_destructive(ctx.GetWriteBufferSize(0));
+    const auto output = GetOutputBuffer(ctx, output_buffer, command, 0);
 
-    const auto nv_result =
-        nvdrv->Ioctl2(fd, command, input_buffer, input_inlined_buffer, output_buffer);
+    const auto nv_result = nvdrv->Ioctl2(fd, command, input_buffer, input_inlined_buffer, output);
     if (command.is_out != 0) {
-        ctx.WriteBuffer(output_buffer);
+        ctx.WriteBuffer(output);
     }
 
     IPC::ResponseBuilder rb{ctx, 3};
@@ -118,14 +133,13 @@ void NVDRV::Ioctl3(HLERequestContext& ctx) {
     }
 
     const auto input_buffer = ctx.ReadBuffer(0);
-    output_buffer.resize_destructive(ctx.GetWriteBufferSize(0));
-    inline_output_buffer.resize_destructive(ctx.GetWriteBufferSize(1));
+    const auto output = GetOutputBuffer(ctx, output_buffer, command, 0);
+    const auto inline_output = GetOutputBuffer(ctx, inline_output_buffer, command, 1);
 
-    const auto nv_result =
-        nvdrv->Ioctl3(fd, command, input_buffer, output_buffer, inline_output_buffer);
+    const auto nv_result = nvdrv->Ioctl3(fd, command, input_buffer, output, inline_output);
     if (command.is_out != 0) {
-        ctx.WriteBuffer(output_buffer, 0);
-        ctx.WriteBuffer(inline_output_buffer, 1);
+        ctx.WriteBuffer(output, 0);
+        ctx.WriteBuffer(inline_output, 1);
     }
 
     IPC::ResponseBuilder rb{ctx, 3};
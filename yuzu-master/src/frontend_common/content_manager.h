@@ -5,7 +5,6 @@
 
 #include <boost/algorithm/string.hpp>
 #include "common/common_types.h"
-#include "common/literals.h"
 #include "core/core.h"
 #include "core/file_sys/common_funcs.h"
 #include "core/file_sys/content_archive.h"
@@ -137,25 +136,7 @@ inline InstallResult InstallNSP(Core::System& system, FileSys::VfsFilesystem& vf
                                 const std::function<bool(size_t, size_t)>& callback) {
     const auto copy = [callback](const FileSys::VirtualFile& src, const FileSys::VirtualFile& dest,
                                  std::size_t block_size) {
-        if (src == nullptr || dest == nullptr) {
-            return false;
-        }
-        if (!dest->Resize(src->GetSize())) {
-            return false;
-        }
-
-        using namespace Common::Literals;
-        std::vector<u8> buffer(1_MiB);
-
-        for (std::size_t i = 0; i < src->GetSize(); i += buffer.size()) {
-            if (callback(src->GetSize(), i)) {
-                dest->Resize(0);
-                return false;
-            }
-            const auto read = src->Read(buffer.data(), buffer.size(), i);
-            dest->Write(buffer.data(), read, i);
-        }
-        return true;
+        return FileSys::VfsRawCopyWithProgress(src, dest, block_size, callback);
     };
 
     std::shared_ptr<FileSys::NSP> nsp;
@@ -203,25 +184,7 @@ inline InstallResult InstallNCA(FileSys::VfsFilesystem& vfs, const std::string&
                                 const std::function<bool(size_t, size_t)>& callback) {
     const auto copy = [callback](const FileSys::VirtualFile& src, const FileSys::VirtualFile& dest,
                                  std::size_t block_size) {
-        if (src == nullptr || dest == nullptr) {
-            return false;
-        }
-        if (!dest->Resize(src->GetSize())) {
-            return false;
-        }
-
-        using namespace Common::Literals;
-        std::vector<u8> buffer(1_MiB);
-
-        for (std::size_t i = 0; i < src->GetSize(); i += buffer.size()) {
-            if (callback(src->GetSize(), i)) {
-                dest->Resize(0);
-                return false;
-            }
-            const auto read = src->Read(buffer.data(), buffer.size(), i);
-            dest->Write(buffer.data(), read, i);
-        }
-        return true;
+        return FileSys::VfsRawCopyWithProgress(src, dest, block_size, callback);
     };
 
     const auto nca =
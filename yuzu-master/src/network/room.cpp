@@ -3,6 +3,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <iomanip>
 #include <mutex>
 #include <random>
@@ -10,7 +11,10 @@
 #include <shared_mutex>
 #include <sstream>
 #include <thread>
+#include <unordered_map>
+#include "common/bit_cast.h"
 #include "common/logging/log.h"
+#include "common/thread_worker.h"
 #include "enet/enet.h"
 #include "network/packet.h"
 #include "network/room.h"
@@ -18,6 +22,13 @@
 
 namespace Network {
 
+namespace {
+/// Key of a fake ip address in the routing index.
+u32 FakeIPKey(const IPv4Address& address) {
+    return Common::BitCast<u32>(address);
+}
+} // Anonymous namespace
+
 class Room::RoomImpl {
 public:
     std::mt19937 random_gen; ///< Random number generator. Used for GenerateFakeIPAddress
@@ -43,6 +54,20 @@ public:
     using MemberList = std::vector<Member>;
     MemberList members;                     ///< Information about the members of this room
     mutable std::shared_mutex member_mutex; ///< Mutex for locking the members list
+    /// Peers of the members indexed by their fake ip address, locked by member_mutex
+    std::unordered_map<u32, ENetPeer*> fake_ip_index;
+
+    /// Join request waiting for the verification backend.
+    struct PendingJoin {
+        ENetPeer* peer;          ///< The remote peer.
+        enet_uint32 connect_id;  ///< Connection of the peer that sent the request.
+        std::string nickname;    ///< The requested nickname.
+        IPv4Address fake_ip;     ///< The requested fake ip address, or NoPreferredIP.
+        std::string ip;          ///< The real ip address of the peer.
+        VerifyUser::UserData user_data;
+    };
+    std::vector<PendingJoin> pending_joins; ///< Verified joins waiting to be added to the room
+    std::mutex pending_joins_mutex;         ///< Mutex for pending_joins
 
     UsernameBanList username_ban_list; ///< List of banned usernames
     IPBanList ip_ban_list;             ///< List of banned IP addresses
@@ -56,17 +81,32 @@ public:
     /// Verification backend of the room
     std::unique_ptr<VerifyUser::Backend> verify_backend;
 
+    /// Worker calling the verification backend, which may block on web requests
+    Common::ThreadWorker verify_worker{1, "RoomVerify"};
+
     /// Thread function that will receive and dispatch messages until the room is destroyed.
     void ServerLoop();
     void StartLoop();
 
+    /// Dispatches a received event to its handler.
+    void HandleEvent(const ENetEvent* event);
+
     /**
-     * Parses and answers a room join request from a client.
-     * Validates the uniqueness of the username and assigns the MAC address
-     * that the client will use for the remainder of the connection.
+     * Parses a room join request from a client and queues it for verification.
+     * Requests that can be rejected without verifying the user are answered immediately.
      */
     void HandleJoinRequest(const ENetEvent* event);
 
+    /**
+     * Answers a verified join request.
+     * Validates the uniqueness of the username and assigns the fake ip address
+     * that the client will use for the remainder of the connection.
+     */
+    void FinishJoinRequest(PendingJoin& join);
+
+    /// Answers the join requests verified since the last call.
+    void FinishPendingJoins();
+
     /**
      * Parses and answers a kick request from a client.
      * Validates the permissions and that the given user exists and then kicks the member.
@@ -217,6 +257,16 @@ public:
      */
     void HandleLdnPacket(const ENetEvent* event);
 
+    /**
+     * Forwards a received packet to its destination member, or to all members except the sender
+     * when it is a broadcast. The packet is sent as is, without copying it.
+     * @param event The ENet event containing the packet
+     * @param remote_ip_offset Offset of the destination IP address in the packet
+     * @param broadcast_offset Offset of the broadcast flag in the packet
+     */
+    void ForwardPacket(const ENetEvent* event, std::size_t remote_ip_offset,
+                       std::size_t broadcast_offset);
+
     /**
      * Extracts a chat entry from a received ENet packet and adds it to the chat queue.
      * @param event The ENet event that was received.
@@ -241,53 +291,66 @@ void Room::RoomImpl::ServerLoop() {
     while (state != State::Closed) {
         ENetEvent event;
         if (enet_host_service(server, &event, 5) > 0) {
-            switch (event.type) {
-            case ENET_EVENT_TYPE_RECEIVE:
-                switch (event.packet->data[0]) {
-                case IdJoinRequest:
-                    HandleJoinRequest(&event);
-                    break;
-                case IdSetGameInfo:
-                    HandleGameInfoPacket(&event);
-                    break;
-                case IdProxyPacket:
-                    HandleProxyPacket(&event);
-                    break;
-                case IdLdnPacket:
-                    HandleLdnPacket(&event);
-                    break;
-                case IdChatMessage:
-                    HandleChatPacket(&event);
-                    break;
-                // Moderation
-                case IdModKick:
-                    HandleModKickPacket(&event);
-                    break;
-                case IdModBan:
-                    HandleModBanPacket(&event);
-                    break;
-                case IdModUnban:
-                    HandleModUnbanPacket(&event);
-                    break;
-                case IdModGetBanList:
-                    HandleModGetBanListPacket(&event);
-                    break;
-                }
-                enet_packet_destroy(event.packet);
-                break;
-            case ENET_EVENT_TYPE_DISCONNECT:
-                HandleClientDisconnection(event.peer);
-                break;
-            case ENET_EVENT_TYPE_NONE:
-            case ENET_EVENT_TYPE_CONNECT:
-                break;
-            }
+            // Handle every event that arrived with this one before flushing, so packets
+            // forwarded to the same peer are sent together
+            do {
+                HandleEvent(&event);
+            } while (enet_host_check_events(server, &event) > 0);
+            enet_host_flush(server);
         }
+        FinishPendingJoins();
     }
     // Close the connection to all members:
     SendCloseMessage();
 }
 
+void Room::RoomImpl::HandleEvent(const ENetEvent* event) {
+    switch (event->type) {
+    case ENET_EVENT_TYPE_RECEIVE:
+        switch (event->packet->data[0]) {
+        case IdJoinRequest:
+            HandleJoinRequest(event);
+            break;
+        case IdSetGameInfo:
+            HandleGameInfoPacket(event);
+            break;
+        case IdProxyPacket:
+            HandleProxyPacket(event);
+            break;
+        case IdLdnPacket:
+            HandleLdnPacket(event);
+            break;
+        case IdChatMessage:
+            HandleChatPacket(event);
+            break;
+        // Moderation
+        case IdModKick:
+            HandleModKickPacket(event);
+            break;
+        case IdModBan:
+            HandleModBanPacket(event);
+            break;
+        case IdModUnban:
+            HandleModUnbanPacket(event);
+            break;
+        case IdModGetBanList:
+            HandleModGetBanListPacket(event);
+            break;
+        }
+        // Forwarded packets are owned by ENet until every peer has sent them
+        if (event->packet->referenceCount == 0) {
+            enet_packet_destroy(event->packet);
+        }
+        break;
+    case ENET_EVENT_TYPE_DISCONNECT:
+        HandleClientDisconnection(event->peer);
+        break;
+    case ENET_EVENT_TYPE_NONE:
+    case ENET_EVENT_TYPE_CONNECT:
+        break;
+    }
+}
+
 void Room::RoomImpl::StartLoop() {
     room_thread = std::make_unique<std::thread>(&Room::RoomImpl::ServerLoop, this);
 }
@@ -334,9 +397,6 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
             SendIPCollision(event->peer);
             return;
         }
-    } else {
-        // Assign a fake ip address of this client automatically
-        preferred_fake_ip = GenerateFakeIPAddress();
     }
 
     if (client_version != network_version) {
@@ -344,20 +404,77 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
         return;
     }
 
-    // At this point the client is ready to be added to the room.
-    Member member{};
-    member.fake_ip = preferred_fake_ip;
-    member.nickname = nickname;
-    member.peer = event->peer;
+    std::string ip;
+    {
+        std::lock_guard lock(ban_list_mutex);
+
+        // Check IP ban
+        std::array<char, 256> ip_raw{};
+        enet_address_get_host_ip(&event->peer->address, ip_raw.data(), sizeof(ip_raw) - 1);
+        ip = ip_raw.data();
+
+        if (std::find(ip_ban_list.begin(), ip_ban_list.end(), ip) != ip_ban_list.end()) {
+            SendUserBanned(event->peer);
+            return;
+        }
+    }
 
     std::string uid;
     {
         std::lock_guard lock(verify_uid_mutex);
         uid = verify_uid;
     }
-    member.user_data = verify_backend->LoadUserData(uid, token);
 
-    std::string ip;
+    // Verifying the user can take a web request, keep routing packets in the meantime
+    verify_worker.QueueWork([this, uid = std::move(uid), token = std::move(token),
+                             join = PendingJoin{
+                                 .peer = event->peer,
+                                 .connect_id = event->peer->connectID,
+                                 .nickname = std::move(nickname),
+                                 .fake_ip = preferred_fake_ip,
+                                 .ip = std::move(ip),
+                                 .user_data = {},
+                             }]() mutable {
+        join.user_data = verify_backend->LoadUserData(uid, token);
+        std::lock_guard lock(pending_joins_mutex);
+        pending_joins.push_back(std::move(join));
+    });
+}
+
+void Room::RoomImpl::FinishJoinRequest(PendingJoin& join) {
+    ENetPeer* const peer = join.peer;
+    if (peer->state != ENET_PEER_STATE_CONNECTED || peer->connectID != join.connect_id) {
+        // The client left while it was being verified
+        return;
+    }
+
+    // Other clients may have joined while this one was being verified
+    {
+        std::lock_guard lock(member_mutex);
+        if (members.size() >= room_information.member_slots) {
+            SendRoomIsFull(peer);
+            return;
+        }
+    }
+    if (!IsValidNickname(join.nickname)) {
+        SendNameCollision(peer);
+        return;
+    }
+    if (join.fake_ip == NoPreferredIP) {
+        // Assign a fake ip address of this client automatically
+        join.fake_ip = GenerateFakeIPAddress();
+    } else if (!IsValidFakeIPAddress(join.fake_ip)) {
+        SendIPCollision(peer);
+        return;
+    }
+
+    // At this point the client is ready to be added to the room.
+    Member member{};
+    member.fake_ip = join.fake_ip;
+    member.nickname = join.nickname;
+    member.peer = peer;
+    member.user_data = std::move(join.user_data);
+
     {
         std::lock_guard lock(ban_list_mutex);
 
@@ -366,35 +483,40 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
             std::find(username_ban_list.begin(), username_ban_list.end(),
                       member.user_data.username) != username_ban_list.end()) {
 
-            SendUserBanned(event->peer);
-            return;
-        }
-
-        // Check IP ban
-        std::array<char, 256> ip_raw{};
-        enet_address_get_host_ip(&event->peer->address, ip_raw.data(), sizeof(ip_raw) - 1);
-        ip = ip_raw.data();
-
-        if (std::find(ip_ban_list.begin(), ip_ban_list.end(), ip) != ip_ban_list.end()) {
-            SendUserBanned(event->peer);
+            SendUserBanned(peer);
             return;
         }
     }
 
     // Notify everyone that the user has joined.
-    SendStatusMessage(IdMemberJoin, member.nickname, member.user_data.username, ip);
+    SendStatusMessage(IdMemberJoin, member.nickname, member.user_data.username, join.ip);
 
     {
         std::lock_guard lock(member_mutex);
+        fake_ip_index.emplace(FakeIPKey(member.fake_ip), peer);
         members.push_back(std::move(member));
     }
 
     // Notify everyone that the room information has changed.
     BroadcastRoomInformation();
-    if (HasModPermission(event->peer)) {
-        SendJoinSuccessAsMod(event->peer, preferred_fake_ip);
+    if (HasModPermission(peer)) {
+        SendJoinSuccessAsMod(peer, join.fake_ip);
     } else {
-        SendJoinSuccess(event->peer, preferred_fake_ip);
+        SendJoinSuccess(peer, join.fake_ip);
+    }
+}
+
+void Room::RoomImpl::FinishPendingJoins() {
+    std::vector<PendingJoin> joins;
+    {
+        std::lock_guard lock(pending_joins_mutex);
+        if (pending_joins.empty()) {
+            return;
+        }
+        joins.swap(pending_joins);
+    }
+    for (PendingJoin& join : joins) {
+        FinishJoinRequest(join);
     }
 }
 
@@ -432,6 +554,7 @@ void Room::RoomImpl::HandleModKickPacket(const ENetEvent* event) {
         ip = ip_raw.data();
 
         enet_peer_disconnect(target_member->peer, 0);
+        fake_ip_index.erase(FakeIPKey(target_member->fake_ip));
         members.erase(target_member);
     }
 
@@ -475,6 +598,7 @@ void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
         ip = ip_raw.data();
 
         enet_peer_disconnect(target_member->peer, 0);
+        fake_ip_index.erase(FakeIPKey(target_member->fake_ip));
         members.erase(target_member);
     }
 
@@ -561,9 +685,8 @@ bool Room::RoomImpl::IsValidNickname(const std::string& nickname) const {
 
 bool Room::RoomImpl::IsValidFakeIPAddress(const IPv4Address& address) const {
     // An IP address is valid if it is not already taken by anybody else in the room.
-    std::lock_guard lock(member_mutex);
-    return std::all_of(members.begin(), members.end(),
-                       [&address](const auto& member) { return member.fake_ip != address; });
+    std::shared_lock lock(member_mutex);
+    return !fake_ip_index.contains(FakeIPKey(address));
 }
 
 bool Room::RoomImpl::HasModPermission(const ENetPeer* client) const {
@@ -813,115 +936,57 @@ IPv4Address Room::RoomImpl::GenerateFakeIPAddress() {
 }
 
 void Room::RoomImpl::HandleProxyPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
-    in_packet.IgnoreBytes(sizeof(u8)); // Message type
-
-    in_packet.IgnoreBytes(sizeof(u8));          // Domain
-    in_packet.IgnoreBytes(sizeof(IPv4Address)); // IP
-    in_packet.IgnoreBytes(sizeof(u16));         // Port
-
-    in_packet.IgnoreBytes(sizeof(u8)); // Domain
-    IPv4Address remote_ip;
-    in_packet.Read(remote_ip);          // IP
-    in_packet.IgnoreBytes(sizeof(u16)); // Port
-
-    in_packet.IgnoreBytes(sizeof(u8)); // Protocol
-
-    bool broadcast;
-    in_packet.Read(broadcast); // Broadcast
-
-    Packet out_packet;
-    out_packet.Append(event->packet->data, event->packet->dataLength);
-    ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                                 ENET_PACKET_FLAG_RELIABLE);
-
-    const auto& destination_address = remote_ip;
-    if (broadcast) { // Send the data to everyone except the sender
-        std::lock_guard lock(member_mutex);
-        bool sent_packet = false;
-        for (const auto& member : members) {
-            if (member.peer != event->peer) {
-                sent_packet = true;
-                enet_peer_send(member.peer, 0, enet_packet);
-            }
-        }
-
-        if (!sent_packet) {
-            enet_packet_destroy(enet_packet);
-        }
-    } else { // Send the data only to the destination client
-        std::lock_guard lock(member_mutex);
-        auto member = std::find_if(members.begin(), members.end(),
-                                   [destination_address](const Member& member_entry) -> bool {
-                                       return member_entry.fake_ip == destination_address;
-                                   });
-        if (member != members.end()) {
-            enet_peer_send(member->peer, 0, enet_packet);
-        } else {
-            LOG_ERROR(Network,
-                      "Attempting to send to unknown IP address: "
-                      "{}.{}.{}.{}",
-                      destination_address[0], destination_address[1], destination_address[2],
-                      destination_address[3]);
-            enet_packet_destroy(enet_packet);
-        }
-    }
-    enet_host_flush(server);
+    // Message type, then the local endpoint (domain, IP and port) and the remote endpoint,
+    // followed by the protocol and the broadcast flag
+    static constexpr std::size_t remote_ip_offset =
+        sizeof(u8) + sizeof(u8) + sizeof(IPv4Address) + sizeof(u16) + sizeof(u8);
+    static constexpr std::size_t broadcast_offset =
+        remote_ip_offset + sizeof(IPv4Address) + sizeof(u16) + sizeof(u8);
+    ForwardPacket(event, remote_ip_offset, broadcast_offset);
 }
 
 void Room::RoomImpl::HandleLdnPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
-
-    in_packet.IgnoreBytes(sizeof(u8)); // Message type
-
-    in_packet.IgnoreBytes(sizeof(u8));          // LAN packet type
-    in_packet.IgnoreBytes(sizeof(IPv4Address)); // Local IP
-
-    IPv4Address remote_ip;
-    in_packet.Read(remote_ip); // Remote IP
+    // Message type, LAN packet type and local IP, followed by the remote IP and the broadcast flag
+    static constexpr std::size_t remote_ip_offset = sizeof(u8) + sizeof(u8) + sizeof(IPv4Address);
+    static constexpr std::size_t broadcast_offset = remote_ip_offset + sizeof(IPv4Address);
+    ForwardPacket(event, remote_ip_offset, broadcast_offset);
+}
 
-    bool broadcast;
-    in_packet.Read(broadcast); // Broadcast
+void Room::RoomImpl::ForwardPacket(const ENetEvent* event, std::size_t remote_ip_offset,
+                                   std::size_t broadcast_offset) {
+    ENetPacket* const packet = event->packet;
+    if (packet->dataLength <= broadcast_offset) {
+        LOG_ERROR(Network, "Received a truncated packet of {} bytes", packet->dataLength);
+        return;
+    }
+    IPv4Address destination_address;
+    std::memcpy(destination_address.data(), packet->data + remote_ip_offset,
+                sizeof(destination_address));
+    const bool broadcast = packet->data[broadcast_offset] != 0;
 
-    Packet out_packet;
-    out_packet.Append(event->packet->data, event->packet->dataLength);
-    ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                                 ENET_PACKET_FLAG_RELIABLE);
+    // Forward the received packet itself, ENet frees it once it has been sent to every peer
+    packet->flags = ENET_PACKET_FLAG_RELIABLE;
 
-    const auto& destination_address = remote_ip;
+    std::shared_lock lock(member_mutex);
     if (broadcast) { // Send the data to everyone except the sender
-        std::lock_guard lock(member_mutex);
-        bool sent_packet = false;
         for (const auto& member : members) {
             if (member.peer != event->peer) {
-                sent_packet = true;
-                enet_peer_send(member.peer, 0, enet_packet);
+                enet_peer_send(member.peer, 0, packet);
             }
         }
-
-        if (!sent_packet) {
-            enet_packet_destroy(enet_packet);
-        }
-    } else {
-        std::lock_guard lock(member_mutex);
-        auto member = std::find_if(members.begin(), members.end(),
-                                   [destination_address](const Member& member_entry) -> bool {
-                                       return member_entry.fake_ip == destination_address;
-                                   });
-        if (member != members.end()) {
-            enet_peer_send(member->peer, 0, enet_packet);
-        } else {
-            LOG_ERROR(Network,
-                      "Attempting to send to unknown IP address: "
-                      "{}.{}.{}.{}",
-                      destination_address[0], destination_address[1], destination_address[2],
-                      destination_address[3]);
-            enet_packet_destroy(enet_packet);
-        }
+        return;
     }
-    enet_host_flush(server);
+    // Send the data only to the destination client
+    const auto it = fake_ip_index.find(FakeIPKey(destination_address));
+    if (it == fake_ip_index.end()) {
+        LOG_ERROR(Network,
+                  "Attempting to send to unknown IP address: "
+                  "{}.{}.{}.{}",
+                  destination_address[0], destination_address[1], destination_address[2],
+                  destination_address[3]);
+        return;
+    }
+    enet_peer_send(it->second, 0, packet);
 }
 
 void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
@@ -1026,6 +1091,7 @@ void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
             enet_address_get_host_ip(&member->peer->address, ip_raw.data(), sizeof(ip_raw) - 1);
             ip = ip_raw.data();
 
+            fake_ip_index.erase(FakeIPKey(member->fake_ip));
             members.erase(member);
         }
     }
@@ -1127,6 +1193,13 @@ void Room::Destroy() {
     room_impl->room_thread->join();
     room_impl->room_thread.reset();
 
+    // Joins still being verified are for peers of the host being destroyed
+    room_impl->verify_worker.WaitForRequests();
+    {
+        std::lock_guard lock(room_impl->pending_joins_mutex);
+        room_impl->pending_joins.clear();
+    }
+
     if (room_impl->server) {
         enet_host_destroy(room_impl->server);
     }
@@ -1135,6 +1208,7 @@ void Room::Destroy() {
     {
         std::lock_guard lock(room_impl->member_mutex);
         room_impl->members.clear();
+        room_impl->fake_ip_index.clear();
     }
     room_impl->room_information.member_slots = 0;
     room_impl->room_information.name.clear();
@@ -79,13 +79,6 @@ public:
         return Common::BitCast<DefinitionType>(definition);
     }
 
-    void SetSsaRegValue(IR::Reg reg, const Value& value) noexcept {
-        ssa_reg_values[RegIndex(reg)] = value;
-    }
-    const Value& SsaRegValue(IR::Reg reg) const noexcept {
-        return ssa_reg_values[RegIndex(reg)];
-    }
-
     void SsaSeal() noexcept {
         is_ssa_sealed = true;
     }
@@ -177,8 +170,6 @@ private:
     /// Block immediate successors
     std::vector<Block*> imm_successors;
 
-    /// Intrusively store the value of a register in the block.
-    std::array<Value, NUM_REGS> ssa_reg_values;
     /// Intrusively store if the block is sealed in the SSA pass.
     bool is_ssa_sealed{false};
 
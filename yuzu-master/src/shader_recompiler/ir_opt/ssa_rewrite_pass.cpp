@@ -13,8 +13,9 @@
 //      https://link.springer.com/chapter/10.1007/978-3-642-37051-9_6
 //
 
+#include <algorithm>
+#include <array>
 #include <deque>
-#include <map>
 #include <span>
 #include <unordered_map>
 #include <variant>
@@ -26,6 +27,7 @@
 #include "shader_recompiler/frontend/ir/reg.h"
 #include "shader_recompiler/frontend/ir/value.h"
 #include "shader_recompiler/ir_opt/passes.h"
+#include "shader_recompiler/object_pool.h"
 
 namespace Shader::Optimization {
 namespace {
@@ -54,19 +56,24 @@ using Variant = std::variant<IR::Reg, IR::Pred, ZeroFlagTag, SignFlagTag, CarryF
                              OverflowFlagTag, GotoVariable, IndirectBranchVariable>;
 using ValueMap = std::unordered_map<IR::Block*, IR::Value>;
 
-struct DefTable {
+/// Definitions of the variables at the end of each block, blocks are indexed by their order.
+/// Registers, predicates and flags are split in groups, and the definitions of a group in a block
+/// are stored in a chunk allocated from a pool the first time the block defines one of them.
+/// Shaders only use a fraction of the registers, so most groups of most blocks are never allocated.
+class DefTable {
+public:
     const IR::Value& Def(IR::Block* block, IR::Reg variable) {
-        return block->SsaRegValue(variable);
+        return Get(block, IR::RegIndex(variable));
     }
     void SetDef(IR::Block* block, IR::Reg variable, const IR::Value& value) {
-        block->SetSsaRegValue(variable, value);
+        Set(block, IR::RegIndex(variable), value);
     }
 
     const IR::Value& Def(IR::Block* block, IR::Pred variable) {
-        return preds[IR::PredIndex(variable)][block];
+        return Get(block, PRED_BASE + IR::PredIndex(variable));
     }
     void SetDef(IR::Block* block, IR::Pred variable, const IR::Value& value) {
-        preds[IR::PredIndex(variable)].insert_or_assign(block, value);
+        Set(block, PRED_BASE + IR::PredIndex(variable), value);
     }
 
     const IR::Value& Def(IR::Block* block, GotoVariable variable) {
@@ -77,47 +84,77 @@ struct DefTable {
     }
 
     const IR::Value& Def(IR::Block* block, IndirectBranchVariable) {
-        return indirect_branch_var[block];
+        return Get(block, INDIRECT_BRANCH_INDEX);
     }
     void SetDef(IR::Block* block, IndirectBranchVariable, const IR::Value& value) {
-        indirect_branch_var.insert_or_assign(block, value);
+        Set(block, INDIRECT_BRANCH_INDEX, value);
     }
 
     const IR::Value& Def(IR::Block* block, ZeroFlagTag) {
-        return zero_flag[block];
+        return Get(block, FLAG_BASE + 0);
     }
     void SetDef(IR::Block* block, ZeroFlagTag, const IR::Value& value) {
-        zero_flag.insert_or_assign(block, value);
+        Set(block, FLAG_BASE + 0, value);
     }
 
     const IR::Value& Def(IR::Block* block, SignFlagTag) {
-        return sign_flag[block];
+        return Get(block, FLAG_BASE + 1);
     }
     void SetDef(IR::Block* block, SignFlagTag, const IR::Value& value) {
-        sign_flag.insert_or_assign(block, value);
+        Set(block, FLAG_BASE + 1, value);
     }
 
     const IR::Value& Def(IR::Block* block, CarryFlagTag) {
-        return carry_flag[block];
+        return Get(block, FLAG_BASE + 2);
     }
     void SetDef(IR::Block* block, CarryFlagTag, const IR::Value& value) {
-        carry_flag.insert_or_assign(block, value);
+        Set(block, FLAG_BASE + 2, value);
     }
 
     const IR::Value& Def(IR::Block* block, OverflowFlagTag) {
-        return overflow_flag[block];
+        return Get(block, FLAG_BASE + 3);
     }
     void SetDef(IR::Block* block, OverflowFlagTag, const IR::Value& value) {
-        overflow_flag.insert_or_assign(block, value);
+        Set(block, FLAG_BASE + 3, value);
+    }
+
+private:
+    static constexpr size_t PRED_BASE = IR::NUM_REGS;
+    static constexpr size_t FLAG_BASE = PRED_BASE + IR::NUM_USER_PREDS;
+    static constexpr size_t INDIRECT_BRANCH_INDEX = FLAG_BASE + 4;
+    static constexpr size_t NUM_VARIABLES = INDIRECT_BRANCH_INDEX + 1;
+    static constexpr size_t GROUP_SIZE = 16;
+    static constexpr size_t NUM_GROUPS = (NUM_VARIABLES + GROUP_SIZE - 1) / GROUP_SIZE;
+
+    using Chunk = std::array<IR::Value, GROUP_SIZE>;
+
+    static size_t ChunkIndex(const IR::Block* block, size_t variable) {
+        return block->GetOrder() * NUM_GROUPS + variable / GROUP_SIZE;
+    }
+
+    const IR::Value& Get(const IR::Block* block, size_t variable) const {
+        static constexpr IR::Value empty{};
+        const size_t index{ChunkIndex(block, variable)};
+        if (index >= chunks.size() || !chunks[index]) {
+            return empty;
+        }
+        return (*chunks[index])[variable % GROUP_SIZE];
+    }
+
+    void Set(const IR::Block* block, size_t variable, const IR::Value& value) {
+        const size_t index{ChunkIndex(block, variable)};
+        if (index >= chunks.size()) {
+            chunks.resize((index / NUM_GROUPS + 1) * NUM_GROUPS);
+        }
+        if (!chunks[index]) {
+            chunks[index] = chunk_pool.Create();
+        }
+        (*chunks[index])[variable % GROUP_SIZE] = value;
     }
 
-    std::array<ValueMap, IR::NUM_USER_PREDS> preds;
+    ObjectPool<Chunk> chunk_pool{256};
+    std::vector<Chunk*> chunks;
     std::unordered_map<u32, ValueMap> goto_vars;
-    ValueMap indirect_branch_var;
-    ValueMap zero_flag;
-    ValueMap sign_flag;
-    ValueMap carry_flag;
-    ValueMap overflow_flag;
 };
 
 IR::Opcode UndefOpcode(IR::Reg) noexcept {
@@ -194,7 +231,7 @@ public:
                     IR::Inst* phi{&*block->PrependNewInst(block->begin(), IR::Opcode::Phi)};
                     phi->SetFlags(IR::TypeOf(UndefOpcode(variable)));
 
-                    incomplete_phis[block].insert_or_assign(variable, phi);
+                    IncompletePhis(block).emplace_back(variable, phi);
                     stack.back().result = IR::Value{&*phi};
                 } else if (const std::span imm_preds = block->ImmPredecessors();
                            imm_preds.size() == 1) {
@@ -239,13 +276,17 @@ public:
     }
 
     void SealBlock(IR::Block* block) {
-        const auto it{incomplete_phis.find(block)};
-        if (it != incomplete_phis.end()) {
-            for (auto& pair : it->second) {
-                auto& variant{pair.first};
-                auto& phi{pair.second};
+        // Reading the operands may add phis to this or other blocks, take the list out of the
+        // table before completing it
+        const u32 order{block->GetOrder()};
+        std::vector<std::pair<Variant, IR::Inst*>> phis;
+        while (order < incomplete_phis.size() && !incomplete_phis[order].empty()) {
+            phis.swap(incomplete_phis[order]);
+            std::ranges::sort(phis, {}, &std::pair<Variant, IR::Inst*>::first);
+            for (auto& [variant, phi] : phis) {
                 std::visit([&](auto& variable) { AddPhiOperands(variable, *phi, block); }, variant);
             }
+            phis.clear();
         }
         block->SsaSeal();
     }
@@ -276,10 +317,12 @@ private:
         }
         // Remove the phi node from the block, it will be reinserted
         IR::Block::InstructionList& list{block->Instructions()};
-        list.erase(IR::Block::InstructionList::s_iterator_to(phi));
+        const auto next{list.erase(IR::Block::InstructionList::s_iterator_to(phi))};
 
         // Find the first non-phi instruction and use it as an insertion point
-        IR::Block::iterator reinsert_point{std::ranges::find_if_not(list, IR::IsPhi)};
+        // Phis are only inserted at the start of blocks, so every instruction before this phi is
+        // a phi too and the search can start after it
+        IR::Block::iterator reinsert_point{std::find_if_not(next, list.end(), IR::IsPhi)};
         if (same.IsEmpty()) {
             // The phi is unreachable or in the start block
             // Insert an undefined instruction and make it the phi node replacement
@@ -295,7 +338,16 @@ private:
         return same;
     }
 
-    std::unordered_map<IR::Block*, std::map<Variant, IR::Inst*>> incomplete_phis;
+    std::vector<std::pair<Variant, IR::Inst*>>& IncompletePhis(const IR::Block* block) {
+        const u32 order{block->GetOrder()};
+        if (order >= incomplete_phis.size()) {
+            incomplete_phis.resize(order + 1);
+        }
+        return incomplete_phis[order];
+    }
+
+    /// Phis of unsealed blocks waiting for their operands, indexed by the order of the block.
+    std::vector<std::vector<std::pair<Variant, IR::Inst*>>> incomplete_phis;
     DefTable current_def;
 };
 
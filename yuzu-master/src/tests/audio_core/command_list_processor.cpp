@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <new>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "audio_core/adsp/apps/audio_renderer/command_list_processor.h"
+#include "audio_core/renderer/command/command_list_header.h"
+#include "audio_core/renderer/command/commands.h"
+#include "audio_core/renderer/voice/voice_state.h"
+#include "common/common_types.h"
+#include "core/core.h"
+#include "core/memory.h"
+
+namespace {
+using namespace AudioCore;
+using AudioCore::ADSP::AudioRenderer::CommandListProcessor;
+using Renderer::CommandId;
+
+constexpr u32 SAMPLE_COUNT = 240;
+constexpr u32 SAMPLE_RATE = 48'000;
+constexpr size_t NUM_VOICES = 12;
+// Voices decode into one of two channel buffers, and are mixed into one of four output buffers
+constexpr u32 NUM_CHANNEL_BUFFERS = 2;
+constexpr u32 NUM_OUTPUT_BUFFERS = 4;
+constexpr u32 BUFFER_COUNT = NUM_CHANNEL_BUFFERS + NUM_OUTPUT_BUFFERS;
+
+/// A command list like the ones generated for voices, in host memory.
+struct TestList {
+    alignas(16) std::array<u8, 0x10000> commands{};
+    size_t size{};
+    u32 command_count{};
+    Renderer::CommandListHeader header{};
+    std::array<Renderer::VoiceState, NUM_VOICES> voice_states{};
+    std::vector<s32> mix_buffers;
+
+    template <typename T>
+    T& Emplace(CommandId type, u32 node_id) {
+        REQUIRE(size + sizeof(T) <= commands.size());
+        T& command{*new (commands.data() + size) T()};
+        command.magic = Renderer::CommandMagic;
+        command.enabled = true;
+        command.type = type;
+        command.size = static_cast<s16>(sizeof(T));
+        command.estimated_process_time = 1000;
+        command.node_id = node_id;
+        size += sizeof(T);
+        ++command_count;
+        return command;
+    }
+};
+
+/**
+ * Build a list of voices which are all starved. Every third voice, starting with the first one,
+ * skips pitch and sample rate conversion so its data source decodes nothing. The others resample
+ * their sample history. The mix buffers start with the leftovers of a previous list.
+ */
+std::unique_ptr<TestList> MakeStarvedVoices(size_t num_voices) {
+    auto list{std::make_unique<TestList>()};
+    std::mt19937 rng{1234};
+    std::uniform_int_distribution<s32> sample{-(1 << 20), 1 << 20};
+    list->mix_buffers.resize(BUFFER_COUNT * SAMPLE_COUNT);
+    std::ranges::generate(list->mix_buffers, [&] { return sample(rng); });
+
+    for (size_t voice = 0; voice < num_voices; ++voice) {
+        auto& voice_state{list->voice_states[voice]};
+        std::ranges::generate(voice_state.sample_history,
+                              [&] { return static_cast<s16>(sample(rng) >> 5); });
+
+        const u32 node_id{static_cast<u32>(voice + 1)};
+        const s16 channel{static_cast<s16>(voice % NUM_CHANNEL_BUFFERS)};
+        auto& data_source{list->Emplace<Renderer::PcmInt16DataSourceVersion1Command>(
+            CommandId::DataSourcePcmInt16Version1, node_id)};
+        data_source.src_quality = SrcQuality::Medium;
+        data_source.output_index = channel;
+        data_source.flags = voice % 3 == 0 ? 2 : 0;
+        data_source.sample_rate = SAMPLE_RATE;
+        data_source.pitch = 1.0f;
+        data_source.channel_count = 1;
+        data_source.voice_state = reinterpret_cast<CpuAddr>(&voice_state);
+
+        auto& volume{
+            list->Emplace<Renderer::VolumeRampCommand>(CommandId::VolumeRamp, node_id)};
+        volume.precision = 15;
+        volume.input_index = channel;
+        volume.output_index = channel;
+        volume.prev_volume = 0.5f;
+        volume.volume = 1.0f;
+
+        auto& mix{list->Emplace<Renderer::MixCommand>(CommandId::Mix, node_id)};
+        mix.precision = 15;
+        mix.input_index = channel;
+        mix.output_index = static_cast<s16>(NUM_CHANNEL_BUFFERS + voice % NUM_OUTPUT_BUFFERS);
+        mix.volume = 1.0f;
+    }
+
+    list->header.command_count = list->command_count;
+    list->header.voice_command_begin = 0;
+    list->header.voice_command_end = list->command_count;
+    return list;
+}
+
+void Process(TestList& list, bool parallel_voices, Core::System& system,
+             Core::Memory::Memory& memory) {
+    CommandListProcessor processor;
+    processor.system = &system;
+    processor.memory = &memory;
+    processor.header = &list.header;
+    processor.commands = list.commands.data();
+    processor.commands_buffer_size = list.size;
+    processor.command_count = list.command_count;
+    processor.sample_count = SAMPLE_COUNT;
+    processor.target_sample_rate = SAMPLE_RATE;
+    processor.mix_buffers = list.mix_buffers;
+    processor.buffer_count = BUFFER_COUNT;
+    processor.parallel_voices = parallel_voices;
+    processor.Process(0);
+}
+} // Anonymous namespace
+
+TEST_CASE("CommandListProcessor: Starved voices are silent", "[audio_core]") {
+    Core::System system;
+    Core::Memory::Memory memory{system};
+    const auto list{MakeStarvedVoices(1)};
+    Process(*list, false, system, memory);
+
+    // The voice decodes nothing, its channel buffer must not keep the leftovers
+    const auto buffer{std::span(list->mix_buffers).first(SAMPLE_COUNT)};
+    REQUIRE(std::ranges::all_of(buffer, [](s32 value) { return value == 0; }));
+}
+
+TEST_CASE("CommandListProcessor: Parallel voices match serial processing", "[audio_core]") {
+    Core::System system;
+    Core::Memory::Memory memory{system};
+    const auto serial{MakeStarvedVoices(NUM_VOICES)};
+    const auto parallel{MakeStarvedVoices(NUM_VOICES)};
+    Process(*serial, false, system, memory);
+    Process(*parallel, true, system, memory);
+
+    REQUIRE(serial->mix_buffers == parallel->mix_buffers);
+    for (size_t voice = 0; voice < NUM_VOICES; ++voice) {
+        REQUIRE(serial->voice_states[voice].sample_history ==
+                parallel->voice_states[voice].sample_history);
+        REQUIRE(serial->voice_states[voice].played_sample_count ==
+                parallel->voice_states[voice].played_sample_count);
+    }
+}
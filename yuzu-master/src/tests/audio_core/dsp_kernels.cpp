@@ -0,0 +1,246 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "audio_core/renderer/command/dsp_kernels.h"
+#include "common/common_types.h"
+#include "common/fixed_point.h"
+
+namespace {
+using AudioCore::Renderer::DspKernels::Fraction;
+using AudioCore::Renderer::DspKernels::GetTable;
+using AudioCore::Renderer::DspKernels::Isa;
+using AudioCore::Renderer::DspKernels::Table;
+
+constexpr std::array ALL_ISAS{Isa::Scalar, Isa::Sse41, Isa::Avx2, Isa::Neon};
+constexpr std::array ISA_NAMES{"Scalar", "SSE4.1", "AVX2", "NEON"};
+constexpr std::array SAMPLE_COUNTS{0U, 1U, 3U, 7U, 8U, 13U, 160U, 240U, 241U};
+
+// Reference kernels, written like the commands were before they used the kernel tables
+
+template <size_t Q>
+s32 ReferenceMix(std::span<s32> output, std::span<const s32> input, f32 volume_, f32 ramp_) {
+    Common::FixedPoint<64 - Q, Q> volume{volume_};
+    const Common::FixedPoint<64 - Q, Q> ramp{ramp_};
+    Common::FixedPoint<64 - Q, Q> sample{0};
+    for (size_t i = 0; i < output.size(); i++) {
+        sample = input[i] * volume;
+        output[i] = (output[i] + sample).to_int();
+        volume += ramp;
+    }
+    return sample.to_int();
+}
+
+template <size_t Q>
+void ReferenceGain(std::span<s32> output, std::span<const s32> input, f32 volume_, f32 ramp_) {
+    Common::FixedPoint<64 - Q, Q> gain{volume_};
+    const Common::FixedPoint<64 - Q, Q> ramp{ramp_};
+    for (size_t i = 0; i < output.size(); i++) {
+        output[i] = (input[i] * gain).to_int();
+        gain += ramp;
+    }
+}
+
+template <size_t Taps>
+void ReferenceResample(std::span<s32> output, std::span<const s16> input,
+                       std::span<const f32> lut, const Fraction& sample_rate_ratio,
+                       Fraction& fraction) {
+    u32 read_index{0};
+    for (size_t i = 0; i < output.size(); i++) {
+        const auto lut_index{(fraction.get_frac() >> 8) * Taps};
+        Common::FixedPoint<56, 8> sum{0};
+        for (size_t tap = 0; tap < Taps; tap++) {
+            sum = sum + Common::FixedPoint<56, 8>{input[read_index + tap] * lut[lut_index + tap]};
+        }
+        output[i] = sum.to_int_floor();
+        fraction += sample_rate_ratio;
+        read_index += static_cast<u32>(fraction.to_int_floor());
+        fraction.clear_int();
+    }
+}
+
+template <size_t Q>
+s64 RawVolume(f32 volume) {
+    return Common::FixedPoint<64 - Q, Q>{volume}.to_raw();
+}
+
+std::vector<s32> RandomSamples(std::mt19937& rng, size_t count) {
+    std::uniform_int_distribution<s32> dist{std::numeric_limits<s32>::min(),
+                                            std::numeric_limits<s32>::max()};
+    std::vector<s32> samples(count);
+    for (auto& sample : samples) {
+        sample = dist(rng);
+    }
+    // Include the extremes, they are where rounding and wrapping differences would show
+    if (count >= 2) {
+        samples[0] = std::numeric_limits<s32>::min();
+        samples[count - 1] = std::numeric_limits<s32>::max();
+    }
+    return samples;
+}
+
+std::vector<s16> RandomPcm(std::mt19937& rng, size_t count) {
+    std::uniform_int_distribution<s32> dist{std::numeric_limits<s16>::min(),
+                                            std::numeric_limits<s16>::max()};
+    std::vector<s16> samples(count);
+    for (auto& sample : samples) {
+        sample = static_cast<s16>(dist(rng));
+    }
+    return samples;
+}
+
+/// Builds a lut in the range of the resampler coefficients.
+std::vector<f32> RandomLut(std::mt19937& rng, size_t taps) {
+    std::uniform_real_distribution<f32> dist{-0.07f, 1.3f};
+    std::vector<f32> lut(128 * taps);
+    for (auto& coefficient : lut) {
+        coefficient = dist(rng);
+    }
+    return lut;
+}
+
+/// Runs func with the kernels of every instruction set supported by the host.
+template <typename Func>
+void ForEachTable(Func&& func) {
+    for (size_t i = 0; i < ALL_ISAS.size(); i++) {
+        if (const Table* const table = GetTable(ALL_ISAS[i])) {
+            func(*table, ISA_NAMES[i]);
+        }
+    }
+}
+
+/// Volumes and ramps to check, the large ones leave the range of the 32-bit vector lanes.
+struct VolumeCase {
+    f32 volume;
+    f32 ramp;
+};
+
+constexpr std::array VOLUME_CASES{
+    VolumeCase{1.0f, 0.0f},      VolumeCase{0.5f, 0.0f},          VolumeCase{0.7071f, 0.0f},
+    VolumeCase{-0.3f, 0.0f},     VolumeCase{0.0f, 1.0f / 240.0f}, VolumeCase{1.0f, -1.0f / 240.0f},
+    VolumeCase{0.25f, 0.0013f},  VolumeCase{3.9f, -0.017f},       VolumeCase{-2.0f, 0.021f},
+    VolumeCase{200.0f, 0.0f},    VolumeCase{255.0f, 0.5f},        VolumeCase{300.0f, -1.0f},
+    VolumeCase{1.0f, 1.5f},
+};
+
+template <size_t Q>
+void CheckMixAndGain(const Table& table, std::mt19937& rng) {
+    for (const u32 count : SAMPLE_COUNTS) {
+        const std::vector<s32> input = RandomSamples(rng, count);
+        for (const auto& [volume, ramp] : VOLUME_CASES) {
+            const std::vector<s32> initial = RandomSamples(rng, count);
+
+            std::vector<s32> expected = initial;
+            std::vector<s32> result = initial;
+            const s32 expected_last = ReferenceMix<Q>(expected, input, volume, ramp);
+            const s32 last = table.mix(result, input, RawVolume<Q>(volume), RawVolume<Q>(ramp), Q);
+            REQUIRE(result == expected);
+            REQUIRE(last == expected_last);
+
+            ReferenceGain<Q>(expected, input, volume, ramp);
+            table.gain(result, input, RawVolume<Q>(volume), RawVolume<Q>(ramp), Q);
+            REQUIRE(result == expected);
+        }
+    }
+}
+
+template <size_t Taps>
+void CheckResample(const Table& table, std::mt19937& rng) {
+    const auto resample = Taps == 4 ? table.resample4 : table.resample8;
+    const std::vector<f32> lut = RandomLut(rng, Taps);
+    // Upsampling, unity, and both downsampling ranges picking different luts in the command
+    for (const f32 ratio : {0.5f, 0.73f, 1.0f, 1.15f, 1.3f, 1.9f, 2.0f}) {
+        for (const u32 count : SAMPLE_COUNTS) {
+            const std::vector<s16> input = RandomPcm(rng, count * 2 + Taps + 1);
+            const Fraction sample_rate_ratio{ratio};
+            const Fraction initial_fraction{static_cast<f32>(rng() % 100) / 100.0f};
+
+            std::vector<s32> expected(count);
+            Fraction expected_fraction{initial_fraction};
+            ReferenceResample<Taps>(expected, input, lut, sample_rate_ratio, expected_fraction);
+
+            std::vector<s32> result(count);
+            Fraction fraction{initial_fraction};
+            resample(result, input, lut, sample_rate_ratio, fraction);
+            REQUIRE(result == expected);
+            REQUIRE(fraction.to_raw() == expected_fraction.to_raw());
+        }
+    }
+}
+
+template <typename Func>
+double NanosecondsPerSample(size_t samples_per_run, Func&& func) {
+    static constexpr int runs = 2000;
+    const auto start = std::chrono::steady_clock::now();
+    for (int run = 0; run < runs; run++) {
+        func();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           static_cast<double>(runs * samples_per_run);
+}
+} // Anonymous namespace
+
+TEST_CASE("DspKernels: Mix and gain match the fixed point commands", "[audio_core]") {
+    std::mt19937 rng{1234};
+    ForEachTable([&](const Table& table, const char*) {
+        CheckMixAndGain<15>(table, rng);
+        CheckMixAndGain<23>(table, rng);
+    });
+}
+
+TEST_CASE("DspKernels: Resampling matches the fixed point commands", "[audio_core]") {
+    std::mt19937 rng{5678};
+    ForEachTable([&](const Table& table, const char*) {
+        CheckResample<4>(table, rng);
+        CheckResample<8>(table, rng);
+    });
+}
+
+TEST_CASE("DspKernels: Default table is supported", "[audio_core]") {
+    const Table& table = GetTable();
+    bool found = false;
+    ForEachTable([&](const Table& candidate, const char*) { found |= &candidate == &table; });
+    REQUIRE(found);
+}
+
+TEST_CASE("DspKernels: Benchmark", "[.][audio_core]") {
+    // One command worth of samples at the 48KHz renderer rate
+    static constexpr u32 sample_count = 240;
+    std::mt19937 rng{42};
+    const std::vector<s32> input = RandomSamples(rng, sample_count);
+    const std::vector<s16> pcm = RandomPcm(rng, sample_count * 2 + 16);
+    const std::vector<f32> lut4 = RandomLut(rng, 4);
+    const std::vector<f32> lut8 = RandomLut(rng, 8);
+    std::vector<s32> output(sample_count);
+
+    ForEachTable([&](const Table& table, const char* name) {
+        const double mix = NanosecondsPerSample(sample_count, [&] {
+            table.mix(output, input, RawVolume<15>(0.5f), RawVolume<15>(0.001f), 15);
+        });
+        const double gain = NanosecondsPerSample(sample_count, [&] {
+            table.gain(output, input, RawVolume<15>(0.5f), RawVolume<15>(0.001f), 15);
+        });
+        const Fraction ratio{1.0884f};
+        const double resample4 = NanosecondsPerSample(sample_count, [&] {
+            Fraction fraction{0};
+            table.resample4(output, pcm, lut4, ratio, fraction);
+        });
+        const double resample8 = NanosecondsPerSample(sample_count, [&] {
+            Fraction fraction{0};
+            table.resample8(output, pcm, lut8, ratio, fraction);
+        });
+        printf("DspKernels %-6s: mix %.2f ns, gain %.2f ns, resample4 %.2f ns, "
+               "resample8 %.2f ns per sample\n",
+               name, mix, gain, resample4, resample8);
+    });
+}
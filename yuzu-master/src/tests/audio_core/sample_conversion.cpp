@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "audio_core/sink/sample_conversion.h"
+#include "common/common_types.h"
+
+namespace {
+using AudioCore::Sink::DownmixToStereo;
+using AudioCore::Sink::ScaleSamples;
+
+constexpr s32 SAMPLE_MIN = std::numeric_limits<s16>::min();
+constexpr s32 SAMPLE_MAX = std::numeric_limits<s16>::max();
+// Includes volumes which saturate, the stream volume goes above 1 with the yuzu volume setting
+constexpr std::array VOLUMES{0.0f, 0.3f, 1.0f, 1.7f, 4.0f};
+constexpr std::array SAMPLE_COUNTS{0U, 1U, 7U, 8U, 9U, 15U, 16U, 17U, 240U, 241U};
+constexpr std::array FRAME_COUNTS{0U, 1U, 2U, 3U, 5U, 160U, 161U};
+
+// Reference conversions, written like SinkStream::AppendBuffer did before they were vectorized
+
+void ReferenceScale(std::span<s16> samples, f32 volume) {
+    for (auto& sample : samples) {
+        sample = static_cast<s16>(std::clamp(
+            static_cast<s32>(static_cast<f32>(sample) * volume), SAMPLE_MIN, SAMPLE_MAX));
+    }
+}
+
+void ReferenceDownmix(std::span<s16> samples, f32 volume) {
+    static constexpr std::array<f32, 4> down_mix_coeff{1.0, 0.596f, 0.354f, 0.707f};
+    for (size_t read_index = 0, write_index = 0; read_index < samples.size();
+         read_index += 6, write_index += 2) {
+        const auto fl = static_cast<f32>(samples[read_index + 0]);
+        const auto fr = static_cast<f32>(samples[read_index + 1]);
+        const auto c = static_cast<f32>(samples[read_index + 2]);
+        const auto lfe = static_cast<f32>(samples[read_index + 3]);
+        const auto bl = static_cast<f32>(samples[read_index + 4]);
+        const auto br = static_cast<f32>(samples[read_index + 5]);
+
+        const auto left_sample{
+            static_cast<s32>((fl * down_mix_coeff[0] + c * down_mix_coeff[1] +
+                              lfe * down_mix_coeff[2] + bl * down_mix_coeff[3]) *
+                             volume)};
+        const auto right_sample{
+            static_cast<s32>((fr * down_mix_coeff[0] + c * down_mix_coeff[1] +
+                              lfe * down_mix_coeff[2] + br * down_mix_coeff[3]) *
+                             volume)};
+
+        samples[write_index + 0] =
+            static_cast<s16>(std::clamp(left_sample, SAMPLE_MIN, SAMPLE_MAX));
+        samples[write_index + 1] =
+            static_cast<s16>(std::clamp(right_sample, SAMPLE_MIN, SAMPLE_MAX));
+    }
+}
+
+/// Random samples, with the extremes of the range mixed in to exercise saturation.
+std::vector<s16> RandomSamples(std::mt19937& rng, size_t count) {
+    std::uniform_int_distribution<s32> dist{SAMPLE_MIN, SAMPLE_MAX};
+    std::vector<s16> samples(count);
+    for (size_t i = 0; i < count; ++i) {
+        switch (i % 11) {
+        case 3:
+            samples[i] = static_cast<s16>(SAMPLE_MAX);
+            break;
+        case 7:
+            samples[i] = static_cast<s16>(SAMPLE_MIN);
+            break;
+        default:
+            samples[i] = static_cast<s16>(dist(rng));
+            break;
+        }
+    }
+    return samples;
+}
+} // Anonymous namespace
+
+TEST_CASE("SampleConversion: ScaleSamples matches the scalar conversion", "[audio_core]") {
+    std::mt19937 rng{42};
+    for (const f32 volume : VOLUMES) {
+        for (const u32 count : SAMPLE_COUNTS) {
+            auto samples = RandomSamples(rng, count);
+            auto expected = samples;
+            ScaleSamples(samples, volume);
+            ReferenceScale(expected, volume);
+            REQUIRE(samples == expected);
+        }
+    }
+}
+
+TEST_CASE("SampleConversion: DownmixToStereo matches the scalar conversion", "[audio_core]") {
+    std::mt19937 rng{43};
+    for (const f32 volume : VOLUMES) {
+        for (const u32 frames : FRAME_COUNTS) {
+            auto samples = RandomSamples(rng, frames * 6);
+            auto expected = samples;
+            REQUIRE(DownmixToStereo(samples, volume) == frames * 2);
+            ReferenceDownmix(expected, volume);
+            REQUIRE(std::equal(samples.begin(), samples.begin() + frames * 2, expected.begin()));
+        }
+    }
+
+    // Loud frames on every channel saturate both outputs
+    std::vector<s16> loud(6 * 3, static_cast<s16>(SAMPLE_MAX));
+    std::ranges::fill(std::span(loud).subspan(6, 6), static_cast<s16>(SAMPLE_MIN));
+    DownmixToStereo(loud, 1.0f);
+    REQUIRE(loud[0] == SAMPLE_MAX);
+    REQUIRE(loud[1] == SAMPLE_MAX);
+    REQUIRE(loud[2] == SAMPLE_MIN);
+    REQUIRE(loud[3] == SAMPLE_MIN);
+    REQUIRE(loud[4] == SAMPLE_MAX);
+    REQUIRE(loud[5] == SAMPLE_MAX);
+}
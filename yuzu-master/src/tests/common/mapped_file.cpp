@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/fs/file.h"
+#include "common/fs/mapped_file.h"
+
+using Common::FS::MappedFile;
+
+namespace {
+/// File on the host removed when the test is done.
+class TempFile {
+public:
+    explicit TempFile(const std::vector<u8>& data)
+        : path{std::filesystem::temp_directory_path() / "yuzu_mapped_file_test"} {
+        Common::FS::IOFile file{path, Common::FS::FileAccessMode::Write,
+                                Common::FS::FileType::BinaryFile};
+        REQUIRE(file.IsOpen());
+        if (!data.empty()) {
+            REQUIRE(file.WriteSpan(std::span{data}) == data.size());
+        }
+    }
+    ~TempFile() {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+
+    const std::filesystem::path& Path() const {
+        return path;
+    }
+
+private:
+    std::filesystem::path path;
+};
+
+std::vector<u8> RandomBytes(size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::vector<u8> result(size);
+    for (u8& value : result) {
+        value = static_cast<u8>(rng());
+    }
+    return result;
+}
+} // Anonymous namespace
+
+TEST_CASE("MappedFile: Map and read", "[common]") {
+    const std::vector<u8> data = RandomBytes(0x12345, 1);
+    const TempFile temp{data};
+    const MappedFile file{temp.Path()};
+    REQUIRE(file.IsOpen());
+    REQUIRE(file.GetSize() == data.size());
+    REQUIRE(std::ranges::equal(file.GetSpan(), data));
+
+    std::array<u8, 0x100> buffer{};
+    REQUIRE(file.Read(buffer.data(), buffer.size(), 0x1000) == buffer.size());
+    REQUIRE(std::equal(buffer.begin(), buffer.end(), data.begin() + 0x1000));
+
+    // Reads are truncated at the end of the file
+    REQUIRE(file.Read(buffer.data(), buffer.size(), data.size() - 0x10) == 0x10);
+    REQUIRE(std::equal(buffer.begin(), buffer.begin() + 0x10, data.end() - 0x10));
+    REQUIRE(file.Read(buffer.data(), buffer.size(), data.size()) == 0);
+    REQUIRE(file.Read(buffer.data(), buffer.size(), data.size() + 0x1000) == 0);
+}
+
+TEST_CASE("MappedFile: Empty and missing files are not mapped", "[common]") {
+    {
+        const TempFile temp{{}};
+        const MappedFile file{temp.Path()};
+        REQUIRE(!file.IsOpen());
+        REQUIRE(file.GetSize() == 0);
+        REQUIRE(file.GetSpan().empty());
+    }
+    const MappedFile file{std::filesystem::temp_directory_path() / "yuzu_mapped_file_missing"};
+    REQUIRE(!file.IsOpen());
+    std::array<u8, 4> buffer{};
+    REQUIRE(file.Read(buffer.data(), buffer.size(), 0) == 0);
+}
+
+TEST_CASE("MappedFile: Move and close", "[common]") {
+    const std::vector<u8> data = RandomBytes(0x3000, 2);
+    const TempFile temp{data};
+    MappedFile file{temp.Path()};
+    MappedFile moved{std::move(file)};
+    REQUIRE(!file.IsOpen());
+    REQUIRE(moved.IsOpen());
+    REQUIRE(std::ranges::equal(moved.GetSpan(), data));
+
+    MappedFile assigned;
+    assigned = std::move(moved);
+    REQUIRE(!moved.IsOpen());
+    REQUIRE(std::ranges::equal(assigned.GetSpan(), data));
+
+    assigned.Close();
+    REQUIRE(!assigned.IsOpen());
+    REQUIRE(assigned.GetSize() == 0);
+}
@@ -4,15 +4,19 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <array>
+#include <atomic>
 #include <bitset>
 #include <chrono>
 #include <cstdlib>
 #include <memory>
 #include <optional>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/hardware_properties.h"
 
 namespace {
 // Numbers are chosen randomly to make sure the correct one is given.
@@ -139,3 +143,109 @@ TEST_CASE("CoreTiming[BasicOrderNoPausing]", "[core]") {
     printf("HostTimer No Pausing Timer Time: %.3f %.6f\n", timer_time / 1000.f,
            timer_time / 1000000.f);
 }
+
+TEST_CASE("CoreTiming[Unschedule]", "[core]") {
+    ScopeInit guard;
+    auto& core_timing = guard.core_timing;
+    std::vector<std::shared_ptr<Core::Timing::EventType>> events{
+        Core::Timing::CreateEvent("callbackA", HostCallbackTemplate<0>),
+        Core::Timing::CreateEvent("callbackB", HostCallbackTemplate<1>),
+        Core::Timing::CreateEvent("callbackC", HostCallbackTemplate<2>),
+    };
+
+    callbacks_ran_flags.reset();
+    expected_callback = 0;
+
+    core_timing.SyncPause(true);
+
+    const auto future_ns = std::chrono::nanoseconds{100};
+    for (const auto& event : events) {
+        core_timing.ScheduleEvent(future_ns, event);
+    }
+    core_timing.UnscheduleEvent(events[0], Core::Timing::UnscheduleEventType::NoWait);
+    core_timing.UnscheduleEvent(events[2], Core::Timing::UnscheduleEventType::NoWait);
+    // Scheduling again after unscheduling must still run the event
+    core_timing.ScheduleEvent(future_ns, events[2]);
+
+    core_timing.Pause(false);
+
+    while (core_timing.HasPendingEvents())
+        ;
+
+    REQUIRE(!callbacks_ran_flags.test(0));
+    REQUIRE(callbacks_ran_flags.test(1));
+    REQUIRE(callbacks_ran_flags.test(2));
+    REQUIRE(expected_callback == 2);
+}
+
+TEST_CASE("CoreTiming[UnscheduleCompaction]", "[core]") {
+    // Single core, so the queue is only advanced by the test and the events never expire
+    Core::Timing::CoreTiming core_timing;
+    core_timing.SetMulticore(false);
+    core_timing.Initialize([]() {});
+
+    const auto event = Core::Timing::CreateEvent("callbackA", HostCallbackTemplate<0>);
+    const auto other_event = Core::Timing::CreateEvent("callbackB", HostCallbackTemplate<1>);
+    core_timing.ScheduleEvent(std::chrono::seconds{2}, other_event);
+
+    for (size_t i = 0; i < 10000; ++i) {
+        core_timing.UnscheduleEvent(event, Core::Timing::UnscheduleEventType::NoWait);
+        core_timing.ScheduleEvent(std::chrono::seconds{1}, event);
+        core_timing.Advance();
+        REQUIRE(core_timing.GetQueuedEventCount() <= 64);
+    }
+
+    // The live events must survive the compactions
+    callbacks_ran_flags.reset();
+    core_timing.AddTicks(Core::Hardware::BASE_CLOCK_RATE * 3);
+    core_timing.Advance();
+    REQUIRE(callbacks_ran_flags.test(0));
+    REQUIRE(callbacks_ran_flags.test(1));
+    REQUIRE(core_timing.GetQueuedEventCount() == 0);
+}
+
+TEST_CASE("CoreTiming[Benchmark]", "[.][core]") {
+    ScopeInit guard;
+    auto& core_timing = guard.core_timing;
+    core_timing.SyncPause(true);
+    core_timing.SyncPause(false);
+
+    // Emulates HLE services rescheduling their looping events from host threads
+    static constexpr size_t num_threads = 4;
+    static constexpr size_t iterations = 100000;
+    std::atomic<u64> num_callbacks{};
+    std::vector<std::shared_ptr<Core::Timing::EventType>> events;
+    for (size_t i = 0; i < num_threads; ++i) {
+        events.push_back(Core::Timing::CreateEvent(
+            "benchmark", [&num_callbacks](s64, std::chrono::nanoseconds)
+                             -> std::optional<std::chrono::nanoseconds> {
+                ++num_callbacks;
+                return std::nullopt;
+            }));
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::jthread> threads;
+    for (size_t i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&core_timing, &event = events[i]] {
+            for (size_t j = 0; j < iterations; ++j) {
+                core_timing.UnscheduleEvent(event, Core::Timing::UnscheduleEventType::NoWait);
+                core_timing.ScheduleLoopingEvent(std::chrono::milliseconds{1},
+                                                 std::chrono::milliseconds{1}, event);
+            }
+        });
+    }
+    threads.clear();
+    const auto end = std::chrono::steady_clock::now();
+
+    for (const auto& event : events) {
+        core_timing.UnscheduleEvent(event);
+    }
+    while (core_timing.HasPendingEvents())
+        ;
+
+    const double ns_per_op =
+        std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    printf("HostTimer Reschedule from %zu threads: %.1f ns per reschedule, %llu callbacks\n",
+           num_threads, ns_per_op, static_cast<unsigned long long>(num_callbacks.load()));
+}
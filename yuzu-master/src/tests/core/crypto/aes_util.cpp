@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/hex_util.h"
+#include "core/crypto/aes_util.h"
+#include "core/crypto/key_manager.h"
+
+using namespace Core::Crypto;
+
+namespace {
+std::vector<u8> RandomBytes(size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::vector<u8> result(size);
+    for (u8& value : result) {
+        value = static_cast<u8>(rng());
+    }
+    return result;
+}
+
+void CheckXtsVector(std::string_view key, std::string_view tweak, std::string_view plaintext,
+                    std::string_view ciphertext) {
+    AESCipher<Key256> cipher(Common::HexStringToArray<0x20>(key), Mode::XTS);
+    cipher.SetIV(Common::HexStringToArray<0x10>(tweak));
+    const std::vector<u8> input = Common::HexStringToVector(plaintext, false);
+    const std::vector<u8> expected = Common::HexStringToVector(ciphertext, false);
+
+    std::vector<u8> output(input.size());
+    cipher.Transcode(input.data(), input.size(), output.data(), Op::Encrypt);
+    REQUIRE(output == expected);
+    cipher.Transcode(expected.data(), expected.size(), output.data(), Op::Decrypt);
+    REQUIRE(output == input);
+}
+} // Anonymous namespace
+
+TEST_CASE("AESCipher: CTR known answer", "[core]") {
+    // NIST SP 800-38A, F.5.1 CTR-AES128.Encrypt
+    AESCipher<Key128> cipher(Common::HexStringToArray<0x10>("2b7e151628aed2a6abf7158809cf4f3c"),
+                             Mode::CTR);
+    cipher.SetIV(Common::HexStringToArray<0x10>("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff"));
+    const std::vector<u8> plaintext = Common::HexStringToVector(
+        "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+        "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710",
+        false);
+    const std::vector<u8> ciphertext = Common::HexStringToVector(
+        "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+        "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee",
+        false);
+
+    // The counter carries over between calls
+    std::vector<u8> output(plaintext.size());
+    cipher.Transcode(plaintext.data(), 0x10, output.data(), Op::Encrypt);
+    cipher.Transcode(plaintext.data() + 0x10, 0x30, output.data() + 0x10, Op::Encrypt);
+    REQUIRE(output == ciphertext);
+}
+
+TEST_CASE("AESCipher: XTS known answer", "[core]") {
+    // IEEE 1619-2007, vectors 1, 2 and 15
+    CheckXtsVector("0000000000000000000000000000000000000000000000000000000000000000",
+                   "00000000000000000000000000000000",
+                   "0000000000000000000000000000000000000000000000000000000000000000",
+                   "917cf69ebd68b2ec9b9fe9a3eadda692cd43d2f59598ed858c02c2652fbf922e");
+    CheckXtsVector("1111111111111111111111111111111122222222222222222222222222222222",
+                   "33333333330000000000000000000000",
+                   "4444444444444444444444444444444444444444444444444444444444444444",
+                   "c454185e6a16936e39334038acef838bfb186fff7480adc4289382ecd6d394f0");
+    CheckXtsVector("fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0",
+                   "9a785634120000000000000000000000", "000102030405060708090a0b0c0d0e0f10",
+                   "6c1625db4671522d3d7599601de7ca09ed");
+}
+
+TEST_CASE("AESCipher: XTS sectors round trip", "[core]") {
+    static constexpr size_t sector_size = 0x200;
+    const std::vector<u8> data = RandomBytes(sector_size * 37, 1);
+    Key256 key{};
+    std::copy_n(RandomBytes(key.size(), 2).begin(), key.size(), key.begin());
+    AESCipher<Key256> cipher(key, Mode::XTS);
+
+    std::vector<u8> encrypted(data.size());
+    cipher.XTSTranscode(data.data(), data.size(), encrypted.data(), 5, sector_size, Op::Encrypt);
+    REQUIRE(encrypted != data);
+
+    // Sectors are independent of each other
+    std::vector<u8> sector(sector_size);
+    cipher.XTSTranscode(data.data() + sector_size * 3, sector_size, sector.data(), 8, sector_size,
+                        Op::Encrypt);
+    REQUIRE(std::equal(sector.begin(), sector.end(), encrypted.begin() + sector_size * 3));
+
+    std::vector<u8> decrypted(data.size());
+    cipher.XTSTranscode(encrypted.data(), encrypted.size(), decrypted.data(), 5, sector_size,
+                        Op::Decrypt);
+    REQUIRE(decrypted == data);
+}
+
+TEST_CASE("AESCipher: Benchmark", "[.][core]") {
+    static constexpr size_t size_mib = 64;
+    static constexpr size_t size = size_mib * 1024 * 1024;
+    static constexpr size_t sector_size = 0x4000;
+    std::vector<u8> data = RandomBytes(size, 3);
+
+    AESCipher<Key128> ctr(Key128{}, Mode::CTR);
+    ctr.SetIV(std::array<u8, 0x10>{});
+    auto start = std::chrono::steady_clock::now();
+    ctr.Transcode(data.data(), data.size(), data.data(), Op::Decrypt);
+    auto end = std::chrono::steady_clock::now();
+    printf("AES-CTR: %.1f MiB/s\n", size_mib / std::chrono::duration<double>(end - start).count());
+
+    AESCipher<Key256> xts(Key256{}, Mode::XTS);
+    start = std::chrono::steady_clock::now();
+    xts.XTSTranscode(data.data(), data.size(), data.data(), 0, sector_size, Op::Decrypt);
+    end = std::chrono::steady_clock::now();
+    printf("AES-XTS: %.1f MiB/s\n", size_mib / std::chrono::duration<double>(end - start).count());
+}
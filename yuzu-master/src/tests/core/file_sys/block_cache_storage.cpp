@@ -0,0 +1,158 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/file_sys/fssystem/fssystem_block_cache_storage.h"
+
+using namespace FileSys;
+
+namespace {
+constexpr size_t BLOCK_SIZE = BlockCacheStorage::BlockSize;
+// Blocks this far apart are kept in the same LRU list
+constexpr size_t SHARD_STRIDE = BLOCK_SIZE * BlockCacheStorage::ShardCount;
+
+/// Storage in memory which counts the reads that reach it.
+class CountingStorage : public IReadOnlyStorage {
+public:
+    explicit CountingStorage(size_t size) : data(size) {
+        std::mt19937 rng{static_cast<u32>(size)};
+        std::ranges::generate(data, [&] { return static_cast<u8>(rng()); });
+    }
+
+    size_t Read(u8* buffer, size_t size, size_t offset) const override {
+        ++num_reads;
+        if (offset >= data.size()) {
+            return 0;
+        }
+        size = std::min({size, data.size() - offset, max_read});
+        std::memcpy(buffer, data.data() + offset, size);
+        return size;
+    }
+
+    size_t GetSize() const override {
+        return data.size();
+    }
+
+    std::vector<u8> data;
+    size_t max_read = ~size_t{0};
+    mutable size_t num_reads = 0;
+};
+
+struct TestCache {
+    explicit TestCache(size_t size, BlockCacheBudget& budget)
+        : base{std::make_shared<CountingStorage>(size)}, cache{base, budget} {}
+
+    /// Reads from the cache and checks the data against the base storage.
+    size_t Read(size_t offset, size_t size) const {
+        std::vector<u8> buffer(size);
+        const size_t read = cache.Read(buffer.data(), size, offset);
+        REQUIRE(std::equal(buffer.begin(), buffer.begin() + read, base->data.begin() + offset));
+        return read;
+    }
+
+    std::shared_ptr<CountingStorage> base;
+    BlockCacheStorage cache;
+};
+} // Anonymous namespace
+
+TEST_CASE("BlockCacheStorage: Hits are counted per block", "[core][file_sys]") {
+    BlockCacheBudget budget{BLOCK_SIZE * 16};
+    const TestCache test{BlockCacheStorage::BypassSize * 2, budget};
+
+    // Small reads within a block only read it once from the base storage
+    REQUIRE(test.Read(0x10, 0x20) == 0x20);
+    REQUIRE(test.Read(0x100, 0x200) == 0x200);
+    REQUIRE(test.Read(0x3000, 0x1000) == 0x1000);
+    REQUIRE(test.base->num_reads == 1);
+
+    // A read over two blocks is a hit on the first and a miss on the second
+    REQUIRE(test.Read(BLOCK_SIZE - 0x10, 0x20) == 0x20);
+    BlockCacheStorage::Statistics stats = test.cache.GetStatistics();
+    REQUIRE(stats.hits == 3);
+    REQUIRE(stats.misses == 2);
+    REQUIRE(test.base->num_reads == 2);
+    REQUIRE(budget.GetUsed() == BLOCK_SIZE * 2);
+
+    // Large reads go straight to the base storage
+    REQUIRE(test.Read(0, BlockCacheStorage::BypassSize) == BlockCacheStorage::BypassSize);
+    stats = test.cache.GetStatistics();
+    REQUIRE(stats.bypassed_reads == 1);
+    REQUIRE(stats.hits == 3);
+    REQUIRE(stats.misses == 2);
+    REQUIRE(test.base->num_reads == 3);
+}
+
+TEST_CASE("BlockCacheStorage: Least recently used blocks are evicted", "[core][file_sys]") {
+    BlockCacheBudget budget{BLOCK_SIZE * 2};
+    const TestCache test{SHARD_STRIDE * 3, budget};
+
+    test.Read(0, 0x10);
+    test.Read(SHARD_STRIDE, 0x10);
+    // Touch the first block so the second one is the oldest
+    test.Read(0x20, 0x10);
+    test.Read(SHARD_STRIDE * 2, 0x10);
+    REQUIRE(test.base->num_reads == 3);
+    REQUIRE(budget.GetUsed() == BLOCK_SIZE * 2);
+
+    test.Read(0x40, 0x10);
+    REQUIRE(test.base->num_reads == 3);
+    test.Read(SHARD_STRIDE * 2 + 0x10, 0x10);
+    REQUIRE(test.base->num_reads == 3);
+    test.Read(SHARD_STRIDE + 0x10, 0x10);
+    REQUIRE(test.base->num_reads == 4);
+
+    const BlockCacheStorage::Statistics stats = test.cache.GetStatistics();
+    REQUIRE(stats.hits == 3);
+    REQUIRE(stats.misses == 4);
+}
+
+TEST_CASE("BlockCacheStorage: Short reads at the end of the storage", "[core][file_sys]") {
+    BlockCacheBudget budget{BLOCK_SIZE * 16};
+    const size_t size = BLOCK_SIZE * 2 + 100;
+    const TestCache test{size, budget};
+
+    REQUIRE(test.Read(size - 100, 0x200) == 100);
+    REQUIRE(test.Read(size - 50, 0x200) == 50);
+    REQUIRE(test.Read(size, 0x10) == 0);
+    REQUIRE(test.Read(size + BLOCK_SIZE, 0x10) == 0);
+    REQUIRE(test.base->num_reads == 1);
+    REQUIRE(test.cache.GetStatistics().hits == 1);
+
+    // Reads which come back short from the base storage are returned but never cached
+    test.base->max_read = 0x100;
+    REQUIRE(test.Read(0x80, 0x200) == 0x80);
+    REQUIRE(test.Read(0x80, 0x200) == 0x80);
+    REQUIRE(test.base->num_reads == 3);
+    REQUIRE(budget.GetUsed() == BLOCK_SIZE);
+}
+
+TEST_CASE("BlockCacheStorage: Caches share the budget", "[core][file_sys]") {
+    BlockCacheBudget budget{BLOCK_SIZE * 2};
+    auto first = std::make_unique<TestCache>(SHARD_STRIDE * 2, budget);
+    const TestCache second{SHARD_STRIDE * 2, budget};
+
+    first->Read(0, 0x10);
+    first->Read(SHARD_STRIDE, 0x10);
+    REQUIRE(budget.GetUsed() == BLOCK_SIZE * 2);
+
+    // The first cache holds the whole budget, the second one can't keep its block
+    second.Read(0, 0x10);
+    second.Read(0, 0x10);
+    REQUIRE(second.base->num_reads == 2);
+    REQUIRE(budget.GetUsed() == BLOCK_SIZE * 2);
+
+    // Closing the first cache gives its blocks back
+    first.reset();
+    REQUIRE(budget.GetUsed() == 0);
+    second.Read(0, 0x10);
+    second.Read(0, 0x10);
+    REQUIRE(second.base->num_reads == 3);
+    REQUIRE(budget.GetUsed() == BLOCK_SIZE);
+}
@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/file_sys/content_index.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+
+using namespace FileSys;
+
+namespace {
+constexpr NcaID META_ID{0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+constexpr NcaID PROGRAM_ID{0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10};
+
+std::map<NcaID, ContentIndex::Entry> MakeEntries() {
+    std::map<NcaID, ContentIndex::Entry> entries;
+    entries.emplace(META_ID, ContentIndex::Entry{
+                                 .size = 0x4000,
+                                 .modified = 1700000000,
+                                 .title_id = 0x0100000000010000,
+                                 .cnmt = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77},
+                             });
+    entries.emplace(PROGRAM_ID, ContentIndex::Entry{
+                                    .size = 0x100000,
+                                    .modified = 1700000001,
+                                    .title_id = 0x0100000000010000,
+                                    .cnmt = {},
+                                });
+    return entries;
+}
+
+/// Cache directory holding an empty index file, VectorVfsDirectory can't create files.
+std::pair<VirtualDir, std::shared_ptr<VectorVfsFile>> MakeCacheDir() {
+    auto index_file =
+        std::make_shared<VectorVfsFile>(std::vector<u8>{}, std::string(ContentIndex::FileName));
+    auto dir = std::make_shared<VectorVfsDirectory>(std::vector<VirtualFile>{index_file});
+    return {std::move(dir), std::move(index_file)};
+}
+
+void SaveEntries(const VirtualDir& dir) {
+    ContentIndex index(dir);
+    index.Assign(MakeEntries());
+    REQUIRE(index.Save());
+}
+} // Anonymous namespace
+
+TEST_CASE("ContentIndex: Entries round-trip through the index file", "[core][file_sys]") {
+    const auto [dir, index_file] = MakeCacheDir();
+    SaveEntries(dir);
+
+    ContentIndex index(dir);
+    index.Load();
+    REQUIRE(index.Size() == 2);
+    for (const auto& [id, expected] : MakeEntries()) {
+        const auto* const entry = index.Find(id, expected.size, expected.modified);
+        REQUIRE(entry != nullptr);
+        REQUIRE(entry->title_id == expected.title_id);
+        REQUIRE(entry->cnmt == expected.cnmt);
+    }
+}
+
+TEST_CASE("ContentIndex: Changed NCAs are not found", "[core][file_sys]") {
+    const auto [dir, index_file] = MakeCacheDir();
+    SaveEntries(dir);
+
+    ContentIndex index(dir);
+    index.Load();
+    const auto& entry = MakeEntries().at(META_ID);
+    REQUIRE(index.Find(META_ID, entry.size, entry.modified) != nullptr);
+    // Stale modification time or size
+    REQUIRE(index.Find(META_ID, entry.size, entry.modified + 1) == nullptr);
+    REQUIRE(index.Find(META_ID, entry.size + 1, entry.modified) == nullptr);
+    // Filesystems without modification times can't be validated
+    REQUIRE(index.Find(META_ID, entry.size, 0) == nullptr);
+    // NCAs that were never indexed
+    REQUIRE(index.Find(NcaID{}, entry.size, entry.modified) == nullptr);
+}
+
+TEST_CASE("ContentIndex: Corrupted index files are discarded", "[core][file_sys]") {
+    const auto [dir, index_file] = MakeCacheDir();
+    SaveEntries(dir);
+    const auto data = index_file->ReadAllBytes();
+
+    SECTION("Flipped byte") {
+        auto corrupted = data;
+        corrupted.back() ^= 0xFF;
+        index_file->Assign(std::move(corrupted));
+    }
+    SECTION("Truncated") {
+        index_file->Assign({data.begin(), data.end() - 1});
+    }
+    SECTION("Truncated header") {
+        index_file->Assign({data.begin(), data.begin() + 8});
+    }
+    SECTION("Trailing bytes") {
+        auto corrupted = data;
+        corrupted.push_back(0);
+        index_file->Assign(std::move(corrupted));
+    }
+
+    ContentIndex index(dir);
+    index.Load();
+    REQUIRE(index.Size() == 0);
+    const auto& entry = MakeEntries().at(META_ID);
+    REQUIRE(index.Find(META_ID, entry.size, entry.modified) == nullptr);
+}
@@ -0,0 +1,150 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include "core/file_sys/layered_romfs.h"
+#include "core/file_sys/romfs.h"
+#include "core/file_sys/vfs/vfs_layered.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+
+using namespace FileSys;
+
+namespace {
+std::shared_ptr<VectorVfsFile> MakeFile(std::string name, size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::vector<u8> data(size);
+    for (u8& value : data) {
+        value = static_cast<u8>(rng());
+    }
+    return std::make_shared<VectorVfsFile>(std::move(data), std::move(name));
+}
+
+/// Builds a tree of num_dirs directories holding files_per_dir files each.
+VirtualDir MakeTree(size_t num_dirs, size_t files_per_dir, size_t file_size, u32 seed) {
+    std::vector<VirtualDir> dirs;
+    for (size_t dir = 0; dir < num_dirs; ++dir) {
+        std::vector<VirtualFile> files;
+        for (size_t file = 0; file < files_per_dir; ++file) {
+            const u32 file_seed = seed + static_cast<u32>(dir * files_per_dir + file);
+            files.push_back(MakeFile(fmt::format("file{}.bin", file), file_size, file_seed));
+        }
+        dirs.push_back(std::make_shared<VectorVfsDirectory>(std::move(files),
+                                                            std::vector<VirtualDir>{},
+                                                            fmt::format("dir{}", dir)));
+    }
+    return std::make_shared<VectorVfsDirectory>(std::vector<VirtualFile>{}, std::move(dirs));
+}
+
+/// Builds the RomFS without the cache, the way ApplyLayeredFS used to.
+VirtualFile BuildUncached(const VirtualFile& base_romfs, std::vector<VirtualDir> layers) {
+    layers.push_back(ExtractRomFS(base_romfs));
+    return CreateRomFS(LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers)));
+}
+
+/// Returns whether the cache was written since the last call, which only happens on a miss.
+bool IsRewritten(const std::filesystem::path& cache_file) {
+    constexpr std::filesystem::file_time_type marker{};
+    const bool rewritten = std::filesystem::last_write_time(cache_file) != marker;
+    std::filesystem::last_write_time(cache_file, marker);
+    return rewritten;
+}
+
+/// Directory on the host removed with its contents when the test is done.
+class TempDir {
+public:
+    TempDir() : path{std::filesystem::temp_directory_path() / "yuzu_layered_romfs_test"} {
+        std::filesystem::remove_all(path);
+    }
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+
+    std::filesystem::path File(const char* name) const {
+        return path / name;
+    }
+
+private:
+    std::filesystem::path path;
+};
+} // Anonymous namespace
+
+TEST_CASE("CreateLayeredRomFS: Matches CreateRomFS", "[core][file_sys]") {
+    const TempDir dir;
+    const auto cache_file = dir.File("cache.bin");
+    const VirtualFile base_romfs = CreateRomFS(MakeTree(4, 8, 0x300, 1));
+
+    // Replaces a file of the base and adds a file and a directory
+    const auto replaced = MakeFile("file3.bin", 0x123, 100);
+    const auto added = MakeFile("added.bin", 0x40, 101);
+    const auto mod = std::make_shared<VectorVfsDirectory>(
+        std::vector<VirtualFile>{}, std::vector<VirtualDir>{
+                                        std::make_shared<VectorVfsDirectory>(
+                                            std::vector<VirtualFile>{replaced, added},
+                                            std::vector<VirtualDir>{}, "dir2"),
+                                        MakeTree(1, 2, 0x80, 102)->GetSubdirectories()[0],
+                                    });
+    const std::vector<VirtualDir> layers{mod};
+
+    const auto expected = BuildUncached(base_romfs, layers)->ReadAllBytes();
+    REQUIRE(CreateLayeredRomFS(base_romfs, layers, {}, cache_file)->ReadAllBytes() == expected);
+    REQUIRE(IsRewritten(cache_file));
+    REQUIRE(CreateLayeredRomFS(base_romfs, layers, {}, cache_file)->ReadAllBytes() == expected);
+    REQUIRE(!IsRewritten(cache_file));
+
+    // Editing a mod file without changing its size keeps the layout
+    replaced->WriteBytes(std::vector<u8>(0x10, 0xAB), 0x20);
+    const auto edited = BuildUncached(base_romfs, layers)->ReadAllBytes();
+    REQUIRE(edited != expected);
+    REQUIRE(CreateLayeredRomFS(base_romfs, layers, {}, cache_file)->ReadAllBytes() == edited);
+    REQUIRE(!IsRewritten(cache_file));
+
+    // Resizing it changes the layout
+    replaced->Resize(0x200);
+    const auto resized = BuildUncached(base_romfs, layers)->ReadAllBytes();
+    REQUIRE(CreateLayeredRomFS(base_romfs, layers, {}, cache_file)->ReadAllBytes() == resized);
+    REQUIRE(IsRewritten(cache_file));
+    REQUIRE(CreateLayeredRomFS(base_romfs, layers, {}, cache_file)->ReadAllBytes() == resized);
+
+    // A damaged cache is rebuilt
+    std::filesystem::resize_file(cache_file, 0x40);
+    std::filesystem::last_write_time(cache_file, {});
+    REQUIRE(CreateLayeredRomFS(base_romfs, layers, {}, cache_file)->ReadAllBytes() == resized);
+    REQUIRE(IsRewritten(cache_file));
+    REQUIRE(CreateLayeredRomFS(base_romfs, layers, {}, cache_file)->ReadAllBytes() == resized);
+    REQUIRE(!IsRewritten(cache_file));
+}
+
+TEST_CASE("CreateLayeredRomFS: Benchmark", "[.][core][file_sys]") {
+    const TempDir dir;
+    const auto cache_file = dir.File("cache.bin");
+    const VirtualFile base_romfs = CreateRomFS(MakeTree(64, 256, 0x20, 1));
+    const std::vector<VirtualDir> layers{MakeTree(8, 16, 0x20, 2)};
+
+    const auto bench = [&](const char* name, const auto& build) {
+        double best = std::numeric_limits<double>::max();
+        for (int run = 0; run < 5; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            REQUIRE(build() != nullptr);
+            const std::chrono::duration<double, std::milli> elapsed =
+                std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        printf("CreateLayeredRomFS: %s %.2f ms\n", name, best);
+    };
+    bench("uncached", [&] { return BuildUncached(base_romfs, layers); });
+    REQUIRE(CreateLayeredRomFS(base_romfs, layers, {}, cache_file) != nullptr);
+    bench("cached", [&] { return CreateLayeredRomFS(base_romfs, layers, {}, cache_file); });
+}
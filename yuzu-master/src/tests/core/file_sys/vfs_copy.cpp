@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/fs/path_util.h"
+#include "core/file_sys/vfs/vfs.h"
+#include "core/file_sys/vfs/vfs_offset.h"
+#include "core/file_sys/vfs/vfs_real.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+
+using namespace FileSys;
+
+namespace {
+constexpr size_t BLOCK_SIZE = 0x10000;
+
+std::vector<u8> RandomBytes(size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::vector<u8> result(size);
+    for (u8& value : result) {
+        value = static_cast<u8>(rng());
+    }
+    return result;
+}
+
+/// Directory on the host removed with its contents when the test is done.
+class TempDir {
+public:
+    TempDir() : path{std::filesystem::temp_directory_path() / "yuzu_vfs_copy_test"} {
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+    }
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+
+    std::string File(const char* name) const {
+        return Common::FS::PathToUTF8String(path / name);
+    }
+
+private:
+    std::filesystem::path path;
+};
+
+VirtualFile CreateHostFile(RealVfsFilesystem& vfs, const std::string& path,
+                           const std::vector<u8>& data) {
+    const VirtualFile file = vfs.CreateFile(path, OpenMode::ReadWrite);
+    REQUIRE(file != nullptr);
+    REQUIRE(file->WriteBytes(data) == data.size());
+    return file;
+}
+} // Anonymous namespace
+
+TEST_CASE("VfsRawCopy: Buffered copy", "[core][file_sys]") {
+    for (const size_t size : {size_t{0}, size_t{100}, BLOCK_SIZE, BLOCK_SIZE * 10 + 123}) {
+        const std::vector<u8> data = RandomBytes(size, static_cast<u32>(size));
+        const auto src = std::make_shared<VectorVfsFile>(data);
+        const auto dest = std::make_shared<VectorVfsFile>();
+        REQUIRE(VfsRawCopy(src, dest, BLOCK_SIZE));
+        REQUIRE(dest->ReadAllBytes() == data);
+    }
+}
+
+TEST_CASE("VfsRawCopy: Progress and cancellation", "[core][file_sys]") {
+    const std::vector<u8> data = RandomBytes(BLOCK_SIZE * 8, 1);
+    const auto src = std::make_shared<VectorVfsFile>(data);
+    const auto dest = std::make_shared<VectorVfsFile>();
+
+    std::vector<size_t> reported;
+    REQUIRE(VfsRawCopyWithProgress(src, dest, BLOCK_SIZE, [&](size_t total, size_t copied) {
+        REQUIRE(total == data.size());
+        reported.push_back(copied);
+        return false;
+    }));
+    REQUIRE(dest->ReadAllBytes() == data);
+    // Once before each block and once when done
+    REQUIRE(reported.size() == 9);
+    for (size_t i = 0; i < reported.size(); ++i) {
+        REQUIRE(reported[i] == i * BLOCK_SIZE);
+    }
+
+    size_t num_calls = 0;
+    REQUIRE(!VfsRawCopyWithProgress(src, dest, BLOCK_SIZE,
+                                    [&](size_t, size_t) { return ++num_calls == 3; }));
+    REQUIRE(num_calls == 3);
+    REQUIRE(dest->GetSize() == 0);
+}
+
+TEST_CASE("VfsRawCopy: Host files", "[core][file_sys]") {
+    const TempDir dir;
+    RealVfsFilesystem vfs;
+    const std::vector<u8> data = RandomBytes(BLOCK_SIZE * 6 + 77, 2);
+    const VirtualFile container = CreateHostFile(vfs, dir.File("container"), data);
+
+    // A slice of a host file, like the NCAs of a NSP
+    const size_t offset = 0x1234;
+    const size_t size = BLOCK_SIZE * 4 + 5;
+    const auto src = std::make_shared<OffsetVfsFile>(container, size, offset);
+    REQUIRE(src->GetHostLocation().has_value());
+    REQUIRE(src->GetHostLocation()->offset == offset);
+
+    const VirtualFile dest = vfs.CreateFile(dir.File("dest"), OpenMode::ReadWrite);
+    REQUIRE(dest != nullptr);
+    size_t last_reported = 0;
+    REQUIRE(VfsRawCopyWithProgress(src, dest, BLOCK_SIZE, [&](size_t total, size_t copied) {
+        REQUIRE(total == size);
+        last_reported = copied;
+        return false;
+    }));
+    REQUIRE(last_reported == size);
+    REQUIRE(dest->ReadAllBytes() ==
+            std::vector<u8>(data.begin() + offset, data.begin() + offset + size));
+}
+
+TEST_CASE("VfsRawCopy: Benchmark", "[.][core][file_sys]") {
+    const TempDir dir;
+    RealVfsFilesystem vfs;
+    const std::vector<u8> data = RandomBytes(64 << 20, 3);
+    const VirtualFile host_src = CreateHostFile(vfs, dir.File("src"), data);
+    const auto memory_src = std::make_shared<VectorVfsFile>(data);
+
+    const auto bench = [&](const char* name, const VirtualFile& src) {
+        double best = 1e9;
+        for (int run = 0; run < 3; ++run) {
+            vfs.DeleteFile(dir.File("dest"));
+            const VirtualFile dest = vfs.CreateFile(dir.File("dest"), OpenMode::ReadWrite);
+            const auto start = std::chrono::steady_clock::now();
+            REQUIRE(VfsRawCopy(src, dest));
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        printf("VfsRawCopy: %s %.0f MiB/s\n", name, static_cast<double>(data.size() >> 20) / best);
+    };
+    bench("host to host", host_src);
+    bench("memory to host", memory_src);
+}
@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/fs/path_util.h"
+#include "common/literals.h"
+#include "core/crypto/aes_util.h"
+#include "core/file_sys/fssystem/fssystem_aes_ctr_storage.h"
+#include "core/file_sys/vfs/vfs.h"
+#include "core/file_sys/vfs/vfs_offset.h"
+#include "core/file_sys/vfs/vfs_real.h"
+#include "core/file_sys/vfs/vfs_vector.h"
+
+using namespace FileSys;
+using namespace Common::Literals;
+
+namespace {
+// Game images smaller than this are read through IOFile
+constexpr size_t IMAGE_SIZE = 16_MiB + 0x1230;
+
+std::vector<u8> RandomBytes(size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::vector<u8> result(size);
+    for (u8& value : result) {
+        value = static_cast<u8>(rng());
+    }
+    return result;
+}
+
+/// Directory on the host removed with its contents when the test is done.
+class TempDir {
+public:
+    TempDir() : path{std::filesystem::temp_directory_path() / "yuzu_vfs_real_test"} {
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+    }
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+
+    std::string File(const char* name) const {
+        return Common::FS::PathToUTF8String(path / name);
+    }
+
+private:
+    std::filesystem::path path;
+};
+
+void WriteHostFile(RealVfsFilesystem& vfs, const std::string& path, const std::vector<u8>& data) {
+    const VirtualFile file = vfs.CreateFile(path, OpenMode::ReadWrite);
+    REQUIRE(file != nullptr);
+    REQUIRE(file->WriteBytes(data) == data.size());
+}
+} // Anonymous namespace
+
+TEST_CASE("RealVfsFile: Game images are read from a mapping", "[core][file_sys]") {
+    const TempDir dir;
+    RealVfsFilesystem vfs;
+    const std::vector<u8> data = RandomBytes(IMAGE_SIZE, 1);
+    WriteHostFile(vfs, dir.File("game.nca"), data);
+
+    const VirtualFile file = vfs.OpenFile(dir.File("game.nca"), OpenMode::Read);
+    REQUIRE(file != nullptr);
+    REQUIRE(file->GetSize() == data.size());
+
+    const std::span<const u8> view = file->GetView(0x4000, 0x1000);
+    REQUIRE(view.size() == 0x4000);
+    REQUIRE(std::equal(view.begin(), view.end(), data.begin() + 0x1000));
+
+    // Views and reads are truncated at the end of the file
+    REQUIRE(file->GetView(0x100, data.size() - 0x10).size() == 0x10);
+    REQUIRE(file->GetView(0x100, data.size()).empty());
+    std::array<u8, 0x100> buffer{};
+    REQUIRE(file->Read(buffer.data(), buffer.size(), data.size() - 0x10) == 0x10);
+    REQUIRE(std::equal(buffer.begin(), buffer.begin() + 0x10, data.end() - 0x10));
+    REQUIRE(file->ReadAllBytes() == data);
+
+    // Slices of the image, like the NCAs of a XCI, view the same memory
+    const auto slice = std::make_shared<OffsetVfsFile>(file, 0x2000, 0x8000);
+    const std::span<const u8> slice_view = slice->GetView(0x4000, 0x100);
+    REQUIRE(slice_view.size() == 0x1F00);
+    REQUIRE(slice_view.data() == file->GetView(0x1F00, 0x8100).data());
+    REQUIRE(slice->GetView(0x10, 0x2000).empty());
+}
+
+TEST_CASE("RealVfsFile: Other files are not mapped", "[core][file_sys]") {
+    const TempDir dir;
+    RealVfsFilesystem vfs;
+    const std::vector<u8> data = RandomBytes(IMAGE_SIZE, 2);
+    WriteHostFile(vfs, dir.File("save.bin"), data);
+    WriteHostFile(vfs, dir.File("small.nca"), RandomBytes(0x1000, 3));
+    WriteHostFile(vfs, dir.File("game.xci"), data);
+
+    const VirtualFile other = vfs.OpenFile(dir.File("save.bin"), OpenMode::Read);
+    REQUIRE(other->GetView(0x100, 0).empty());
+    REQUIRE(other->ReadAllBytes() == data);
+
+    const VirtualFile small = vfs.OpenFile(dir.File("small.nca"), OpenMode::Read);
+    REQUIRE(small->GetView(0x100, 0).empty());
+
+    // Writable files always go through IOFile
+    const VirtualFile writable = vfs.OpenFile(dir.File("game.xci"), OpenMode::ReadWrite);
+    REQUIRE(writable->GetView(0x100, 0).empty());
+    REQUIRE(writable->ReadAllBytes() == data);
+}
+
+TEST_CASE("AesCtrStorage: Decrypt from a mapped image", "[core][file_sys]") {
+    const TempDir dir;
+    RealVfsFilesystem vfs;
+    const std::vector<u8> plaintext = RandomBytes(IMAGE_SIZE, 4);
+    const Core::Crypto::Key128 key{0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE,
+                                   0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+    std::array<u8, AesCtrStorage::IvSize> iv{};
+    AesCtrStorage::MakeIv(iv.data(), iv.size(), 0x0123456789ABCDEFULL, 0);
+
+    std::vector<u8> ciphertext(plaintext.size());
+    Core::Crypto::AESCipher<Core::Crypto::Key128> cipher{key, Core::Crypto::Mode::CTR};
+    cipher.SetIV(iv);
+    cipher.Transcode(plaintext.data(), plaintext.size(), ciphertext.data(),
+                     Core::Crypto::Op::Encrypt);
+    WriteHostFile(vfs, dir.File("game.nca"), ciphertext);
+
+    const VirtualFile mapped = vfs.OpenFile(dir.File("game.nca"), OpenMode::Read);
+    REQUIRE(!mapped->GetView(0x10, 0).empty());
+    const AesCtrStorage mapped_storage{mapped, key.data(), key.size(), iv.data(), iv.size()};
+    const AesCtrStorage copied_storage{std::make_shared<VectorVfsFile>(ciphertext), key.data(),
+                                       key.size(), iv.data(), iv.size()};
+
+    std::vector<u8> mapped_output(0x4000);
+    std::vector<u8> copied_output(0x4000);
+    for (const size_t offset : {size_t{0}, size_t{0x10}, size_t{0x8000}, IMAGE_SIZE - 0x4000}) {
+        REQUIRE(mapped_storage.Read(mapped_output.data(), mapped_output.size(), offset) ==
+                mapped_output.size());
+        REQUIRE(copied_storage.Read(copied_output.data(), copied_output.size(), offset) ==
+                copied_output.size());
+        REQUIRE(mapped_output == copied_output);
+        REQUIRE(std::equal(mapped_output.begin(), mapped_output.end(), plaintext.begin() + offset));
+    }
+}
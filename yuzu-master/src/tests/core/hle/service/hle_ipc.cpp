@@ -0,0 +1,127 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "core/core.h"
+#include "core/hle/ipc.h"
+#include "core/hle/service/hle_ipc.h"
+
+namespace {
+constexpr u32 TIPC_COMMAND = 3;
+constexpr u32 DATA_SIZE = 4;
+
+template <typename T>
+void PushRaw(std::array<u32, IPC::COMMAND_BUFFER_LENGTH>& cmd_buf, size_t& offset, const T& value) {
+    std::memcpy(cmd_buf.data() + offset, &value, sizeof(T));
+    offset += sizeof(T) / sizeof(u32);
+}
+
+IPC::BufferDescriptorABW MakeDescriptorABW(u32 address, u32 size) {
+    IPC::BufferDescriptorABW descriptor{};
+    descriptor.address_bits_0_31 = address;
+    descriptor.size_bits_0_31 = size;
+    return descriptor;
+}
+
+/**
+ * Builds a TIPC request like the ones of the fs and hid services, with an X, two A, two B and a
+ * C buffer, two copied handles and a moved one. TIPC requests have no domain header, so they can
+ * be parsed without a session.
+ */
+std::array<u32, IPC::COMMAND_BUFFER_LENGTH> MakeRequest() {
+    std::array<u32, IPC::COMMAND_BUFFER_LENGTH> cmd_buf{};
+    size_t offset = 0;
+
+    IPC::CommandHeader header{};
+    header.type.Assign(static_cast<IPC::CommandType>(
+        static_cast<u32>(IPC::CommandType::TIPC_CommandRegion) + TIPC_COMMAND));
+    header.num_buf_x_descriptors.Assign(1);
+    header.num_buf_a_descriptors.Assign(2);
+    header.num_buf_b_descriptors.Assign(2);
+    header.data_size.Assign(DATA_SIZE);
+    header.buf_c_descriptor_flags.Assign(IPC::CommandHeader::BufferDescriptorCFlag::OneDescriptor);
+    header.enable_handle_descriptor.Assign(1);
+    PushRaw(cmd_buf, offset, header);
+
+    IPC::HandleDescriptorHeader handle_header{};
+    handle_header.num_handles_to_copy.Assign(2);
+    handle_header.num_handles_to_move.Assign(1);
+    PushRaw(cmd_buf, offset, handle_header);
+    for (const Service::Handle handle : {0x10u, 0x11u, 0x20u}) {
+        PushRaw(cmd_buf, offset, handle);
+    }
+
+    IPC::BufferDescriptorX buffer_x{};
+    buffer_x.address_bits_0_31 = 0x1000;
+    buffer_x.size.Assign(0x40);
+    PushRaw(cmd_buf, offset, buffer_x);
+    PushRaw(cmd_buf, offset, MakeDescriptorABW(0x2000, 0x100));
+    PushRaw(cmd_buf, offset, MakeDescriptorABW(0x3000, 0x200));
+    PushRaw(cmd_buf, offset, MakeDescriptorABW(0x4000, 0x300));
+    PushRaw(cmd_buf, offset, MakeDescriptorABW(0x5000, 0x400));
+    offset += DATA_SIZE;
+
+    IPC::BufferDescriptorC buffer_c{};
+    buffer_c.address_bits_0_31 = 0x6000;
+    buffer_c.size.Assign(0x80);
+    PushRaw(cmd_buf, offset, buffer_c);
+    return cmd_buf;
+}
+} // Anonymous namespace
+
+TEST_CASE("HLERequestContext: Parse a request", "[core]") {
+    Core::System system;
+    auto cmd_buf = MakeRequest();
+    Service::HLERequestContext ctx(system.Kernel(), system.ApplicationMemory(), nullptr, nullptr);
+    ctx.ParseCommandBuffer(cmd_buf.data(), true);
+
+    REQUIRE(ctx.IsTipc());
+    REQUIRE(ctx.GetCommand() == TIPC_COMMAND);
+    REQUIRE(ctx.GetCopyHandle(0) == 0x10);
+    REQUIRE(ctx.GetCopyHandle(1) == 0x11);
+    REQUIRE(ctx.GetMoveHandle(0) == 0x20);
+    REQUIRE(ctx.BufferDescriptorX().size() == 1);
+    REQUIRE(ctx.BufferDescriptorA().size() == 2);
+    REQUIRE(ctx.BufferDescriptorB().size() == 2);
+    REQUIRE(ctx.BufferDescriptorC().size() == 1);
+    REQUIRE(ctx.BufferDescriptorX()[0].Address() == 0x1000);
+    REQUIRE(ctx.GetReadBufferSize(0) == 0x100);
+    REQUIRE(ctx.GetReadBufferSize(1) == 0x200);
+    REQUIRE(ctx.GetWriteBufferSize(0) == 0x300);
+    REQUIRE(ctx.GetWriteBufferSize(1) == 0x400);
+    REQUIRE(ctx.BufferDescriptorC()[0].Address() == 0x6000);
+    REQUIRE(ctx.BufferDescriptorC()[0].Size() == 0x80);
+}
+
+TEST_CASE("HLERequestContext: Benchmark", "[.][core]") {
+    Core::System system;
+    auto cmd_buf = MakeRequest();
+
+    // Creates a context for every request, like the server sessions do, and queries the buffers
+    // like a handler with two input and two output buffers
+    constexpr size_t iterations = 2'000'000;
+    size_t total_size = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        Service::HLERequestContext ctx(system.Kernel(), system.ApplicationMemory(), nullptr,
+                                       nullptr);
+        ctx.ParseCommandBuffer(cmd_buf.data(), true);
+        total_size += ctx.GetReadBufferSize(0) + ctx.GetReadBufferSize(1);
+        if (ctx.CanWriteBuffer(0) && ctx.CanWriteBuffer(1)) {
+            total_size += ctx.GetWriteBufferSize(0) + ctx.GetWriteBufferSize(1);
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+    REQUIRE(total_size == iterations * 0xA00);
+
+    const double ns_per_request =
+        std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    printf("HLERequestContext parse: %.1f ns per request\n", ns_per_request);
+}
@@ -0,0 +1,255 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include "common/common_types.h"
+#include "enet/enet.h"
+#include "network/packet.h"
+#include "network/room.h"
+#include "network/verify_user.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+using Network::IPv4Address;
+
+constexpr u16 TestRoomPort = 24900;
+constexpr auto JoinTimeout = std::chrono::seconds{5};
+
+/// Payload carried by the proxy packets of the tests.
+struct Payload {
+    u32 sender;
+    u32 sequence;
+    s64 send_time;
+};
+
+/// Opens the room on construction and closes it on destruction.
+class TestRoom {
+public:
+    explicit TestRoom(u16 port) {
+        REQUIRE(enet_initialize() == 0);
+        REQUIRE(room.Create("Test room", "", "127.0.0.1", port, "", 64, "", {},
+                            std::make_unique<Network::VerifyUser::NullBackend>()));
+    }
+
+    ~TestRoom() {
+        room.Destroy();
+        enet_deinitialize();
+    }
+
+private:
+    Network::Room room;
+};
+
+/// Member of the room talking the room protocol directly over ENet.
+class Client {
+public:
+    explicit Client(u32 index_) : index{index_} {
+        host = enet_host_create(nullptr, 1, Network::NumChannels, 0, 0);
+        REQUIRE(host != nullptr);
+    }
+
+    ~Client() {
+        if (peer) {
+            enet_peer_disconnect(peer, 0);
+            enet_host_flush(host);
+        }
+        enet_host_destroy(host);
+    }
+
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    /// Connects to the room and waits until it is a member.
+    bool Join(u16 port) {
+        ENetAddress address{};
+        enet_address_set_host(&address, "127.0.0.1");
+        address.port = port;
+        peer = enet_host_connect(host, &address, Network::NumChannels, 0);
+        if (!peer || !WaitFor(ENET_EVENT_TYPE_CONNECT, 0)) {
+            return false;
+        }
+        Network::Packet packet;
+        packet.Write(static_cast<u8>(Network::IdJoinRequest));
+        packet.Write(fmt::format("client{:02}", index));
+        packet.Write(Network::NoPreferredIP);
+        packet.Write(Network::network_version);
+        packet.Write(std::string{}); // Password
+        packet.Write(std::string{}); // Token
+        Send(packet);
+        return WaitFor(ENET_EVENT_TYPE_RECEIVE, Network::IdJoinSuccess);
+    }
+
+    /// Sends a proxy packet to a member, or to every other member when broadcasting.
+    void SendProxy(const IPv4Address& destination, bool broadcast, const Payload& payload) {
+        std::vector<u8> data(64);
+        std::memcpy(data.data(), &payload, sizeof(payload));
+
+        Network::Packet packet;
+        packet.Write(static_cast<u8>(Network::IdProxyPacket));
+        packet.Write(static_cast<u8>(0)); // Domain
+        packet.Write(fake_ip);
+        packet.Write(static_cast<u16>(0)); // Port
+        packet.Write(static_cast<u8>(0));  // Domain
+        packet.Write(destination);
+        packet.Write(static_cast<u16>(0)); // Port
+        packet.Write(static_cast<u8>(0));  // Protocol
+        packet.Write(broadcast);
+        packet.Write(data);
+        Send(packet);
+    }
+
+    /// Services the connection without blocking, calling func with each received payload.
+    template <typename Func>
+    void Poll(Func&& func) {
+        ENetEvent event;
+        while (enet_host_service(host, &event, 0) > 0) {
+            if (event.type != ENET_EVENT_TYPE_RECEIVE) {
+                continue;
+            }
+            if (event.packet->data[0] == Network::IdProxyPacket) {
+                Network::Packet packet;
+                packet.Append(event.packet->data, event.packet->dataLength);
+                packet.IgnoreBytes(18); // Header
+                std::vector<u8> data;
+                packet.Read(data);
+                Payload payload;
+                std::memcpy(&payload, data.data(), sizeof(payload));
+                func(payload);
+            }
+            enet_packet_destroy(event.packet);
+        }
+    }
+
+    const IPv4Address& FakeIP() const {
+        return fake_ip;
+    }
+
+private:
+    void Send(const Network::Packet& packet) {
+        ENetPacket* const enet_packet = enet_packet_create(
+            packet.GetData(), packet.GetDataSize(), ENET_PACKET_FLAG_RELIABLE);
+        // Queued packets are sent by the next service call
+        enet_peer_send(peer, 0, enet_packet);
+    }
+
+    bool WaitFor(ENetEventType type, u8 message) {
+        const auto deadline = Clock::now() + JoinTimeout;
+        ENetEvent event;
+        while (Clock::now() < deadline) {
+            if (enet_host_service(host, &event, 10) <= 0) {
+                continue;
+            }
+            if (event.type != ENET_EVENT_TYPE_RECEIVE) {
+                if (event.type == type) {
+                    return true;
+                }
+                continue;
+            }
+            const bool found = event.packet->data[0] == message;
+            if (found) {
+                Network::Packet packet;
+                packet.Append(event.packet->data, event.packet->dataLength);
+                packet.IgnoreBytes(sizeof(u8));
+                packet.Read(fake_ip);
+            }
+            enet_packet_destroy(event.packet);
+            if (found) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    u32 index;
+    ENetHost* host = nullptr;
+    ENetPeer* peer = nullptr;
+    IPv4Address fake_ip{};
+};
+
+std::vector<std::unique_ptr<Client>> JoinClients(u32 count, u16 port) {
+    std::vector<std::unique_ptr<Client>> clients;
+    for (u32 i = 0; i < count; ++i) {
+        clients.push_back(std::make_unique<Client>(i));
+        REQUIRE(clients.back()->Join(port));
+    }
+    return clients;
+}
+
+s64 Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch())
+        .count();
+}
+} // Anonymous namespace
+
+TEST_CASE("Room: Routes proxy packets", "[network]") {
+    TestRoom room{TestRoomPort};
+    const auto clients = JoinClients(3, TestRoomPort);
+
+    clients[0]->SendProxy(clients[1]->FakeIP(), false, Payload{0, 1, 0});
+    clients[0]->SendProxy({}, true, Payload{0, 2, 0});
+
+    std::vector<std::vector<u32>> received(clients.size());
+    const auto deadline = Clock::now() + JoinTimeout;
+    while (Clock::now() < deadline && (received[1].size() < 2 || received[2].empty())) {
+        for (size_t i = 0; i < clients.size(); ++i) {
+            clients[i]->Poll(
+                [&](const Payload& payload) { received[i].push_back(payload.sequence); });
+        }
+    }
+    REQUIRE(received[0].empty());
+    REQUIRE(received[1] == std::vector<u32>{1, 2});
+    REQUIRE(received[2] == std::vector<u32>{2});
+}
+
+TEST_CASE("Room: Proxy load", "[.][network]") {
+    static constexpr u32 num_clients = 16;
+    static constexpr u32 packets_per_client = 2000;
+    static constexpr u32 burst = 50;
+    static constexpr u64 total_packets = u64{num_clients} * packets_per_client;
+
+    TestRoom room{TestRoomPort + 1};
+    const auto clients = JoinClients(num_clients, TestRoomPort + 1);
+
+    // Every client streams packets to the next one, like the members of a session would
+    std::vector<s64> latencies;
+    latencies.reserve(total_packets);
+    const auto receive = [&](const Payload& payload) {
+        latencies.push_back(Now() - payload.send_time);
+    };
+    const auto start = Clock::now();
+    for (u32 sent = 0; sent < packets_per_client; sent += burst) {
+        for (u32 i = 0; i < num_clients; ++i) {
+            const IPv4Address& destination = clients[(i + 1) % num_clients]->FakeIP();
+            for (u32 j = 0; j < burst; ++j) {
+                clients[i]->SendProxy(destination, false, Payload{i, sent + j, Now()});
+            }
+        }
+        for (const auto& client : clients) {
+            client->Poll(receive);
+        }
+    }
+    const auto deadline = Clock::now() + std::chrono::seconds{30};
+    while (latencies.size() < total_packets && Clock::now() < deadline) {
+        for (const auto& client : clients) {
+            client->Poll(receive);
+        }
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    REQUIRE(latencies.size() == total_packets);
+
+    std::ranges::sort(latencies);
+    const double p50_ms = static_cast<double>(latencies[latencies.size() / 2]) / 1e6;
+    const double p99_ms = static_cast<double>(latencies[latencies.size() * 99 / 100]) / 1e6;
+    printf("Room proxy load with %u members: %.0f packets/s, p50 %.3f ms, p99 %.3f ms\n",
+           num_clients, static_cast<double>(total_packets) / seconds, p50_ms, p99_ms);
+}
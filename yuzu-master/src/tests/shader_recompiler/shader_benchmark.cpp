@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Measures shader translation over environments dumped from games, which give a more
+// representative mix than the synthesized programs of the unit tests.
+// Usage: shader_benchmark <directory of dumped environments>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <vector>
+
+#include "common/common_types.h"
+#include "tests/shader_recompiler/translate_helpers.h"
+#include "video_core/shader_environment.h"
+
+using namespace ShaderTests;
+
+namespace {
+/// Loads the environments dumped to the files of a directory.
+std::vector<VideoCommon::FileEnvironment> LoadCorpus(const std::filesystem::path& dir) {
+    std::vector<VideoCommon::FileEnvironment> envs;
+    for (const auto& entry : std::filesystem::directory_iterator{dir}) {
+        std::ifstream file{entry.path(), std::ios::binary};
+        const std::vector<u8> data{std::istreambuf_iterator<char>{file}, {}};
+        size_t offset = 0;
+        while (offset < data.size()) {
+            VideoCommon::FileEnvironment env;
+            const size_t size = env.Deserialize(std::span(data).subspan(offset));
+            if (size == 0) {
+                break;
+            }
+            envs.push_back(std::move(env));
+            offset += size;
+        }
+    }
+    return envs;
+}
+
+} // Anonymous namespace
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <directory of dumped shader environments>\n", argv[0]);
+        return 1;
+    }
+    auto corpus = LoadCorpus(argv[1]);
+    if (corpus.empty()) {
+        fprintf(stderr, "No shader environments found in %s\n", argv[1]);
+        return 1;
+    }
+    Pools pools;
+    // Warm up, so the pools have grown to their working size
+    MicrosecondsPerProgram(pools, corpus);
+    printf("TranslateProgram: %.1f us per program of %zu in %s\n",
+           MicrosecondsPerProgram(pools, corpus), corpus.size(), argv[1]);
+    return 0;
+}
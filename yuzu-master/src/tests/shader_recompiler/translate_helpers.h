@@ -0,0 +1,247 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/common_types.h"
+#include "shader_recompiler/environment.h"
+#include "shader_recompiler/frontend/ir/basic_block.h"
+#include "shader_recompiler/frontend/ir/program.h"
+#include "shader_recompiler/frontend/maxwell/control_flow.h"
+#include "shader_recompiler/frontend/maxwell/translate_program.h"
+#include "shader_recompiler/host_translate_info.h"
+#include "shader_recompiler/object_pool.h"
+
+namespace ShaderTests {
+
+constexpr u64 PT = 7;
+
+/// Compute shader environment over synthesized code.
+class CodeEnvironment final : public Shader::Environment {
+public:
+    explicit CodeEnvironment(std::vector<u64> code_) : code{std::move(code_)} {
+        stage = Shader::Stage::Compute;
+    }
+
+    u64 ReadInstruction(u32 address) override {
+        return address / 8 < code.size() ? code[address / 8] : 0;
+    }
+    u32 ReadCbufValue(u32, u32) override {
+        return 0;
+    }
+    Shader::TextureType ReadTextureType(u32) override {
+        return Shader::TextureType::Color2D;
+    }
+    Shader::TexturePixelFormat ReadTexturePixelFormat(u32) override {
+        return Shader::TexturePixelFormat::A8B8G8R8_UNORM;
+    }
+    bool IsTexturePixelFormatInteger(u32) override {
+        return false;
+    }
+    u32 ReadViewportTransformState() override {
+        return 0;
+    }
+    u32 TextureBoundBuffer() const override {
+        return 0;
+    }
+    u32 LocalMemorySize() const override {
+        return 0;
+    }
+    u32 SharedMemorySize() const override {
+        return 0;
+    }
+    std::array<u32, 3> WorkgroupSize() const override {
+        return {64, 1, 1};
+    }
+    bool HasHLEMacroState() const override {
+        return false;
+    }
+    std::optional<Shader::ReplaceConstant> GetReplaceConstBuffer(u32, u32) override {
+        return std::nullopt;
+    }
+    void Dump(u64, u64) override {}
+
+private:
+    std::vector<u64> code;
+};
+
+/// Writes Maxwell code shaped like real shaders: uniform reads feeding arithmetic, branches over
+/// conditional blocks and loops carrying values across iterations.
+class ProgramWriter {
+public:
+    explicit ProgramWriter(u32 seed) : rng{seed} {}
+
+    std::vector<u64> Write(int num_regions) {
+        for (int region = 0; region < num_regions; ++region) {
+            Region(0);
+        }
+        Emit(0xE30000000007000FULL); // EXIT
+        return std::move(code);
+    }
+
+private:
+    void Region(int depth) {
+        const u32 kind = depth < 3 ? static_cast<u32>(rng() % 4) : 0;
+        if (kind == 1) {
+            // Conditional block, the guard skips over it
+            const u64 pred = Compare();
+            const size_t branch = Emit(0);
+            Arithmetic(4 + rng() % 12);
+            Region(depth + 1);
+            Patch(branch, pred | 8, Label());
+        } else if (kind == 2) {
+            // Loop, the back edge is taken while the guard holds
+            const u32 start = Label();
+            Arithmetic(4 + rng() % 12);
+            Region(depth + 1);
+            const u64 pred = Compare();
+            Patch(Emit(0), pred, start);
+        } else {
+            Arithmetic(8 + rng() % 24);
+        }
+    }
+
+    void Arithmetic(size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            const u64 dest = rng() % 24;
+            const u64 src_a = rng() % 24;
+            const u64 src_b = rng() % 24;
+            static constexpr u64 reg_ops[]{
+                0x5C58000000000000ULL, // FADD (reg)
+                0x5C68000000000000ULL, // FMUL (reg)
+                0x5C10000000000000ULL, // IADD (reg)
+                0x5C40000000000000ULL, // LOP (reg)
+                0x5C48000000000000ULL, // SHL (reg)
+            };
+            if (rng() % 4 == 0) {
+                // FADD (cbuf) reading a uniform of c0
+                const u64 offset = rng() % 64;
+                Emit(0x4C58000000000000ULL | (offset << 20) | (PT << 16) | (src_a << 8) | dest);
+            } else {
+                const u64 op = reg_ops[rng() % std::size(reg_ops)];
+                Emit(op | (src_b << 20) | (PT << 16) | (src_a << 8) | dest);
+            }
+        }
+    }
+
+    /// Writes an ISETP (reg) into a random predicate and returns it.
+    u64 Compare() {
+        const u64 pred = rng() % 7;
+        const u64 compare_op = 1 + rng() % 6;
+        Emit(0x5B60000000000000ULL | (compare_op << 49) | (PT << 39) | ((rng() % 24) << 20) |
+             (PT << 16) | ((rng() % 24) << 8) | (pred << 3) | PT);
+        return pred;
+    }
+
+    /// Returns the address of the next instruction.
+    u32 Label() {
+        if (code.size() % 4 == 0) {
+            code.push_back(0);
+        }
+        return static_cast<u32>(code.size() * 8);
+    }
+
+    /// Writes a predicated BRA to a label.
+    void Patch(size_t index, u64 pred, u32 target) {
+        const s64 offset = static_cast<s64>(target) - static_cast<s64>(index * 8 + 8);
+        code[index] = 0xE24000000000000FULL | ((static_cast<u64>(offset) & 0xFFFFFF) << 20) |
+                      (pred << 16);
+    }
+
+    size_t Emit(u64 inst) {
+        // Every fourth word holds the scheduling information of the next three
+        if (code.size() % 4 == 0) {
+            code.push_back(0);
+        }
+        code.push_back(inst);
+        return code.size() - 1;
+    }
+
+    std::mt19937 rng;
+    std::vector<u64> code;
+};
+
+struct Pools {
+    void ReleaseContents() {
+        flow_block.ReleaseContents();
+        block.ReleaseContents();
+        inst.ReleaseContents();
+    }
+
+    Shader::ObjectPool<Shader::IR::Inst> inst{8192};
+    Shader::ObjectPool<Shader::IR::Block> block{32};
+    Shader::ObjectPool<Shader::Maxwell::Flow::Block> flow_block{32};
+};
+
+/// Translates a program the way the pipeline caches do before emitting host code. The program
+/// lives in the pools until their contents are released.
+inline Shader::IR::Program TranslateToIR(Pools& pools, Shader::Environment& env) {
+    static constexpr Shader::HostTranslateInfo host_info{
+        .support_float64 = true,
+        .support_float16 = true,
+        .support_int64 = true,
+        .support_conditional_barrier = true,
+    };
+    Shader::Maxwell::Flow::CFG cfg{env, pools.flow_block, env.StartAddress()};
+    return Shader::Maxwell::TranslateProgram(pools.inst, pools.block, env, cfg, host_info);
+}
+
+/// Translates a program and returns the number of instructions in its IR.
+inline size_t Translate(Pools& pools, Shader::Environment& env) {
+    const Shader::IR::Program program = TranslateToIR(pools, env);
+    size_t num_insts = 0;
+    for (const Shader::IR::Block* const block : program.blocks) {
+        num_insts += block->size();
+    }
+    pools.ReleaseContents();
+    return num_insts;
+}
+
+/// Translates a program and dumps its IR, without the host addresses of the instructions so that
+/// the dump is the same on every run.
+inline std::string DumpTranslated(Pools& pools, Shader::Environment& env) {
+    const std::string dump = Shader::IR::DumpProgram(TranslateToIR(pools, env));
+    pools.ReleaseContents();
+
+    std::string result;
+    result.reserve(dump.size());
+    size_t line_begin = 0;
+    while (line_begin < dump.size()) {
+        size_t line_end = dump.find('\n', line_begin);
+        line_end = line_end == std::string::npos ? dump.size() : line_end + 1;
+        if (dump[line_begin] == '[') {
+            // Instruction lines start with "[address] "
+            line_begin = dump.find("] ", line_begin) + 2;
+        }
+        result.append(dump, line_begin, line_end - line_begin);
+        line_begin = line_end;
+    }
+    return result;
+}
+
+/// Returns the best time of a few runs over all environments, in microseconds per program.
+template <typename Env>
+double MicrosecondsPerProgram(Pools& pools, std::vector<Env>& envs) {
+    double best = std::numeric_limits<double>::max();
+    for (int batch = 0; batch < 5; ++batch) {
+        const auto start = std::chrono::steady_clock::now();
+        for (Env& env : envs) {
+            Translate(pools, env);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, std::chrono::duration<double, std::micro>(elapsed).count());
+    }
+    return best / static_cast<double>(envs.size());
+}
+
+} // namespace ShaderTests
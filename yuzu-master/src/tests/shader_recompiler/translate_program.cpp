@@ -0,0 +1,53 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/cityhash.h"
+#include "common/common_types.h"
+#include "tests/shader_recompiler/translate_helpers.h"
+
+using namespace ShaderTests;
+
+namespace {
+/// Hashes of the IR dumps of the synthesized programs, by seed. Changes to the translation that
+/// alter the IR on purpose have to update them.
+constexpr std::array<u64, 32> REFERENCE_DUMP_HASHES{
+    0x620B7CF44F589E6EULL, 0xB460020F6FB4F3DFULL, 0x4F08DB4323571680ULL, 0x37AD1F0563E31B8FULL,
+    0xE07A44BE70D616DCULL, 0x35032FFD9E1B7D30ULL, 0x709C169C24419B26ULL, 0x8850AF40A2D25C7DULL,
+    0xDD0E99E0BB239318ULL, 0x8A5BED30F2B69821ULL, 0xCA2A3966573265FBULL, 0x5EB12371E1D80CF6ULL,
+    0x1B02D7445C90A3A0ULL, 0xB293308EC403FA4CULL, 0x8C9934183C5A64A2ULL, 0x026BB0CFD05F287AULL,
+    0xD9C773B92B0FF4F6ULL, 0xCCD22D60874A7F9EULL, 0xD64D142B76A7D075ULL, 0x604B1C87B394C8F8ULL,
+    0x895755055FC5FE13ULL, 0x5D6A416A6A561825ULL, 0x06E0218A7BF601E6ULL, 0xBC64EE7E00CF30ABULL,
+    0x21E71132E25B2323ULL, 0x8A17EA8C4A72C32CULL, 0x944538425A6207CEULL, 0xA870F15D5F0121E0ULL,
+    0x1054B2B71C439950ULL, 0x90A8B29780D7591BULL, 0x6541C30F13FF15DAULL, 0x570BE277AAFCBE67ULL,
+};
+} // Anonymous namespace
+
+TEST_CASE("TranslateProgram: Synthesized programs", "[shader_recompiler]") {
+    Pools pools;
+    for (u32 seed = 0; seed < REFERENCE_DUMP_HASHES.size(); ++seed) {
+        CodeEnvironment env{ProgramWriter{seed}.Write(8)};
+        const std::string dump = DumpTranslated(pools, env);
+        CAPTURE(seed);
+        INFO(dump);
+        REQUIRE(Common::CityHash64(dump.data(), dump.size()) == REFERENCE_DUMP_HASHES[seed]);
+    }
+}
+
+TEST_CASE("TranslateProgram: Benchmark", "[.][shader_recompiler]") {
+    Pools pools;
+    std::vector<CodeEnvironment> envs;
+    for (u32 seed = 0; seed < 64; ++seed) {
+        envs.emplace_back(ProgramWriter{seed}.Write(24));
+    }
+    // Warm up, so the pools have grown to their working size
+    MicrosecondsPerProgram(pools, envs);
+    printf("TranslateProgram: %.1f us per synthesized program\n",
+           MicrosecondsPerProgram(pools, envs));
+}
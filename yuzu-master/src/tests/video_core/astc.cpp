@@ -0,0 +1,181 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/div_ceil.h"
+#include "video_core/textures/astc.h"
+
+namespace {
+struct Footprint {
+    u32 width;
+    u32 height;
+};
+
+constexpr std::array<Footprint, 14> FOOTPRINTS{{
+    {4, 4},
+    {5, 4},
+    {5, 5},
+    {6, 5},
+    {6, 6},
+    {8, 5},
+    {8, 6},
+    {8, 8},
+    {10, 5},
+    {10, 6},
+    {10, 8},
+    {10, 10},
+    {12, 10},
+    {12, 12},
+}};
+
+/**
+ * Generates blocks with a 4x4 weight grid, which is valid for every footprint. Weight ranges cover
+ * plain bits, trits and quints, color data is random. With high precision, single partition
+ * blocks also use the upper weight ranges.
+ */
+/// FNV-1a hashes of 61x43 images decoded by the bit-at-a-time decoder, one for each footprint
+constexpr std::array<u64, 14> GOLDEN_HASHES{
+    0xB5F7A427431E83AAULL, 0x6928DB2534B05B0BULL, 0x1DAF01B690DFD280ULL, 0x12D08469B50A771BULL,
+    0x3D007152CB27BD28ULL, 0x83FF91FBA278F96FULL, 0xF035F75213FD6398ULL, 0xB45F34DAC8A31D3FULL,
+    0x28930EF1847800ADULL, 0xF54143463BFCA66FULL, 0x90BF2C9485773F70ULL, 0x78EC55B0D2A92FD0ULL,
+    0x2F27973EADF39514ULL, 0xE9330E3E281C7CD8ULL,
+};
+
+u64 HashImage(std::span<const u8> image) {
+    u64 hash = 0xCBF29CE484222325ULL;
+    for (const u8 value : image) {
+        hash = (hash ^ value) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+std::vector<u8> MakeBlocks(size_t num_blocks, u32 seed, bool high_precision = false) {
+    static constexpr std::array<u32, 4> endpoint_modes{0, 4, 8, 12};
+    std::mt19937 rng{seed};
+    std::vector<u8> data(num_blocks * 16);
+    for (size_t block = 0; block < num_blocks; ++block) {
+        const u32 range = 2 + rng() % 6;
+        // Block mode layout 0: A = 2 (height 4), B = 0 (width 4), R encoded in bits [4, 1:0]
+        u32 mode = ((range & 1) << 4) | (range >> 1) | (2U << 5);
+        const u32 partitions = rng() % 2;
+        // Only single partition blocks have enough bits left for color data with the upper ranges
+        if (high_precision && partitions == 0 && rng() % 2 == 1) {
+            mode |= 1U << 9;
+        }
+        u64 low = (u64{rng()} << 32) | rng();
+        const u64 high = (u64{rng()} << 32) | rng();
+        low &= ~u64{0x1FFFFFFFF};
+        low |= mode | (partitions << 11);
+        if (partitions == 0) {
+            low |= u64{endpoint_modes[rng() % endpoint_modes.size()]} << 13;
+        } else {
+            // Random partition index, every partition shares the same endpoint mode
+            low |= u64{rng() % 1024} << 13;
+            low |= u64{endpoint_modes[rng() % endpoint_modes.size()]} << 25;
+        }
+        std::memcpy(&data[block * 16], &low, sizeof(low));
+        std::memcpy(&data[block * 16 + 8], &high, sizeof(high));
+    }
+    return data;
+}
+} // Anonymous namespace
+
+TEST_CASE("ASTC: Tiled decode matches single block decode", "[video_core]") {
+    static constexpr u32 width = 203;
+    static constexpr u32 height = 97;
+    static constexpr u32 depth = 2;
+    for (const Footprint& footprint : FOOTPRINTS) {
+        const u32 cols = Common::DivCeil(width, footprint.width);
+        const u32 rows = Common::DivCeil(height, footprint.height);
+        const std::vector<u8> data = MakeBlocks(cols * rows * depth, footprint.width);
+        std::vector<u8> image(width * height * depth * 4);
+        Tegra::Texture::ASTC::Decompress(data, width, height, depth, footprint.width,
+                                         footprint.height, image);
+
+        std::vector<u8> block_pixels(footprint.width * footprint.height * 4);
+        for (u32 z = 0; z < depth; ++z) {
+            for (u32 row = 0; row < rows; ++row) {
+                for (u32 col = 0; col < cols; ++col) {
+                    const size_t block_index = (z * rows + row) * cols + col;
+                    const std::span<const u8> block{&data[block_index * 16], 16};
+                    Tegra::Texture::ASTC::Decompress(block, footprint.width, footprint.height, 1,
+                                                     footprint.width, footprint.height,
+                                                     block_pixels);
+                    const u32 x = col * footprint.width;
+                    const u32 y = row * footprint.height;
+                    const u32 copy_width = std::min(footprint.width, width - x);
+                    const u32 copy_height = std::min(footprint.height, height - y);
+                    for (u32 line = 0; line < copy_height; ++line) {
+                        const size_t offset = ((z * height + y + line) * width + x) * 4;
+                        REQUIRE(std::memcmp(&image[offset],
+                                            &block_pixels[line * footprint.width * 4],
+                                            copy_width * 4) == 0);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("ASTC: Decode matches golden output", "[video_core]") {
+    static constexpr u32 width = 61;
+    static constexpr u32 height = 43;
+    for (size_t i = 0; i < FOOTPRINTS.size(); ++i) {
+        const Footprint& footprint = FOOTPRINTS[i];
+        const u32 num_blocks = Common::DivCeil(width, footprint.width) *
+                               Common::DivCeil(height, footprint.height);
+        const std::vector<u8> data = MakeBlocks(num_blocks, static_cast<u32>(100 + i), true);
+        std::vector<u8> image(width * height * 4);
+        Tegra::Texture::ASTC::Decompress(data, width, height, 1, footprint.width,
+                                         footprint.height, image);
+        REQUIRE(HashImage(image) == GOLDEN_HASHES[i]);
+    }
+}
+
+TEST_CASE("ASTC: Void extent block", "[video_core]") {
+    // Void extent LDR header with all extent coordinates set, which the decoder skips in 13-bit
+    // reads, followed by the RGBA color as 16-bit values
+    static constexpr u64 header = 0xFFFFFFFFFFFFFDFCULL;
+    static constexpr u64 color = 0xDEF09ABC56781234ULL;
+    std::array<u8, 16> block;
+    std::memcpy(block.data(), &header, sizeof(header));
+    std::memcpy(block.data() + 8, &color, sizeof(color));
+
+    std::array<u8, 6 * 5 * 4> image{};
+    Tegra::Texture::ASTC::Decompress(block, 6, 5, 1, 6, 5, image);
+    for (size_t pixel = 0; pixel < image.size(); pixel += 4) {
+        REQUIRE(image[pixel + 0] == 0x12);
+        REQUIRE(image[pixel + 1] == 0x56);
+        REQUIRE(image[pixel + 2] == 0x9A);
+        REQUIRE(image[pixel + 3] == 0xDE);
+    }
+}
+
+TEST_CASE("ASTC: Benchmark", "[.][video_core]") {
+    static constexpr u32 width = 1024;
+    static constexpr u32 height = 1024;
+    for (const Footprint& footprint : FOOTPRINTS) {
+        const u32 num_blocks = Common::DivCeil(width, footprint.width) *
+                               Common::DivCeil(height, footprint.height);
+        const std::vector<u8> data = MakeBlocks(num_blocks, 0);
+        std::vector<u8> image(width * height * 4);
+
+        const auto start = std::chrono::steady_clock::now();
+        Tegra::Texture::ASTC::Decompress(data, width, height, 1, footprint.width,
+                                         footprint.height, image);
+        const auto end = std::chrono::steady_clock::now();
+        const double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+        printf("ASTC %ux%u %ux%u: %.3f ms\n", footprint.width, footprint.height, width, height,
+               milliseconds);
+    }
+}
@@ -0,0 +1,158 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "video_core/compiled_shader_cache.h"
+
+using VideoCommon::CompiledShaderCache;
+using VideoCommon::CompiledShaderStage;
+
+namespace {
+constexpr u32 CACHE_VERSION = 3;
+constexpr u64 FINGERPRINT = 0x0123456789ABCDEF;
+
+/// Cache file on the host removed when the test is done.
+class TempFile {
+public:
+    TempFile() : path{std::filesystem::temp_directory_path() / "yuzu_compiled_shader_test.bin"} {
+        std::filesystem::remove(path);
+    }
+    ~TempFile() {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+
+    const std::filesystem::path& Path() const {
+        return path;
+    }
+
+private:
+    std::filesystem::path path;
+};
+
+std::vector<CompiledShaderStage> MakeStages(u32 seed) {
+    std::vector<CompiledShaderStage> stages(2);
+    for (u32 i = 0; i < stages.size(); ++i) {
+        CompiledShaderStage& stage = stages[i];
+        stage.index = i * 4;
+        stage.info.uses_fp64 = (seed & 1) != 0;
+        stage.info.constant_buffer_mask = seed + i;
+        stage.info.constant_buffer_used_sizes[1] = seed * 16;
+        stage.info.constant_buffer_descriptors.push_back({.index = 1, .count = 1});
+        for (u32 word = 0; word < 32 + seed; ++word) {
+            stage.code.push_back(seed * 1000 + i * 100 + word);
+        }
+    }
+    return stages;
+}
+
+void CheckStages(const std::optional<std::vector<CompiledShaderStage>>& found, u32 seed) {
+    REQUIRE(found.has_value());
+    const std::vector<CompiledShaderStage> expected = MakeStages(seed);
+    REQUIRE(found->size() == expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        const CompiledShaderStage& stage = (*found)[i];
+        REQUIRE(stage.index == expected[i].index);
+        REQUIRE(stage.code == expected[i].code);
+        REQUIRE(stage.info.uses_fp64 == expected[i].info.uses_fp64);
+        REQUIRE(stage.info.constant_buffer_mask == expected[i].info.constant_buffer_mask);
+        REQUIRE(stage.info.constant_buffer_used_sizes ==
+                expected[i].info.constant_buffer_used_sizes);
+        REQUIRE(stage.info.constant_buffer_descriptors.size() == 1);
+        REQUIRE(stage.info.constant_buffer_descriptors[0].index == 1);
+    }
+}
+
+constexpr std::array<char, 4> KEY_A{'a', 'b', 'c', 'd'};
+constexpr std::array<char, 6> KEY_B{'e', 'f', 'g', 'h', 'i', 'j'};
+} // Anonymous namespace
+
+TEST_CASE("CompiledShaderCache: Round trip", "[video_core]") {
+    const TempFile file;
+    {
+        CompiledShaderCache cache;
+        cache.Load(file.Path(), CACHE_VERSION, FINGERPRINT);
+        REQUIRE(!cache.Find(std::span<const char>(KEY_A)).has_value());
+        cache.Save(std::span<const char>(KEY_A), MakeStages(1));
+        // Saved pipelines are only found after loading the cache again
+        REQUIRE(!cache.Find(std::span<const char>(KEY_A)).has_value());
+    }
+    {
+        CompiledShaderCache cache;
+        cache.Load(file.Path(), CACHE_VERSION, FINGERPRINT);
+        CheckStages(cache.Find(std::span<const char>(KEY_A)), 1);
+        REQUIRE(!cache.Find(std::span<const char>(KEY_B)).has_value());
+
+        // Appending while the file is mapped, like new pipelines of a session
+        cache.Save(std::span<const char>(KEY_B), MakeStages(2));
+        CheckStages(cache.Find(std::span<const char>(KEY_A)), 1);
+    }
+    CompiledShaderCache cache;
+    cache.Load(file.Path(), CACHE_VERSION, FINGERPRINT);
+    CheckStages(cache.Find(std::span<const char>(KEY_A)), 1);
+    CheckStages(cache.Find(std::span<const char>(KEY_B)), 2);
+}
+
+TEST_CASE("CompiledShaderCache: Version and fingerprint changes invalidate the file",
+          "[video_core]") {
+    const TempFile file;
+    const auto save = [&] {
+        CompiledShaderCache cache;
+        cache.Load(file.Path(), CACHE_VERSION, FINGERPRINT);
+        cache.Save(std::span<const char>(KEY_A), MakeStages(1));
+    };
+    save();
+    {
+        CompiledShaderCache cache;
+        cache.Load(file.Path(), CACHE_VERSION + 1, FINGERPRINT);
+        REQUIRE(!cache.Find(std::span<const char>(KEY_A)).has_value());
+        REQUIRE(!std::filesystem::exists(file.Path()));
+    }
+    save();
+    {
+        CompiledShaderCache cache;
+        cache.Load(file.Path(), CACHE_VERSION, FINGERPRINT + 1);
+        REQUIRE(!cache.Find(std::span<const char>(KEY_A)).has_value());
+        REQUIRE(!std::filesystem::exists(file.Path()));
+
+        // The file starts over with the new fingerprint
+        cache.Save(std::span<const char>(KEY_B), MakeStages(2));
+    }
+    CompiledShaderCache cache;
+    cache.Load(file.Path(), CACHE_VERSION, FINGERPRINT + 1);
+    REQUIRE(!cache.Find(std::span<const char>(KEY_A)).has_value());
+    CheckStages(cache.Find(std::span<const char>(KEY_B)), 2);
+}
+
+TEST_CASE("CompiledShaderCache: Truncated trailing entries are dropped", "[video_core]") {
+    const TempFile file;
+    {
+        CompiledShaderCache cache;
+        cache.Load(file.Path(), CACHE_VERSION, FINGERPRINT);
+        cache.Save(std::span<const char>(KEY_A), MakeStages(1));
+    }
+    const auto first_size = std::filesystem::file_size(file.Path());
+    {
+        CompiledShaderCache cache;
+        cache.Load(file.Path(), CACHE_VERSION, FINGERPRINT);
+        cache.Save(std::span<const char>(KEY_B), MakeStages(2));
+    }
+    const auto full_size = std::filesystem::file_size(file.Path());
+
+    // Cut the last entry in its data, right after its header and in its header
+    for (const auto cut_size : {full_size - 5, first_size + 8, first_size + 3}) {
+        std::filesystem::resize_file(file.Path(), cut_size);
+        CompiledShaderCache cache;
+        cache.Load(file.Path(), CACHE_VERSION, FINGERPRINT);
+        CheckStages(cache.Find(std::span<const char>(KEY_A)), 1);
+        REQUIRE(!cache.Find(std::span<const char>(KEY_B)).has_value());
+    }
+}
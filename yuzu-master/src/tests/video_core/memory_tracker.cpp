@@ -1,15 +1,24 @@
 // SPDX-FileCopyrightText: Copyright 2023 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <limits>
 #include <memory>
+#include <random>
 #include <stdexcept>
 #include <unordered_map>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
 #include "common/alignment.h"
 #include "common/common_types.h"
+#include "common/div_ceil.h"
 #include "video_core/buffer_cache/memory_tracker_base.h"
+#include "video_core/buffer_cache/word_kernels.h"
 
 namespace {
 using Range = std::pair<u64, u64>;
@@ -546,3 +555,404 @@ TEST_CASE("MemoryTracker: Cached write downloads") {
     memory_track->MarkRegionAsCpuModified(c, WORD);
     REQUIRE(rasterizer.Count() == 0);
 }
+
+namespace {
+constexpr u64 REGION_PAGES = HIGH_PAGE_SIZE / PAGE;
+
+/// Page by page model of the tracker, the behavior the word bitmaps have to reproduce.
+class PageModel {
+public:
+    explicit PageModel(size_t num_regions)
+        : regions(num_regions), pages(num_regions * REGION_PAGES) {}
+
+    void MarkCpu(VAddr addr, u64 size) {
+        ForEachPage(addr, size, true, [](Page& page) {
+            page.tracked -= page.untracked ? 0 : 1;
+            page.cpu = page.untracked = true;
+            page.cached = false;
+        });
+    }
+
+    void UnmarkCpu(VAddr addr, u64 size) {
+        ForEachPage(addr, size, true, [](Page& page) {
+            page.tracked += page.untracked ? 1 : 0;
+            page.cached &= !page.cpu;
+            page.cpu = page.untracked = false;
+        });
+    }
+
+    void SetGpu(VAddr addr, u64 size, bool value) {
+        ForEachPage(addr, size, true, [value](Page& page) { page.gpu = value; });
+    }
+
+    void SetPreflushable(VAddr addr, u64 size, bool value) {
+        ForEachPage(addr, size, true, [value](Page& page) { page.preflushable = value; });
+    }
+
+    void CachedCpuWrite(VAddr addr, u64 size) {
+        ForEachPage(addr, size, true, [](Page& page) {
+            page.tracked -= page.untracked ? 0 : 1;
+            page.cached = page.untracked = true;
+        });
+    }
+
+    void FlushCachedWrites() {
+        for (Page& page : pages) {
+            page.tracked -= page.cached && !page.untracked ? 1 : 0;
+            page.untracked |= page.cached;
+            page.cpu |= page.cached;
+            page.cached = false;
+        }
+    }
+
+    bool IsCpuModified(VAddr addr, u64 size) {
+        bool result = false;
+        ForEachPage(addr, size, true, [&](Page& page) { result |= page.cpu; });
+        return result;
+    }
+
+    bool IsGpuModified(VAddr addr, u64 size) {
+        bool result = false;
+        ForEachPage(addr, size, false, [&](Page& page) { result |= page.gpu && !page.untracked; });
+        return result;
+    }
+
+    bool IsPreflushable(VAddr addr, u64 size) {
+        bool result = false;
+        ForEachPage(addr, size, false, [&](Page& page) { result |= page.preflushable; });
+        return result;
+    }
+
+    Range ModifiedCpuRegion(VAddr addr, u64 size) {
+        return ModifiedRegion(addr, size, true, [](const Page& page) { return page.cpu; });
+    }
+
+    Range ModifiedGpuRegion(VAddr addr, u64 size) {
+        return ModifiedRegion(addr, size, false,
+                              [](const Page& page) { return page.gpu && !page.untracked; });
+    }
+
+    /// Returns the ranges an upload reports, and applies its changes
+    std::vector<Range> Upload(VAddr addr, u64 size) {
+        std::vector<Range> runs = Runs(addr, size, true, [](const Page& page) { return page.cpu; });
+        UnmarkCpu(addr, size);
+        return runs;
+    }
+
+    /// Returns the ranges a download reports, and applies its changes
+    std::vector<Range> Download(VAddr addr, u64 size, bool clear) {
+        std::vector<Range> runs =
+            Runs(addr, size, false, [](const Page& page) { return page.gpu && !page.untracked; });
+        if (clear) {
+            ForEachPage(addr, size, false, [](Page& page) { page.gpu &= page.untracked; });
+        }
+        return runs;
+    }
+
+    int Count(VAddr addr) const {
+        return pages[(addr - c) / PAGE].tracked;
+    }
+
+private:
+    struct Page {
+        bool cpu = true;
+        bool gpu = false;
+        bool cached = false;
+        bool untracked = true;
+        bool preflushable = false;
+        int tracked = 0;
+    };
+
+    template <typename Func>
+    void ForEachPage(VAddr addr, u64 size, bool create, Func&& func) {
+        const u64 page_end = Common::DivCeil(addr - c + size, PAGE);
+        for (u64 page = (addr - c) / PAGE; page < page_end; ++page) {
+            if (!regions[page / REGION_PAGES]) {
+                if (!create) {
+                    continue;
+                }
+                regions[page / REGION_PAGES] = true;
+            }
+            func(pages[page]);
+        }
+    }
+
+    template <typename Pred>
+    Range ModifiedRegion(VAddr addr, u64 size, bool create, Pred&& pred) {
+        std::vector<Range> runs = Runs(addr, size, create, pred);
+        if (runs.empty()) {
+            return Range{0, 0};
+        }
+        return Range{runs.front().first, runs.back().first + runs.back().second};
+    }
+
+    /// Returns the address and size of each run of pages, runs don't cross regions
+    template <typename Pred>
+    std::vector<Range> Runs(VAddr addr, u64 size, bool create, Pred&& pred) {
+        std::vector<Range> runs;
+        u64 page = (addr - c) / PAGE;
+        bool pending = false;
+        ForEachPage(addr, size, create, [&](Page& state) {
+            const VAddr page_addr = c + page * PAGE;
+            if (pred(state)) {
+                if (pending && page % REGION_PAGES != 0 &&
+                    runs.back().first + runs.back().second == page_addr) {
+                    runs.back().second += PAGE;
+                } else {
+                    runs.emplace_back(page_addr, PAGE);
+                }
+                pending = true;
+            }
+            ++page;
+        });
+        return runs;
+    }
+
+    std::vector<bool> regions;
+    std::vector<Page> pages;
+};
+
+/// Tracker that only counts the notifications, so the benchmarks measure the bitmaps.
+class CountingRasterizer {
+public:
+    void UpdatePagesCachedCount(VAddr, u64 size, int delta) {
+        ++calls;
+        pages += static_cast<s64>(size / PAGE) * delta;
+    }
+
+    u64 calls = 0;
+    s64 pages = 0;
+};
+
+template <typename Func>
+double NanosecondsPerOp(size_t ops_per_run, Func&& func) {
+    static constexpr int batches = 10;
+    static constexpr int runs = 20;
+    // Warm up, so the first run doesn't pay for creating the regions
+    func();
+    // Keep the fastest batch, the others are the ones that got interrupted
+    double best = std::numeric_limits<double>::max();
+    for (int batch = 0; batch < batches; ++batch) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int run = 0; run < runs; ++run) {
+            func();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, std::chrono::duration<double, std::nano>(elapsed).count());
+    }
+    return best / static_cast<double>(runs * ops_per_run);
+}
+} // Anonymous namespace
+
+TEST_CASE("MemoryTracker: Random operations match a page model", "[video_core]") {
+    static constexpr size_t num_regions = 8;
+    static constexpr u64 space = num_regions * HIGH_PAGE_SIZE;
+    std::mt19937 rng{1234};
+    RasterizerInterface rasterizer;
+    std::unique_ptr<MemoryTracker> memory_track(std::make_unique<MemoryTracker>(rasterizer));
+    PageModel model(num_regions);
+
+    const auto random_range = [&] {
+        static constexpr std::array<u64, 4> max_sizes{PAGE * 2, WORD, WORD * 5, HIGH_PAGE_SIZE * 3};
+        const u64 offset = rng() % space;
+        const u64 size = 1 + rng() % std::min(max_sizes[rng() % max_sizes.size()], space - offset);
+        return std::make_pair(c + offset, size);
+    };
+    const auto collect = [](std::vector<Range>& ranges) {
+        return [&ranges](u64 addr, u64 size) { ranges.emplace_back(addr, size); };
+    };
+    for (int step = 0; step < 20000; ++step) {
+        const auto [addr, size] = random_range();
+        std::vector<Range> ranges;
+        switch (rng() % 14) {
+        case 0:
+        case 1:
+            memory_track->MarkRegionAsCpuModified(addr, size);
+            model.MarkCpu(addr, size);
+            break;
+        case 2:
+        case 3:
+            memory_track->UnmarkRegionAsCpuModified(addr, size);
+            model.UnmarkCpu(addr, size);
+            break;
+        case 4:
+            memory_track->MarkRegionAsGpuModified(addr, size);
+            model.SetGpu(addr, size, true);
+            break;
+        case 5:
+            memory_track->UnmarkRegionAsGpuModified(addr, size);
+            model.SetGpu(addr, size, false);
+            break;
+        case 6:
+            if (rng() % 2 == 0) {
+                memory_track->MarkRegionAsPreflushable(addr, size);
+                model.SetPreflushable(addr, size, true);
+            } else {
+                memory_track->UnmarkRegionAsPreflushable(addr, size);
+                model.SetPreflushable(addr, size, false);
+            }
+            REQUIRE(memory_track->IsRegionPreflushable(addr, size) ==
+                    model.IsPreflushable(addr, size));
+            break;
+        case 7:
+            memory_track->CachedCpuWrite(addr, size);
+            model.CachedCpuWrite(addr, size);
+            break;
+        case 8:
+            memory_track->FlushCachedWrites();
+            model.FlushCachedWrites();
+            break;
+        case 9:
+            REQUIRE(memory_track->IsRegionCpuModified(addr, size) ==
+                    model.IsCpuModified(addr, size));
+            REQUIRE(memory_track->IsRegionGpuModified(addr, size) ==
+                    model.IsGpuModified(addr, size));
+            break;
+        case 10:
+            REQUIRE(memory_track->ModifiedCpuRegion(addr, size) ==
+                    model.ModifiedCpuRegion(addr, size));
+            REQUIRE(memory_track->ModifiedGpuRegion(addr, size) ==
+                    model.ModifiedGpuRegion(addr, size));
+            break;
+        case 11:
+            memory_track->ForEachUploadRange(addr, size, collect(ranges));
+            REQUIRE(ranges == model.Upload(addr, size));
+            break;
+        case 12:
+            memory_track->ForEachDownloadRange(addr, size, false, collect(ranges));
+            REQUIRE(ranges == model.Download(addr, size, false));
+            break;
+        case 13:
+            memory_track->ForEachDownloadRangeAndClear(addr, size, collect(ranges));
+            REQUIRE(ranges == model.Download(addr, size, true));
+            break;
+        }
+        if (step % 64 == 0) {
+            for (VAddr page = c; page < c + space; page += PAGE) {
+                REQUIRE(rasterizer.Count(page) == model.Count(page));
+            }
+        }
+    }
+}
+
+TEST_CASE("MemoryTracker: Word kernels match the scalar scans", "[video_core]") {
+    using namespace VideoCommon::WordKernels;
+    const Table& scalar = *GetTable(Isa::Scalar);
+    std::mt19937_64 rng{5678};
+    for (const Isa isa : {Isa::Avx2, Isa::Neon}) {
+        const Table* const table = GetTable(isa);
+        if (!table) {
+            continue;
+        }
+        for (size_t count = 0; count < 40; ++count) {
+            for (int trial = 0; trial < 64; ++trial) {
+                // Runs of empty or full words, with a few others where the scans have to stop
+                std::vector<u64> words(count, trial % 2 == 0 ? 0 : ~u64{0});
+                std::vector<u64> exclude(count);
+                const std::array<const u64*, 2> excludes{nullptr, exclude.data()};
+                for (size_t changes = rng() % 3; changes > 0 && count > 0; --changes) {
+                    words[rng() % count] = rng() % 2 == 0 ? rng() : ~words[0];
+                    exclude[rng() % count] = rng() % 2 == 0 ? rng() : ~u64{0};
+                }
+                for (const u64 flip : {u64{0}, ~u64{0}}) {
+                    for (const u64* const mask : excludes) {
+                        const u64* const data = words.data();
+                        REQUIRE(table->find_set(data, mask, flip, count) ==
+                                scalar.find_set(data, mask, flip, count));
+                        REQUIRE(table->find_not_full(data, mask, flip, count) ==
+                                scalar.find_not_full(data, mask, flip, count));
+                        REQUIRE(table->find_last_set(data, mask, flip, count) ==
+                                scalar.find_last_set(data, mask, flip, count));
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("MemoryTracker: Benchmark", "[.][video_core]") {
+    // A 64MB heap of buffers, tracked and uploaded the way the buffer cache does every frame
+    static constexpr u64 heap_size = HIGH_PAGE_SIZE * 16;
+    static constexpr u64 buffer_size = HIGH_PAGE_SIZE / 4;
+    static constexpr size_t num_buffers = heap_size / buffer_size;
+    std::mt19937 rng{42};
+    CountingRasterizer rasterizer;
+    auto memory_track = std::make_unique<VideoCommon::MemoryTrackerBase<CountingRasterizer>>(
+        rasterizer);
+    memory_track->UnmarkRegionAsCpuModified(c, heap_size);
+
+    std::vector<Range> writes(256);
+    for (auto& [addr, size] : writes) {
+        addr = c + rng() % heap_size;
+        size = 1 + rng() % (PAGE * 4);
+    }
+    u64 checksum = 0;
+    const auto sink = [&checksum](u64 addr, u64 size) { checksum += addr ^ size; };
+
+    // Guest writes to a few pages of the heap, followed by the uploads of every buffer
+    const double write = NanosecondsPerOp(writes.size(), [&] {
+        for (const auto& [addr, size] : writes) {
+            memory_track->MarkRegionAsCpuModified(addr, size);
+        }
+        memory_track->ForEachUploadRange(c, heap_size, sink);
+    });
+    const double upload = NanosecondsPerOp(num_buffers, [&] {
+        for (const auto& [addr, size] : writes) {
+            memory_track->MarkRegionAsCpuModified(addr, size);
+        }
+        for (u64 buffer = 0; buffer < num_buffers; ++buffer) {
+            memory_track->ForEachUploadRange(c + buffer * buffer_size, buffer_size, sink);
+        }
+    });
+    // Whole buffers invalidated and retracked, as when the guest rewrites its heap
+    const double retrack = NanosecondsPerOp(num_buffers * 2, [&] {
+        for (u64 buffer = 0; buffer < num_buffers; ++buffer) {
+            memory_track->MarkRegionAsCpuModified(c + buffer * buffer_size, buffer_size);
+        }
+        for (u64 buffer = 0; buffer < num_buffers; ++buffer) {
+            memory_track->UnmarkRegionAsCpuModified(c + buffer * buffer_size, buffer_size);
+        }
+    });
+    // Bindings checking whether their buffers need an upload or a download
+    for (const auto& [addr, size] : writes) {
+        memory_track->MarkRegionAsCpuModified(addr, size);
+        memory_track->MarkRegionAsGpuModified(addr + HIGH_PAGE_SIZE, size);
+    }
+    std::vector<Range> queries(1024);
+    for (auto& [addr, size] : queries) {
+        addr = c + rng() % (heap_size - buffer_size);
+        size = PAGE + rng() % buffer_size;
+    }
+    bool any = false;
+    const double query = NanosecondsPerOp(queries.size(), [&] {
+        for (const auto& [addr, size] : queries) {
+            any |= memory_track->IsRegionCpuModified(addr, size);
+            any |= memory_track->IsRegionGpuModified(addr, size);
+        }
+    });
+    const double modified_region = NanosecondsPerOp(queries.size(), [&] {
+        for (const auto& [addr, size] : queries) {
+            const auto [begin, end] = memory_track->ModifiedCpuRegion(addr, size);
+            checksum += begin + end;
+        }
+    });
+    // Render targets written by the GPU and read back
+    const double download = NanosecondsPerOp(num_buffers, [&] {
+        for (const auto& [addr, size] : writes) {
+            memory_track->MarkRegionAsGpuModified(addr, size * 16);
+        }
+        for (u64 buffer = 0; buffer < num_buffers; ++buffer) {
+            memory_track->ForEachDownloadRangeAndClear(c + buffer * buffer_size, buffer_size,
+                                                       sink);
+        }
+    });
+    memory_track->ForEachUploadRange(c, heap_size, sink);
+    REQUIRE(rasterizer.pages == static_cast<s64>(heap_size / PAGE));
+    REQUIRE(checksum != 0);
+    REQUIRE(any);
+    printf("MemoryTracker: write and upload %.2f ns per write, upload %.2f ns, retrack %.2f ns, "
+           "download %.2f ns per buffer, query %.2f ns, modified region %.2f ns per query, "
+           "%llu notifications\n",
+           write, upload, retrack, download, query, modified_region,
+           static_cast<unsigned long long>(rasterizer.calls));
+}
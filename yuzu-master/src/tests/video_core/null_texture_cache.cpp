@@ -0,0 +1,453 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/literals.h"
+#include "core/core.h"
+#include "core/device_memory.h"
+#include "video_core/buffer_cache/buffer_cache.h"
+#include "video_core/control/channel_state.h"
+#include "video_core/dirty_flags.h"
+#include "video_core/dma_pusher.h"
+#include "video_core/engines/fermi_2d.h"
+#include "video_core/engines/kepler_compute.h"
+#include "video_core/engines/kepler_memory.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/engines/maxwell_dma.h"
+#include "video_core/framebuffer_config.h"
+#include "video_core/host1x/gpu_device_memory_manager.h"
+#include "video_core/memory_manager.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_null/null_buffer_cache.h"
+#include "video_core/renderer_null/null_rasterizer.h"
+#include "video_core/renderer_null/null_staging_buffer_pool.h"
+#include "video_core/renderer_null/null_texture_cache.h"
+#include "video_core/texture_cache/texture_cache.h"
+#include "video_core/texture_cache/util.h"
+
+// The emulator doesn't use the caches with the null runtimes, instantiate them whole here so any
+// runtime member they need is still checked to exist.
+template class VideoCommon::TextureCache<Null::TextureCacheParams>;
+template class VideoCommon::BufferCache<Null::BufferCacheParams>;
+
+namespace {
+using VideoCommon::BufferCopy;
+using VideoCommon::BufferImageCopy;
+using VideoCommon::Extent3D;
+using VideoCommon::ImageCopy;
+using VideoCommon::ImageInfo;
+using VideoCommon::ImageType;
+using VideoCore::Surface::PixelFormat;
+
+ImageInfo MakeInfo(PixelFormat format, u32 width, u32 height, s32 levels, s32 layers) {
+    ImageInfo info;
+    info.format = format;
+    info.type = ImageType::e2D;
+    info.size = Extent3D{width, height, 1};
+    info.resources.levels = levels;
+    info.resources.layers = layers;
+    info.layer_stride = VideoCommon::CalculateLayerStride(info);
+    info.maybe_unaligned_layer_stride = VideoCommon::CalculateLayerSize(info);
+    return info;
+}
+
+/// Builds tightly packed copies of every level, the way the texture cache lays out uploads.
+std::vector<BufferImageCopy> FullCopies(const ImageInfo& info, u32 tile_size, u32 bytes_per_block,
+                                        size_t& total_size) {
+    std::vector<BufferImageCopy> copies;
+    total_size = 0;
+    for (s32 level = 0; level < info.resources.levels; ++level) {
+        const u32 width = std::max(info.size.width >> level, 1U);
+        const u32 height = std::max(info.size.height >> level, 1U);
+        const u32 aligned_width = (width + tile_size - 1) / tile_size * tile_size;
+        const u32 aligned_height = (height + tile_size - 1) / tile_size * tile_size;
+        const size_t layer_size = static_cast<size_t>(aligned_width / tile_size) *
+                                  (aligned_height / tile_size) * bytes_per_block;
+        copies.push_back(BufferImageCopy{
+            .buffer_offset = total_size,
+            .buffer_size = layer_size * info.resources.layers,
+            .buffer_row_length = aligned_width,
+            .buffer_image_height = aligned_height,
+            .image_subresource{
+                .base_level = level,
+                .base_layer = 0,
+                .num_layers = info.resources.layers,
+            },
+            .image_offset{0, 0, 0},
+            .image_extent{width, height, 1},
+        });
+        total_size += layer_size * info.resources.layers;
+    }
+    return copies;
+}
+
+void FillPattern(std::span<u8> data, u32 seed) {
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<u8>((i * 131 + seed) ^ (i >> 8));
+    }
+}
+
+/// Forwards guest memory events to a texture cache, the way the hardware rasterizers do.
+class TextureCacheRasterizer final : public VideoCore::RasterizerInterface {
+public:
+    explicit TextureCacheRasterizer(Null::TextureCache& texture_cache_)
+        : texture_cache{texture_cache_} {}
+
+    void InvalidateRegion(DAddr addr, u64 size, VideoCommon::CacheType) override {
+        texture_cache.WriteMemory(addr, size);
+    }
+    void UnmapMemory(DAddr addr, u64 size) override {
+        texture_cache.UnmapMemory(addr, size);
+    }
+    void ModifyGPUMemory(size_t as_id, GPUVAddr addr, u64 size) override {
+        texture_cache.UnmapGPUMemory(as_id, addr, size);
+    }
+
+    void Draw(bool, u32) override {}
+    void DrawTexture() override {}
+    void Clear(u32) override {}
+    void DispatchCompute() override {}
+    void ResetCounter(VideoCommon::QueryType) override {}
+    void Query(GPUVAddr, VideoCommon::QueryType, VideoCommon::QueryPropertiesFlags, u32,
+               u32) override {}
+    void BindGraphicsUniformBuffer(size_t, u32, GPUVAddr, u32) override {}
+    void DisableGraphicsUniformBuffer(size_t, u32) override {}
+    void SignalFence(std::function<void()>&& func) override {
+        func();
+    }
+    void SyncOperation(std::function<void()>&& func) override {
+        func();
+    }
+    void SignalSyncPoint(u32) override {}
+    void SignalReference() override {}
+    void ReleaseFences(bool) override {}
+    void FlushAll() override {}
+    void FlushRegion(DAddr, u64, VideoCommon::CacheType) override {}
+    bool MustFlushRegion(DAddr, u64, VideoCommon::CacheType) override {
+        return false;
+    }
+    VideoCore::RasterizerDownloadArea GetFlushArea(DAddr addr, u64 size) override {
+        return {addr, addr + size, false};
+    }
+    void OnCacheInvalidation(PAddr, u64) override {}
+    bool OnCPUWrite(PAddr, u64) override {
+        return false;
+    }
+    void InvalidateGPUCache() override {}
+    void FlushAndInvalidateRegion(DAddr, u64, VideoCommon::CacheType) override {}
+    void WaitForIdle() override {}
+    void FragmentBarrier() override {}
+    void TiledCacheBarrier() override {}
+    void FlushCommands() override {}
+    void TickFrame() override {}
+    Tegra::Engines::AccelerateDMAInterface& AccessAccelerateDMA() override {
+        return accelerate_dma;
+    }
+    void AccelerateInlineToMemory(GPUVAddr, size_t, std::span<const u8>) override {}
+
+private:
+    Null::TextureCache& texture_cache;
+    Null::AccelerateDMA accelerate_dma;
+};
+
+/**
+ * A texture cache on the null runtime, bound to a channel which renders to 64x64 A8B8G8R8 targets.
+ * The GPU memory of the channel is mapped to device memory without backing, guest reads of it
+ * return zeros.
+ */
+class TextureCacheFixture {
+public:
+    static constexpr GPUVAddr GPU_ADDR = 0x10'0000'0000;
+    static constexpr DAddr DEVICE_ADDR = 0x1000'0000;
+    static constexpr size_t MAPPED_SIZE = 0x100'0000;
+    static constexpr u32 SIZE = 64;
+    /// 64x64 texels of 4 bytes fill whole GOBs, so layers are tightly packed.
+    static constexpr u32 LAYER_SIZE = SIZE * SIZE * 4;
+
+    TextureCacheFixture() {
+        device_memory_manager.RegisterProcess(nullptr);
+        gpu_memory = std::make_shared<Tegra::MemoryManager>(system, device_memory_manager);
+        gpu_memory->BindRasterizer(&rasterizer);
+        channel.memory_manager = gpu_memory;
+        channel.maxwell_3d = std::make_unique<Tegra::Engines::Maxwell3D>(system, *gpu_memory);
+        channel.kepler_compute =
+            std::make_unique<Tegra::Engines::KeplerCompute>(system, *gpu_memory);
+        texture_cache.CreateChannel(channel);
+        texture_cache.BindToChannel(channel.bind_id);
+        gpu_memory->Map(GPU_ADDR, DEVICE_ADDR, MAPPED_SIZE, Tegra::PTEKind::GENERIC_16BX2);
+    }
+
+    /// Render to a target at the start of the mapped memory.
+    void UpdateRenderTarget(u32 width, u32 height, u32 layers) {
+        auto& maxwell3d = *channel.maxwell_3d;
+        auto& regs = maxwell3d.regs;
+        regs.rt_control.count.Assign(1);
+        auto& rt = regs.rt[0];
+        rt.address_high = static_cast<u32>(GPU_ADDR >> 32);
+        rt.address_low = static_cast<u32>(GPU_ADDR);
+        rt.width = width;
+        rt.height = height;
+        rt.format = Tegra::RenderTargetFormat::A8B8G8R8_UNORM;
+        rt.tile_mode.block_height.Assign(3);
+        rt.depth.Assign(layers);
+        rt.array_pitch = LAYER_SIZE / 4;
+        regs.surface_clip.width.Assign(width);
+        regs.surface_clip.height.Assign(height);
+        maxwell3d.dirty.flags[VideoCommon::Dirty::RenderTargets] = true;
+        maxwell3d.dirty.flags[VideoCommon::Dirty::RenderTargetControl] = true;
+        texture_cache.UpdateRenderTargets(false);
+    }
+
+    /// Returns the most recently modified image at the start of the mapped memory.
+    Null::Image* FindImage() {
+        const auto [view, is_rescaled] =
+            texture_cache.TryFindFramebufferImageView(Tegra::FramebufferConfig{}, DEVICE_ADDR);
+        return view ? view->GetImage() : nullptr;
+    }
+
+    Core::System system;
+    Core::DeviceMemory device_memory;
+    Tegra::MaxwellDeviceMemoryManager device_memory_manager{device_memory};
+    Null::StagingBufferPool staging_pool;
+    Null::TextureCacheRuntime runtime{staging_pool};
+    Null::TextureCache texture_cache{runtime, device_memory_manager};
+    TextureCacheRasterizer rasterizer{texture_cache};
+    std::shared_ptr<Tegra::MemoryManager> gpu_memory;
+    Tegra::Control::ChannelState channel{0};
+};
+
+/// Writes a pattern to the texels of the first layer inside a size x size square.
+void FillTexels(Null::Image& image, u32 size, u32 seed) {
+    for (u32 y = 0; y < size; ++y) {
+        for (u32 x = 0; x < size; ++x) {
+            FillPattern(image.Block(0, 0, x, y, 0), seed + y * TextureCacheFixture::SIZE + x);
+        }
+    }
+}
+
+/// Checks the texels of the first layer inside a size x size square hold the pattern.
+bool HasTexels(Null::Image& image, u32 size, u32 seed) {
+    std::array<u8, 4> expected;
+    for (u32 y = 0; y < size; ++y) {
+        for (u32 x = 0; x < size; ++x) {
+            FillPattern(expected, seed + y * TextureCacheFixture::SIZE + x);
+            if (!std::ranges::equal(image.Block(0, 0, x, y, 0), expected)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+} // Anonymous namespace
+
+TEST_CASE("NullTextureCache: Upload and download levels and layers", "[video_core]") {
+    Null::StagingBufferPool staging_pool;
+    Null::TextureCacheRuntime runtime{staging_pool};
+    const ImageInfo info = MakeInfo(PixelFormat::A8B8G8R8_UNORM, 37, 19, 4, 3);
+    Null::Image image{runtime, info, 0, 0};
+
+    size_t total_size = 0;
+    const std::vector<BufferImageCopy> copies = FullCopies(info, 1, 4, total_size);
+    std::vector<u8> upload(total_size);
+    FillPattern(upload, 1);
+
+    Null::StagingBufferMap upload_map = runtime.UploadStagingBuffer(total_size);
+    std::memcpy(upload_map.mapped_span.data(), upload.data(), total_size);
+    image.UploadMemory(upload_map, copies);
+    REQUIRE(image.Data().size() == total_size);
+    REQUIRE(runtime.GetDeviceMemoryUsage() == total_size);
+
+    Null::StagingBufferMap download_map = runtime.DownloadStagingBuffer(total_size);
+    image.DownloadMemory(download_map, copies);
+    REQUIRE(std::equal(upload.begin(), upload.end(), download_map.mapped_span.begin()));
+}
+
+TEST_CASE("NullTextureCache: Moved images keep the memory usage", "[video_core]") {
+    Null::StagingBufferPool staging_pool;
+    Null::TextureCacheRuntime runtime{staging_pool};
+    const ImageInfo small_info = MakeInfo(PixelFormat::A8B8G8R8_UNORM, 16, 16, 1, 1);
+    const ImageInfo large_info = MakeInfo(PixelFormat::A8B8G8R8_UNORM, 64, 64, 1, 1);
+    Null::Image small{runtime, small_info, 0, 0};
+    Null::Image large{runtime, large_info, 0, 0};
+    REQUIRE(runtime.GetDeviceMemoryUsage() == (16 * 16 + 64 * 64) * 4);
+
+    // Assigning over an image releases its storage
+    small = std::move(large);
+    REQUIRE(runtime.GetDeviceMemoryUsage() == 64 * 64 * 4);
+    {
+        Null::Image moved{std::move(small)};
+        REQUIRE(moved.Data().size() == 64 * 64 * 4);
+        REQUIRE(runtime.GetDeviceMemoryUsage() == 64 * 64 * 4);
+    }
+    REQUIRE(runtime.GetDeviceMemoryUsage() == 0);
+}
+
+TEST_CASE("NullTextureCache: Compressed partial upload", "[video_core]") {
+    Null::StagingBufferPool staging_pool;
+    Null::TextureCacheRuntime runtime{staging_pool};
+    const ImageInfo info = MakeInfo(PixelFormat::BC1_RGBA_UNORM, 30, 30, 1, 1);
+    Null::Image image{runtime, info, 0, 0};
+    REQUIRE(image.LevelBlocks(0).width == 8);
+    REQUIRE(image.LevelBlocks(0).height == 8);
+
+    // Upload a 2x1 block region at block (3, 5)
+    std::array<u8, 16> blocks;
+    FillPattern(blocks, 2);
+    const std::array copies{BufferImageCopy{
+        .buffer_offset = 0,
+        .buffer_size = blocks.size(),
+        .buffer_row_length = 8,
+        .buffer_image_height = 4,
+        .image_subresource{},
+        .image_offset{12, 20, 0},
+        .image_extent{8, 4, 1},
+    }};
+    image.UploadMemory(blocks.data(), 0, copies);
+    REQUIRE(std::ranges::equal(image.Block(0, 0, 3, 5, 0), std::span(blocks).first(8)));
+    REQUIRE(std::ranges::equal(image.Block(0, 0, 4, 5, 0), std::span(blocks).last(8)));
+    REQUIRE(std::ranges::all_of(image.Block(0, 0, 2, 5, 0), [](u8 value) { return value == 0; }));
+}
+
+TEST_CASE("NullTextureCache: Copy between images", "[video_core]") {
+    Null::StagingBufferPool staging_pool;
+    Null::TextureCacheRuntime runtime{staging_pool};
+    const ImageInfo info = MakeInfo(PixelFormat::R32_UINT, 16, 16, 1, 2);
+    Null::Image src{runtime, info, 0, 0};
+    Null::Image dst{runtime, info, 0, 0};
+
+    size_t total_size = 0;
+    const std::vector<BufferImageCopy> copies = FullCopies(info, 1, 4, total_size);
+    std::vector<u8> upload(total_size);
+    FillPattern(upload, 3);
+    src.UploadMemory(upload.data(), 0, copies);
+
+    const std::array image_copies{ImageCopy{
+        .src_subresource{.base_level = 0, .base_layer = 1, .num_layers = 1},
+        .dst_subresource{.base_level = 0, .base_layer = 0, .num_layers = 1},
+        .src_offset{2, 3, 0},
+        .dst_offset{5, 7, 0},
+        .extent{4, 2, 1},
+    }};
+    runtime.CopyImage(dst, src, image_copies);
+    for (u32 y = 0; y < 16; ++y) {
+        for (u32 x = 0; x < 16; ++x) {
+            const bool inside = x >= 5 && x < 9 && y >= 7 && y < 9;
+            const std::span<u8> texel = dst.Block(0, 0, x, y, 0);
+            if (inside) {
+                REQUIRE(std::ranges::equal(texel, src.Block(0, 1, x - 3, y - 4, 0)));
+            } else {
+                REQUIRE(std::ranges::all_of(texel, [](u8 value) { return value == 0; }));
+            }
+        }
+    }
+}
+
+TEST_CASE("NullBufferCache: Copy and clear", "[video_core]") {
+    Null::StagingBufferPool staging_pool;
+    Null::BufferCacheRuntime runtime{staging_pool};
+    Null::Buffer src{runtime, 0x1000, 0x1000};
+    Null::Buffer dst{runtime, 0x2000, 0x1000};
+
+    std::vector<u8> data(0x100);
+    FillPattern(data, 4);
+    src.ImmediateUpload(0x40, data);
+
+    const std::array copies{BufferCopy{.src_offset = 0x40, .dst_offset = 0x200, .size = 0x100}};
+    runtime.CopyBuffer(dst, src, copies, true);
+    std::vector<u8> readback(0x100);
+    dst.ImmediateDownload(0x200, readback);
+    REQUIRE(readback == data);
+
+    runtime.ClearBuffer(dst, 0x204, 8, 0xDEADBEEF);
+    u32 value{};
+    std::memcpy(&value, dst.Data().data() + 0x208, sizeof(value));
+    REQUIRE(value == 0xDEADBEEF);
+    REQUIRE(dst.Data()[0x203] == data[3]);
+    REQUIRE(dst.Data()[0x20C] == data[0xC]);
+}
+
+TEST_CASE("NullTextureCache: Render targets with more layers join the old image", "[video_core]") {
+    TextureCacheFixture fixture;
+    constexpr u32 SIZE = TextureCacheFixture::SIZE;
+    fixture.UpdateRenderTarget(SIZE, SIZE, 1);
+    Null::Image* image = fixture.FindImage();
+    REQUIRE(image != nullptr);
+    REQUIRE(image->info.resources.layers == 1);
+    FillTexels(*image, SIZE, 5);
+
+    // The old image is not a subresource of the new one, it's copied into it and deleted
+    fixture.UpdateRenderTarget(SIZE, SIZE, 2);
+    image = fixture.FindImage();
+    REQUIRE(image != nullptr);
+    REQUIRE(image->info.resources.layers == 2);
+    REQUIRE(True(image->flags & VideoCommon::ImageFlagBits::GpuModified));
+    REQUIRE(image->aliased_images.empty());
+    REQUIRE(HasTexels(*image, SIZE, 5));
+    REQUIRE(fixture.runtime.GetDeviceMemoryUsage() ==
+            (1 + 2) * TextureCacheFixture::LAYER_SIZE);
+    for (size_t tick = 0; tick <= 8; ++tick) {
+        fixture.texture_cache.TickFrame();
+    }
+    REQUIRE(fixture.runtime.GetDeviceMemoryUsage() == 2 * TextureCacheFixture::LAYER_SIZE);
+}
+
+TEST_CASE("NullTextureCache: Smaller render targets alias the old image", "[video_core]") {
+    TextureCacheFixture fixture;
+    constexpr u32 SIZE = TextureCacheFixture::SIZE;
+    constexpr u32 SMALL_SIZE = SIZE - 4;
+    fixture.UpdateRenderTarget(SIZE, SIZE, 1);
+    FillTexels(*fixture.FindImage(), SIZE, 6);
+
+    // Both sizes cover the same GOBs, the images alias and the new one gets the old contents
+    fixture.UpdateRenderTarget(SMALL_SIZE, SMALL_SIZE, 1);
+    Null::Image* small_image = fixture.FindImage();
+    REQUIRE(small_image != nullptr);
+    REQUIRE(small_image->info.size.width == SMALL_SIZE);
+    REQUIRE(small_image->aliased_images.size() == 1);
+    REQUIRE(HasTexels(*small_image, SMALL_SIZE, 6));
+    FillTexels(*small_image, SMALL_SIZE, 7);
+
+    // Going back to the old image synchronizes the newer contents of its alias
+    fixture.UpdateRenderTarget(SIZE, SIZE, 1);
+    Null::Image* image = fixture.FindImage();
+    REQUIRE(image != nullptr);
+    REQUIRE(image->info.size.width == SIZE);
+    REQUIRE(image->aliased_images.size() == 1);
+    REQUIRE(HasTexels(*image, SMALL_SIZE, 7));
+    REQUIRE(fixture.runtime.GetDeviceMemoryUsage() ==
+            (SIZE * SIZE + SMALL_SIZE * SMALL_SIZE) * 4);
+}
+
+TEST_CASE("NullTextureCache: Guest writes and unmaps invalidate images", "[video_core]") {
+    TextureCacheFixture fixture;
+    constexpr u32 SIZE = TextureCacheFixture::SIZE;
+    fixture.UpdateRenderTarget(SIZE, SIZE, 1);
+    FillTexels(*fixture.FindImage(), SIZE, 8);
+
+    // The image is reuploaded from guest memory, which reads as zeros, on its next use
+    fixture.gpu_memory->InvalidateRegion(TextureCacheFixture::GPU_ADDR,
+                                         TextureCacheFixture::LAYER_SIZE);
+    REQUIRE(True(fixture.FindImage()->flags & VideoCommon::ImageFlagBits::CpuModified));
+    fixture.texture_cache.UpdateRenderTargets(false);
+    Null::Image* image = fixture.FindImage();
+    REQUIRE(False(image->flags & VideoCommon::ImageFlagBits::CpuModified));
+    REQUIRE(std::ranges::all_of(image->Data(), [](u8 value) { return value == 0; }));
+
+    fixture.gpu_memory->Unmap(TextureCacheFixture::GPU_ADDR, TextureCacheFixture::MAPPED_SIZE);
+    REQUIRE(fixture.FindImage() == nullptr);
+    for (size_t tick = 0; tick <= 8; ++tick) {
+        fixture.texture_cache.TickFrame();
+    }
+    REQUIRE(fixture.runtime.GetDeviceMemoryUsage() == 0);
+}
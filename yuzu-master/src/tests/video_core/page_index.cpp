@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/hash.h"
+#include "video_core/texture_cache/page_index.h"
+
+namespace {
+constexpr u64 PAGE_BITS = 20;
+
+/// Page table layout used by the texture cache before PageIndex.
+using HashPageTable = std::unordered_map<u64, std::vector<u32>, Common::IdentityHash<u64>>;
+
+enum class OpType {
+    Register,
+    Unregister,
+    Lookup,
+};
+
+struct Op {
+    OpType type;
+    u32 id;
+    u64 addr;
+    u64 size;
+};
+
+/**
+ * Generates a trace shaped like the texture cache traffic of a frame: a working set of images
+ * that is slowly replaced, and many small lookups and invalidations landing on it.
+ */
+std::vector<Op> MakeTrace(size_t num_ops, u32 seed) {
+    static constexpr u64 heap_base = 0x8'0000'0000ULL;
+    static constexpr u64 heap_size = 2ULL << 30;
+    std::mt19937_64 rng{seed};
+    std::vector<Op> trace;
+    std::vector<Op> live;
+    u32 next_id = 0;
+    while (trace.size() < num_ops) {
+        const u64 roll = rng() % 100;
+        if (live.size() < 64 || roll < 2) {
+            const u64 size = (1 + rng() % 64) << 16;
+            const u64 addr = heap_base + ((rng() % heap_size) & ~u64{0xFFF});
+            const Op op{OpType::Register, next_id++, addr, size};
+            live.push_back(op);
+            trace.push_back(op);
+        } else if (roll < 4) {
+            const size_t index = rng() % live.size();
+            Op op = live[index];
+            op.type = OpType::Unregister;
+            trace.push_back(op);
+            live[index] = live.back();
+            live.pop_back();
+        } else {
+            const Op& image = live[rng() % live.size()];
+            const u64 offset = rng() % image.size;
+            const u64 size = std::min<u64>(1 + rng() % 0x4000, image.size - offset);
+            trace.push_back({OpType::Lookup, 0, image.addr + offset, size});
+        }
+    }
+    return trace;
+}
+
+template <typename Func>
+void ForEachPage(u64 addr, u64 size, Func&& func) {
+    const u64 page_end = (addr + size - 1) >> PAGE_BITS;
+    for (u64 page = addr >> PAGE_BITS; page <= page_end; ++page) {
+        func(page);
+    }
+}
+
+/// Replays a trace, returning a checksum of the ids found by lookups.
+template <typename Table, typename FindFunc>
+u64 Replay(Table& table, std::span<const Op> trace, FindFunc&& find) {
+    u64 checksum = 0;
+    for (const Op& op : trace) {
+        switch (op.type) {
+        case OpType::Register:
+            ForEachPage(op.addr, op.size, [&](u64 page) { table[page].push_back(op.id); });
+            break;
+        case OpType::Unregister:
+            ForEachPage(op.addr, op.size, [&](u64 page) {
+                auto* const ids = find(table, page);
+                REQUIRE(ids != nullptr);
+                const auto it = std::ranges::find(*ids, op.id);
+                REQUIRE(it != ids->end());
+                ids->erase(it);
+            });
+            break;
+        case OpType::Lookup:
+            ForEachPage(op.addr, op.size, [&](u64 page) {
+                const auto* const ids = find(table, page);
+                if (!ids) {
+                    return;
+                }
+                for (const u32 id : *ids) {
+                    checksum = checksum * 31 + id;
+                }
+            });
+            break;
+        }
+    }
+    return checksum;
+}
+
+u64 ReplayHash(HashPageTable& table, std::span<const Op> trace) {
+    return Replay(table, trace, [](HashPageTable& map, u64 page) -> std::vector<u32>* {
+        const auto it = map.find(page);
+        return it != map.end() ? &it->second : nullptr;
+    });
+}
+
+u64 ReplayIndex(VideoCommon::PageIndex<u32>& table, std::span<const Op> trace) {
+    return Replay(table, trace,
+                  [](VideoCommon::PageIndex<u32>& index, u64 page) { return index.Find(page); });
+}
+} // Anonymous namespace
+
+TEST_CASE("PageIndex: Find and insert", "[video_core]") {
+    VideoCommon::PageIndex<u32> index;
+    REQUIRE(index.Find(0) == nullptr);
+    REQUIRE(index.Find(~0ULL) == nullptr);
+
+    index[5].push_back(1);
+    index[5].push_back(2);
+    index[~0ULL].push_back(3);
+    auto* const list = index.Find(5);
+    REQUIRE(list != nullptr);
+    REQUIRE(list->size() == 2);
+
+    // Growing the table keeps existing lists in place
+    index[1ULL << 24].push_back(4);
+    REQUIRE(index.Find(5) == list);
+    REQUIRE(index.Find(6)->empty());
+    REQUIRE(index.Find(~0ULL)->front() == 3);
+    REQUIRE(index.Find(1ULL << 24)->front() == 4);
+
+    index.Clear();
+    REQUIRE(index.Find(5) == nullptr);
+    REQUIRE(index.Find(~0ULL) == nullptr);
+}
+
+TEST_CASE("PageIndex: Matches hash page table", "[video_core]") {
+    const std::vector<Op> trace = MakeTrace(200'000, 1);
+    HashPageTable hash_table;
+    VideoCommon::PageIndex<u32> index;
+    REQUIRE(ReplayHash(hash_table, trace) == ReplayIndex(index, trace));
+}
+
+TEST_CASE("PageIndex: Benchmark", "[.][video_core]") {
+    static constexpr size_t num_ops = 2'000'000;
+    const std::vector<Op> trace = MakeTrace(num_ops, 2);
+
+    HashPageTable hash_table;
+    auto start = std::chrono::steady_clock::now();
+    const u64 hash_checksum = ReplayHash(hash_table, trace);
+    auto end = std::chrono::steady_clock::now();
+    const double hash_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    VideoCommon::PageIndex<u32> index;
+    start = std::chrono::steady_clock::now();
+    const u64 index_checksum = ReplayIndex(index, trace);
+    end = std::chrono::steady_clock::now();
+    const double index_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    REQUIRE(hash_checksum == index_checksum);
+    printf("Page table replay of %zu ops: unordered_map %.3f ms, PageIndex %.3f ms\n", num_ops,
+           hash_ms, index_ms);
+}
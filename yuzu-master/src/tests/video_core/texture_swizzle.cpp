@@ -0,0 +1,184 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/alignment.h"
+#include "common/common_types.h"
+#include "common/div_ceil.h"
+#include "video_core/textures/decoders.h"
+
+namespace {
+using namespace Tegra::Texture;
+
+constexpr SwizzleTable SWIZZLE_TABLE = MakeSwizzleTable();
+
+struct Layout {
+    u32 stride;
+    u32 height;
+    u32 block_height;
+    u32 block_depth;
+};
+
+/// Reference block linear address of a byte, computed from the GOB table one byte at a time.
+u32 ReferenceOffset(const Layout& layout, u32 x, u32 y, u32 z) {
+    const u32 gobs_in_x = Common::DivCeil(layout.stride, GOB_SIZE_X);
+    const u32 block_size = gobs_in_x * (GOB_SIZE << (layout.block_height + layout.block_depth));
+    const u32 slice_size =
+        Common::DivCeil(layout.height, GOB_SIZE_Y << layout.block_height) * block_size;
+    const u32 gob_y = y / GOB_SIZE_Y;
+    const u32 depth_mask = (1U << layout.block_depth) - 1;
+    const u32 height_mask = (1U << layout.block_height) - 1;
+    return (z >> layout.block_depth) * slice_size +
+           ((z & depth_mask) << layout.block_height) * GOB_SIZE +
+           (gob_y >> layout.block_height) * block_size + (gob_y & height_mask) * GOB_SIZE +
+           (x / GOB_SIZE_X) * (GOB_SIZE << (layout.block_height + layout.block_depth)) +
+           SWIZZLE_TABLE[y % GOB_SIZE_Y][x % GOB_SIZE_X];
+}
+
+std::vector<u8> RandomBytes(size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::vector<u8> result(size);
+    for (u8& value : result) {
+        value = static_cast<u8>(rng());
+    }
+    return result;
+}
+
+struct TextureCase {
+    u32 bytes_per_pixel;
+    u32 width;
+    u32 height;
+    u32 depth;
+    u32 block_height;
+    u32 block_depth;
+};
+
+void CheckUnswizzle(const TextureCase& test) {
+    const Layout layout{
+        .stride = test.width * test.bytes_per_pixel,
+        .height = test.height,
+        .block_height = test.block_height,
+        .block_depth = test.block_depth,
+    };
+    const size_t swizzled_size =
+        CalculateSize(true, test.bytes_per_pixel, test.width, test.height, test.depth,
+                      test.block_height, test.block_depth);
+    const size_t linear_size =
+        CalculateSize(false, test.bytes_per_pixel, test.width, test.height, test.depth,
+                      test.block_height, test.block_depth);
+    const std::vector<u8> swizzled = RandomBytes(swizzled_size, test.width ^ test.height);
+    std::vector<u8> linear(linear_size);
+    UnswizzleTexture(linear, swizzled, test.bytes_per_pixel, test.width, test.height, test.depth,
+                     test.block_height, test.block_depth);
+
+    std::vector<u8> reswizzled(swizzled_size);
+    SwizzleTexture(reswizzled, linear, test.bytes_per_pixel, test.width, test.height, test.depth,
+                   test.block_height, test.block_depth);
+
+    const u32 pitch = layout.stride;
+    for (u32 z = 0; z < test.depth; ++z) {
+        for (u32 y = 0; y < test.height; ++y) {
+            for (u32 x = 0; x < pitch; ++x) {
+                const u32 swizzled_offset = ReferenceOffset(layout, x, y, z);
+                const u32 linear_offset = (z * test.height + y) * pitch + x;
+                REQUIRE(linear[linear_offset] == swizzled[swizzled_offset]);
+                REQUIRE(reswizzled[swizzled_offset] == swizzled[swizzled_offset]);
+            }
+        }
+    }
+}
+
+void CheckSubrect(u32 bytes_per_pixel, u32 origin_x, u32 origin_y, u32 extent_x, u32 extent_y) {
+    static constexpr u32 width = 100;
+    static constexpr u32 height = 70;
+    static constexpr u32 block_height = 2;
+    const Layout layout{
+        .stride = Common::AlignUp(width * bytes_per_pixel, GOB_SIZE_X),
+        .height = height,
+        .block_height = block_height,
+        .block_depth = 0,
+    };
+    const u32 pitch = extent_x * bytes_per_pixel;
+    const size_t swizzled_size =
+        CalculateSize(true, bytes_per_pixel, width, height, 1, block_height, 0);
+    const std::vector<u8> swizzled = RandomBytes(swizzled_size, origin_x ^ extent_y);
+    std::vector<u8> linear(pitch * height);
+    UnswizzleSubrect(linear, swizzled, bytes_per_pixel, width, height, 1, origin_x, origin_y,
+                     extent_x, extent_y, block_height, 0, pitch);
+
+    std::vector<u8> reswizzled = swizzled;
+    std::vector<u8> pattern = RandomBytes(linear.size(), origin_y);
+    SwizzleSubrect(reswizzled, pattern, bytes_per_pixel, width, height, 1, origin_x, origin_y,
+                   extent_x, extent_y, block_height, 0, pitch);
+
+    // Pixels are copied whole, even when their size makes them straddle a GOB sector. Straddling
+    // pixels can overwrite their neighbours when swizzling, so only check reads for those.
+    const bool check_writes = std::has_single_bit(bytes_per_pixel);
+    for (u32 y = 0; y < extent_y; ++y) {
+        for (u32 column = 0; column < extent_x; ++column) {
+            const u32 pixel_offset =
+                ReferenceOffset(layout, (origin_x + column) * bytes_per_pixel, origin_y + y, 0);
+            for (u32 byte = 0; byte < bytes_per_pixel; ++byte) {
+                const u32 swizzled_offset = pixel_offset + byte;
+                const u32 linear_offset = y * pitch + column * bytes_per_pixel + byte;
+                REQUIRE(linear[linear_offset] == swizzled[swizzled_offset]);
+                if (check_writes) {
+                    REQUIRE(reswizzled[swizzled_offset] == pattern[linear_offset]);
+                }
+            }
+        }
+    }
+}
+} // Anonymous namespace
+
+TEST_CASE("TextureSwizzle: Unswizzle matches GOB table", "[video_core]") {
+    for (const u32 bytes_per_pixel : {1U, 2U, 4U, 8U, 16U}) {
+        for (u32 block_height = 0; block_height <= 5; ++block_height) {
+            CheckUnswizzle({bytes_per_pixel, 256 / bytes_per_pixel, 64, 1, block_height, 0});
+            CheckUnswizzle({bytes_per_pixel, 200 / bytes_per_pixel, 37, 1, block_height, 0});
+        }
+        CheckUnswizzle({bytes_per_pixel, 128 / bytes_per_pixel, 24, 4, 1, 1});
+    }
+    CheckUnswizzle({3, 45, 19, 1, 1, 0});
+    CheckUnswizzle({12, 33, 17, 2, 0, 1});
+}
+
+TEST_CASE("TextureSwizzle: Subrect matches GOB table", "[video_core]") {
+    for (const u32 bytes_per_pixel : {1U, 2U, 3U, 4U, 6U, 8U, 12U, 16U}) {
+        CheckSubrect(bytes_per_pixel, 0, 0, 100, 70);
+        CheckSubrect(bytes_per_pixel, 64 / bytes_per_pixel, 8, 32, 16);
+        CheckSubrect(bytes_per_pixel, 5, 3, 90, 60);
+    }
+}
+
+TEST_CASE("TextureSwizzle: Benchmark", "[.][video_core]") {
+    static constexpr u32 width_bytes = 4096;
+    static constexpr u32 height = 1024;
+    static constexpr int iterations = 8;
+    for (const u32 bytes_per_pixel : {1U, 4U, 16U}) {
+        for (const u32 block_height : {0U, 2U, 4U}) {
+            const u32 width = width_bytes / bytes_per_pixel;
+            const std::vector<u8> swizzled = RandomBytes(
+                CalculateSize(true, bytes_per_pixel, width, height, 1, block_height, 0), 0);
+            std::vector<u8> linear(width_bytes * height);
+
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; ++i) {
+                UnswizzleTexture(linear, swizzled, bytes_per_pixel, width, height, 1,
+                                 block_height, 0);
+            }
+            const auto end = std::chrono::steady_clock::now();
+            const double seconds = std::chrono::duration<double>(end - start).count();
+            const double mib = static_cast<double>(linear.size()) * iterations / (1024 * 1024);
+            printf("Unswizzle bpp=%u block_height=%u: %.1f MiB/s\n", bytes_per_pixel,
+                   block_height, mib / seconds);
+        }
+    }
+}
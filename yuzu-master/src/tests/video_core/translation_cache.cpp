@@ -0,0 +1,169 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/virtual_buffer.h"
+#include "video_core/translation_cache.h"
+
+namespace {
+using Tegra::TranslationCache;
+
+struct Translation {
+    u64 address;
+};
+
+constexpr u64 BIG_PAGE_BITS = 16;
+constexpr u64 DEVICE_PAGE_BITS = 12;
+constexpr u64 ADDRESS_SPACE_BITS = 40;
+constexpr u64 DEVICE_SPACE_BITS = 34;
+constexpr size_t NUM_BIG_PAGES = 1ULL << (ADDRESS_SPACE_BITS - BIG_PAGE_BITS);
+
+/// Page tables laid out like the ones of Tegra::MemoryManager and the device memory manager.
+class PageTables {
+public:
+    PageTables()
+        : entries(NUM_BIG_PAGES / 32), big_page_table_dev(NUM_BIG_PAGES),
+          continuous(NUM_BIG_PAGES / 64),
+          device_table(1ULL << (DEVICE_SPACE_BITS - DEVICE_PAGE_BITS)) {}
+
+    void Map(u64 big_page, u64 device_page, u64 host_page) {
+        entries[big_page / 32] |= 2ULL << (2 * (big_page % 32));
+        continuous[big_page / 64] |= 1ULL << (big_page % 64);
+        big_page_table_dev[big_page] = static_cast<u32>(device_page);
+        for (u64 i = 0; i < (1ULL << (BIG_PAGE_BITS - DEVICE_PAGE_BITS)); ++i) {
+            device_table[device_page + i] = static_cast<u32>(host_page + i + 1);
+        }
+    }
+
+    /// Translates a big page to its host address the way MemoryManager::GetPointer used to.
+    u64 Walk(u64 big_page) const {
+        if (((entries[big_page / 32] >> (2 * (big_page % 32))) & 3) != 2) {
+            return 0;
+        }
+        const u64 device_page = big_page_table_dev[big_page];
+        const u32 host_page = device_table[device_page];
+        if (host_page == 0 || ((continuous[big_page / 64] >> (big_page % 64)) & 1) == 0) {
+            return 0;
+        }
+        return static_cast<u64>(host_page - 1) << DEVICE_PAGE_BITS;
+    }
+
+private:
+    std::vector<u64> entries;
+    Common::VirtualBuffer<u32> big_page_table_dev;
+    std::vector<u64> continuous;
+    Common::VirtualBuffer<u32> device_table;
+};
+
+/// Big pages of the mapped buffers and textures, placed like the nvdrv allocator places them.
+std::vector<std::vector<u64>> MapResources(PageTables& tables, std::mt19937& rng) {
+    std::vector<std::vector<u64>> resources(1024);
+    std::uniform_int_distribution<u64> size_dist{1, 64};
+    u64 big_page = (1ULL << 34) >> BIG_PAGE_BITS;
+    u64 device_page = 0x10000;
+    for (auto& pages : resources) {
+        const u64 count = size_dist(rng);
+        for (u64 i = 0; i < count; ++i) {
+            tables.Map(big_page + i, device_page, (device_page * 7919) & 0x3fffff);
+            pages.push_back(big_page + i);
+            device_page += 1ULL << (BIG_PAGE_BITS - DEVICE_PAGE_BITS);
+        }
+        // Leave holes between the allocations, they are freed and reused over time
+        big_page += count + rng() % 512;
+    }
+    return resources;
+}
+
+/// Pages touched by a sequence of draws, each binding a handful of resources of a hot set.
+std::vector<u64> DrawAccesses(const std::vector<std::vector<u64>>& resources, std::mt19937& rng) {
+    struct Binding {
+        size_t resource;
+        size_t page;
+    };
+    const auto bind = [&] {
+        const size_t resource = rng() % resources.size();
+        return Binding{resource, rng() % resources[resource].size()};
+    };
+    std::vector<Binding> hot_set(128);
+    for (auto& binding : hot_set) {
+        binding = bind();
+    }
+    std::vector<u64> accesses;
+    for (int draw = 0; draw < 20000; ++draw) {
+        // The working set drifts as the frame moves on to other passes
+        if (draw % 8 == 0) {
+            hot_set[rng() % hot_set.size()] = bind();
+        }
+        for (int slot = 0; slot < 12; ++slot) {
+            // Reads start at the bound offset and sometimes cross into the next page
+            const Binding& binding = hot_set[rng() % hot_set.size()];
+            const auto& pages = resources[binding.resource];
+            for (size_t access = 0; access < 4; ++access) {
+                accesses.push_back(pages[std::min(binding.page + access / 3, pages.size() - 1)]);
+            }
+        }
+    }
+    return accesses;
+}
+} // Anonymous namespace
+
+TEST_CASE("TranslationCache: Lookups", "[video_core]") {
+    static TranslationCache<Translation, 16> cache;
+    REQUIRE(cache.Find(0, 0, 1) == nullptr);
+
+    cache.Insert(0, 3, 1, Translation{0x1000});
+    REQUIRE(cache.Find(0, 3, 1) != nullptr);
+    REQUIRE(cache.Find(0, 3, 1)->address == 0x1000);
+
+    // Other owners, newer generations and pages sharing the slot miss
+    REQUIRE(cache.Find(1, 3, 1) == nullptr);
+    REQUIRE(cache.Find(0, 3, 2) == nullptr);
+    REQUIRE(cache.Find(0, 19, 1) == nullptr);
+
+    cache.Insert(0, 19, 1, Translation{0x2000});
+    REQUIRE(cache.Find(0, 3, 1) == nullptr);
+    REQUIRE(cache.Find(0, 19, 1)->address == 0x2000);
+}
+
+TEST_CASE("TranslationCache: Benchmark", "[.][video_core]") {
+    std::mt19937 rng{1234};
+    PageTables tables;
+    const auto resources = MapResources(tables, rng);
+    const auto accesses = DrawAccesses(resources, rng);
+
+    static TranslationCache<Translation, 1024> cache;
+    const auto run = [&](auto&& translate) {
+        u64 checksum = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (const u64 page : accesses) {
+            checksum += translate(page);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        const double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+        return std::make_pair(ns / static_cast<double>(accesses.size()), checksum);
+    };
+    const auto walk = [&](u64 page) { return tables.Walk(page); };
+    const auto cached = [&](u64 page) {
+        static constexpr u64 generation = 1;
+        if (const auto* const translation = cache.Find(0, page, generation)) {
+            return translation->address;
+        }
+        return cache.Insert(0, page, generation, Translation{tables.Walk(page)}).address;
+    };
+    // Warm up both, so neither pays for faulting in the tables
+    run(walk);
+    run(cached);
+    const auto [walk_ns, walk_checksum] = run(walk);
+    const auto [cached_ns, cached_checksum] = run(cached);
+    REQUIRE(walk_checksum == cached_checksum);
+    printf("TranslationCache: page table walk %.2f ns, cached %.2f ns per translation\n", walk_ns,
+           cached_ns);
+}
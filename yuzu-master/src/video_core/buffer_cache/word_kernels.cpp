@@ -0,0 +1,241 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifdef ARCHITECTURE_x86_64
+#include <immintrin.h>
+#elif defined(ARCHITECTURE_arm64)
+#include <arm_neon.h>
+#endif
+
+#include "common/common_funcs.h"
+#include "video_core/buffer_cache/word_kernels.h"
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace VideoCommon::WordKernels {
+namespace {
+template <bool HasExclude>
+u64 EffectiveBits(const u64* words, const u64* exclude, u64 flip, size_t index) {
+    const u64 bits = words[index] ^ flip;
+    if constexpr (HasExclude) {
+        return bits & ~exclude[index];
+    } else {
+        return bits;
+    }
+}
+
+/// Scalar scan, Full selects between looking for a word that isn't full or one that isn't empty.
+template <bool HasExclude, bool Full>
+size_t FindScalar(const u64* words, const u64* exclude, u64 flip, size_t begin, size_t count) {
+    for (size_t i = begin; i < count; ++i) {
+        const u64 bits = EffectiveBits<HasExclude>(words, exclude, flip, i);
+        if (Full ? bits != ~u64{0} : bits != 0) {
+            return i;
+        }
+    }
+    return count;
+}
+
+template <bool HasExclude>
+size_t FindLastScalar(const u64* words, const u64* exclude, u64 flip, size_t end, size_t count) {
+    for (size_t i = end; i-- > 0;) {
+        if (EffectiveBits<HasExclude>(words, exclude, flip, i) != 0) {
+            return i;
+        }
+    }
+    return count;
+}
+
+size_t FindSetScalar(const u64* words, const u64* exclude, u64 flip, size_t count) {
+    return exclude ? FindScalar<true, false>(words, exclude, flip, 0, count)
+                   : FindScalar<false, false>(words, exclude, flip, 0, count);
+}
+
+size_t FindNotFullScalar(const u64* words, const u64* exclude, u64 flip, size_t count) {
+    return exclude ? FindScalar<true, true>(words, exclude, flip, 0, count)
+                   : FindScalar<false, true>(words, exclude, flip, 0, count);
+}
+
+size_t FindLastSetScalar(const u64* words, const u64* exclude, u64 flip, size_t count) {
+    return exclude ? FindLastScalar<true>(words, exclude, flip, count, count)
+                   : FindLastScalar<false>(words, exclude, flip, count, count);
+}
+
+#ifdef ARCHITECTURE_x86_64
+/// Effective bits of 4 words.
+template <bool HasExclude>
+TARGET_ISA("avx2")
+__m256i EffectiveBitsAvx2(const u64* words, const u64* exclude, __m256i flip, size_t index) {
+    const __m256i bits{_mm256_xor_si256(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + index)), flip)};
+    if constexpr (HasExclude) {
+        return _mm256_andnot_si256(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(exclude + index)), bits);
+    } else {
+        return bits;
+    }
+}
+
+template <bool HasExclude, bool Full>
+TARGET_ISA("avx2")
+size_t FindAvx2(const u64* words, const u64* exclude, u64 flip, size_t count) {
+    const __m256i flip_vector{_mm256_set1_epi64x(static_cast<s64>(flip))};
+    const __m256i ones{_mm256_set1_epi64x(-1)};
+    size_t i{0};
+    for (; i + 4 <= count; i += 4) {
+        const __m256i bits{EffectiveBitsAvx2<HasExclude>(words, exclude, flip_vector, i)};
+        // testc checks for all ones, testz for all zeros
+        const bool skip{Full ? _mm256_testc_si256(bits, ones) != 0
+                             : _mm256_testz_si256(bits, bits) != 0};
+        if (!skip) {
+            break;
+        }
+    }
+    return FindScalar<HasExclude, Full>(words, exclude, flip, i, count);
+}
+
+template <bool HasExclude>
+TARGET_ISA("avx2")
+size_t FindLastAvx2(const u64* words, const u64* exclude, u64 flip, size_t count) {
+    const __m256i flip_vector{_mm256_set1_epi64x(static_cast<s64>(flip))};
+    size_t end{count};
+    for (; end >= 4; end -= 4) {
+        const __m256i bits{EffectiveBitsAvx2<HasExclude>(words, exclude, flip_vector, end - 4)};
+        if (!_mm256_testz_si256(bits, bits)) {
+            break;
+        }
+    }
+    return FindLastScalar<HasExclude>(words, exclude, flip, end, count);
+}
+
+TARGET_ISA("avx2")
+size_t FindSetAvx2(const u64* words, const u64* exclude, u64 flip, size_t count) {
+    return exclude ? FindAvx2<true, false>(words, exclude, flip, count)
+                   : FindAvx2<false, false>(words, exclude, flip, count);
+}
+
+TARGET_ISA("avx2")
+size_t FindNotFullAvx2(const u64* words, const u64* exclude, u64 flip, size_t count) {
+    return exclude ? FindAvx2<true, true>(words, exclude, flip, count)
+                   : FindAvx2<false, true>(words, exclude, flip, count);
+}
+
+TARGET_ISA("avx2")
+size_t FindLastSetAvx2(const u64* words, const u64* exclude, u64 flip, size_t count) {
+    return exclude ? FindLastAvx2<true>(words, exclude, flip, count)
+                   : FindLastAvx2<false>(words, exclude, flip, count);
+}
+#endif
+
+#ifdef ARCHITECTURE_arm64
+/// Effective bits of 4 words, folded into a single vector by Full.
+template <bool HasExclude, bool Full>
+uint64x2_t FoldedBitsNeon(const u64* words, const u64* exclude, uint64x2_t flip, size_t index) {
+    uint64x2_t low{veorq_u64(vld1q_u64(words + index), flip)};
+    uint64x2_t high{veorq_u64(vld1q_u64(words + index + 2), flip)};
+    if constexpr (HasExclude) {
+        low = vbicq_u64(low, vld1q_u64(exclude + index));
+        high = vbicq_u64(high, vld1q_u64(exclude + index + 2));
+    }
+    return Full ? vandq_u64(low, high) : vorrq_u64(low, high);
+}
+
+template <bool HasExclude, bool Full>
+size_t FindNeon(const u64* words, const u64* exclude, u64 flip, size_t count) {
+    const uint64x2_t flip_vector{vdupq_n_u64(flip)};
+    size_t i{0};
+    for (; i + 4 <= count; i += 4) {
+        const uint64x2_t folded{FoldedBitsNeon<HasExclude, Full>(words, exclude, flip_vector, i)};
+        const uint32x4_t bits{vreinterpretq_u32_u64(folded)};
+        const bool skip{Full ? vminvq_u32(bits) == ~u32{0} : vmaxvq_u32(bits) == 0};
+        if (!skip) {
+            break;
+        }
+    }
+    return FindScalar<HasExclude, Full>(words, exclude, flip, i, count);
+}
+
+template <bool HasExclude>
+size_t FindLastNeon(const u64* words, const u64* exclude, u64 flip, size_t count) {
+    const uint64x2_t flip_vector{vdupq_n_u64(flip)};
+    size_t end{count};
+    for (; end >= 4; end -= 4) {
+        const uint32x4_t bits{vreinterpretq_u32_u64(
+            FoldedBitsNeon<HasExclude, false>(words, exclude, flip_vector, end - 4))};
+        if (vmaxvq_u32(bits) != 0) {
+            break;
+        }
+    }
+    return FindLastScalar<HasExclude>(words, exclude, flip, end, count);
+}
+
+size_t FindSetNeon(const u64* words, const u64* exclude, u64 flip, size_t count) {
+    return exclude ? FindNeon<true, false>(words, exclude, flip, count)
+                   : FindNeon<false, false>(words, exclude, flip, count);
+}
+
+size_t FindNotFullNeon(const u64* words, const u64* exclude, u64 flip, size_t count) {
+    return exclude ? FindNeon<true, true>(words, exclude, flip, count)
+                   : FindNeon<false, true>(words, exclude, flip, count);
+}
+
+size_t FindLastSetNeon(const u64* words, const u64* exclude, u64 flip, size_t count) {
+    return exclude ? FindLastNeon<true>(words, exclude, flip, count)
+                   : FindLastNeon<false>(words, exclude, flip, count);
+}
+#endif
+
+constexpr Table ScalarTable{
+    .find_set = FindSetScalar,
+    .find_not_full = FindNotFullScalar,
+    .find_last_set = FindLastSetScalar,
+};
+
+#ifdef ARCHITECTURE_x86_64
+constexpr Table Avx2Table{
+    .find_set = FindSetAvx2,
+    .find_not_full = FindNotFullAvx2,
+    .find_last_set = FindLastSetAvx2,
+};
+#endif
+
+#ifdef ARCHITECTURE_arm64
+constexpr Table NeonTable{
+    .find_set = FindSetNeon,
+    .find_not_full = FindNotFullNeon,
+    .find_last_set = FindLastSetNeon,
+};
+#endif
+} // Anonymous namespace
+
+const Table* GetTable(Isa isa) {
+    switch (isa) {
+    case Isa::Scalar:
+        return &ScalarTable;
+#ifdef ARCHITECTURE_x86_64
+    case Isa::Avx2:
+        return Common::GetCPUCaps().avx2 ? &Avx2Table : nullptr;
+#endif
+#ifdef ARCHITECTURE_arm64
+    case Isa::Neon:
+        return &NeonTable;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+const Table& GetTable() {
+    static const Table& table{[]() -> const Table& {
+        for (const Isa isa : {Isa::Avx2, Isa::Neon}) {
+            if (const Table* const candidate = GetTable(isa)) {
+                return *candidate;
+            }
+        }
+        return ScalarTable;
+    }()};
+    return table;
+}
+
+} // namespace VideoCommon::WordKernels
@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "common/common_types.h"
+
+// Scans over whole words of the WordManager page bitmaps. Partially covered words at the edges of
+// a range are left to the caller, the kernels only see words where every page is queried.
+//
+// Scans look at the effective bits of each word, (words[i] ^ flip) & ~exclude[i]. A flip of all
+// ones scans for clear pages instead of set ones, and exclude may be nullptr when there's nothing
+// to mask out.
+namespace VideoCommon::WordKernels {
+
+/// Instruction sets the kernels are implemented with.
+enum class Isa {
+    Scalar,
+    Avx2,
+    Neon,
+};
+
+struct Table {
+    /// Returns the index of the first word with an effective bit set, or count when there is none.
+    size_t (*find_set)(const u64* words, const u64* exclude, u64 flip, size_t count);
+
+    /// Returns the index of the first word with an effective bit clear, or count when all are set.
+    size_t (*find_not_full)(const u64* words, const u64* exclude, u64 flip, size_t count);
+
+    /// Returns the index of the last word with an effective bit set, or count when there is none.
+    size_t (*find_last_set)(const u64* words, const u64* exclude, u64 flip, size_t count);
+};
+
+/// Returns the kernels of an instruction set, or nullptr when the host doesn't support it.
+[[nodiscard]] const Table* GetTable(Isa isa);
+
+/// Returns the fastest kernels supported by the host.
+[[nodiscard]] const Table& GetTable();
+
+} // namespace VideoCommon::WordKernels
@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <bit>
+#include <functional>
 #include <limits>
 #include <span>
 #include <utility>
@@ -13,6 +14,7 @@
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/div_ceil.h"
+#include "video_core/buffer_cache/word_kernels.h"
 #include "video_core/host1x/gpu_device_memory_manager.h"
 
 namespace VideoCommon {
@@ -179,69 +181,6 @@ public:
         return cpu_addr;
     }
 
-    static u64 ExtractBits(u64 word, size_t page_start, size_t page_end) {
-        constexpr size_t number_bits = sizeof(u64) * 8;
-        const size_t limit_page_end = number_bits - std::min(page_end, number_bits);
-        u64 bits = (word >> page_start) << page_start;
-        bits = (bits << limit_page_end) >> limit_page_end;
-        return bits;
-    }
-
-    static std::pair<size_t, size_t> GetWordPage(VAddr address) {
-        const size_t converted_address = static_cast<size_t>(address);
-        const size_t word_number = converted_address / BYTES_PER_WORD;
-        const size_t amount_pages = converted_address % BYTES_PER_WORD;
-        return std::make_pair(word_number, amount_pages / BYTES_PER_PAGE);
-    }
-
-    template <typename Func>
-    void IterateWords(size_t offset, size_t size, Func&& func) const {
-        using FuncReturn = std::invoke_result_t<Func, std::size_t, u64>;
-        static constexpr bool BOOL_BREAK = std::is_same_v<FuncReturn, bool>;
-        const size_t start = static_cast<size_t>(std::max<s64>(static_cast<s64>(offset), 0LL));
-        const size_t end = static_cast<size_t>(std::max<s64>(static_cast<s64>(offset + size), 0LL));
-        if (start >= SizeBytes() || end <= start) {
-            return;
-        }
-        auto [start_word, start_page] = GetWordPage(start);
-        auto [end_word, end_page] = GetWordPage(end + BYTES_PER_PAGE - 1ULL);
-        const size_t num_words = NumWords();
-        start_word = std::min(start_word, num_words);
-        end_word = std::min(end_word, num_words);
-        const size_t diff = end_word - start_word;
-        end_word += (end_page + PAGES_PER_WORD - 1ULL) / PAGES_PER_WORD;
-        end_word = std::min(end_word, num_words);
-        end_page += diff * PAGES_PER_WORD;
-        constexpr u64 base_mask{~0ULL};
-        for (size_t word_index = start_word; word_index < end_word; word_index++) {
-            const u64 mask = ExtractBits(base_mask, start_page, end_page);
-            start_page = 0;
-            end_page -= PAGES_PER_WORD;
-            if constexpr (BOOL_BREAK) {
-                if (func(word_index, mask)) {
-                    return;
-                }
-            } else {
-                func(word_index, mask);
-            }
-        }
-    }
-
-    template <typename Func>
-    void IteratePages(u64 mask, Func&& func) const {
-        size_t offset = 0;
-        while (mask != 0) {
-            const size_t empty_bits = std::countr_zero(mask);
-            offset += empty_bits;
-            mask = mask >> empty_bits;
-
-            const size_t continuous_bits = std::countr_one(mask);
-            func(offset, continuous_bits);
-            mask = continuous_bits < PAGES_PER_WORD ? (mask >> continuous_bits) : 0;
-            offset += continuous_bits;
-        }
-    }
-
     /**
      * Change the state of a range of pages
      *
@@ -250,12 +189,18 @@ public:
      */
     template <Type type, bool enable>
     void ChangeRegionState(u64 dirty_addr, u64 size) noexcept(type == Type::GPU) {
-        std::span<u64> state_words = words.template Span<type>();
-        [[maybe_unused]] std::span<u64> untracked_words = words.template Span<Type::Untracked>();
-        [[maybe_unused]] std::span<u64> cached_words = words.template Span<Type::CachedCPU>();
-        IterateWords(dirty_addr - cpu_addr, size, [&](size_t index, u64 mask) {
+        const WordRange range = GetWordRange(dirty_addr - cpu_addr, size);
+        if (range.Empty()) {
+            return;
+        }
+        u64* const state_words = Array<type>();
+        [[maybe_unused]] u64* const untracked_words = Array<Type::Untracked>();
+        [[maybe_unused]] u64* const cached_words = Array<Type::CachedCPU>();
+        [[maybe_unused]] auto notify = NotifyRasterizer<!enable>();
+        ForEachWord(range, [&](size_t index, u64 mask) {
             if constexpr (type == Type::CPU || type == Type::CachedCPU) {
-                NotifyRasterizer<!enable>(index, untracked_words[index], mask);
+                const u64 untracked = untracked_words[index];
+                notify.Add(index, (enable ? ~untracked : untracked) & mask);
             }
             if constexpr (enable) {
                 state_words[index] |= mask;
@@ -276,6 +221,7 @@ public:
                 }
             }
         });
+        notify.Flush();
     }
 
     /**
@@ -290,55 +236,42 @@ public:
     void ForEachModifiedRange(VAddr query_cpu_range, s64 size, Func&& func) {
         static_assert(type != Type::Untracked);
 
-        std::span<u64> state_words = words.template Span<type>();
-        [[maybe_unused]] std::span<u64> untracked_words = words.template Span<Type::Untracked>();
-        [[maybe_unused]] std::span<u64> cached_words = words.template Span<Type::CachedCPU>();
-        const size_t offset = query_cpu_range - cpu_addr;
-        bool pending = false;
-        size_t pending_offset{};
-        size_t pending_pointer{};
-        const auto release = [&]() {
-            func(cpu_addr + pending_offset * BYTES_PER_PAGE,
-                 (pending_pointer - pending_offset) * BYTES_PER_PAGE);
+        const WordRange range = GetWordRange(query_cpu_range - cpu_addr, size);
+        if (range.Empty()) {
+            return;
+        }
+        const auto release = [&](size_t page_begin, size_t page_end) {
+            func(cpu_addr + page_begin * BYTES_PER_PAGE, (page_end - page_begin) * BYTES_PER_PAGE);
         };
-        IterateWords(offset, size, [&](size_t index, u64 mask) {
-            if constexpr (type == Type::GPU) {
-                mask &= ~untracked_words[index];
-            }
-            const u64 word = state_words[index] & mask;
-            if constexpr (clear) {
-                if constexpr (type == Type::CPU || type == Type::CachedCPU) {
-                    NotifyRasterizer<true>(index, untracked_words[index], mask);
-                }
+        u64* const state_words = Array<type>();
+        [[maybe_unused]] u64* const untracked_words = Array<Type::Untracked>();
+        [[maybe_unused]] u64* const cached_words = Array<Type::CachedCPU>();
+        if constexpr (clear && (type == Type::CPU || type == Type::CachedCPU)) {
+            // The whole range starts being tracked, so every word has to be visited anyway
+            RunCollector modified{release};
+            auto notify = NotifyRasterizer<true>();
+            ForEachWord(range, [&](size_t index, u64 mask) {
+                const u64 word = state_words[index] & mask;
+                modified.Add(index, word);
+                notify.Add(index, untracked_words[index] & mask);
                 state_words[index] &= ~mask;
-                if constexpr (type == Type::CPU || type == Type::CachedCPU) {
-                    untracked_words[index] &= ~mask;
-                }
+                untracked_words[index] &= ~mask;
                 if constexpr (type == Type::CPU) {
                     cached_words[index] &= ~word;
                 }
-            }
-            const size_t base_offset = index * PAGES_PER_WORD;
-            IteratePages(word, [&](size_t pages_offset, size_t pages_size) {
-                const auto reset = [&]() {
-                    pending_offset = base_offset + pages_offset;
-                    pending_pointer = base_offset + pages_offset + pages_size;
-                };
-                if (!pending) {
-                    reset();
-                    pending = true;
-                    return;
-                }
-                if (pending_pointer == base_offset + pages_offset) {
-                    pending_pointer += pages_size;
-                    return;
-                }
-                release();
-                reset();
             });
-        });
-        if (pending) {
-            release();
+            notify.Flush();
+            modified.Flush();
+        } else {
+            ForEachRun(range, ModifiedView<type>(), release);
+            if constexpr (clear) {
+                ForEachWord(range, [&](size_t index, u64 mask) {
+                    if constexpr (type == Type::GPU) {
+                        mask &= ~untracked_words[index];
+                    }
+                    state_words[index] &= ~mask;
+                });
+            }
         }
     }
 
@@ -352,22 +285,8 @@ public:
     [[nodiscard]] bool IsRegionModified(u64 offset, u64 size) const noexcept {
         static_assert(type != Type::Untracked);
 
-        const std::span<const u64> state_words = words.template Span<type>();
-        [[maybe_unused]] const std::span<const u64> untracked_words =
-            words.template Span<Type::Untracked>();
-        bool result = false;
-        IterateWords(offset, size, [&](size_t index, u64 mask) {
-            if constexpr (type == Type::GPU) {
-                mask &= ~untracked_words[index];
-            }
-            const u64 word = state_words[index] & mask;
-            if (word != 0) {
-                result = true;
-                return true;
-            }
-            return false;
-        });
-        return result;
+        const WordRange range = GetWordRange(offset, size);
+        return !range.Empty() && FindFirstWord(range, ModifiedView<type>()) != range.end;
     }
 
     /**
@@ -379,27 +298,23 @@ public:
     template <Type type>
     [[nodiscard]] std::pair<u64, u64> ModifiedRegion(u64 offset, u64 size) const noexcept {
         static_assert(type != Type::Untracked);
-        const std::span<const u64> state_words = words.template Span<type>();
-        [[maybe_unused]] const std::span<const u64> untracked_words =
-            words.template Span<Type::Untracked>();
-        u64 begin = std::numeric_limits<u64>::max();
-        u64 end = 0;
-        IterateWords(offset, size, [&](size_t index, u64 mask) {
-            if constexpr (type == Type::GPU) {
-                mask &= ~untracked_words[index];
-            }
-            const u64 word = state_words[index] & mask;
-            if (word == 0) {
-                return;
-            }
-            const u64 local_page_begin = std::countr_zero(word);
-            const u64 local_page_end = PAGES_PER_WORD - std::countl_zero(word);
-            const u64 page_index = index * PAGES_PER_WORD;
-            begin = std::min(begin, page_index + local_page_begin);
-            end = page_index + local_page_end;
-        });
+
         static constexpr std::pair<u64, u64> EMPTY{0, 0};
-        return begin < end ? std::make_pair(begin * BYTES_PER_PAGE, end * BYTES_PER_PAGE) : EMPTY;
+        const WordRange range = GetWordRange(offset, size);
+        if (range.Empty()) {
+            return EMPTY;
+        }
+        const BitmapView modified = ModifiedView<type>();
+        const size_t first_word = FindFirstWord(range, modified);
+        if (first_word == range.end) {
+            return EMPTY;
+        }
+        const size_t last_word = FindLastWord(range, modified);
+        const u64 first_bits = modified[first_word] & range.Mask(first_word);
+        const u64 last_bits = modified[last_word] & range.Mask(last_word);
+        const u64 begin = first_word * PAGES_PER_WORD + std::countr_zero(first_bits);
+        const u64 end = (last_word + 1) * PAGES_PER_WORD - std::countl_zero(last_bits);
+        return std::make_pair(begin * BYTES_PER_PAGE, end * BYTES_PER_PAGE);
     }
 
     /// Returns the number of words of the manager
@@ -422,16 +337,243 @@ public:
         u64* const cached_words = Array<Type::CachedCPU>();
         u64* const untracked_words = Array<Type::Untracked>();
         u64* const cpu_words = Array<Type::CPU>();
+        auto notify = NotifyRasterizer<false>();
         for (u64 word_index = 0; word_index < num_words; ++word_index) {
             const u64 cached_bits = cached_words[word_index];
-            NotifyRasterizer<false>(word_index, untracked_words[word_index], cached_bits);
+            notify.Add(word_index, ~untracked_words[word_index] & cached_bits);
             untracked_words[word_index] |= cached_bits;
             cpu_words[word_index] |= cached_bits;
             cached_words[word_index] = 0;
         }
+        notify.Flush();
     }
 
 private:
+    /// Shorter scans aren't worth calling the kernels for
+    static constexpr size_t KERNEL_MIN_WORDS = 4;
+
+    /// Words covering a range of pages, with the pages covered in the first and the last words
+    struct WordRange {
+        [[nodiscard]] bool Empty() const noexcept {
+            return begin == end;
+        }
+
+        /// Returns the pages of a word covered by the range
+        [[nodiscard]] u64 Mask(size_t index) const noexcept {
+            const u64 mask = index == begin ? first_mask : ~u64{0};
+            return index == end - 1 ? mask & last_mask : mask;
+        }
+
+        size_t begin;   ///< First word of the range
+        size_t end;     ///< One past the last word of the range
+        u64 first_mask; ///< Pages covered in the first word
+        u64 last_mask;  ///< Pages covered in the last word
+    };
+
+    /// Bits of a state word array as seen by a query, (words[i] ^ flip) & ~exclude[i]
+    struct BitmapView {
+        [[nodiscard]] u64 operator[](size_t index) const noexcept {
+            const u64 bits = words[index] ^ flip;
+            return exclude ? bits & ~exclude[index] : bits;
+        }
+
+        /// Returns the excluded bits starting at a word, in the form the kernels take them
+        [[nodiscard]] const u64* Exclude(size_t index) const noexcept {
+            return exclude ? exclude + index : nullptr;
+        }
+
+        const u64* words;   ///< State words
+        const u64* exclude; ///< Pages to ignore, or nullptr
+        u64 flip;           ///< All ones to look at the cleared pages instead
+    };
+
+    [[nodiscard]] WordRange GetWordRange(size_t offset, size_t size) const noexcept {
+        const size_t start = static_cast<size_t>(std::max<s64>(static_cast<s64>(offset), 0LL));
+        const size_t end = static_cast<size_t>(std::max<s64>(static_cast<s64>(offset + size), 0LL));
+        if (start >= SizeBytes() || end <= start) {
+            return WordRange{0, 0, 0, 0};
+        }
+        const size_t page_begin = start / BYTES_PER_PAGE;
+        const size_t page_end =
+            std::min<size_t>(Common::DivCeil(end, BYTES_PER_PAGE), NumWords() * PAGES_PER_WORD);
+        const size_t last_pages = page_end % PAGES_PER_WORD;
+        return WordRange{
+            .begin = page_begin / PAGES_PER_WORD,
+            .end = Common::DivCeil(page_end, PAGES_PER_WORD),
+            .first_mask = ~u64{0} << (page_begin % PAGES_PER_WORD),
+            .last_mask = last_pages == 0 ? ~u64{0} : ~u64{0} >> (PAGES_PER_WORD - last_pages),
+        };
+    }
+
+    /// Returns the view of the pages reported as modified for a state
+    template <Type type>
+    [[nodiscard]] BitmapView ModifiedView() const noexcept {
+        // Untracked pages hold the most recent data in guest memory, never download them
+        const u64* const exclude = type == Type::GPU ? Array<Type::Untracked>() : nullptr;
+        return BitmapView{Array<type>(), exclude, 0};
+    }
+
+    /// Call func(index, mask) on each word of a range with the pages of the word it covers
+    template <typename Func>
+    static void ForEachWord(const WordRange& range, Func&& func) {
+        for (size_t index = range.begin; index < range.end; ++index) {
+            func(index, range.Mask(index));
+        }
+    }
+
+    /// Returns the first word of a range with pages set in the view, or the end of the range
+    [[nodiscard]] static size_t FindFirstWord(const WordRange& range, const BitmapView& view) {
+        if ((view[range.begin] & range.Mask(range.begin)) != 0) {
+            return range.begin;
+        }
+        const size_t last = range.end - 1;
+        if (last == range.begin) {
+            return range.end;
+        }
+        const size_t found = FindSet(view, range.begin + 1, last);
+        if (found != last) {
+            return found;
+        }
+        return (view[last] & range.last_mask) != 0 ? last : range.end;
+    }
+
+    /// Returns the last word of a range with pages set in the view, the range must have one
+    [[nodiscard]] static size_t FindLastWord(const WordRange& range, const BitmapView& view) {
+        const size_t last = range.end - 1;
+        if ((view[last] & range.Mask(last)) != 0 || last == range.begin) {
+            return last;
+        }
+        const size_t found = FindLastSet(view, range.begin + 1, last);
+        return found != last ? found : range.begin;
+    }
+
+    /// Returns the first word in [begin, end) with pages set in the view, or end
+    [[nodiscard]] static size_t FindSet(const BitmapView& view, size_t begin, size_t end) {
+        if (end - begin < KERNEL_MIN_WORDS) {
+            while (begin < end && view[begin] == 0) {
+                ++begin;
+            }
+            return begin;
+        }
+        return begin + WordKernels::GetTable().find_set(view.words + begin, view.Exclude(begin),
+                                                        view.flip, end - begin);
+    }
+
+    /// Returns the first word in [begin, end) with pages clear in the view, or end
+    [[nodiscard]] static size_t FindNotFull(const BitmapView& view, size_t begin, size_t end) {
+        if (end - begin < KERNEL_MIN_WORDS) {
+            while (begin < end && view[begin] == ~u64{0}) {
+                ++begin;
+            }
+            return begin;
+        }
+        return begin + WordKernels::GetTable().find_not_full(
+                           view.words + begin, view.Exclude(begin), view.flip, end - begin);
+    }
+
+    /// Returns the last word in [begin, end) with pages set in the view, or end
+    [[nodiscard]] static size_t FindLastSet(const BitmapView& view, size_t begin, size_t end) {
+        if (end - begin < KERNEL_MIN_WORDS) {
+            for (size_t index = end; index-- > begin;) {
+                if (view[index] != 0) {
+                    return index;
+                }
+            }
+            return end;
+        }
+        const size_t count = end - begin;
+        const size_t found = WordKernels::GetTable().find_last_set(
+            view.words + begin, view.Exclude(begin), view.flip, count);
+        return found != count ? begin + found : end;
+    }
+
+    /// Merges the pages added word by word into runs, calling func(page_begin, page_end) once per
+    /// run of contiguous pages, even when it crosses words.
+    template <typename Func>
+    class RunCollector {
+    public:
+        explicit RunCollector(Func func_) : func{std::move(func_)} {}
+
+        /// Add the pages set in the bits of a word, words must be added in increasing order
+        void Add(size_t index, u64 bits) {
+            const size_t base_page = index * PAGES_PER_WORD;
+            if (bits == ~u64{0}) {
+                Extend(base_page, base_page + PAGES_PER_WORD);
+                return;
+            }
+            IteratePages(bits, [&](size_t pages_offset, size_t pages_size) {
+                Extend(base_page + pages_offset, base_page + pages_offset + pages_size);
+            });
+        }
+
+        /// Add a run of pages, runs must be added in increasing order
+        void Extend(size_t page_begin, size_t page_end) {
+            if (run_begin != run_end && run_end == page_begin) {
+                run_end = page_end;
+                return;
+            }
+            Flush();
+            run_begin = page_begin;
+            run_end = page_end;
+        }
+
+        /// Report the pending run, must be called after adding the last pages
+        void Flush() {
+            if (run_begin != run_end) {
+                func(run_begin, run_end);
+                run_begin = run_end;
+            }
+        }
+
+    private:
+        Func func;
+        size_t run_begin = 0;
+        size_t run_end = 0;
+    };
+
+    /**
+     * Call func(page_begin, page_end) on each run of contiguous pages set in the view within a
+     * range. The middle of the range is scanned in bulk for the words that are empty or that
+     * continue a run.
+     */
+    template <typename Func>
+    static void ForEachRun(const WordRange& range, const BitmapView& view, Func&& func) {
+        const size_t last = range.end - 1;
+        RunCollector runs{std::ref(func)};
+        for (size_t index = range.begin; index < range.end; ++index) {
+            const u64 word = view[index] & range.Mask(index);
+            if (word == 0) {
+                if (index + 1 < last) {
+                    index = FindSet(view, index + 1, last) - 1;
+                }
+                continue;
+            }
+            runs.Add(index, word);
+            if ((word >> (PAGES_PER_WORD - 1)) != 0 && index + 1 < last) {
+                // The run reaches the end of the word, extend it over the full words after it
+                const size_t next = FindNotFull(view, index + 1, last);
+                runs.Extend((index + 1) * PAGES_PER_WORD, next * PAGES_PER_WORD);
+                index = next - 1;
+            }
+        }
+        runs.Flush();
+    }
+
+    template <typename Func>
+    static void IteratePages(u64 mask, Func&& func) {
+        size_t offset = 0;
+        while (mask != 0) {
+            const size_t empty_bits = std::countr_zero(mask);
+            offset += empty_bits;
+            mask = mask >> empty_bits;
+
+            const size_t continuous_bits = std::countr_one(mask);
+            func(offset, continuous_bits);
+            mask = continuous_bits < PAGES_PER_WORD ? (mask >> continuous_bits) : 0;
+            offset += continuous_bits;
+        }
+    }
+
     template <Type type>
     u64* Array() noexcept {
         if constexpr (type == Type::CPU) {
@@ -442,6 +584,8 @@ private:
             return words.cached_cpu.Pointer(IsShort());
         } else if constexpr (type == Type::Untracked) {
             return words.untracked.Pointer(IsShort());
+        } else if constexpr (type == Type::Preflushable) {
+            return words.preflushable.Pointer(IsShort());
         }
     }
 
@@ -455,26 +599,24 @@ private:
             return words.cached_cpu.Pointer(IsShort());
         } else if constexpr (type == Type::Untracked) {
             return words.untracked.Pointer(IsShort());
+        } else if constexpr (type == Type::Preflushable) {
+            return words.preflushable.Pointer(IsShort());
         }
     }
 
     /**
-     * Notify tracker about changes in the CPU tracking state of a word in the buffer
+     * Returns a collector notifying the tracker about changes in the CPU tracking state of the
+     * pages added to it. Changes of adjacent pages are notified together.
      *
-     * @param word_index   Index to the word to notify to the tracker
-     * @param current_bits Current state of the word
-     * @param new_bits     New state of the word
-     *
-     * @tparam add_to_tracker True when the tracker should start tracking the new pages
+     * @tparam add_to_tracker True when the tracker should start tracking the added pages
      */
     template <bool add_to_tracker>
-    void NotifyRasterizer(u64 word_index, u64 current_bits, u64 new_bits) const {
-        u64 changed_bits = (add_to_tracker ? current_bits : ~current_bits) & new_bits;
-        VAddr addr = cpu_addr + word_index * BYTES_PER_WORD;
-        IteratePages(changed_bits, [&](size_t offset, size_t size) {
-            tracker->UpdatePagesCachedCount(addr + offset * BYTES_PER_PAGE, size * BYTES_PER_PAGE,
+    auto NotifyRasterizer() const {
+        return RunCollector{[this](size_t page_begin, size_t page_end) {
+            tracker->UpdatePagesCachedCount(cpu_addr + page_begin * BYTES_PER_PAGE,
+                                            (page_end - page_begin) * BYTES_PER_PAGE,
                                             add_to_tracker ? 1 : -1);
-        });
+        }};
     }
 
     VAddr cpu_addr = 0;
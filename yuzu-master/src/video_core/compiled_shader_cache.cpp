@@ -0,0 +1,328 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "video_core/compiled_shader_cache.h"
+
+namespace VideoCommon {
+namespace {
+constexpr std::array<char, 8> MAGIC_NUMBER{'y', 'u', 'z', 'u', 's', 'h', 'b', 'n'};
+
+// Version of the layout of the file itself, the backends version their emitted code separately
+// 1: Keys of a variable size only store the bytes up to their Size()
+constexpr u32 FORMAT_VERSION = 1;
+
+constexpr u32 MAX_STAGES = 6;
+
+struct Header {
+    std::array<char, 8> magic_number;
+    u32 cache_version;
+    u32 format_version;
+    u64 host_fingerprint;
+};
+static_assert(std::has_unique_object_representations_v<Header>);
+
+struct EntryHeader {
+    u32 key_size;
+    u32 data_size;
+};
+
+class Writer {
+public:
+    template <typename... Values>
+    void operator()(const Values&... values) {
+        (Write(values), ...);
+    }
+
+    std::string& Data() {
+        return data;
+    }
+
+private:
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename T, size_t N>
+    void Write(const boost::container::static_vector<T, N>& values) {
+        WriteRange(values);
+    }
+
+    template <typename T, size_t N>
+    void Write(const boost::container::small_vector<T, N>& values) {
+        WriteRange(values);
+    }
+
+    template <typename K, typename V>
+    void Write(const std::map<K, V>& map) {
+        Write(static_cast<u32>(map.size()));
+        for (const auto& [key, value] : map) {
+            Write(key);
+            Write(value);
+        }
+    }
+
+    template <typename T>
+    void Write(const std::vector<T>& values) {
+        WriteRange(values);
+    }
+
+    template <typename Range>
+    void WriteRange(const Range& values) {
+        static_assert(std::is_trivially_copyable_v<typename Range::value_type>);
+        Write(static_cast<u32>(values.size()));
+        data.append(reinterpret_cast<const char*>(values.data()),
+                    values.size() * sizeof(typename Range::value_type));
+    }
+
+    std::string data;
+};
+
+class Reader {
+public:
+    explicit Reader(std::span<const u8> data_) : data{data_} {}
+
+    template <typename... Values>
+    void operator()(Values&... values) {
+        (Read(values), ...);
+    }
+
+    /// Returns true when every read was in bounds and all data was consumed.
+    [[nodiscard]] bool IsValid() const {
+        return !overflow && offset == data.size();
+    }
+
+private:
+    bool Consume(void* dest, size_t size) {
+        if (overflow || size > data.size() - offset) {
+            overflow = true;
+            return false;
+        }
+        std::memcpy(dest, data.data() + offset, size);
+        offset += size;
+        return true;
+    }
+
+    template <typename T>
+    void Read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        Consume(&value, sizeof(value));
+    }
+
+    template <typename T, size_t N>
+    void Read(boost::container::static_vector<T, N>& values) {
+        u32 size{};
+        Read(size);
+        if (size > N) {
+            overflow = true;
+            return;
+        }
+        ReadRange(values, size);
+    }
+
+    template <typename T, size_t N>
+    void Read(boost::container::small_vector<T, N>& values) {
+        u32 size{};
+        Read(size);
+        ReadRange(values, size);
+    }
+
+    template <typename K, typename V>
+    void Read(std::map<K, V>& map) {
+        u32 size{};
+        Read(size);
+        for (u32 i = 0; i < size && !overflow; ++i) {
+            K key{};
+            V value{};
+            Read(key);
+            Read(value);
+            map.emplace(key, value);
+        }
+    }
+
+    template <typename T>
+    void Read(std::vector<T>& values) {
+        u32 size{};
+        Read(size);
+        ReadRange(values, size);
+    }
+
+    template <typename Range>
+    void ReadRange(Range& values, u32 size) {
+        static_assert(std::is_trivially_copyable_v<typename Range::value_type>);
+        const size_t size_bytes = size * sizeof(typename Range::value_type);
+        if (overflow || size_bytes > data.size() - offset) {
+            overflow = true;
+            return;
+        }
+        values.resize(size);
+        Consume(values.data(), size_bytes);
+    }
+
+    std::span<const u8> data;
+    size_t offset{};
+    bool overflow{};
+};
+
+/// Visits every member of Shader::Info, update the cache versions when its members change.
+template <typename Archive, typename InfoType>
+void VisitInfo(Archive& archive, InfoType& info) {
+    archive(info.uses_workgroup_id, info.uses_local_invocation_id, info.uses_invocation_id,
+            info.uses_invocation_info, info.uses_sample_id, info.uses_is_helper_invocation,
+            info.uses_subgroup_invocation_id, info.uses_subgroup_shuffles, info.uses_patches,
+            info.interpolation, info.loads, info.stores, info.passthrough,
+            info.legacy_stores_mapping, info.loads_indexed_attributes, info.stores_frag_color,
+            info.stores_sample_mask, info.stores_frag_depth, info.stores_tess_level_outer,
+            info.stores_tess_level_inner, info.stores_indexed_attributes, info.stores_global_memory,
+            info.uses_local_memory, info.uses_fp16, info.uses_fp64, info.uses_fp16_denorms_flush,
+            info.uses_fp16_denorms_preserve, info.uses_fp32_denorms_flush,
+            info.uses_fp32_denorms_preserve, info.uses_int8, info.uses_int16, info.uses_int64,
+            info.uses_image_1d, info.uses_sampled_1d, info.uses_sparse_residency,
+            info.uses_demote_to_helper_invocation, info.uses_subgroup_vote, info.uses_subgroup_mask,
+            info.uses_fswzadd, info.uses_derivatives, info.uses_typeless_image_reads,
+            info.uses_typeless_image_writes, info.uses_image_buffers, info.uses_shared_increment,
+            info.uses_shared_decrement, info.uses_global_increment, info.uses_global_decrement,
+            info.uses_atomic_f32_add, info.uses_atomic_f16x2_add, info.uses_atomic_f16x2_min,
+            info.uses_atomic_f16x2_max, info.uses_atomic_f32x2_add, info.uses_atomic_f32x2_min,
+            info.uses_atomic_f32x2_max, info.uses_atomic_s32_min, info.uses_atomic_s32_max,
+            info.uses_int64_bit_atomics, info.uses_global_memory, info.uses_atomic_image_u32,
+            info.uses_shadow_lod, info.uses_rescaling_uniform, info.uses_cbuf_indirect,
+            info.uses_render_area, info.used_constant_buffer_types, info.used_storage_buffer_types,
+            info.used_indirect_cbuf_types, info.constant_buffer_mask,
+            info.constant_buffer_used_sizes, info.nvn_buffer_base, info.nvn_buffer_used,
+            info.requires_layer_emulation, info.emulated_layer, info.used_clip_distances,
+            info.constant_buffer_descriptors, info.storage_buffers_descriptors,
+            info.texture_buffer_descriptors, info.image_buffer_descriptors,
+            info.texture_descriptors, info.image_descriptors);
+}
+} // Anonymous namespace
+
+void CompiledShaderCache::Load(const std::filesystem::path& filename_, u32 cache_version_,
+                               u64 host_fingerprint_) {
+    filename = filename_;
+    cache_version = cache_version_;
+    host_fingerprint = host_fingerprint_;
+    entries.clear();
+
+    mapped_file.Open(filename);
+    if (!mapped_file.IsOpen()) {
+        return;
+    }
+    const std::span<const u8> data = mapped_file.GetSpan();
+    Header header{};
+    if (data.size() < sizeof(header)) {
+        ResetFile();
+        return;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic_number != MAGIC_NUMBER || header.cache_version != cache_version ||
+        header.format_version != FORMAT_VERSION || header.host_fingerprint != host_fingerprint) {
+        LOG_INFO(Common_Filesystem, "Deleting outdated compiled shader cache");
+        ResetFile();
+        return;
+    }
+    size_t offset = sizeof(header);
+    while (data.size() - offset >= sizeof(EntryHeader)) {
+        EntryHeader entry;
+        std::memcpy(&entry, data.data() + offset, sizeof(entry));
+        offset += sizeof(entry);
+        if (size_t{entry.key_size} + entry.data_size > data.size() - offset) {
+            // Truncated entry, likely from a crash while saving. Entries before it are fine.
+            break;
+        }
+        std::string key(reinterpret_cast<const char*>(data.data() + offset), entry.key_size);
+        offset += entry.key_size;
+        entries.insert_or_assign(std::move(key), EntryLocation{offset, entry.data_size});
+        offset += entry.data_size;
+    }
+    LOG_INFO(Common_Filesystem, "Loaded {} compiled pipelines", entries.size());
+}
+
+std::optional<std::vector<CompiledShaderStage>> CompiledShaderCache::Find(
+    std::span<const char> key) const {
+    // Entries and the mapping are only modified while loading, saving only appends to the file
+    const auto it = entries.find(std::string(key.data(), key.size()));
+    if (it == entries.end()) {
+        return std::nullopt;
+    }
+    Reader reader{mapped_file.GetSpan().subspan(it->second.offset, it->second.size)};
+    u32 num_stages{};
+    reader(num_stages);
+    std::vector<CompiledShaderStage> stages(std::min(num_stages, MAX_STAGES));
+    for (CompiledShaderStage& stage : stages) {
+        reader(stage.index);
+        VisitInfo(reader, stage.info);
+        reader(stage.code);
+    }
+    if (stages.size() != num_stages || !reader.IsValid()) {
+        LOG_ERROR(Common_Filesystem, "Corrupted compiled shader cache entry");
+        return std::nullopt;
+    }
+    return stages;
+}
+
+void CompiledShaderCache::Save(std::span<const char> key,
+                               std::span<const CompiledShaderStage> stages) try {
+    Writer writer;
+    writer(static_cast<u32>(stages.size()));
+    for (const CompiledShaderStage& stage : stages) {
+        writer(stage.index);
+        VisitInfo(writer, stage.info);
+        writer(stage.code);
+    }
+    const EntryHeader entry{
+        .key_size = static_cast<u32>(key.size()),
+        .data_size = static_cast<u32>(writer.Data().size()),
+    };
+
+    std::scoped_lock lock{save_mutex};
+    if (filename.empty()) {
+        return;
+    }
+    std::ofstream file(filename, std::ios::binary | std::ios::ate | std::ios::app);
+    file.exceptions(std::ifstream::failbit);
+    if (!file.is_open()) {
+        LOG_ERROR(Common_Filesystem, "Failed to open compiled shader cache file {}",
+                  Common::FS::PathToUTF8String(filename));
+        return;
+    }
+    if (file.tellp() == 0) {
+        const Header header{
+            .magic_number = MAGIC_NUMBER,
+            .cache_version = cache_version,
+            .format_version = FORMAT_VERSION,
+            .host_fingerprint = host_fingerprint,
+        };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    file.write(reinterpret_cast<const char*>(&entry), sizeof(entry))
+        .write(key.data(), key.size())
+        .write(writer.Data().data(), writer.Data().size());
+
+} catch (const std::ios_base::failure& e) {
+    LOG_ERROR(Common_Filesystem, "{}", e.what());
+    if (!Common::FS::RemoveFile(filename)) {
+        LOG_ERROR(Common_Filesystem, "Failed to delete compiled shader cache file {}",
+                  Common::FS::PathToUTF8String(filename));
+    }
+}
+
+void CompiledShaderCache::ResetFile() {
+    mapped_file.Close();
+    entries.clear();
+    if (!Common::FS::RemoveFile(filename)) {
+        LOG_ERROR(Common_Filesystem, "Failed to delete compiled shader cache file {}",
+                  Common::FS::PathToUTF8String(filename));
+    }
+}
+
+} // namespace VideoCommon
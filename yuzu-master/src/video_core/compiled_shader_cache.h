@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/fs/mapped_file.h"
+#include "shader_recompiler/shader_info.h"
+
+namespace VideoCommon {
+
+/// Backend code of a pipeline stage, with the shader info needed to bind its resources.
+struct CompiledShaderStage {
+    u32 index;
+    Shader::Info info;
+    std::vector<u32> code;
+};
+
+/**
+ * On-disk cache of the backend code emitted for pipelines, indexed by the pipeline key.
+ * Hits skip translation, optimization passes and code emission entirely.
+ *
+ * The whole file is invalidated when the cache version or the host fingerprint changes. The
+ * fingerprint has to cover everything besides the key that affects the emitted code, such as the
+ * driver, the emulator revision and the settings read by the recompiler.
+ */
+class CompiledShaderCache {
+public:
+    /**
+     * Maps the cache file and indexes its entries, deleting it when it is outdated or corrupted.
+     *
+     * @param filename Path of the cache file, created on the first save when it doesn't exist
+     * @param cache_version Version of the backend's cache format
+     * @param host_fingerprint Hash of the host state the emitted code depends on
+     */
+    void Load(const std::filesystem::path& filename, u32 cache_version, u64 host_fingerprint);
+
+    /**
+     * Finds the stages of a pipeline. Thread safe, including with concurrent saves.
+     * Saved pipelines are only found after the cache is loaded again.
+     *
+     * @returns The cached stages, or std::nullopt when the pipeline isn't cached.
+     */
+    [[nodiscard]] std::optional<std::vector<CompiledShaderStage>> Find(
+        std::span<const char> key) const;
+
+    /// Appends the stages of a pipeline to the cache file.
+    void Save(std::span<const char> key, std::span<const CompiledShaderStage> stages);
+
+    template <typename Key>
+    [[nodiscard]] std::optional<std::vector<CompiledShaderStage>> Find(const Key& key) const {
+        return Find(KeyBytes(key));
+    }
+
+    template <typename Key>
+    void Save(const Key& key, std::span<const CompiledShaderStage> stages) {
+        Save(KeyBytes(key), stages);
+    }
+
+private:
+    struct EntryLocation {
+        size_t offset;
+        size_t size;
+    };
+
+    /// Returns the bytes of a key that take part in its comparisons. Keys with a variable size
+    /// leave the tail past Size() unused, and it must not affect lookups.
+    template <typename Key>
+    static std::span<const char> KeyBytes(const Key& key) {
+        static_assert(std::is_trivially_copyable_v<Key>);
+        static_assert(std::has_unique_object_representations_v<Key>);
+        if constexpr (requires { key.Size(); }) {
+            return std::span(reinterpret_cast<const char*>(&key), key.Size());
+        } else {
+            return std::span(reinterpret_cast<const char*>(&key), sizeof(key));
+        }
+    }
+
+    void ResetFile();
+
+    std::mutex save_mutex;
+    std::filesystem::path filename;
+    u32 cache_version{};
+    u64 host_fingerprint{};
+    Common::FS::MappedFile mapped_file;
+    std::unordered_map<std::string, EntryLocation> entries;
+};
+
+} // namespace VideoCommon
@@ -15,10 +15,16 @@
 #include "video_core/memory_manager.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
+#include "video_core/translation_cache.h"
 
 namespace Tegra {
 using Tegra::Memory::GuestMemoryFlags;
 
+namespace {
+// 64MiB worth of big pages, 32KiB per thread
+constexpr size_t TRANSLATION_CACHE_ENTRIES = 1024;
+} // Anonymous namespace
+
 std::atomic<size_t> MemoryManager::unique_identifier_generator{};
 
 MemoryManager::MemoryManager(Core::System& system_, MaxwellDeviceMemoryManager& memory_,
@@ -89,7 +95,7 @@ void MemoryManager::SetEntry(size_t position, MemoryManager::EntryType entry) {
 }
 
 PTEKind MemoryManager::GetPageKind(GPUVAddr gpu_addr) const {
-    std::unique_lock<std::mutex> lock(guard);
+    std::shared_lock lock(guard);
     return kind_map.GetValueAt(gpu_addr);
 }
 
@@ -128,7 +134,11 @@ GPUVAddr MemoryManager::PageTableOp(GPUVAddr gpu_addr, [[maybe_unused]] DAddr de
         }
         remaining_size -= page_size;
     }
-    kind_map.Map(gpu_addr, gpu_addr + size, kind);
+    InvalidateTranslations();
+    {
+        std::unique_lock lock(guard);
+        kind_map.Map(gpu_addr, gpu_addr + size, kind);
+    }
     return gpu_addr;
 }
 
@@ -168,13 +178,36 @@ GPUVAddr MemoryManager::BigPageTableOp(GPUVAddr gpu_addr, [[maybe_unused]] DAddr
         }
         remaining_size -= big_page_size;
     }
+    InvalidateTranslations();
     {
-        std::unique_lock<std::mutex> lock(guard);
+        std::unique_lock lock(guard);
         kind_map.Map(gpu_addr, gpu_addr + size, kind);
     }
     return gpu_addr;
 }
 
+const MemoryManager::BigPageTranslation* MemoryManager::TranslateBigPage(
+    size_t big_page_index) const {
+    static thread_local TranslationCache<BigPageTranslation, TRANSLATION_CACHE_ENTRIES> cache;
+
+    // Host pointers come from the device memory manager, its mappings invalidate them too. Both
+    // counters only grow, so their sum only stays the same while neither changes.
+    const u64 current_generation =
+        generation.load(std::memory_order_acquire) + memory.MappingGeneration();
+    if (const auto* const translation =
+            cache.Find(unique_identifier, big_page_index, current_generation)) [[likely]] {
+        return translation;
+    }
+    if (GetEntry<true>(big_page_index << big_page_bits) != EntryType::Mapped) {
+        return nullptr;
+    }
+    const DAddr dev_addr = static_cast<DAddr>(big_page_table_dev[big_page_index]) << cpu_page_bits;
+    u8* const host_pointer =
+        IsBigPageContinuous(big_page_index) ? memory.GetPointer<u8>(dev_addr) : nullptr;
+    return &cache.Insert(unique_identifier, big_page_index, current_generation,
+                         BigPageTranslation{dev_addr, host_pointer});
+}
+
 void MemoryManager::BindRasterizer(VideoCore::RasterizerInterface* rasterizer_) {
     rasterizer = rasterizer_;
 }
@@ -213,19 +246,16 @@ std::optional<DAddr> MemoryManager::GpuToCpuAddress(GPUVAddr gpu_addr) const {
     if (!IsWithinGPUAddressRange(gpu_addr)) [[unlikely]] {
         return std::nullopt;
     }
-    if (GetEntry<true>(gpu_addr) != EntryType::Mapped) [[unlikely]] {
-        if (GetEntry<false>(gpu_addr) != EntryType::Mapped) {
-            return std::nullopt;
-        }
-
-        const DAddr dev_addr_base = static_cast<DAddr>(page_table[PageEntryIndex<false>(gpu_addr)])
-                                    << cpu_page_bits;
-        return dev_addr_base + (gpu_addr & page_mask);
+    if (const auto* const translation = TranslateBigPage(gpu_addr >> big_page_bits)) [[likely]] {
+        return translation->dev_addr + (gpu_addr & big_page_mask);
+    }
+    if (GetEntry<false>(gpu_addr) != EntryType::Mapped) {
+        return std::nullopt;
     }
 
-    const DAddr dev_addr_base =
-        static_cast<DAddr>(big_page_table_dev[PageEntryIndex<true>(gpu_addr)]) << cpu_page_bits;
-    return dev_addr_base + (gpu_addr & big_page_mask);
+    const DAddr dev_addr_base = static_cast<DAddr>(page_table[PageEntryIndex<false>(gpu_addr)])
+                                << cpu_page_bits;
+    return dev_addr_base + (gpu_addr & page_mask);
 }
 
 std::optional<DAddr> MemoryManager::GpuToCpuAddress(GPUVAddr addr, std::size_t size) const {
@@ -276,6 +306,12 @@ template void MemoryManager::Write<u32>(GPUVAddr addr, u32 data);
 template void MemoryManager::Write<u64>(GPUVAddr addr, u64 data);
 
 u8* MemoryManager::GetPointer(GPUVAddr gpu_addr) {
+    if (IsWithinGPUAddressRange(gpu_addr)) [[likely]] {
+        const auto* const translation = TranslateBigPage(gpu_addr >> big_page_bits);
+        if (translation && translation->host_pointer) [[likely]] {
+            return translation->host_pointer + (gpu_addr & big_page_mask);
+        }
+    }
     const auto address{GpuToCpuAddress(gpu_addr)};
     if (!address) {
         return {};
@@ -285,6 +321,12 @@ u8* MemoryManager::GetPointer(GPUVAddr gpu_addr) {
 }
 
 const u8* MemoryManager::GetPointer(GPUVAddr gpu_addr) const {
+    if (IsWithinGPUAddressRange(gpu_addr)) [[likely]] {
+        const auto* const translation = TranslateBigPage(gpu_addr >> big_page_bits);
+        if (translation && translation->host_pointer) [[likely]] {
+            return translation->host_pointer + (gpu_addr & big_page_mask);
+        }
+    }
     const auto address{GpuToCpuAddress(gpu_addr)};
     if (!address) {
         return {};
@@ -384,16 +426,20 @@ void MemoryManager::ReadBlockImpl(GPUVAddr gpu_src_addr, void* dest_buffer, std:
         dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
     };
     auto mapped_big = [&](std::size_t page_index, std::size_t offset, std::size_t copy_amount) {
-        const DAddr dev_addr_base =
-            (static_cast<DAddr>(big_page_table_dev[page_index]) << cpu_page_bits) + offset;
+        const auto* const translation = TranslateBigPage(page_index);
+        if (!translation) [[unlikely]] {
+            // Unmapped by another thread since the entry was checked
+            set_to_zero(page_index, offset, copy_amount);
+            return;
+        }
+        const DAddr dev_addr_base = translation->dev_addr + offset;
         if constexpr (is_safe) {
             rasterizer->FlushRegion(dev_addr_base, copy_amount, which);
         }
-        if (!IsBigPageContinuous(page_index)) [[unlikely]] {
+        if (!translation->host_pointer) [[unlikely]] {
             memory.ReadBlockUnsafe(dev_addr_base, dest_buffer, copy_amount);
         } else {
-            u8* physical = memory.GetPointer<u8>(dev_addr_base);
-            std::memcpy(dest_buffer, physical, copy_amount);
+            std::memcpy(dest_buffer, translation->host_pointer + offset, copy_amount);
         }
         dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
     };
@@ -433,16 +479,20 @@ void MemoryManager::WriteBlockImpl(GPUVAddr gpu_dest_addr, const void* src_buffe
         src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
     };
     auto mapped_big = [&](std::size_t page_index, std::size_t offset, std::size_t copy_amount) {
-        const DAddr dev_addr_base =
-            (static_cast<DAddr>(big_page_table_dev[page_index]) << cpu_page_bits) + offset;
+        const auto* const translation = TranslateBigPage(page_index);
+        if (!translation) [[unlikely]] {
+            // Unmapped by another thread since the entry was checked
+            just_advance(page_index, offset, copy_amount);
+            return;
+        }
+        const DAddr dev_addr_base = translation->dev_addr + offset;
         if constexpr (is_safe) {
             rasterizer->InvalidateRegion(dev_addr_base, copy_amount, which);
         }
-        if (!IsBigPageContinuous(page_index)) [[unlikely]] {
+        if (!translation->host_pointer) [[unlikely]] {
             memory.WriteBlockUnsafe(dev_addr_base, src_buffer, copy_amount);
         } else {
-            u8* physical = memory.GetPointer<u8>(dev_addr_base);
-            std::memcpy(physical, src_buffer, copy_amount);
+            std::memcpy(translation->host_pointer + offset, src_buffer, copy_amount);
         }
         src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
     };
@@ -564,7 +614,7 @@ size_t MemoryManager::MaxContinuousRange(GPUVAddr gpu_addr, size_t size) const {
 }
 
 size_t MemoryManager::GetMemoryLayoutSize(GPUVAddr gpu_addr, size_t max_size) const {
-    std::unique_lock<std::mutex> lock(guard);
+    std::shared_lock lock(guard);
     return kind_map.GetContinuousSizeFrom(gpu_addr);
 }
 
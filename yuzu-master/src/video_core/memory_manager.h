@@ -7,6 +7,7 @@
 #include <map>
 #include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <vector>
 #include <boost/container/small_vector.hpp>
 
@@ -182,6 +183,24 @@ private:
     inline bool IsBigPageContinuous(size_t big_page_index) const;
     inline void SetBigPageContinuous(size_t big_page_index, bool value);
 
+    /// Translation of a mapped big page
+    struct BigPageTranslation {
+        DAddr dev_addr;
+        /// Host memory of the big page, null when it isn't continuous in host memory
+        u8* host_pointer;
+    };
+
+    /**
+     * Translates a big page through the translation cache of the calling thread.
+     * @returns The translation, or nullptr when the big page is not mapped as a whole.
+     */
+    [[nodiscard]] const BigPageTranslation* TranslateBigPage(size_t big_page_index) const;
+
+    /// Drops the cached translations of every thread, must be called after the tables changed.
+    void InvalidateTranslations() {
+        generation.fetch_add(1, std::memory_order_release);
+    }
+
     template <bool is_gpu_address>
     void GetSubmappedRangeImpl(
         GPUVAddr gpu_addr, std::size_t size,
@@ -239,7 +258,10 @@ private:
     boost::container::small_vector<std::pair<DAddr, std::size_t>, 32> page_stash{};
     boost::container::small_vector<std::pair<DAddr, std::size_t>, 32> page_stash2{};
 
-    mutable std::mutex guard;
+    mutable std::shared_mutex guard;
+
+    // Starts above zero, see TranslationCache
+    std::atomic<u64> generation{1};
 
     static constexpr size_t continuous_bits = 64;
 
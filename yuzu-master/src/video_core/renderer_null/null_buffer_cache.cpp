@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstring>
+
+#include "common/assert.h"
+#include "video_core/renderer_null/null_buffer_cache.h"
+
+namespace Null {
+
+Buffer::Buffer(BufferCacheRuntime&, DAddr cpu_addr_, u64 size_bytes_)
+    : VideoCommon::BufferBase(cpu_addr_, size_bytes_), data(SizeBytes()) {}
+
+Buffer::Buffer(BufferCacheRuntime&, VideoCommon::NullBufferParams null_params)
+    : VideoCommon::BufferBase(null_params) {}
+
+void Buffer::ImmediateUpload(size_t offset, std::span<const u8> upload_data) noexcept {
+    std::memcpy(data.data() + offset, upload_data.data(), upload_data.size_bytes());
+}
+
+void Buffer::ImmediateDownload(size_t offset, std::span<u8> download_data) noexcept {
+    std::memcpy(download_data.data(), data.data() + offset, download_data.size_bytes());
+}
+
+BufferCacheRuntime::BufferCacheRuntime(StagingBufferPool& staging_buffer_pool_)
+    : staging_buffer_pool{staging_buffer_pool_} {}
+
+StagingBufferMap BufferCacheRuntime::UploadStagingBuffer(size_t size) {
+    return staging_buffer_pool.RequestUploadBuffer(size);
+}
+
+StagingBufferMap BufferCacheRuntime::DownloadStagingBuffer(size_t size, bool deferred) {
+    return staging_buffer_pool.RequestDownloadBuffer(size, deferred);
+}
+
+void BufferCacheRuntime::FreeDeferredStagingBuffer(StagingBufferMap& buffer) {
+    staging_buffer_pool.FreeDeferredStagingBuffer(buffer);
+}
+
+void BufferCacheRuntime::CopyBuffer(u8* dst_buffer, u8* src_buffer,
+                                    std::span<const VideoCommon::BufferCopy> copies, bool, bool) {
+    for (const VideoCommon::BufferCopy& copy : copies) {
+        // Joined buffers can overlap the buffer they are copied from
+        std::memmove(dst_buffer + copy.dst_offset, src_buffer + copy.src_offset, copy.size);
+    }
+}
+
+void BufferCacheRuntime::ClearBuffer(u8* dst_buffer, u32 offset, size_t size, u32 value) {
+    ASSERT(size % sizeof(u32) == 0);
+    u8* const begin = dst_buffer + offset;
+    for (size_t i = 0; i < size; i += sizeof(u32)) {
+        std::memcpy(begin + i, &value, sizeof(u32));
+    }
+}
+
+} // namespace Null
@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+#include "common/common_types.h"
+#include "video_core/buffer_cache/buffer_cache_base.h"
+#include "video_core/buffer_cache/memory_tracker_base.h"
+#include "video_core/host1x/gpu_device_memory_manager.h"
+#include "video_core/renderer_null/null_staging_buffer_pool.h"
+#include "video_core/surface.h"
+
+namespace Null {
+
+class BufferCacheRuntime;
+
+/// Buffer holding its contents in host memory.
+class Buffer : public VideoCommon::BufferBase {
+public:
+    explicit Buffer(BufferCacheRuntime&, DAddr cpu_addr, u64 size_bytes);
+    explicit Buffer(BufferCacheRuntime&, VideoCommon::NullBufferParams);
+
+    void ImmediateUpload(size_t offset, std::span<const u8> data) noexcept;
+
+    void ImmediateDownload(size_t offset, std::span<u8> data) noexcept;
+
+    void MarkUsage(u64, u64) noexcept {}
+
+    [[nodiscard]] u8* Handle() noexcept {
+        return data.data();
+    }
+
+    [[nodiscard]] std::span<const u8> Data() const noexcept {
+        return data;
+    }
+
+    operator u8*() noexcept {
+        return data.data();
+    }
+
+private:
+    std::vector<u8> data;
+};
+
+/**
+ * Buffer cache runtime backed by host memory, for running the buffer cache without a GPU.
+ * Copies and clears are done immediately and bindings are ignored.
+ */
+class BufferCacheRuntime {
+public:
+    explicit BufferCacheRuntime(StagingBufferPool& staging_buffer_pool);
+
+    void TickFrame(Common::SlotVector<Buffer>&) noexcept {}
+
+    void Finish() {}
+
+    u64 GetDeviceLocalMemory() const {
+        return 0;
+    }
+
+    u64 GetDeviceMemoryUsage() const {
+        return 0;
+    }
+
+    bool CanReportMemoryUsage() const {
+        return false;
+    }
+
+    u32 GetStorageBufferAlignment() const {
+        return 16;
+    }
+
+    [[nodiscard]] StagingBufferMap UploadStagingBuffer(size_t size);
+
+    [[nodiscard]] StagingBufferMap DownloadStagingBuffer(size_t size, bool deferred = false);
+
+    void FreeDeferredStagingBuffer(StagingBufferMap& buffer);
+
+    bool CanReorderUpload(const Buffer&, std::span<const VideoCommon::BufferCopy>) {
+        return false;
+    }
+
+    void PreCopyBarrier() {}
+
+    void CopyBuffer(u8* dst_buffer, u8* src_buffer, std::span<const VideoCommon::BufferCopy> copies,
+                    bool barrier, bool can_reorder_upload = false);
+
+    void PostCopyBarrier() {}
+
+    void ClearBuffer(u8* dst_buffer, u32 offset, size_t size, u32 value);
+
+    void BindIndexBuffer(Buffer&, u32, u32) {}
+
+    void BindVertexBuffers(VideoCommon::HostBindings<Buffer>&) {}
+
+    void BindTransformFeedbackBuffers(VideoCommon::HostBindings<Buffer>&) {}
+
+    std::span<u8> BindMappedUniformBuffer(size_t, u32, u32 size) {
+        uniform_scratch.resize(std::max<size_t>(uniform_scratch.size(), size));
+        return std::span(uniform_scratch).first(size);
+    }
+
+    void BindUniformBuffer(Buffer&, u32, u32) {}
+
+    void BindStorageBuffer(Buffer&, u32, u32, bool) {}
+
+    void BindTextureBuffer(Buffer&, u32, u32, VideoCore::Surface::PixelFormat) {}
+
+private:
+    StagingBufferPool& staging_buffer_pool;
+    std::vector<u8> uniform_scratch;
+};
+
+struct BufferCacheParams {
+    using Runtime = Null::BufferCacheRuntime;
+    using Buffer = Null::Buffer;
+    using Async_Buffer = Null::StagingBufferMap;
+    using MemoryTracker = VideoCommon::MemoryTrackerBase<Tegra::MaxwellDeviceMemoryManager>;
+
+    static constexpr bool IS_OPENGL = false;
+    static constexpr bool HAS_PERSISTENT_UNIFORM_BUFFER_BINDINGS = false;
+    static constexpr bool HAS_FULL_INDEX_AND_PRIMITIVE_SUPPORT = true;
+    static constexpr bool NEEDS_BIND_UNIFORM_INDEX = false;
+    static constexpr bool NEEDS_BIND_STORAGE_INDEX = false;
+    static constexpr bool USE_MEMORY_MAPS = false;
+    static constexpr bool SEPARATE_IMAGE_BUFFER_BINDINGS = false;
+    static constexpr bool USE_MEMORY_MAPS_FOR_UPLOADS = false;
+};
+
+using BufferCache = VideoCommon::BufferCache<BufferCacheParams>;
+
+} // namespace Null
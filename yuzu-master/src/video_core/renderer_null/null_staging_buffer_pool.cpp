@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <limits>
+
+#include "common/assert.h"
+#include "common/bit_util.h"
+#include "video_core/renderer_null/null_staging_buffer_pool.h"
+
+namespace Null {
+
+StagingBufferMap StagingBuffers::RequestMap(size_t requested_size, bool deferred) {
+    const size_t index = RequestBuffer(requested_size);
+    allocs[index].deferred = deferred;
+    last_index = deferred ? std::nullopt : std::optional<size_t>{index};
+    return StagingBufferMap{
+        .mapped_span = std::span(allocs[index].data.get(), requested_size),
+        .buffer = allocs[index].data.get(),
+        .index = index,
+    };
+}
+
+void StagingBuffers::FreeDeferredStagingBuffer(size_t index) {
+    ASSERT(allocs[index].deferred);
+    allocs[index].deferred = false;
+}
+
+size_t StagingBuffers::RequestBuffer(size_t requested_size) {
+    if (const std::optional<size_t> index = FindBuffer(requested_size); index) {
+        return *index;
+    }
+    const size_t next_pow2_size = Common::NextPow2(std::max<size_t>(requested_size, 1));
+    allocs.push_back(StagingBufferAlloc{
+        .data = std::make_unique<u8[]>(next_pow2_size),
+        .size = next_pow2_size,
+        .deferred = false,
+    });
+    return allocs.size() - 1;
+}
+
+std::optional<size_t> StagingBuffers::FindBuffer(size_t requested_size) {
+    size_t smallest_buffer = std::numeric_limits<size_t>::max();
+    std::optional<size_t> found;
+    const size_t num_buffers = allocs.size();
+    for (size_t index = 0; index < num_buffers; ++index) {
+        const StagingBufferAlloc& alloc = allocs[index];
+        const size_t buffer_size = alloc.size;
+        if (buffer_size < requested_size || buffer_size >= smallest_buffer) {
+            continue;
+        }
+        if (alloc.deferred || index == last_index) {
+            continue;
+        }
+        smallest_buffer = buffer_size;
+        found = index;
+    }
+    return found;
+}
+
+StagingBufferMap StagingBufferPool::RequestUploadBuffer(size_t size) {
+    return upload_buffers.RequestMap(size, false);
+}
+
+StagingBufferMap StagingBufferPool::RequestDownloadBuffer(size_t size, bool deferred) {
+    return download_buffers.RequestMap(size, deferred);
+}
+
+void StagingBufferPool::FreeDeferredStagingBuffer(StagingBufferMap& buffer) {
+    download_buffers.FreeDeferredStagingBuffer(buffer.index);
+}
+
+} // namespace Null
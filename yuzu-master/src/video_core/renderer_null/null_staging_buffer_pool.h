@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Null {
+
+/// Host memory handed out for uploads and downloads. Buffers are referred to by their pointer.
+struct StagingBufferMap {
+    std::span<u8> mapped_span;
+    size_t offset = 0;
+    u8* buffer = nullptr;
+    size_t index = 0;
+};
+
+struct StagingBuffers {
+    StagingBufferMap RequestMap(size_t requested_size, bool deferred);
+
+    void FreeDeferredStagingBuffer(size_t index);
+
+    size_t RequestBuffer(size_t requested_size);
+
+    std::optional<size_t> FindBuffer(size_t requested_size);
+
+    struct StagingBufferAlloc {
+        std::unique_ptr<u8[]> data;
+        size_t size;
+        bool deferred;
+    };
+    std::vector<StagingBufferAlloc> allocs;
+    /// Last buffer handed out without deferring, kept alive until the next request
+    std::optional<size_t> last_index;
+};
+
+/**
+ * Staging memory for the headless caches. Work is done as soon as it is recorded, so there are no
+ * fences: a map stays valid until the next request to the same pool, or until it is freed when
+ * it was requested as deferred.
+ */
+class StagingBufferPool {
+public:
+    StagingBufferPool() = default;
+    ~StagingBufferPool() = default;
+
+    StagingBufferMap RequestUploadBuffer(size_t size);
+    StagingBufferMap RequestDownloadBuffer(size_t size, bool deferred = false);
+    void FreeDeferredStagingBuffer(StagingBufferMap& buffer);
+
+private:
+    StagingBuffers upload_buffers;
+    StagingBuffers download_buffers;
+};
+
+} // namespace Null
@@ -0,0 +1,358 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "common/assert.h"
+#include "common/div_ceil.h"
+#include "common/logging/log.h"
+#include "video_core/renderer_null/null_texture_cache.h"
+#include "video_core/surface.h"
+#include "video_core/texture_cache/util.h"
+
+namespace Null {
+
+using VideoCommon::BufferImageCopy;
+using VideoCommon::Extent3D;
+using VideoCommon::ImageCopy;
+using VideoCore::Surface::BytesPerBlock;
+using VideoCore::Surface::DefaultBlockHeight;
+using VideoCore::Surface::DefaultBlockWidth;
+
+namespace {
+/**
+ * Copies the blocks of each row of an image region. Formats with different block sizes are
+ * reinterpreted, copying as many bytes per row as both images have.
+ */
+void CopyImageRegions(Image& dst, Image& src, std::span<const ImageCopy> copies) {
+    const u32 src_tile_width = DefaultBlockWidth(src.info.format);
+    const u32 src_tile_height = DefaultBlockHeight(src.info.format);
+    const u32 dst_tile_width = DefaultBlockWidth(dst.info.format);
+    const u32 dst_tile_height = DefaultBlockHeight(dst.info.format);
+    const u32 src_bytes_per_block = BytesPerBlock(src.info.format);
+    const u32 dst_bytes_per_block = BytesPerBlock(dst.info.format);
+    for (const ImageCopy& copy : copies) {
+        const s32 src_level = copy.src_subresource.base_level;
+        const s32 dst_level = copy.dst_subresource.base_level;
+        if (src_level >= src.info.resources.levels || dst_level >= dst.info.resources.levels) {
+            continue;
+        }
+        const Extent3D src_blocks = src.LevelBlocks(src_level);
+        const Extent3D dst_blocks = dst.LevelBlocks(dst_level);
+        const u32 src_x = copy.src_offset.x / src_tile_width;
+        const u32 src_y = copy.src_offset.y / src_tile_height;
+        const u32 src_z = copy.src_offset.z;
+        const u32 dst_x = copy.dst_offset.x / dst_tile_width;
+        const u32 dst_y = copy.dst_offset.y / dst_tile_height;
+        const u32 dst_z = copy.dst_offset.z;
+        if (src_x >= src_blocks.width || src_y >= src_blocks.height ||
+            src_z >= src_blocks.depth || dst_x >= dst_blocks.width ||
+            dst_y >= dst_blocks.height || dst_z >= dst_blocks.depth) {
+            continue;
+        }
+        const u32 src_width = std::min(Common::DivCeil(copy.extent.width, src_tile_width),
+                                       src_blocks.width - src_x);
+        const u32 dst_width = std::min(Common::DivCeil(copy.extent.width, dst_tile_width),
+                                       dst_blocks.width - dst_x);
+        const u32 height = std::min({Common::DivCeil(copy.extent.height, src_tile_height),
+                                     src_blocks.height - src_y, dst_blocks.height - dst_y});
+        const u32 depth =
+            std::min({copy.extent.depth, src_blocks.depth - src_z, dst_blocks.depth - dst_z});
+        const size_t row_bytes =
+            std::min(src_width * src_bytes_per_block, dst_width * dst_bytes_per_block);
+        const s32 num_layers =
+            std::min({copy.src_subresource.num_layers,
+                      src.info.resources.layers - copy.src_subresource.base_layer,
+                      dst.info.resources.layers - copy.dst_subresource.base_layer});
+        for (s32 layer = 0; layer < num_layers; ++layer) {
+            const s32 src_layer = copy.src_subresource.base_layer + layer;
+            const s32 dst_layer = copy.dst_subresource.base_layer + layer;
+            for (u32 z = 0; z < depth; ++z) {
+                for (u32 y = 0; y < height; ++y) {
+                    const std::span<u8> src_row =
+                        src.Block(src_level, src_layer, src_x, src_y + y, src_z + z);
+                    const std::span<u8> dst_row =
+                        dst.Block(dst_level, dst_layer, dst_x, dst_y + y, dst_z + z);
+                    std::memcpy(dst_row.data(), src_row.data(), row_bytes);
+                }
+            }
+        }
+    }
+}
+
+/// Maps a destination coordinate to its nearest source coordinate, regions can be mirrored.
+u32 NearestCoordinate(s32 dst, s32 dst_start, s32 dst_end, s32 src_start, s32 src_end,
+                      u32 src_limit) {
+    const s64 dst_size = dst_end - dst_start;
+    const s64 src_size = src_end - src_start;
+    const s64 src = src_start + ((2 * s64{dst - dst_start} + 1) * src_size) / (2 * dst_size) -
+                    (src_size < 0 ? 1 : 0);
+    return static_cast<u32>(std::clamp<s64>(src, 0, s64{src_limit} - 1));
+}
+} // Anonymous namespace
+
+TextureCacheRuntime::TextureCacheRuntime(StagingBufferPool& staging_buffer_pool_)
+    : staging_buffer_pool{staging_buffer_pool_} {}
+
+TextureCacheRuntime::~TextureCacheRuntime() = default;
+
+StagingBufferMap TextureCacheRuntime::UploadStagingBuffer(size_t size) {
+    return staging_buffer_pool.RequestUploadBuffer(size);
+}
+
+StagingBufferMap TextureCacheRuntime::DownloadStagingBuffer(size_t size, bool deferred) {
+    return staging_buffer_pool.RequestDownloadBuffer(size, deferred);
+}
+
+void TextureCacheRuntime::FreeDeferredStagingBuffer(StagingBufferMap& buffer) {
+    staging_buffer_pool.FreeDeferredStagingBuffer(buffer);
+}
+
+void TextureCacheRuntime::CopyImage(Image& dst, Image& src,
+                                    std::span<const ImageCopy> copies) {
+    ASSERT(BytesPerBlock(dst.info.format) == BytesPerBlock(src.info.format));
+    CopyImageRegions(dst, src, copies);
+}
+
+void TextureCacheRuntime::CopyImageMSAA(Image& dst, Image& src,
+                                        std::span<const ImageCopy> copies) {
+    // Samples are stored like texels, so resolving and expanding are plain copies
+    CopyImage(dst, src, copies);
+}
+
+void TextureCacheRuntime::ReinterpretImage(Image& dst, Image& src,
+                                           std::span<const ImageCopy> copies) {
+    CopyImageRegions(dst, src, copies);
+}
+
+void TextureCacheRuntime::ConvertImage(Framebuffer* dst, ImageView& dst_view,
+                                       ImageView& src_view) {
+    const Region2D dst_region{
+        .start = {0, 0},
+        .end = {static_cast<s32>(dst_view.size.width), static_cast<s32>(dst_view.size.height)},
+    };
+    const Region2D src_region{
+        .start = {0, 0},
+        .end = {static_cast<s32>(src_view.size.width), static_cast<s32>(src_view.size.height)},
+    };
+    BlitImage(dst, dst_view, src_view, dst_region, src_region,
+              Tegra::Engines::Fermi2D::Filter::Point, Tegra::Engines::Fermi2D::Operation::SrcCopy);
+}
+
+void TextureCacheRuntime::BlitImage(Framebuffer*, ImageView& dst, ImageView& src,
+                                    const Region2D& dst_region, const Region2D& src_region,
+                                    Tegra::Engines::Fermi2D::Filter,
+                                    Tegra::Engines::Fermi2D::Operation) {
+    Image* const dst_image = dst.GetImage();
+    Image* const src_image = src.GetImage();
+    if (!dst_image || !src_image) {
+        return;
+    }
+    const u32 bytes_per_block = BytesPerBlock(dst_image->info.format);
+    if (bytes_per_block != BytesPerBlock(src_image->info.format) ||
+        DefaultBlockWidth(dst_image->info.format) != 1 ||
+        DefaultBlockWidth(src_image->info.format) != 1) {
+        LOG_WARNING(Render, "Unimplemented blit from {} to {}", src_image->info.format,
+                    dst_image->info.format);
+        return;
+    }
+    if (dst_region.start.x == dst_region.end.x || dst_region.start.y == dst_region.end.y) {
+        return;
+    }
+    // Filtering and blending operations are not emulated, texels are copied from the nearest
+    // source sample
+    const s32 dst_level = dst.range.base.level;
+    const s32 src_level = src.range.base.level;
+    const s32 dst_layer = dst.range.base.layer;
+    const s32 src_layer = src.range.base.layer;
+    const Extent3D dst_blocks = dst_image->LevelBlocks(dst_level);
+    const Extent3D src_blocks = src_image->LevelBlocks(src_level);
+    const s32 min_x = std::max(std::min(dst_region.start.x, dst_region.end.x), 0);
+    const s32 min_y = std::max(std::min(dst_region.start.y, dst_region.end.y), 0);
+    const s32 max_x =
+        std::min(std::max(dst_region.start.x, dst_region.end.x), s32(dst_blocks.width));
+    const s32 max_y =
+        std::min(std::max(dst_region.start.y, dst_region.end.y), s32(dst_blocks.height));
+    for (s32 y = min_y; y < max_y; ++y) {
+        const u32 src_y = NearestCoordinate(y, dst_region.start.y, dst_region.end.y,
+                                            src_region.start.y, src_region.end.y,
+                                            src_blocks.height);
+        for (s32 x = min_x; x < max_x; ++x) {
+            const u32 src_x = NearestCoordinate(x, dst_region.start.x, dst_region.end.x,
+                                                src_region.start.x, src_region.end.x,
+                                                src_blocks.width);
+            std::memcpy(dst_image->Block(dst_level, dst_layer, x, y, 0).data(),
+                        src_image->Block(src_level, src_layer, src_x, src_y, 0).data(),
+                        bytes_per_block);
+        }
+    }
+}
+
+void TextureCacheRuntime::AccelerateImageUpload(Image&, const StagingBufferMap&,
+                                                std::span<const VideoCommon::SwizzleParameters>) {
+    // Images never request accelerated uploads
+    UNREACHABLE();
+}
+
+Image::Image(TextureCacheRuntime& runtime_, const VideoCommon::ImageInfo& info_,
+             GPUVAddr gpu_addr_, VAddr cpu_addr_)
+    : VideoCommon::ImageBase(info_, gpu_addr_, cpu_addr_), runtime{&runtime_} {
+    const u32 tile_width = DefaultBlockWidth(info.format);
+    const u32 tile_height = DefaultBlockHeight(info.format);
+    const u32 bytes_per_block = BytesPerBlock(info.format);
+    const size_t num_layers = static_cast<size_t>(info.resources.layers);
+    size_t offset = 0;
+    for (s32 level = 0; level < info.resources.levels; ++level) {
+        const Extent3D size = VideoCommon::MipSize(info.size, level);
+        LevelLayout& layout = levels[level];
+        layout.width = Common::DivCeil(size.width, tile_width);
+        layout.height = Common::DivCeil(size.height, tile_height);
+        layout.depth = size.depth;
+        layout.offset = offset;
+        layout.row_pitch = static_cast<size_t>(layout.width) * bytes_per_block;
+        layout.slice_pitch = layout.row_pitch * layout.height;
+        layout.layer_pitch = layout.slice_pitch * layout.depth;
+        offset += layout.layer_pitch * num_layers;
+    }
+    storage.resize(offset);
+    runtime->memory_usage += storage.size();
+}
+
+Image::Image(const VideoCommon::NullImageParams& params) : VideoCommon::ImageBase{params} {}
+
+Image::~Image() {
+    if (runtime) {
+        runtime->memory_usage -= storage.size();
+    }
+}
+
+Image::Image(Image&& other) noexcept
+    : VideoCommon::ImageBase{std::move(other)}, runtime{std::exchange(other.runtime, nullptr)},
+      levels{other.levels}, storage{std::move(other.storage)} {}
+
+Image& Image::operator=(Image&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    // The storage of this image is released, take it out of the usage of its runtime
+    if (runtime) {
+        runtime->memory_usage -= storage.size();
+    }
+    VideoCommon::ImageBase::operator=(std::move(other));
+    runtime = std::exchange(other.runtime, nullptr);
+    levels = other.levels;
+    storage = std::move(other.storage);
+    return *this;
+}
+
+void Image::UploadMemory(u8* buffer, size_t buffer_offset,
+                         std::span<const BufferImageCopy> copies) {
+    for (const BufferImageCopy& copy : copies) {
+        CopyBuffer(buffer, buffer_offset, copy, true);
+    }
+}
+
+void Image::UploadMemory(const StagingBufferMap& map, std::span<const BufferImageCopy> copies) {
+    UploadMemory(map.buffer, map.offset, copies);
+}
+
+void Image::DownloadMemory(u8* buffer, size_t buffer_offset,
+                           std::span<const BufferImageCopy> copies) {
+    for (const BufferImageCopy& copy : copies) {
+        CopyBuffer(buffer, buffer_offset, copy, false);
+    }
+}
+
+void Image::DownloadMemory(const StagingBufferMap& map, std::span<const BufferImageCopy> copies) {
+    DownloadMemory(map.buffer, map.offset, copies);
+}
+
+std::span<u8> Image::Block(s32 level, s32 layer, u32 x, u32 y, u32 z) noexcept {
+    const LevelLayout& layout = levels[level];
+    const u32 bytes_per_block = BytesPerBlock(info.format);
+    const size_t offset = layout.offset + layout.layer_pitch * layer + layout.slice_pitch * z +
+                          layout.row_pitch * y + size_t{x} * bytes_per_block;
+    return std::span(storage).subspan(offset, bytes_per_block);
+}
+
+Extent3D Image::LevelBlocks(s32 level) const noexcept {
+    const LevelLayout& layout = levels[level];
+    return Extent3D{layout.width, layout.height, layout.depth};
+}
+
+void Image::CopyBuffer(u8* buffer, size_t buffer_offset, const BufferImageCopy& copy,
+                       bool upload) {
+    const s32 level = copy.image_subresource.base_level;
+    if (level >= info.resources.levels) {
+        return;
+    }
+    const LevelLayout& layout = levels[level];
+    const u32 tile_width = DefaultBlockWidth(info.format);
+    const u32 tile_height = DefaultBlockHeight(info.format);
+    const u32 bytes_per_block = BytesPerBlock(info.format);
+
+    // Buffer strides follow the Vulkan rules, zero means tightly packed
+    const u32 row_length =
+        copy.buffer_row_length != 0 ? copy.buffer_row_length : copy.image_extent.width;
+    const u32 image_height =
+        copy.buffer_image_height != 0 ? copy.buffer_image_height : copy.image_extent.height;
+    const size_t buffer_row_pitch =
+        static_cast<size_t>(Common::DivCeil(row_length, tile_width)) * bytes_per_block;
+    const size_t buffer_slice_pitch = buffer_row_pitch * Common::DivCeil(image_height, tile_height);
+    const size_t buffer_layer_pitch = buffer_slice_pitch * copy.image_extent.depth;
+
+    const u32 x = copy.image_offset.x / tile_width;
+    const u32 y = copy.image_offset.y / tile_height;
+    const u32 z = copy.image_offset.z;
+    if (x >= layout.width || y >= layout.height || z >= layout.depth) {
+        return;
+    }
+    const u32 width = std::min(Common::DivCeil(copy.image_extent.width, tile_width),
+                               layout.width - x);
+    const u32 height = std::min(Common::DivCeil(copy.image_extent.height, tile_height),
+                                layout.height - y);
+    const u32 depth = std::min(copy.image_extent.depth, layout.depth - z);
+    const size_t row_bytes = static_cast<size_t>(width) * bytes_per_block;
+    const s32 num_layers = std::min(copy.image_subresource.num_layers,
+                                    info.resources.layers - copy.image_subresource.base_layer);
+
+    u8* const buffer_base = buffer + buffer_offset + copy.buffer_offset;
+    for (s32 layer = 0; layer < num_layers; ++layer) {
+        const s32 image_layer = copy.image_subresource.base_layer + layer;
+        for (u32 slice = 0; slice < depth; ++slice) {
+            for (u32 row = 0; row < height; ++row) {
+                u8* const image_row = Block(level, image_layer, x, y + row, z + slice).data();
+                u8* const buffer_row = buffer_base + buffer_layer_pitch * layer +
+                                       buffer_slice_pitch * slice + buffer_row_pitch * row;
+                if (upload) {
+                    std::memcpy(image_row, buffer_row, row_bytes);
+                } else {
+                    std::memcpy(buffer_row, image_row, row_bytes);
+                }
+            }
+        }
+    }
+}
+
+ImageView::ImageView(TextureCacheRuntime&, const VideoCommon::ImageViewInfo& info,
+                     ImageId image_id_, Image& image, const SlotVector<Image>& slot_images_)
+    : VideoCommon::ImageViewBase{info, image.info, image_id_, image.gpu_addr},
+      slot_images{&slot_images_} {}
+
+ImageView::ImageView(TextureCacheRuntime&, const VideoCommon::ImageInfo& info,
+                     const VideoCommon::ImageViewInfo& view_info, GPUVAddr gpu_addr_)
+    : VideoCommon::ImageViewBase{info, view_info, gpu_addr_} {}
+
+ImageView::ImageView(TextureCacheRuntime&, const VideoCommon::NullImageViewParams& params)
+    : VideoCommon::ImageViewBase{params} {}
+
+Image* ImageView::GetImage() const noexcept {
+    if (!slot_images) {
+        return nullptr;
+    }
+    return const_cast<Image*>(&(*slot_images)[image_id]);
+}
+
+} // namespace Null
@@ -0,0 +1,219 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include "common/common_types.h"
+#include "video_core/renderer_null/null_staging_buffer_pool.h"
+#include "video_core/texture_cache/image_view_base.h"
+#include "video_core/texture_cache/texture_cache_base.h"
+
+namespace Null {
+
+using Common::SlotVector;
+using VideoCommon::ImageId;
+using VideoCommon::NUM_RT;
+using VideoCommon::Region2D;
+
+class Framebuffer;
+class Image;
+class ImageView;
+
+/**
+ * Texture cache runtime backed by host memory, for running the texture cache without a GPU.
+ * Images hold their texels in the same linear layout as the unswizzled guest data, and uploads,
+ * downloads, copies and blits move real data between them.
+ */
+class TextureCacheRuntime {
+public:
+    explicit TextureCacheRuntime(StagingBufferPool& staging_buffer_pool);
+    ~TextureCacheRuntime();
+
+    void Finish() {}
+
+    StagingBufferMap UploadStagingBuffer(size_t size);
+
+    StagingBufferMap DownloadStagingBuffer(size_t size, bool deferred = false);
+
+    void FreeDeferredStagingBuffer(StagingBufferMap& buffer);
+
+    u64 GetDeviceLocalMemory() const {
+        return 0;
+    }
+
+    u64 GetDeviceMemoryUsage() const {
+        return memory_usage;
+    }
+
+    bool CanReportMemoryUsage() const {
+        return false;
+    }
+
+    bool ShouldReinterpret([[maybe_unused]] Image& dst,
+                           [[maybe_unused]] Image& src) const noexcept {
+        return true;
+    }
+
+    bool CanUploadMSAA() const noexcept {
+        return true;
+    }
+
+    void CopyImage(Image& dst, Image& src, std::span<const VideoCommon::ImageCopy> copies);
+
+    void CopyImageMSAA(Image& dst, Image& src, std::span<const VideoCommon::ImageCopy> copies);
+
+    void ReinterpretImage(Image& dst, Image& src, std::span<const VideoCommon::ImageCopy> copies);
+
+    void ConvertImage(Framebuffer* dst, ImageView& dst_view, ImageView& src_view);
+
+    void BlitImage(Framebuffer* dst_framebuffer, ImageView& dst, ImageView& src,
+                   const Region2D& dst_region, const Region2D& src_region,
+                   Tegra::Engines::Fermi2D::Filter filter,
+                   Tegra::Engines::Fermi2D::Operation operation);
+
+    void AccelerateImageUpload(Image& image, const StagingBufferMap& map,
+                               std::span<const VideoCommon::SwizzleParameters> swizzles);
+
+    void InsertUploadMemoryBarrier() {}
+
+    void TransitionImageLayout(Image&) {}
+
+    bool HasNativeBgr() const noexcept {
+        return true;
+    }
+
+    bool HasBrokenTextureViewFormats() const noexcept {
+        return false;
+    }
+
+    void TickFrame() {}
+
+    void BarrierFeedbackLoop() const noexcept {}
+
+private:
+    friend Image;
+
+    StagingBufferPool& staging_buffer_pool;
+    u64 memory_usage = 0;
+};
+
+class Image : public VideoCommon::ImageBase {
+public:
+    explicit Image(TextureCacheRuntime&, const VideoCommon::ImageInfo& info, GPUVAddr gpu_addr,
+                   VAddr cpu_addr);
+    explicit Image(const VideoCommon::NullImageParams&);
+
+    ~Image();
+
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
+
+    Image(Image&&) noexcept;
+    Image& operator=(Image&&) noexcept;
+
+    void UploadMemory(u8* buffer, size_t buffer_offset,
+                      std::span<const VideoCommon::BufferImageCopy> copies);
+
+    void UploadMemory(const StagingBufferMap& map,
+                      std::span<const VideoCommon::BufferImageCopy> copies);
+
+    void DownloadMemory(u8* buffer, size_t buffer_offset,
+                        std::span<const VideoCommon::BufferImageCopy> copies);
+
+    void DownloadMemory(const StagingBufferMap& map,
+                        std::span<const VideoCommon::BufferImageCopy> copies);
+
+    bool IsRescaled() const noexcept {
+        return false;
+    }
+
+    bool ScaleUp([[maybe_unused]] bool ignore = false) {
+        return false;
+    }
+
+    bool ScaleDown([[maybe_unused]] bool ignore = false) {
+        return false;
+    }
+
+    /// Returns the bytes of a block, in block units of the image format.
+    [[nodiscard]] std::span<u8> Block(s32 level, s32 layer, u32 x, u32 y, u32 z) noexcept;
+
+    /// Returns the size of a level in blocks of the image format.
+    [[nodiscard]] VideoCommon::Extent3D LevelBlocks(s32 level) const noexcept;
+
+    /// Returns the host memory of the whole image.
+    [[nodiscard]] std::span<const u8> Data() const noexcept {
+        return storage;
+    }
+
+private:
+    struct LevelLayout {
+        size_t offset;
+        size_t row_pitch;
+        size_t slice_pitch;
+        size_t layer_pitch;
+        u32 width;
+        u32 height;
+        u32 depth;
+    };
+
+    void CopyBuffer(u8* buffer, size_t buffer_offset, const VideoCommon::BufferImageCopy& copy,
+                    bool upload);
+
+    TextureCacheRuntime* runtime{};
+    std::array<LevelLayout, VideoCommon::MAX_MIP_LEVELS> levels{};
+    std::vector<u8> storage;
+};
+
+class ImageView : public VideoCommon::ImageViewBase {
+public:
+    explicit ImageView(TextureCacheRuntime&, const VideoCommon::ImageViewInfo&, ImageId, Image&,
+                       const SlotVector<Image>&);
+    explicit ImageView(TextureCacheRuntime&, const VideoCommon::ImageInfo&,
+                       const VideoCommon::ImageViewInfo&, GPUVAddr);
+    explicit ImageView(TextureCacheRuntime&, const VideoCommon::NullImageViewParams&);
+
+    /// Returns the image of the view, or nullptr for buffer and null views.
+    [[nodiscard]] Image* GetImage() const noexcept;
+
+private:
+    const SlotVector<Image>* slot_images = nullptr;
+};
+
+class ImageAlloc : public VideoCommon::ImageAllocBase {};
+
+class Sampler {
+public:
+    explicit Sampler(TextureCacheRuntime&, const Tegra::Texture::TSCEntry&) {}
+};
+
+class Framebuffer {
+public:
+    explicit Framebuffer(TextureCacheRuntime&, std::span<ImageView*, NUM_RT>, ImageView*,
+                         const VideoCommon::RenderTargets&) {}
+};
+
+struct TextureCacheParams {
+    static constexpr bool ENABLE_VALIDATION = true;
+    static constexpr bool FRAMEBUFFER_BLITS = false;
+    static constexpr bool HAS_EMULATED_COPIES = false;
+    static constexpr bool HAS_DEVICE_MEMORY_INFO = false;
+    static constexpr bool IMPLEMENTS_ASYNC_DOWNLOADS = false;
+
+    using Runtime = Null::TextureCacheRuntime;
+    using Image = Null::Image;
+    using ImageAlloc = Null::ImageAlloc;
+    using ImageView = Null::ImageView;
+    using Sampler = Null::Sampler;
+    using Framebuffer = Null::Framebuffer;
+    using AsyncBuffer = Null::StagingBufferMap;
+    using BufferType = u8*;
+};
+
+using TextureCache = VideoCommon::TextureCache<TextureCacheParams>;
+
+} // namespace Null
@@ -48,6 +48,7 @@ using VideoCommon::FileEnvironment;
 using VideoCommon::GenericEnvironment;
 using VideoCommon::GraphicsEnvironment;
 using VideoCommon::LoadPipelines;
+using VideoCommon::PipelineRecord;
 using VideoCommon::SerializePipeline;
 using Context = ShaderContext::Context;
 
@@ -290,12 +291,15 @@ void ShaderCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading,
             workers->QueueWork(std::move(work));
         }
     }};
-    const auto load_compute{[&](std::ifstream& file, FileEnvironment env) {
-        ComputePipelineKey key;
-        file.read(reinterpret_cast<char*>(&key), sizeof(key));
-        queue_work([this, key, env_ = std::move(env), &state, &callback](Context* ctx) mutable {
-            ctx->pools.ReleaseContents();
-            auto pipeline{CreateComputePipeline(ctx->pools, key, env_, true)};
+    const auto load_compute{[&](const ComputePipelineKey& key, PipelineRecord record) {
+        queue_work([this, key, record_ = std::move(record), &state, &callback,
+                    stop_loading](Context* ctx) {
+            std::unique_ptr<ComputePipeline> pipeline;
+            if (!stop_loading.stop_requested()) {
+                std::vector<FileEnvironment> envs{record_.Deserialize()};
+                ctx->pools.ReleaseContents();
+                pipeline = CreateComputePipeline(ctx->pools, key, envs.front(), true);
+            }
             std::scoped_lock lock{state.mutex};
             if (pipeline) {
                 compute_cache.emplace(key, std::move(pipeline));
@@ -307,16 +311,19 @@ void ShaderCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading,
         });
         ++state.total;
     }};
-    const auto load_graphics{[&](std::ifstream& file, std::vector<FileEnvironment> envs) {
-        GraphicsPipelineKey key;
-        file.read(reinterpret_cast<char*>(&key), sizeof(key));
-        queue_work([this, key, envs_ = std::move(envs), &state, &callback](Context* ctx) mutable {
-            boost::container::static_vector<Shader::Environment*, 5> env_ptrs;
-            for (auto& env : envs_) {
-                env_ptrs.push_back(&env);
+    const auto load_graphics{[&](const GraphicsPipelineKey& key, PipelineRecord record) {
+        queue_work([this, key, record_ = std::move(record), &state, &callback,
+                    stop_loading](Context* ctx) {
+            std::unique_ptr<GraphicsPipeline> pipeline;
+            if (!stop_loading.stop_requested()) {
+                std::vector<FileEnvironment> envs{record_.Deserialize()};
+                boost::container::static_vector<Shader::Environment*, 5> env_ptrs;
+                for (auto& env : envs) {
+                    env_ptrs.push_back(&env);
+                }
+                ctx->pools.ReleaseContents();
+                pipeline = CreateGraphicsPipeline(ctx->pools, key, MakeSpan(env_ptrs), false, true);
             }
-            ctx->pools.ReleaseContents();
-            auto pipeline{CreateGraphicsPipeline(ctx->pools, key, MakeSpan(env_ptrs), false, true)};
             std::scoped_lock lock{state.mutex};
             if (pipeline) {
                 graphics_cache.emplace(key, std::move(pipeline));
@@ -328,7 +335,8 @@ void ShaderCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading,
         });
         ++state.total;
     }};
-    LoadPipelines(stop_loading, shader_cache_filename, CACHE_VERSION, load_compute, load_graphics);
+    LoadPipelines<ComputePipelineKey, GraphicsPipelineKey>(
+        stop_loading, shader_cache_filename, CACHE_VERSION, load_compute, load_graphics);
 
     LOG_INFO(Render_OpenGL, "Total Pipeline Count: {}", state.total);
 
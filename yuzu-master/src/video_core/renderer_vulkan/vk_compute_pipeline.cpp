@@ -27,7 +27,7 @@ using Tegra::Texture::TexturePair;
 ComputePipeline::ComputePipeline(const Device& device_, vk::PipelineCache& pipeline_cache_,
                                  DescriptorPool& descriptor_pool,
                                  GuestDescriptorQueue& guest_descriptor_queue_,
-                                 Common::ThreadWorker* thread_worker,
+                                 Common::TaskGroup* thread_worker,
                                  PipelineStatistics* pipeline_statistics,
                                  VideoCore::ShaderNotify* shader_notify, const Shader::Info& info_,
                                  vk::ShaderModule spv_module_)
@@ -90,7 +90,7 @@ ComputePipeline::ComputePipeline(const Device& device_, vk::PipelineCache& pipel
         }
     }};
     if (thread_worker) {
-        thread_worker->QueueWork(std::move(func));
+        thread_worker->Run(std::move(func));
     } else {
         func();
     }
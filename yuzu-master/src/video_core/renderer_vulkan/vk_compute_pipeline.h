@@ -8,7 +8,7 @@
 #include <mutex>
 
 #include "common/common_types.h"
-#include "common/thread_worker.h"
+#include "common/task_scheduler.h"
 #include "shader_recompiler/shader_info.h"
 #include "video_core/renderer_vulkan/vk_buffer_cache.h"
 #include "video_core/renderer_vulkan/vk_descriptor_pool.h"
@@ -31,7 +31,7 @@ public:
     explicit ComputePipeline(const Device& device, vk::PipelineCache& pipeline_cache,
                              DescriptorPool& descriptor_pool,
                              GuestDescriptorQueue& guest_descriptor_queue,
-                             Common::ThreadWorker* thread_worker,
+                             Common::TaskGroup* thread_worker,
                              PipelineStatistics* pipeline_statistics,
                              VideoCore::ShaderNotify* shader_notify, const Shader::Info& info,
                              vk::ShaderModule spv_module);
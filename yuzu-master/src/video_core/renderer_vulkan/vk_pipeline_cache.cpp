@@ -13,7 +13,9 @@
 #include "common/fs/fs.h"
 #include "common/fs/path_util.h"
 #include "common/microprofile.h"
-#include "common/thread_worker.h"
+#include "common/scm_rev.h"
+#include "common/settings.h"
+#include "common/task_scheduler.h"
 #include "core/core.h"
 #include "shader_recompiler/backend/spirv/emit_spirv.h"
 #include "shader_recompiler/environment.h"
@@ -263,6 +265,17 @@ Shader::RuntimeInfo MakeRuntimeInfo(std::span<const Shader::IR::Program> program
     return info;
 }
 
+/// Hashes the host state that affects emitted SPIR-V without being part of the pipeline keys
+u64 MakeCompiledShaderFingerprint(const Device& device) {
+    const auto& resolution{Settings::values.resolution_info};
+    const std::string fingerprint{fmt::format(
+        "{} {} {} {} {} {} {} {} {}", Common::g_scm_rev, device.GetModelName(),
+        static_cast<u32>(device.GetDriverID()), device.GetDriverVersion(), resolution.active,
+        resolution.up_scale, resolution.down_shift, Settings::values.renderer_debug.GetValue(),
+        Settings::values.disable_shader_loop_safety_checks.GetValue())};
+    return Common::CityHash64(fingerprint.data(), fingerprint.size());
+}
+
 size_t GetTotalPipelineWorkers() {
     const size_t max_core_threads =
         std::max<size_t>(static_cast<size_t>(std::thread::hardware_concurrency()), 2ULL) - 1ULL;
@@ -310,9 +323,9 @@ PipelineCache::PipelineCache(Tegra::MaxwellDeviceMemoryManager& device_memory_,
       texture_cache{texture_cache_}, shader_notify{shader_notify_},
       use_asynchronous_shaders{Settings::values.use_asynchronous_shaders.GetValue()},
       use_vulkan_pipeline_cache{Settings::values.use_vulkan_driver_pipeline_cache.GetValue()},
-      workers(device.HasBrokenParallelShaderCompiling() ? 1ULL : GetTotalPipelineWorkers(),
-              "VkPipelineBuilder"),
-      serialization_thread(1, "VkPipelineSerialization") {
+      workers(Common::TaskPriority::Normal,
+              device.HasBrokenParallelShaderCompiling() ? 1ULL : GetTotalPipelineWorkers()),
+      serialization_thread(Common::TaskPriority::Low, 1) {
     const auto& float_control{device.FloatControlProperties()};
     const VkDriverId driver_id{device.GetDriverID()};
     profile = Shader::Profile{
@@ -471,6 +484,8 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
         return;
     }
     pipeline_cache_filename = base_dir / "vulkan.bin";
+    compiled_shader_cache.Load(base_dir / "vulkan_compiled.bin", CACHE_VERSION,
+                               MakeCompiledShaderFingerprint(device));
 
     if (use_vulkan_pipeline_cache) {
         vulkan_pipeline_cache_filename = base_dir / "vulkan_pipelines.bin";
@@ -489,13 +504,17 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
     if (device.IsKhrPipelineExecutablePropertiesEnabled()) {
         state.statistics = std::make_unique<PipelineStatistics>(device);
     }
-    const auto load_compute{[&](std::ifstream& file, FileEnvironment env) {
-        ComputePipelineCacheKey key;
-        file.read(reinterpret_cast<char*>(&key), sizeof(key));
-
-        workers.QueueWork([this, key, env_ = std::move(env), &state, &callback]() mutable {
-            ShaderPools pools;
-            auto pipeline{CreateComputePipeline(pools, key, env_, state.statistics.get(), false)};
+    const auto load_compute{[&](const ComputePipelineCacheKey& key,
+                                VideoCommon::PipelineRecord record) {
+        workers.Run([this, key, record_ = std::move(record), &state, &callback,
+                           stop_loading] {
+            std::unique_ptr<ComputePipeline> pipeline;
+            if (!stop_loading.stop_requested()) {
+                std::vector<FileEnvironment> envs{record_.Deserialize()};
+                ShaderPools pools;
+                pipeline = CreateComputePipeline(pools, key, envs.front(), state.statistics.get(),
+                                                 false);
+            }
             std::scoped_lock lock{state.mutex};
             if (pipeline) {
                 compute_cache.emplace(key, std::move(pipeline));
@@ -507,10 +526,8 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
         });
         ++state.total;
     }};
-    const auto load_graphics{[&](std::ifstream& file, std::vector<FileEnvironment> envs) {
-        GraphicsPipelineCacheKey key;
-        file.read(reinterpret_cast<char*>(&key), sizeof(key));
-
+    const auto load_graphics{[&](const GraphicsPipelineCacheKey& key,
+                                 VideoCommon::PipelineRecord record) {
         if ((key.state.extended_dynamic_state != 0) !=
                 dynamic_features.has_extended_dynamic_state ||
             (key.state.extended_dynamic_state_2 != 0) !=
@@ -524,15 +541,19 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
             (key.state.dynamic_vertex_input != 0) != dynamic_features.has_dynamic_vertex_input) {
             return;
         }
-        workers.QueueWork([this, key, envs_ = std::move(envs), &state, &callback]() mutable {
-            ShaderPools pools;
-            boost::container::static_vector<Shader::Environment*, 5> env_ptrs;
-            for (auto& env : envs_) {
-                env_ptrs.push_back(&env);
+        workers.Run([this, key, record_ = std::move(record), &state, &callback,
+                           stop_loading] {
+            std::unique_ptr<GraphicsPipeline> pipeline;
+            if (!stop_loading.stop_requested()) {
+                std::vector<FileEnvironment> envs{record_.Deserialize()};
+                ShaderPools pools;
+                boost::container::static_vector<Shader::Environment*, 5> env_ptrs;
+                for (auto& env : envs) {
+                    env_ptrs.push_back(&env);
+                }
+                pipeline = CreateGraphicsPipeline(pools, key, MakeSpan(env_ptrs),
+                                                  state.statistics.get(), false);
             }
-            auto pipeline{CreateGraphicsPipeline(pools, key, MakeSpan(env_ptrs),
-                                                 state.statistics.get(), false)};
-
             std::scoped_lock lock{state.mutex};
             if (pipeline) {
                 graphics_cache.emplace(key, std::move(pipeline));
@@ -544,8 +565,8 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
         });
         ++state.total;
     }};
-    VideoCommon::LoadPipelines(stop_loading, pipeline_cache_filename, CACHE_VERSION, load_compute,
-                               load_graphics);
+    VideoCommon::LoadPipelines<ComputePipelineCacheKey, GraphicsPipelineCacheKey>(
+        stop_loading, pipeline_cache_filename, CACHE_VERSION, load_compute, load_graphics);
 
     LOG_INFO(Render_Vulkan, "Total Pipeline Count: {}", state.total);
 
@@ -554,7 +575,7 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
     state.has_loaded = true;
     lock.unlock();
 
-    workers.WaitForRequests(stop_loading);
+    workers.Wait(stop_loading);
 
     if (use_vulkan_pipeline_cache) {
         SerializeVulkanPipelineCache(vulkan_pipeline_cache_filename, vulkan_pipeline_cache,
@@ -610,6 +631,12 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
     bool build_in_parallel) try {
     auto hash = key.Hash();
     LOG_INFO(Render_Vulkan, "0x{:016x}", hash);
+    // Shaders are dumped while translating, so dumping bypasses the compiled cache
+    const auto cached_stages{Settings::values.dump_shaders ? std::nullopt
+                                                           : compiled_shader_cache.Find(key)};
+    if (cached_stages) {
+        return CreateCachedGraphicsPipeline(key, *cached_stages, statistics, build_in_parallel);
+    }
     size_t env_index{0};
     std::array<Shader::IR::Program, Maxwell::MaxShaderProgram> programs;
     const bool uses_vertex_a{key.unique_hashes[0] != 0};
@@ -656,6 +683,8 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
     std::array<const Shader::Info*, Maxwell::MaxShaderStage> infos{};
     std::array<vk::ShaderModule, Maxwell::MaxShaderStage> modules;
 
+    std::vector<VideoCommon::CompiledShaderStage> compiled_stages;
+
     const Shader::IR::Program* previous_stage{};
     Shader::Backend::Bindings binding;
     for (size_t index = uses_vertex_a && uses_vertex_b ? 1 : 0; index < Maxwell::MaxShaderProgram;
@@ -673,7 +702,7 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
 
         const auto runtime_info{MakeRuntimeInfo(programs, key, program, previous_stage)};
         ConvertLegacyToGeneric(program, runtime_info);
-        const std::vector<u32> code{EmitSPIRV(profile, runtime_info, program, binding)};
+        std::vector<u32> code{EmitSPIRV(profile, runtime_info, program, binding)};
         device.SaveShader(code);
         modules[stage_index] = BuildShader(device, code);
         if (device.HasDebuggingToolAttached()) {
@@ -681,8 +710,18 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
             modules[stage_index].SetObjectNameEXT(name.c_str());
         }
         previous_stage = &program;
+        compiled_stages.push_back({
+            .index = static_cast<u32>(stage_index),
+            .info = program.info,
+            .code = std::move(code),
+        });
     }
-    Common::ThreadWorker* const thread_worker{build_in_parallel ? &workers : nullptr};
+    if (!pipeline_cache_filename.empty()) {
+        serialization_thread.Run([this, key, stages = std::move(compiled_stages)] {
+            compiled_shader_cache.Save(key, stages);
+        });
+    }
+    Common::TaskGroup* const thread_worker{build_in_parallel ? &workers : nullptr};
     return std::make_unique<GraphicsPipeline>(
         scheduler, buffer_cache, texture_cache, vulkan_pipeline_cache, &shader_notify, device,
         descriptor_pool, guest_descriptor_queue, thread_worker, statistics, render_pass_cache, key,
@@ -706,6 +745,32 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
     return nullptr;
 }
 
+std::unique_ptr<GraphicsPipeline> PipelineCache::CreateCachedGraphicsPipeline(
+    const GraphicsPipelineCacheKey& key, std::span<const VideoCommon::CompiledShaderStage> stages,
+    PipelineStatistics* statistics, bool build_in_parallel) {
+    std::array<const Shader::Info*, Maxwell::MaxShaderStage> infos{};
+    std::array<vk::ShaderModule, Maxwell::MaxShaderStage> modules;
+    for (const VideoCommon::CompiledShaderStage& stage : stages) {
+        if (stage.index >= Maxwell::MaxShaderStage) {
+            LOG_ERROR(Render_Vulkan, "Invalid cached stage index {}", stage.index);
+            return nullptr;
+        }
+        infos[stage.index] = &stage.info;
+        device.SaveShader(stage.code);
+        modules[stage.index] = BuildShader(device, stage.code);
+        if (device.HasDebuggingToolAttached()) {
+            const std::string name{
+                fmt::format("Shader {:016x}", key.unique_hashes[stage.index + 1])};
+            modules[stage.index].SetObjectNameEXT(name.c_str());
+        }
+    }
+    Common::TaskGroup* const thread_worker{build_in_parallel ? &workers : nullptr};
+    return std::make_unique<GraphicsPipeline>(
+        scheduler, buffer_cache, texture_cache, vulkan_pipeline_cache, &shader_notify, device,
+        descriptor_pool, guest_descriptor_queue, thread_worker, statistics, render_pass_cache, key,
+        std::move(modules), infos);
+}
+
 std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline() {
     GraphicsEnvironments environments;
     GetGraphicsEnvironments(environments, graphics_key.unique_hashes);
@@ -716,7 +781,7 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline() {
     if (!pipeline || pipeline_cache_filename.empty()) {
         return pipeline;
     }
-    serialization_thread.QueueWork([this, key = graphics_key, envs = std::move(environments.envs)] {
+    serialization_thread.Run([this, key = graphics_key, envs = std::move(environments.envs)] {
         boost::container::static_vector<const GenericEnvironment*, Maxwell::MaxShaderProgram>
             env_ptrs;
         for (size_t index = 0; index < Maxwell::MaxShaderProgram; ++index) {
@@ -741,7 +806,7 @@ std::unique_ptr<ComputePipeline> PipelineCache::CreateComputePipeline(
     if (!pipeline || pipeline_cache_filename.empty()) {
         return pipeline;
     }
-    serialization_thread.QueueWork([this, key, env_ = std::move(env)] {
+    serialization_thread.Run([this, key, env_ = std::move(env)] {
         SerializePipeline(key, std::array<const GenericEnvironment*, 1>{&env_},
                           pipeline_cache_filename, CACHE_VERSION);
     });
@@ -759,6 +824,17 @@ std::unique_ptr<ComputePipeline> PipelineCache::CreateComputePipeline(
 
     LOG_INFO(Render_Vulkan, "0x{:016x}", hash);
 
+    Common::TaskGroup* const thread_worker{build_in_parallel ? &workers : nullptr};
+    const auto cached_stages{Settings::values.dump_shaders ? std::nullopt
+                                                           : compiled_shader_cache.Find(key)};
+    if (cached_stages && cached_stages->size() == 1) {
+        const VideoCommon::CompiledShaderStage& stage{cached_stages->front()};
+        device.SaveShader(stage.code);
+        return std::make_unique<ComputePipeline>(
+            device, vulkan_pipeline_cache, descriptor_pool, guest_descriptor_queue, thread_worker,
+            statistics, &shader_notify, stage.info, BuildShader(device, stage.code));
+    }
+
     Shader::Maxwell::Flow::CFG cfg{env, pools.flow_block, env.StartAddress()};
 
     // Dump it before error.
@@ -774,7 +850,14 @@ std::unique_ptr<ComputePipeline> PipelineCache::CreateComputePipeline(
         const auto name{fmt::format("Shader {:016x}", key.unique_hash)};
         spv_module.SetObjectNameEXT(name.c_str());
     }
-    Common::ThreadWorker* const thread_worker{build_in_parallel ? &workers : nullptr};
+    if (!pipeline_cache_filename.empty()) {
+        std::array<VideoCommon::CompiledShaderStage, 1> stages{{
+            {.index = 0, .info = program.info, .code = code},
+        }};
+        serialization_thread.Run([this, key, stages = std::move(stages)] {
+            compiled_shader_cache.Save(key, stages);
+        });
+    }
     return std::make_unique<ComputePipeline>(device, vulkan_pipeline_cache, descriptor_pool,
                                              guest_descriptor_queue, thread_worker, statistics,
                                              &shader_notify, program.info, std::move(spv_module));
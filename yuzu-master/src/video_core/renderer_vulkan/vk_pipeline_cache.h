@@ -12,13 +12,14 @@
 #include <vector>
 
 #include "common/common_types.h"
-#include "common/thread_worker.h"
+#include "common/task_scheduler.h"
 #include "shader_recompiler/frontend/ir/basic_block.h"
 #include "shader_recompiler/frontend/ir/value.h"
 #include "shader_recompiler/frontend/maxwell/control_flow.h"
 #include "shader_recompiler/host_translate_info.h"
 #include "shader_recompiler/object_pool.h"
 #include "shader_recompiler/profile.h"
+#include "video_core/compiled_shader_cache.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/host1x/gpu_device_memory_manager.h"
 #include "video_core/renderer_vulkan/fixed_pipeline_state.h"
@@ -125,6 +126,11 @@ private:
         std::span<Shader::Environment* const> envs, PipelineStatistics* statistics,
         bool build_in_parallel);
 
+    std::unique_ptr<GraphicsPipeline> CreateCachedGraphicsPipeline(
+        const GraphicsPipelineCacheKey& key,
+        std::span<const VideoCommon::CompiledShaderStage> stages, PipelineStatistics* statistics,
+        bool build_in_parallel);
+
     std::unique_ptr<ComputePipeline> CreateComputePipeline(const ComputePipelineCacheKey& key,
                                                            const ShaderInfo* shader);
 
@@ -163,12 +169,13 @@ private:
     Shader::HostTranslateInfo host_info;
 
     std::filesystem::path pipeline_cache_filename;
+    VideoCommon::CompiledShaderCache compiled_shader_cache;
 
     std::filesystem::path vulkan_pipeline_cache_filename;
     vk::PipelineCache vulkan_pipeline_cache;
 
-    Common::ThreadWorker workers;
-    Common::ThreadWorker serialization_thread;
+    Common::TaskGroup workers;
+    Common::TaskGroup serialization_thread;
     DynamicFeatures dynamic_features;
 };
 
@@ -2,10 +2,12 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <memory>
 #include <optional>
+#include <system_error>
 #include <utility>
 
 #include "common/assert.h"
@@ -13,6 +15,7 @@
 #include "common/common_types.h"
 #include "common/div_ceil.h"
 #include "common/fs/fs.h"
+#include "common/fs/mapped_file.h"
 #include "common/fs/path_util.h"
 #include "common/logging/log.h"
 #include "common/polyfill_ranges.h"
@@ -31,6 +34,95 @@ constexpr size_t INST_SIZE = sizeof(u64);
 
 using Maxwell = Tegra::Engines::Maxwell3D::Regs;
 
+namespace {
+/// Bounds checked reader over serialized data, it stops reading after the first out of bounds read.
+class SpanReader {
+public:
+    explicit SpanReader(std::span<const u8> data_) : data{data_} {}
+
+    template <typename T>
+    void Read(T& value) {
+        ReadBytes(&value, sizeof(value));
+    }
+
+    void ReadBytes(void* dest, size_t size) {
+        if (Skip(size)) {
+            std::memcpy(dest, data.data() + offset - size, size);
+        }
+    }
+
+    bool Skip(u64 count, size_t element_size = 1) {
+        if (failed || count > (data.size() - offset) / element_size) {
+            failed = true;
+            return false;
+        }
+        offset += static_cast<size_t>(count) * element_size;
+        return true;
+    }
+
+    [[nodiscard]] size_t Offset() const noexcept {
+        return offset;
+    }
+
+    [[nodiscard]] bool Failed() const noexcept {
+        return failed;
+    }
+
+private:
+    std::span<const u8> data;
+    size_t offset{};
+    bool failed{};
+};
+
+/// Location of a pipeline in a mapped pipeline cache file.
+struct PipelineIndexEntry {
+    size_t envs_offset;
+    size_t envs_size;
+    size_t key_offset;
+    u32 num_envs;
+    bool is_compute;
+};
+
+/// Measures the pipeline at the start of data, returns std::nullopt when it's truncated.
+std::optional<PipelineIndexEntry> MeasurePipeline(std::span<const u8> data, size_t base_offset,
+                                                  size_t compute_key_size,
+                                                  size_t graphics_key_size) {
+    u32 num_envs{};
+    if (data.size() < sizeof(num_envs)) {
+        return std::nullopt;
+    }
+    std::memcpy(&num_envs, data.data(), sizeof(num_envs));
+    if (num_envs == 0 || num_envs > Maxwell::MaxShaderProgram) {
+        return std::nullopt;
+    }
+    size_t offset{sizeof(num_envs)};
+    Shader::Stage first_stage{};
+    for (u32 index = 0; index < num_envs; ++index) {
+        Shader::Stage stage{};
+        const size_t env_size{FileEnvironment::SerializedSize(data.subspan(offset), stage)};
+        if (env_size == 0) {
+            return std::nullopt;
+        }
+        if (index == 0) {
+            first_stage = stage;
+        }
+        offset += env_size;
+    }
+    const bool is_compute{first_stage == Shader::Stage::Compute};
+    const size_t key_size{is_compute ? compute_key_size : graphics_key_size};
+    if (data.size() - offset < key_size) {
+        return std::nullopt;
+    }
+    return PipelineIndexEntry{
+        .envs_offset = base_offset + sizeof(num_envs),
+        .envs_size = offset - sizeof(num_envs),
+        .key_offset = base_offset + offset,
+        .num_envs = num_envs,
+        .is_compute = is_compute,
+    };
+}
+} // Anonymous namespace
+
 static u64 MakeCbufKey(u32 index, u32 offset) {
     return (static_cast<u64>(index) << 32) | offset;
 }
@@ -448,68 +540,109 @@ u32 ComputeEnvironment::ReadViewportTransformState() {
     return viewport_transform_state;
 }
 
-void FileEnvironment::Deserialize(std::ifstream& file) {
+size_t FileEnvironment::Deserialize(std::span<const u8> data) {
+    if (SerializedSize(data, stage) == 0) {
+        return 0;
+    }
+    SpanReader reader{data};
     u64 code_size{};
     u64 num_texture_types{};
     u64 num_texture_pixel_formats{};
     u64 num_cbuf_values{};
     u64 num_cbuf_replacement_values{};
-    file.read(reinterpret_cast<char*>(&code_size), sizeof(code_size))
-        .read(reinterpret_cast<char*>(&num_texture_types), sizeof(num_texture_types))
-        .read(reinterpret_cast<char*>(&num_texture_pixel_formats),
-              sizeof(num_texture_pixel_formats))
-        .read(reinterpret_cast<char*>(&num_cbuf_values), sizeof(num_cbuf_values))
-        .read(reinterpret_cast<char*>(&num_cbuf_replacement_values),
-              sizeof(num_cbuf_replacement_values))
-        .read(reinterpret_cast<char*>(&local_memory_size), sizeof(local_memory_size))
-        .read(reinterpret_cast<char*>(&texture_bound), sizeof(texture_bound))
-        .read(reinterpret_cast<char*>(&start_address), sizeof(start_address))
-        .read(reinterpret_cast<char*>(&read_lowest), sizeof(read_lowest))
-        .read(reinterpret_cast<char*>(&read_highest), sizeof(read_highest))
-        .read(reinterpret_cast<char*>(&viewport_transform_state), sizeof(viewport_transform_state))
-        .read(reinterpret_cast<char*>(&stage), sizeof(stage));
+    reader.Read(code_size);
+    reader.Read(num_texture_types);
+    reader.Read(num_texture_pixel_formats);
+    reader.Read(num_cbuf_values);
+    reader.Read(num_cbuf_replacement_values);
+    reader.Read(local_memory_size);
+    reader.Read(texture_bound);
+    reader.Read(start_address);
+    reader.Read(read_lowest);
+    reader.Read(read_highest);
+    reader.Read(viewport_transform_state);
+    reader.Read(stage);
     code.resize(Common::DivCeil(code_size, sizeof(u64)));
-    file.read(reinterpret_cast<char*>(code.data()), code_size);
+    reader.ReadBytes(code.data(), code_size);
+    texture_types.reserve(num_texture_types);
     for (size_t i = 0; i < num_texture_types; ++i) {
         u32 key;
         Shader::TextureType type;
-        file.read(reinterpret_cast<char*>(&key), sizeof(key))
-            .read(reinterpret_cast<char*>(&type), sizeof(type));
+        reader.Read(key);
+        reader.Read(type);
         texture_types.emplace(key, type);
     }
+    texture_pixel_formats.reserve(num_texture_pixel_formats);
     for (size_t i = 0; i < num_texture_pixel_formats; ++i) {
         u32 key;
         Shader::TexturePixelFormat format;
-        file.read(reinterpret_cast<char*>(&key), sizeof(key))
-            .read(reinterpret_cast<char*>(&format), sizeof(format));
+        reader.Read(key);
+        reader.Read(format);
         texture_pixel_formats.emplace(key, format);
     }
+    cbuf_values.reserve(num_cbuf_values);
     for (size_t i = 0; i < num_cbuf_values; ++i) {
         u64 key;
         u32 value;
-        file.read(reinterpret_cast<char*>(&key), sizeof(key))
-            .read(reinterpret_cast<char*>(&value), sizeof(value));
+        reader.Read(key);
+        reader.Read(value);
         cbuf_values.emplace(key, value);
     }
+    cbuf_replacements.reserve(num_cbuf_replacement_values);
     for (size_t i = 0; i < num_cbuf_replacement_values; ++i) {
         u64 key;
         Shader::ReplaceConstant value;
-        file.read(reinterpret_cast<char*>(&key), sizeof(key))
-            .read(reinterpret_cast<char*>(&value), sizeof(value));
+        reader.Read(key);
+        reader.Read(value);
         cbuf_replacements.emplace(key, value);
     }
     if (stage == Shader::Stage::Compute) {
-        file.read(reinterpret_cast<char*>(&workgroup_size), sizeof(workgroup_size))
-            .read(reinterpret_cast<char*>(&shared_memory_size), sizeof(shared_memory_size));
+        reader.Read(workgroup_size);
+        reader.Read(shared_memory_size);
         initial_offset = 0;
     } else {
-        file.read(reinterpret_cast<char*>(&sph), sizeof(sph));
+        reader.Read(sph);
         initial_offset = sizeof(sph);
         if (stage == Shader::Stage::Geometry) {
-            file.read(reinterpret_cast<char*>(&gp_passthrough_mask), sizeof(gp_passthrough_mask));
+            reader.Read(gp_passthrough_mask);
         }
     }
     is_proprietary_driver = texture_bound == 2;
+    return reader.Offset();
+}
+
+size_t FileEnvironment::SerializedSize(std::span<const u8> data, Shader::Stage& stage) {
+    SpanReader reader{data};
+    u64 code_size{};
+    u64 num_texture_types{};
+    u64 num_texture_pixel_formats{};
+    u64 num_cbuf_values{};
+    u64 num_cbuf_replacement_values{};
+    reader.Read(code_size);
+    reader.Read(num_texture_types);
+    reader.Read(num_texture_pixel_formats);
+    reader.Read(num_cbuf_values);
+    reader.Read(num_cbuf_replacement_values);
+    reader.Skip(sizeof(local_memory_size) + sizeof(texture_bound) + sizeof(start_address) +
+                sizeof(read_lowest) + sizeof(read_highest) + sizeof(viewport_transform_state));
+    reader.Read(stage);
+    if (reader.Failed() || stage > Shader::Stage::VertexA) {
+        return 0;
+    }
+    reader.Skip(code_size);
+    reader.Skip(num_texture_types, sizeof(u32) + sizeof(Shader::TextureType));
+    reader.Skip(num_texture_pixel_formats, sizeof(u32) + sizeof(Shader::TexturePixelFormat));
+    reader.Skip(num_cbuf_values, sizeof(u64) + sizeof(u32));
+    reader.Skip(num_cbuf_replacement_values, sizeof(u64) + sizeof(Shader::ReplaceConstant));
+    if (stage == Shader::Stage::Compute) {
+        reader.Skip(sizeof(workgroup_size) + sizeof(shared_memory_size));
+    } else {
+        reader.Skip(sizeof(sph));
+        if (stage == Shader::Stage::Geometry) {
+            reader.Skip(sizeof(gp_passthrough_mask));
+        }
+    }
+    return reader.Failed() ? 0 : reader.Offset();
 }
 
 void FileEnvironment::Dump(u64 pipeline_hash, u64 shader_hash) {
@@ -614,24 +747,41 @@ void SerializePipeline(std::span<const char> key, std::span<const GenericEnviron
     }
 }
 
+PipelineRecord::PipelineRecord(std::shared_ptr<const Common::FS::MappedFile> file_,
+                               std::span<const u8> data_, u32 num_envs_)
+    : file{std::move(file_)}, data{data_}, num_envs{num_envs_} {}
+
+std::vector<FileEnvironment> PipelineRecord::Deserialize() const {
+    std::vector<FileEnvironment> envs(num_envs);
+    size_t offset{};
+    for (FileEnvironment& env : envs) {
+        const size_t size{env.Deserialize(data.subspan(offset))};
+        ASSERT_MSG(size != 0, "Pipeline record was validated when it was indexed");
+        offset += size;
+    }
+    return envs;
+}
+
 void LoadPipelines(
     std::stop_token stop_loading, const std::filesystem::path& filename, u32 expected_cache_version,
-    Common::UniqueFunction<void, std::ifstream&, FileEnvironment> load_compute,
-    Common::UniqueFunction<void, std::ifstream&, std::vector<FileEnvironment>> load_graphics) try {
-    std::ifstream file(filename, std::ios::binary | std::ios::ate);
-    if (!file.is_open()) {
+    size_t compute_key_size, size_t graphics_key_size,
+    Common::UniqueFunction<void, std::span<const u8>, PipelineRecord> load_compute,
+    Common::UniqueFunction<void, std::span<const u8>, PipelineRecord> load_graphics) {
+    auto file{std::make_shared<Common::FS::MappedFile>(filename)};
+    if (!file->IsOpen()) {
         return;
     }
-    file.exceptions(std::ifstream::failbit);
-    const auto end{file.tellg()};
-    file.seekg(0, std::ios::beg);
+    std::span<const u8> data{file->GetSpan()};
 
-    std::array<char, 8> magic_number;
-    u32 cache_version;
-    file.read(magic_number.data(), magic_number.size())
-        .read(reinterpret_cast<char*>(&cache_version), sizeof(cache_version));
+    static constexpr size_t header_size{MAGIC_NUMBER.size() + sizeof(u32)};
+    std::array<char, 8> magic_number{};
+    u32 cache_version{};
+    if (data.size() >= header_size) {
+        std::memcpy(magic_number.data(), data.data(), magic_number.size());
+        std::memcpy(&cache_version, data.data() + magic_number.size(), sizeof(cache_version));
+    }
     if (magic_number != MAGIC_NUMBER || cache_version != expected_cache_version) {
-        file.close();
+        file->Close();
         if (Common::FS::RemoveFile(filename)) {
             if (magic_number != MAGIC_NUMBER) {
                 LOG_ERROR(Common_Filesystem, "Invalid pipeline cache file");
@@ -646,28 +796,57 @@ void LoadPipelines(
         }
         return;
     }
-    while (file.tellg() != end) {
+
+    // Index every pipeline first, environments are deserialized later by the load callbacks
+    std::vector<PipelineIndexEntry> index;
+    size_t offset{header_size};
+    while (offset != data.size()) {
         if (stop_loading.stop_requested()) {
             return;
         }
-        u32 num_envs{};
-        file.read(reinterpret_cast<char*>(&num_envs), sizeof(num_envs));
-        std::vector<FileEnvironment> envs(num_envs);
-        for (FileEnvironment& env : envs) {
-            env.Deserialize(file);
+        const std::optional<PipelineIndexEntry> entry{
+            MeasurePipeline(data.subspan(offset), offset, compute_key_size, graphics_key_size)};
+        if (!entry) {
+            break;
         }
-        if (envs.front().ShaderStage() == Shader::Stage::Compute) {
-            load_compute(file, std::move(envs.front()));
-        } else {
-            load_graphics(file, std::move(envs));
+        index.push_back(*entry);
+        offset = entry->key_offset + (entry->is_compute ? compute_key_size : graphics_key_size);
+    }
+    if (offset != data.size()) {
+        // Most likely a write was interrupted, keep the pipelines before it
+        LOG_WARNING(Common_Filesystem,
+                    "Pipeline cache is corrupted at offset {}, discarding the last {} bytes",
+                    offset, data.size() - offset);
+        file->Close();
+        std::error_code ec;
+        std::filesystem::resize_file(filename, offset, ec);
+        if (ec) {
+            LOG_ERROR(Common_Filesystem, "Failed to truncate pipeline cache file: {}",
+                      ec.message());
+            if (!Common::FS::RemoveFile(filename)) {
+                LOG_ERROR(Common_Filesystem, "Failed to delete pipeline cache file {}",
+                          Common::FS::PathToUTF8String(filename));
+            }
+            return;
+        }
+        file->Open(filename);
+        if (!file->IsOpen() || file->GetSize() != offset) {
+            return;
         }
+        data = file->GetSpan();
     }
 
-} catch (const std::ios_base::failure& e) {
-    LOG_ERROR(Common_Filesystem, "{}", e.what());
-    if (!Common::FS::RemoveFile(filename)) {
-        LOG_ERROR(Common_Filesystem, "Failed to delete pipeline cache file {}",
-                  Common::FS::PathToUTF8String(filename));
+    for (const PipelineIndexEntry& entry : index) {
+        if (stop_loading.stop_requested()) {
+            return;
+        }
+        PipelineRecord record{file, data.subspan(entry.envs_offset, entry.envs_size),
+                              entry.num_envs};
+        if (entry.is_compute) {
+            load_compute(data.subspan(entry.key_offset, compute_key_size), std::move(record));
+        } else {
+            load_graphics(data.subspan(entry.key_offset, graphics_key_size), std::move(record));
+        }
     }
 }
 
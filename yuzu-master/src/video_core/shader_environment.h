@@ -4,6 +4,7 @@
 #pragma once
 
 #include <array>
+#include <cstring>
 #include <filesystem>
 #include <iosfwd>
 #include <limits>
@@ -20,6 +21,10 @@
 #include "shader_recompiler/environment.h"
 #include "video_core/engines/maxwell_3d.h"
 
+namespace Common::FS {
+class MappedFile;
+}
+
 namespace Tegra {
 class Memorymanager;
 }
@@ -165,7 +170,22 @@ public:
     FileEnvironment& operator=(const FileEnvironment&) = delete;
     FileEnvironment(const FileEnvironment&) = delete;
 
-    void Deserialize(std::ifstream& file);
+    /**
+     * Deserializes an environment written by GenericEnvironment::Serialize.
+     *
+     * @returns Number of bytes consumed, zero when the data is truncated.
+     */
+    size_t Deserialize(std::span<const u8> data);
+
+    /**
+     * Measures a serialized environment without deserializing it.
+     *
+     * @param data  Serialized data, starting at the environment
+     * @param stage Stage of the environment
+     *
+     * @returns Size in bytes of the environment, zero when the data is truncated.
+     */
+    [[nodiscard]] static size_t SerializedSize(std::span<const u8> data, Shader::Stage& stage);
 
     [[nodiscard]] u64 ReadInstruction(u32 address) override;
 
@@ -224,9 +244,53 @@ void SerializePipeline(const Key& key, const Envs& envs, const std::filesystem::
                       std::span(envs.data(), envs.size()), filename, cache_version);
 }
 
+/// Pipeline in a memory mapped pipeline cache file, its environments are deserialized on demand.
+class PipelineRecord {
+public:
+    explicit PipelineRecord(std::shared_ptr<const Common::FS::MappedFile> file_,
+                            std::span<const u8> data_, u32 num_envs_);
+
+    /// Deserializes the environments of the pipeline, safe to call from any thread.
+    [[nodiscard]] std::vector<FileEnvironment> Deserialize() const;
+
+private:
+    std::shared_ptr<const Common::FS::MappedFile> file;
+    std::span<const u8> data;
+    u32 num_envs;
+};
+
+/**
+ * Maps a pipeline cache file and indexes its pipelines, then passes them to the load callbacks in
+ * the order they were serialized. Environments are not deserialized, so callbacks can queue that
+ * work to other threads together with the pipeline build.
+ *
+ * Truncated pipelines at the end of the file, left by interrupted writes, are removed from it.
+ */
 void LoadPipelines(
     std::stop_token stop_loading, const std::filesystem::path& filename, u32 expected_cache_version,
-    Common::UniqueFunction<void, std::ifstream&, FileEnvironment> load_compute,
-    Common::UniqueFunction<void, std::ifstream&, std::vector<FileEnvironment>> load_graphics);
+    size_t compute_key_size, size_t graphics_key_size,
+    Common::UniqueFunction<void, std::span<const u8>, PipelineRecord> load_compute,
+    Common::UniqueFunction<void, std::span<const u8>, PipelineRecord> load_graphics);
+
+template <typename ComputeKey, typename GraphicsKey>
+void LoadPipelines(std::stop_token stop_loading, const std::filesystem::path& filename,
+                   u32 expected_cache_version,
+                   Common::UniqueFunction<void, const ComputeKey&, PipelineRecord> load_compute,
+                   Common::UniqueFunction<void, const GraphicsKey&, PipelineRecord> load_graphics) {
+    static_assert(std::is_trivially_copyable_v<ComputeKey>);
+    static_assert(std::is_trivially_copyable_v<GraphicsKey>);
+    LoadPipelines(
+        stop_loading, filename, expected_cache_version, sizeof(ComputeKey), sizeof(GraphicsKey),
+        [&](std::span<const u8> key_data, PipelineRecord record) {
+            ComputeKey key;
+            std::memcpy(&key, key_data.data(), sizeof(key));
+            load_compute(key, std::move(record));
+        },
+        [&](std::span<const u8> key_data, PipelineRecord record) {
+            GraphicsKey key;
+            std::memcpy(&key, key_data.data(), sizeof(key));
+            load_graphics(key, std::move(record));
+        });
+}
 
 } // namespace VideoCommon
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <boost/container/small_vector.hpp>
+
+#include "common/common_types.h"
+#include "common/hash.h"
+
+namespace VideoCommon {
+
+/**
+ * Maps page numbers to the small lists of ids registered in them, like an
+ * unordered_map<u64, vector<Id>> would, but as a two-level radix table.
+ *
+ * Looking up a page is two dependent loads instead of a hash and a bucket walk, and the lists
+ * of consecutive pages are contiguous in memory. Lists store a few ids inline, which covers most
+ * pages. The root grows on demand to the highest page used. Pages beyond what the root can cover
+ * fall back to a hash map, so any page number is accepted.
+ *
+ * References to lists stay valid until Clear is called.
+ */
+template <typename Id>
+class PageIndex {
+    static constexpr u64 LEAF_BITS = 9;
+    static constexpr u64 LEAF_SIZE = 1ULL << LEAF_BITS;
+    static constexpr u64 LEAF_MASK = LEAF_SIZE - 1;
+    static constexpr u64 MAX_ROOTS = 1ULL << 16;
+
+public:
+    using List = boost::container::small_vector<Id, 4>;
+
+    /// Returns the list of a page, or nullptr when nothing has ever been registered near it.
+    [[nodiscard]] List* Find(u64 page) noexcept {
+        const u64 root = page >> LEAF_BITS;
+        if (root >= roots.size()) [[unlikely]] {
+            return root >= MAX_ROOTS ? FindOverflow(page) : nullptr;
+        }
+        Leaf* const leaf = roots[root].get();
+        return leaf ? &(*leaf)[page & LEAF_MASK] : nullptr;
+    }
+
+    [[nodiscard]] const List* Find(u64 page) const noexcept {
+        return const_cast<PageIndex*>(this)->Find(page);
+    }
+
+    /// Returns the list of a page, creating it when needed.
+    [[nodiscard]] List& operator[](u64 page) {
+        const u64 root = page >> LEAF_BITS;
+        if (root >= MAX_ROOTS) [[unlikely]] {
+            return overflow[page];
+        }
+        if (root >= roots.size()) {
+            roots.resize(root + 1);
+        }
+        std::unique_ptr<Leaf>& leaf = roots[root];
+        if (!leaf) {
+            leaf = std::make_unique<Leaf>();
+        }
+        return (*leaf)[page & LEAF_MASK];
+    }
+
+    /// Removes every list.
+    void Clear() {
+        roots.clear();
+        overflow.clear();
+    }
+
+private:
+    using Leaf = std::array<List, LEAF_SIZE>;
+
+    List* FindOverflow(u64 page) noexcept {
+        const auto it = overflow.find(page);
+        return it != overflow.end() ? &it->second : nullptr;
+    }
+
+    std::vector<std::unique_ptr<Leaf>> roots;
+    std::unordered_map<u64, List, Common::IdentityHash<u64>> overflow;
+};
+
+} // namespace VideoCommon
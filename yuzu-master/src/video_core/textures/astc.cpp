@@ -16,8 +16,8 @@
 #include "common/alignment.h"
 #include "common/common_types.h"
 #include "common/polyfill_ranges.h"
+#include "common/task_scheduler.h"
 #include "video_core/textures/astc.h"
-#include "video_core/textures/workers.h"
 
 class InputBitStream {
 public:
@@ -43,20 +43,28 @@ public:
     }
 
     constexpr u32 ReadBits(std::size_t nBits) {
+        // Consume as many bits as possible from the current byte on each iteration
         u32 ret = 0;
-        for (std::size_t i = 0; i < nBits; ++i) {
-            ret |= (ReadBit() & 1) << i;
+        std::size_t shift = 0;
+        while (shift < nBits && bits_read < total_bits * 8) {
+            const std::size_t count = std::min({nBits - shift, 8 - next_bit,
+                                                total_bits * 8 - bits_read});
+            const u32 chunk = (static_cast<u32>(*cur_byte) >> next_bit) & ((1U << count) - 1);
+            ret |= chunk << shift;
+            shift += count;
+            next_bit += count;
+            bits_read += count;
+            if (next_bit >= 8) {
+                next_bit -= 8;
+                ++cur_byte;
+            }
         }
         return ret;
     }
 
     template <std::size_t nBits>
     constexpr u32 ReadBits() {
-        u32 ret = 0;
-        for (std::size_t i = 0; i < nBits; ++i) {
-            ret |= (ReadBit() & 1) << i;
-        }
-        return ret;
+        return ReadBits(nBits);
     }
 
 private:
@@ -221,10 +229,98 @@ using IntegerEncodedVector = boost::container::static_vector<
         boost::container::inplace_alignment<alignof(IntegerEncodedValue)>,
         boost::container::throw_on_overflow<false>>::type>;
 
+// Unpacks the 8 bit trit block selector into its five trits, section C.2.12
+static constexpr std::array<u8, 5> UnpackTrits(u32 T) {
+    const auto bit = [](u32 value, u32 index) { return (value >> index) & 1; };
+    const auto range = [](u32 value, u32 start, u32 end) {
+        return (value >> start) & ((1U << (end - start + 1)) - 1);
+    };
+    std::array<u8, 5> t{};
+    u32 C = 0;
+    if (range(T, 2, 4) == 7) {
+        C = (range(T, 5, 7) << 2) | range(T, 0, 1);
+        t[4] = t[3] = 2;
+    } else {
+        C = range(T, 0, 4);
+        if (range(T, 5, 6) == 3) {
+            t[4] = 2;
+            t[3] = static_cast<u8>(bit(T, 7));
+        } else {
+            t[4] = static_cast<u8>(bit(T, 7));
+            t[3] = static_cast<u8>(range(T, 5, 6));
+        }
+    }
+
+    if (range(C, 0, 1) == 3) {
+        t[2] = 2;
+        t[1] = static_cast<u8>(bit(C, 4));
+        t[0] = static_cast<u8>((bit(C, 3) << 1) | (bit(C, 2) & ~bit(C, 3)));
+    } else if (range(C, 2, 3) == 3) {
+        t[2] = 2;
+        t[1] = 2;
+        t[0] = static_cast<u8>(range(C, 0, 1));
+    } else {
+        t[2] = static_cast<u8>(bit(C, 4));
+        t[1] = static_cast<u8>(range(C, 2, 3));
+        t[0] = static_cast<u8>((bit(C, 1) << 1) | (bit(C, 0) & ~bit(C, 1)));
+    }
+    return t;
+}
+
+// Unpacks the 7 bit quint block selector into its three quints, section C.2.12
+static constexpr std::array<u8, 3> UnpackQuints(u32 Q) {
+    const auto bit = [](u32 value, u32 index) { return (value >> index) & 1; };
+    const auto range = [](u32 value, u32 start, u32 end) {
+        return (value >> start) & ((1U << (end - start + 1)) - 1);
+    };
+    std::array<u8, 3> q{};
+    if (range(Q, 1, 2) == 3 && range(Q, 5, 6) == 0) {
+        q[0] = q[1] = 4;
+        q[2] = static_cast<u8>((bit(Q, 0) << 2) | ((bit(Q, 4) & ~bit(Q, 0)) << 1) |
+                               (bit(Q, 3) & ~bit(Q, 0)));
+        return q;
+    }
+    u32 C = 0;
+    if (range(Q, 1, 2) == 3) {
+        q[2] = 4;
+        C = (range(Q, 3, 4) << 3) | ((~range(Q, 5, 6) & 3) << 1) | bit(Q, 0);
+    } else {
+        q[2] = static_cast<u8>(range(Q, 5, 6));
+        C = range(Q, 0, 4);
+    }
+
+    if (range(C, 0, 2) == 5) {
+        q[1] = 4;
+        q[0] = static_cast<u8>(range(C, 3, 4));
+    } else {
+        q[1] = static_cast<u8>(range(C, 3, 4));
+        q[0] = static_cast<u8>(range(C, 0, 2));
+    }
+    return q;
+}
+
+static constexpr auto MakeTritTable() {
+    std::array<std::array<u8, 5>, 256> table{};
+    for (u32 i = 0; i < table.size(); ++i) {
+        table[i] = UnpackTrits(i);
+    }
+    return table;
+}
+
+static constexpr auto MakeQuintTable() {
+    std::array<std::array<u8, 3>, 128> table{};
+    for (u32 i = 0; i < table.size(); ++i) {
+        table[i] = UnpackQuints(i);
+    }
+    return table;
+}
+
+static constexpr auto TRIT_TABLE = MakeTritTable();
+static constexpr auto QUINT_TABLE = MakeQuintTable();
+
 static void DecodeTritBlock(InputBitStream& bits, IntegerEncodedVector& result, u32 nBitsPerValue) {
     // Implement the algorithm in section C.2.12
     std::array<u32, 5> m;
-    std::array<u32, 5> t;
     u32 T;
 
     // Read the trit encoded block according to
@@ -240,38 +336,7 @@ static void DecodeTritBlock(InputBitStream& bits, IntegerEncodedVector& result,
     m[4] = bits.ReadBits(nBitsPerValue);
     T |= bits.ReadBit() << 7;
 
-    u32 C = 0;
-
-    Bits<u32> Tb(T);
-    if (Tb(2, 4) == 7) {
-        C = (Tb(5, 7) << 2) | Tb(0, 1);
-        t[4] = t[3] = 2;
-    } else {
-        C = Tb(0, 4);
-        if (Tb(5, 6) == 3) {
-            t[4] = 2;
-            t[3] = Tb[7];
-        } else {
-            t[4] = Tb[7];
-            t[3] = Tb(5, 6);
-        }
-    }
-
-    Bits<u32> Cb(C);
-    if (Cb(0, 1) == 3) {
-        t[2] = 2;
-        t[1] = Cb[4];
-        t[0] = (Cb[3] << 1) | (Cb[2] & ~Cb[3]);
-    } else if (Cb(2, 3) == 3) {
-        t[2] = 2;
-        t[1] = 2;
-        t[0] = Cb(0, 1);
-    } else {
-        t[2] = Cb[4];
-        t[1] = Cb(2, 3);
-        t[0] = (Cb[1] << 1) | (Cb[0] & ~Cb[1]);
-    }
-
+    const std::array<u8, 5>& t = TRIT_TABLE[T];
     for (std::size_t i = 0; i < 5; ++i) {
         IntegerEncodedValue& val = result.emplace_back(IntegerEncoding::Trit, nBitsPerValue);
         val.bit_value = m[i];
@@ -283,7 +348,6 @@ static void DecodeQuintBlock(InputBitStream& bits, IntegerEncodedVector& result,
                              u32 nBitsPerValue) {
     // Implement the algorithm in section C.2.12
     u32 m[3];
-    u32 q[3];
     u32 Q;
 
     // Read the trit encoded block according to
@@ -295,30 +359,7 @@ static void DecodeQuintBlock(InputBitStream& bits, IntegerEncodedVector& result,
     m[2] = bits.ReadBits(nBitsPerValue);
     Q |= bits.ReadBits<2>() << 5;
 
-    Bits<u32> Qb(Q);
-    if (Qb(1, 2) == 3 && Qb(5, 6) == 0) {
-        q[0] = q[1] = 4;
-        q[2] = (Qb[0] << 2) | ((Qb[4] & ~Qb[0]) << 1) | (Qb[3] & ~Qb[0]);
-    } else {
-        u32 C = 0;
-        if (Qb(1, 2) == 3) {
-            q[2] = 4;
-            C = (Qb(3, 4) << 3) | ((~Qb(5, 6) & 3) << 1) | Qb[0];
-        } else {
-            q[2] = Qb(5, 6);
-            C = Qb(0, 4);
-        }
-
-        Bits<u32> Cb(C);
-        if (Cb(0, 2) == 5) {
-            q[1] = 4;
-            q[0] = Cb(3, 4);
-        } else {
-            q[1] = Cb(3, 4);
-            q[0] = Cb(0, 2);
-        }
-    }
-
+    const std::array<u8, 3>& q = QUINT_TABLE[Q];
     for (std::size_t i = 0; i < 3; ++i) {
         IntegerEncodedValue& val = result.emplace_back(IntegerEncoding::Quint, nBitsPerValue);
         val.bit_value = m[i];
@@ -1653,41 +1694,54 @@ static void DecompressBlock(std::span<const u8, 16> inBuf, const u32 blockWidth,
 
 void Decompress(std::span<const uint8_t> data, uint32_t width, uint32_t height, uint32_t depth,
                 uint32_t block_width, uint32_t block_height, std::span<uint8_t> output) {
+    // Minimum amount of blocks decoded by a single task, smaller jobs are dominated by the cost of
+    // waking up a worker.
+    static constexpr u32 MIN_BLOCKS_PER_TASK = 256;
+
     const u32 rows = Common::DivideUp(height, block_height);
     const u32 cols = Common::DivideUp(width, block_width);
-
-    Common::ThreadWorker& workers{GetThreadWorkers()};
-
-    for (u32 z = 0; z < depth; ++z) {
-        const u32 depth_offset = z * height * width * 4;
-        for (u32 y_index = 0; y_index < rows; ++y_index) {
-            auto decompress_stride = [data, width, height, block_width, block_height, output, rows,
-                                      cols, z, depth_offset, y_index] {
-                const u32 y = y_index * block_height;
-                for (u32 x_index = 0; x_index < cols; ++x_index) {
-                    const u32 block_index = (z * rows * cols) + (y_index * cols) + x_index;
-                    const u32 x = x_index * block_width;
-
-                    const std::span<const u8, 16> blockPtr{data.subspan(block_index * 16, 16)};
-
-                    // Blocks can be at most 12x12
-                    std::array<u32, 12 * 12> uncompData;
-                    DecompressBlock(blockPtr, block_width, block_height, uncompData);
-
-                    u32 decompWidth = std::min(block_width, width - x);
-                    u32 decompHeight = std::min(block_height, height - y);
-
-                    const std::span<u8> outRow = output.subspan(depth_offset + (y * width + x) * 4);
-                    for (u32 h = 0; h < decompHeight; ++h) {
-                        std::memcpy(outRow.data() + h * width * 4,
-                                    uncompData.data() + h * block_width, decompWidth * 4);
-                    }
+    const u32 total_rows = rows * depth;
+    const u32 rows_per_task = std::max(1U, MIN_BLOCKS_PER_TASK / cols);
+
+    const auto decompress_rows = [data, width, height, block_width, block_height, output, rows,
+                                  cols](u32 first_row, u32 last_row) {
+        // Blocks can be at most 12x12
+        std::array<u32, 12 * 12> uncompData;
+        for (u32 row = first_row; row < last_row; ++row) {
+            const u32 z = row / rows;
+            const u32 y_index = row % rows;
+            const u32 y = y_index * block_height;
+            const u32 depth_offset = z * height * width * 4;
+            const u32 decompHeight = std::min(block_height, height - y);
+            for (u32 x_index = 0; x_index < cols; ++x_index) {
+                const u32 block_index = row * cols + x_index;
+                const u32 x = x_index * block_width;
+
+                const std::span<const u8, 16> blockPtr{data.subspan(block_index * 16, 16)};
+                DecompressBlock(blockPtr, block_width, block_height, uncompData);
+
+                const u32 decompWidth = std::min(block_width, width - x);
+                u8* const outRow = output.data() + depth_offset + (y * width + x) * 4;
+                for (u32 h = 0; h < decompHeight; ++h) {
+                    std::memcpy(outRow + h * width * 4, uncompData.data() + h * block_width,
+                                decompWidth * 4);
                 }
-            };
-            workers.QueueWork(std::move(decompress_stride));
+            }
         }
-        workers.WaitForRequests();
+    };
+
+    if (total_rows <= rows_per_task) {
+        // Small images are decoded in place, handing them to the pool only adds latency
+        decompress_rows(0, total_rows);
+        return;
+    }
+
+    Common::TaskGroup workers{Common::TaskPriority::High};
+    for (u32 row = 0; row < total_rows; row += rows_per_task) {
+        const u32 last_row = std::min(row + rows_per_task, total_rows);
+        workers.Run([decompress_rows, row, last_row] { decompress_rows(row, last_row); });
     }
+    workers.Wait();
 }
 
 } // namespace Tegra::Texture::ASTC
@@ -4,8 +4,8 @@
 #include <stb_dxt.h>
 #include <string.h>
 #include "common/alignment.h"
+#include "common/task_scheduler.h"
 #include "video_core/textures/bcn.h"
-#include "video_core/textures/workers.h"
 
 namespace Tegra::Texture::BCN {
 
@@ -18,7 +18,7 @@ void CompressBCN(std::span<const uint8_t> data, uint32_t width, uint32_t height,
     constexpr u32 bytes_per_px = 4;
     const u32 plane_dim = width * height;
 
-    Common::ThreadWorker& workers{GetThreadWorkers()};
+    Common::TaskGroup workers{Common::TaskPriority::High};
 
     for (u32 z = 0; z < depth; z++) {
         for (u32 y = 0; y < height; y += 4) {
@@ -60,9 +60,9 @@ void CompressBCN(std::span<const uint8_t> data, uint32_t width, uint32_t height,
                       reinterpret_cast<u8*>(input_colors), any_alpha);
                 }
             };
-            workers.QueueWork(std::move(compress_row));
+            workers.Run(std::move(compress_row));
         }
-        workers.WaitForRequests();
+        workers.Wait();
     }
 }
 
@@ -1,15 +1,27 @@
 // SPDX-FileCopyrightText: Copyright 2018 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <array>
+#include <bit>
 #include <cmath>
 #include <cstring>
 #include <span>
 
+#ifdef ARCHITECTURE_x86_64
+#include <immintrin.h>
+#elif defined(ARCHITECTURE_arm64)
+#include <arm_neon.h>
+#endif
+
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/bit_util.h"
+#include "common/common_funcs.h"
 #include "common/div_ceil.h"
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif
 #include "video_core/gpu.h"
 #include "video_core/textures/decoders.h"
 
@@ -33,6 +45,237 @@ void incrpdep(u32& value) {
     value = ((value | ~mask) + swizzled_incr) & mask;
 }
 
+/// Offset of a 16 byte sector of a GOB line, in format 16 bytes x 2 sector packing.
+constexpr u32 GobSectorOffset(u32 sector, u32 y) {
+    return (sector >> 1) * 256 + (y >> 1) * 64 + (sector & 1) * 32 + (y & 1) * 16;
+}
+
+constexpr u32 GOB_SECTOR_SIZE = 16;
+constexpr u32 GOB_SECTORS_X = GOB_SIZE_X / GOB_SECTOR_SIZE;
+
+/**
+ * Copies a horizontal run of whole GOBs between block linear and pitch linear memory.
+ * When TO_LINEAR is true, output is the swizzled surface, matching SwizzleImpl.
+ *
+ * @param output     Pointer to the first GOB (or first line) to write
+ * @param input      Pointer to the first line (or first GOB) to read
+ * @param pitch      Distance in bytes between lines of the pitch linear surface
+ * @param num_gobs   Number of horizontally adjacent GOBs to copy
+ * @param gob_stride Distance in bytes between horizontally adjacent GOBs
+ */
+using GobCopyFunction = void (*)(u8* output, const u8* input, u32 pitch, u32 num_gobs,
+                                 u32 gob_stride);
+
+template <bool TO_LINEAR>
+void CopyGobsGeneric(u8* output, const u8* input, u32 pitch, u32 num_gobs, u32 gob_stride) {
+    for (u32 gob = 0; gob < num_gobs; ++gob) {
+        const u32 swizzled_base = gob * gob_stride;
+        const u32 linear_base = gob * GOB_SIZE_X;
+        for (u32 y = 0; y < GOB_SIZE_Y; ++y) {
+            for (u32 sector = 0; sector < GOB_SECTORS_X; ++sector) {
+                const u32 swizzled_offset = swizzled_base + GobSectorOffset(sector, y);
+                const u32 linear_offset = linear_base + y * pitch + sector * GOB_SECTOR_SIZE;
+                u8* const dst = output + (TO_LINEAR ? swizzled_offset : linear_offset);
+                const u8* const src = input + (TO_LINEAR ? linear_offset : swizzled_offset);
+                std::memcpy(dst, src, GOB_SECTOR_SIZE);
+            }
+        }
+    }
+}
+
+#ifdef ARCHITECTURE_x86_64
+template <bool TO_LINEAR>
+TARGET_ISA("avx2")
+void CopyGobsAVX2(u8* output, const u8* input, u32 pitch, u32 num_gobs, u32 gob_stride) {
+    // Sectors of two consecutive lines are adjacent in a GOB, move both with a single 32 byte
+    // access on the swizzled side.
+    for (u32 gob = 0; gob < num_gobs; ++gob) {
+        const u32 swizzled_base = gob * gob_stride;
+        const u32 linear_base = gob * GOB_SIZE_X;
+        for (u32 y = 0; y < GOB_SIZE_Y; y += 2) {
+            for (u32 sector = 0; sector < GOB_SECTORS_X; ++sector) {
+                const u32 swizzled_offset = swizzled_base + GobSectorOffset(sector, y);
+                const u32 linear_offset = linear_base + y * pitch + sector * GOB_SECTOR_SIZE;
+                if constexpr (TO_LINEAR) {
+                    const __m128i low = _mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(input + linear_offset));
+                    const __m128i high = _mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(input + linear_offset + pitch));
+                    const __m256i value =
+                        _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + swizzled_offset),
+                                        value);
+                } else {
+                    const __m256i value = _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(input + swizzled_offset));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + linear_offset),
+                                     _mm256_castsi256_si128(value));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + linear_offset + pitch),
+                                     _mm256_extracti128_si256(value, 1));
+                }
+            }
+        }
+    }
+}
+#endif
+
+#ifdef ARCHITECTURE_arm64
+template <bool TO_LINEAR>
+void CopyGobsNEON(u8* output, const u8* input, u32 pitch, u32 num_gobs, u32 gob_stride) {
+    for (u32 gob = 0; gob < num_gobs; ++gob) {
+        const u32 swizzled_base = gob * gob_stride;
+        const u32 linear_base = gob * GOB_SIZE_X;
+        for (u32 y = 0; y < GOB_SIZE_Y; y += 2) {
+            for (u32 sector = 0; sector < GOB_SECTORS_X; ++sector) {
+                const u32 swizzled_offset = swizzled_base + GobSectorOffset(sector, y);
+                const u32 linear_offset = linear_base + y * pitch + sector * GOB_SECTOR_SIZE;
+                if constexpr (TO_LINEAR) {
+                    const uint8x16_t low = vld1q_u8(input + linear_offset);
+                    const uint8x16_t high = vld1q_u8(input + linear_offset + pitch);
+                    vst1q_u8(output + swizzled_offset, low);
+                    vst1q_u8(output + swizzled_offset + GOB_SECTOR_SIZE, high);
+                } else {
+                    const uint8x16_t low = vld1q_u8(input + swizzled_offset);
+                    const uint8x16_t high = vld1q_u8(input + swizzled_offset + GOB_SECTOR_SIZE);
+                    vst1q_u8(output + linear_offset, low);
+                    vst1q_u8(output + linear_offset + pitch, high);
+                }
+            }
+        }
+    }
+}
+#endif
+
+template <bool TO_LINEAR>
+GobCopyFunction GetGobCopyFunction() {
+    static const GobCopyFunction function = []() -> GobCopyFunction {
+#if defined(ARCHITECTURE_x86_64)
+        if (Common::GetCPUCaps().avx2) {
+            return CopyGobsAVX2<TO_LINEAR>;
+        }
+#elif defined(ARCHITECTURE_arm64)
+        return CopyGobsNEON<TO_LINEAR>;
+#endif
+        return CopyGobsGeneric<TO_LINEAR>;
+    }();
+    return function;
+}
+
+struct BlockLinearLayout {
+    u32 block_size;
+    u32 slice_size;
+    u32 block_height;
+    u32 block_height_mask;
+    u32 block_depth;
+    u32 block_depth_mask;
+    u32 x_shift;
+};
+
+constexpr BlockLinearLayout MakeBlockLinearLayout(u32 stride, u32 height, u32 block_height,
+                                                  u32 block_depth) {
+    const u32 gobs_in_x = Common::DivCeilLog2(stride, GOB_SIZE_X_SHIFT);
+    const u32 block_size = gobs_in_x << (GOB_SIZE_SHIFT + block_height + block_depth);
+    return {
+        .block_size = block_size,
+        .slice_size = Common::DivCeilLog2(height, block_height + GOB_SIZE_Y_SHIFT) * block_size,
+        .block_height = block_height,
+        .block_height_mask = (1U << block_height) - 1,
+        .block_depth = block_depth,
+        .block_depth_mask = (1U << block_depth) - 1,
+        .x_shift = GOB_SIZE_SHIFT + block_height + block_depth,
+    };
+}
+
+constexpr u32 SliceOffset(const BlockLinearLayout& layout, u32 z) {
+    return (z >> layout.block_depth) * layout.slice_size +
+           ((z & layout.block_depth_mask) << (GOB_SIZE_SHIFT + layout.block_height));
+}
+
+constexpr u32 GobLineOffset(const BlockLinearLayout& layout, u32 y) {
+    const u32 block_y = y >> GOB_SIZE_Y_SHIFT;
+    return (block_y >> layout.block_height) * layout.block_size +
+           ((block_y & layout.block_height_mask) << GOB_SIZE_SHIFT);
+}
+
+/// Swizzles the pixels in [column_begin, column_end) x [line_begin, line_end) one at a time.
+template <bool TO_LINEAR, u32 BYTES_PER_PIXEL>
+void SwizzleRows(std::span<u8> output, std::span<const u8> input, const BlockLinearLayout& layout,
+                 u32 offset_z, u32 linear_base, u32 pitch, u32 origin_x, u32 origin_y,
+                 u32 column_begin, u32 column_end, u32 line_begin, u32 line_end) {
+    for (u32 line = line_begin; line < line_end; ++line) {
+        const u32 y = line + origin_y;
+        const u32 swizzled_y = pdep<SWIZZLE_Y_BITS>(y);
+        const u32 offset_y = GobLineOffset(layout, y);
+
+        u32 swizzled_x = pdep<SWIZZLE_X_BITS>((column_begin + origin_x) * BYTES_PER_PIXEL);
+        for (u32 column = column_begin; column < column_end;
+             ++column, incrpdep<SWIZZLE_X_BITS, BYTES_PER_PIXEL>(swizzled_x)) {
+            const u32 x = (column + origin_x) * BYTES_PER_PIXEL;
+            const u32 offset_x = (x >> GOB_SIZE_X_SHIFT) << layout.x_shift;
+
+            const u32 base_swizzled_offset = offset_z + offset_y + offset_x;
+            const u32 swizzled_offset = base_swizzled_offset + (swizzled_x | swizzled_y);
+
+            const u32 unswizzled_offset = linear_base + line * pitch + column * BYTES_PER_PIXEL;
+
+            u8* const dst = &output[TO_LINEAR ? swizzled_offset : unswizzled_offset];
+            const u8* const src = &input[TO_LINEAR ? unswizzled_offset : swizzled_offset];
+
+            std::memcpy(dst, src, BYTES_PER_PIXEL);
+        }
+    }
+}
+
+/**
+ * Swizzles a rectangle of a single slice. Whole GOBs inside the rectangle are moved a sector at a
+ * time, the unaligned borders fall back to per pixel copies.
+ */
+template <bool TO_LINEAR, u32 BYTES_PER_PIXEL>
+void SwizzleSlice(std::span<u8> output, std::span<const u8> input, const BlockLinearLayout& layout,
+                  u32 offset_z, u32 linear_base, u32 pitch, u32 origin_x, u32 origin_y,
+                  u32 extent_x, u32 num_lines) {
+    u32 line = 0;
+    // Pixels of non power of two sizes can straddle sectors, keep them on the per pixel path.
+    if constexpr (std::has_single_bit(BYTES_PER_PIXEL)) {
+        const u32 x_begin = origin_x * BYTES_PER_PIXEL;
+        const u32 x_end = (origin_x + extent_x) * BYTES_PER_PIXEL;
+        const u32 gob_x_begin = Common::AlignUpLog2(x_begin, GOB_SIZE_X_SHIFT);
+        const u32 gob_x_end = x_end >> GOB_SIZE_X_SHIFT << GOB_SIZE_X_SHIFT;
+        const u32 band_begin =
+            std::min(Common::AlignUpLog2(origin_y, GOB_SIZE_Y_SHIFT) - origin_y, num_lines);
+        if (gob_x_begin < gob_x_end && band_begin + GOB_SIZE_Y <= num_lines) {
+            const GobCopyFunction copy_gobs = GetGobCopyFunction<TO_LINEAR>();
+            const u32 num_gobs = (gob_x_end - gob_x_begin) >> GOB_SIZE_X_SHIFT;
+            const u32 gob_stride = 1U << layout.x_shift;
+            const u32 column_gob_begin = gob_x_begin / BYTES_PER_PIXEL - origin_x;
+            const u32 column_gob_end = gob_x_end / BYTES_PER_PIXEL - origin_x;
+            const u32 offset_x = (gob_x_begin >> GOB_SIZE_X_SHIFT) << layout.x_shift;
+
+            SwizzleRows<TO_LINEAR, BYTES_PER_PIXEL>(output, input, layout, offset_z, linear_base,
+                                                    pitch, origin_x, origin_y, 0, extent_x, 0,
+                                                    band_begin);
+            for (line = band_begin; line + GOB_SIZE_Y <= num_lines; line += GOB_SIZE_Y) {
+                const u32 swizzled_offset =
+                    offset_z + GobLineOffset(layout, line + origin_y) + offset_x;
+                const u32 unswizzled_offset =
+                    linear_base + line * pitch + column_gob_begin * BYTES_PER_PIXEL;
+                u8* const dst = &output[TO_LINEAR ? swizzled_offset : unswizzled_offset];
+                const u8* const src = &input[TO_LINEAR ? unswizzled_offset : swizzled_offset];
+                copy_gobs(dst, src, pitch, num_gobs, gob_stride);
+
+                SwizzleRows<TO_LINEAR, BYTES_PER_PIXEL>(output, input, layout, offset_z,
+                                                        linear_base, pitch, origin_x, origin_y, 0,
+                                                        column_gob_begin, line, line + GOB_SIZE_Y);
+                SwizzleRows<TO_LINEAR, BYTES_PER_PIXEL>(
+                    output, input, layout, offset_z, linear_base, pitch, origin_x, origin_y,
+                    column_gob_end, extent_x, line, line + GOB_SIZE_Y);
+            }
+        }
+    }
+    SwizzleRows<TO_LINEAR, BYTES_PER_PIXEL>(output, input, layout, offset_z, linear_base, pitch,
+                                            origin_x, origin_y, 0, extent_x, line, num_lines);
+}
+
 template <bool TO_LINEAR, u32 BYTES_PER_PIXEL>
 void SwizzleImpl(std::span<u8> output, std::span<const u8> input, u32 width, u32 height, u32 depth,
                  u32 block_height, u32 block_depth, u32 stride) {
@@ -46,45 +289,14 @@ void SwizzleImpl(std::span<u8> output, std::span<const u8> input, u32 width, u32
     // As it's not exposed 'width * BYTES_PER_PIXEL' will be the expected pitch.
     const u32 pitch = width * BYTES_PER_PIXEL;
 
-    const u32 gobs_in_x = Common::DivCeilLog2(stride, GOB_SIZE_X_SHIFT);
-    const u32 block_size = gobs_in_x << (GOB_SIZE_SHIFT + block_height + block_depth);
-    const u32 slice_size =
-        Common::DivCeilLog2(height, block_height + GOB_SIZE_Y_SHIFT) * block_size;
-
-    const u32 block_height_mask = (1U << block_height) - 1;
-    const u32 block_depth_mask = (1U << block_depth) - 1;
-    const u32 x_shift = GOB_SIZE_SHIFT + block_height + block_depth;
+    const BlockLinearLayout layout =
+        MakeBlockLinearLayout(stride, height, block_height, block_depth);
 
     for (u32 slice = 0; slice < depth; ++slice) {
-        const u32 z = slice + origin_z;
-        const u32 offset_z = (z >> block_depth) * slice_size +
-                             ((z & block_depth_mask) << (GOB_SIZE_SHIFT + block_height));
-        for (u32 line = 0; line < height; ++line) {
-            const u32 y = line + origin_y;
-            const u32 swizzled_y = pdep<SWIZZLE_Y_BITS>(y);
-
-            const u32 block_y = y >> GOB_SIZE_Y_SHIFT;
-            const u32 offset_y = (block_y >> block_height) * block_size +
-                                 ((block_y & block_height_mask) << GOB_SIZE_SHIFT);
-
-            u32 swizzled_x = pdep<SWIZZLE_X_BITS>(origin_x * BYTES_PER_PIXEL);
-            for (u32 column = 0; column < width;
-                 ++column, incrpdep<SWIZZLE_X_BITS, BYTES_PER_PIXEL>(swizzled_x)) {
-                const u32 x = (column + origin_x) * BYTES_PER_PIXEL;
-                const u32 offset_x = (x >> GOB_SIZE_X_SHIFT) << x_shift;
-
-                const u32 base_swizzled_offset = offset_z + offset_y + offset_x;
-                const u32 swizzled_offset = base_swizzled_offset + (swizzled_x | swizzled_y);
-
-                const u32 unswizzled_offset =
-                    slice * pitch * height + line * pitch + column * BYTES_PER_PIXEL;
-
-                u8* const dst = &output[TO_LINEAR ? swizzled_offset : unswizzled_offset];
-                const u8* const src = &input[TO_LINEAR ? unswizzled_offset : swizzled_offset];
-
-                std::memcpy(dst, src, BYTES_PER_PIXEL);
-            }
-        }
+        const u32 offset_z = SliceOffset(layout, slice + origin_z);
+        SwizzleSlice<TO_LINEAR, BYTES_PER_PIXEL>(output, input, layout, offset_z,
+                                                 slice * pitch * height, pitch, origin_x,
+                                                 origin_y, width, height);
     }
 }
 
@@ -101,49 +313,18 @@ void SwizzleSubrectImpl(std::span<u8> output, std::span<const u8> input, u32 wid
     const u32 pitch = pitch_linear;
     const u32 stride = Common::AlignUpLog2(width * BYTES_PER_PIXEL, GOB_SIZE_X_SHIFT);
 
-    const u32 gobs_in_x = Common::DivCeilLog2(stride, GOB_SIZE_X_SHIFT);
-    const u32 block_size = gobs_in_x << (GOB_SIZE_SHIFT + block_height + block_depth);
-    const u32 slice_size =
-        Common::DivCeilLog2(height, block_height + GOB_SIZE_Y_SHIFT) * block_size;
-
-    const u32 block_height_mask = (1U << block_height) - 1;
-    const u32 block_depth_mask = (1U << block_depth) - 1;
-    const u32 x_shift = GOB_SIZE_SHIFT + block_height + block_depth;
+    const BlockLinearLayout layout =
+        MakeBlockLinearLayout(stride, height, block_height, block_depth);
 
     u32 unprocessed_lines = num_lines;
     u32 extent_y = std::min(num_lines, height - origin_y);
 
     for (u32 slice = 0; slice < depth; ++slice) {
-        const u32 z = slice + origin_z;
-        const u32 offset_z = (z >> block_depth) * slice_size +
-                             ((z & block_depth_mask) << (GOB_SIZE_SHIFT + block_height));
+        const u32 offset_z = SliceOffset(layout, slice + origin_z);
         const u32 lines_in_y = std::min(unprocessed_lines, extent_y);
-        for (u32 line = 0; line < lines_in_y; ++line) {
-            const u32 y = line + origin_y;
-            const u32 swizzled_y = pdep<SWIZZLE_Y_BITS>(y);
-
-            const u32 block_y = y >> GOB_SIZE_Y_SHIFT;
-            const u32 offset_y = (block_y >> block_height) * block_size +
-                                 ((block_y & block_height_mask) << GOB_SIZE_SHIFT);
-
-            u32 swizzled_x = pdep<SWIZZLE_X_BITS>(origin_x * BYTES_PER_PIXEL);
-            for (u32 column = 0; column < extent_x;
-                 ++column, incrpdep<SWIZZLE_X_BITS, BYTES_PER_PIXEL>(swizzled_x)) {
-                const u32 x = (column + origin_x) * BYTES_PER_PIXEL;
-                const u32 offset_x = (x >> GOB_SIZE_X_SHIFT) << x_shift;
-
-                const u32 base_swizzled_offset = offset_z + offset_y + offset_x;
-                const u32 swizzled_offset = base_swizzled_offset + (swizzled_x | swizzled_y);
-
-                const u32 unswizzled_offset =
-                    slice * pitch * height + line * pitch + column * BYTES_PER_PIXEL;
-
-                u8* const dst = &output[TO_LINEAR ? swizzled_offset : unswizzled_offset];
-                const u8* const src = &input[TO_LINEAR ? unswizzled_offset : swizzled_offset];
-
-                std::memcpy(dst, src, BYTES_PER_PIXEL);
-            }
-        }
+        SwizzleSlice<TO_LINEAR, BYTES_PER_PIXEL>(output, input, layout, offset_z,
+                                                 slice * pitch * height, pitch, origin_x,
+                                                 origin_y, extent_x, lines_in_y);
         unprocessed_lines -= lines_in_y;
         if (unprocessed_lines == 0) {
             return;
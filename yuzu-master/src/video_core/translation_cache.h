@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: Copyright 2024 yuzu Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <type_traits>
+
+#include "common/common_types.h"
+
+namespace Tegra {
+
+/**
+ * Direct mapped cache of page translations, meant to be owned by a single thread so lookups never
+ * synchronize. Entries are tagged with the owner of the page tables they were read from and with
+ * a generation the owner bumps whenever it modifies its page tables, so a single bump drops every
+ * entry read before it.
+ *
+ * The cache is trivially constructible to be usable as a thread_local without an initialization
+ * guard. A zero initialized entry never matches, generations must start above zero.
+ * Pages must be below 2^40 and owners below 2^24, they share the tag of an entry.
+ */
+template <typename Value, size_t NumEntries>
+class TranslationCache {
+    static_assert((NumEntries & (NumEntries - 1)) == 0, "NumEntries must be a power of two");
+    static_assert(std::is_trivially_default_constructible_v<Value>);
+
+public:
+    /// Returns the cached translation of a page, or nullptr when it has to be read again.
+    [[nodiscard]] const Value* Find(size_t owner, u64 page, u64 generation) const {
+        const Entry& entry = entries[page & (NumEntries - 1)];
+        if (entry.tag != Tag(owner, page) || entry.generation != generation) {
+            return nullptr;
+        }
+        return &entry.value;
+    }
+
+    /// Caches the translation of a page, replacing the page sharing its slot.
+    const Value& Insert(size_t owner, u64 page, u64 generation, const Value& value) {
+        Entry& entry = entries[page & (NumEntries - 1)];
+        entry.tag = Tag(owner, page);
+        entry.generation = generation;
+        entry.value = value;
+        return entry.value;
+    }
+
+private:
+    struct Entry {
+        u64 tag;
+        u64 generation;
+        Value value;
+    };
+
+    static constexpr u64 Tag(size_t owner, u64 page) {
+        return (static_cast<u64>(owner) << 40) | page;
+    }
+
+    std::array<Entry, NumEntries> entries;
+};
+
+} // namespace Tegra
@@ -3278,8 +3278,13 @@ void GMainWindow::OnMenuInstallToNAND() {
         ContentManager::InstallResult result;
 
         if (file.endsWith(QStringLiteral("nsp"), Qt::CaseInsensitive)) {
-            const auto progress_callback = [this](size_t size, size_t progress) {
-                emit UpdateInstallProgress();
+            const auto progress_callback = [this, reported = size_t{0}](size_t size,
+                                                                        size_t progress) mutable {
+                // The dialog counts in CopyBufferSize steps, progress restarts with each file
+                reported = std::min(reported, progress);
+                for (; reported + CopyBufferSize <= progress; reported += CopyBufferSize) {
+                    emit UpdateInstallProgress();
+                }
                 if (install_progress->wasCanceled()) {
                     return true;
                 }
@@ -3382,8 +3387,12 @@ ContentManager::InstallResult GMainWindow::InstallNCA(const QString& filename) {
     auto* registered_cache = is_application ? fs_controller.GetUserNANDContents()
                                             : fs_controller.GetSystemNANDContents();
 
-    const auto progress_callback = [this](size_t size, size_t progress) {
-        emit UpdateInstallProgress();
+    const auto progress_callback = [this, reported = size_t{0}](size_t size,
+                                                                size_t progress) mutable {
+        // The dialog counts in CopyBufferSize steps
+        for (; reported + CopyBufferSize <= progress; reported += CopyBufferSize) {
+            emit UpdateInstallProgress();
+        }
         if (install_progress->wasCanceled()) {
             return true;
         }